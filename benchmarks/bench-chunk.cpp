@@ -0,0 +1,178 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.hpp"
+#include "voxy/chunk.hpp"
+
+#include <string>
+#include <random>
+#include <vector>
+#include <memory>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace std;
+using namespace voxy;
+
+struct VoxelPos { uint8_t x, y, z; };
+
+template<uint8_t S, typename V>
+static void benchChunk(const char* typeName)
+{
+	typedef Chunk3<S, S, S, V> Chunk;
+	auto prefix = "chunk/" + to_string(S) + "x" + to_string(S) + "x" + to_string(S) + "/" + typeName + "/";
+	auto name = [&](const char* op) { return prefix + op; };
+
+	auto chunk = make_unique<Chunk>(voxel::null);
+	auto other = make_unique<Chunk>(voxel::null);
+	auto source = make_unique<V[]>(Chunk::size);
+	for (size_t i = 0; i < Chunk::size; i++)
+		source[i] = (V)(i % 7 + voxel::predefinedCount);
+
+	vector<VoxelPos> positions;
+	positions.reserve(Chunk::size);
+	for (uint8_t z = 0; z < S; z++)
+	{
+		for (uint8_t y = 0; y < S; y++)
+		{
+			for (uint8_t x = 0; x < S; x++)
+				positions.push_back({ x, y, z });
+		}
+	}
+	auto randomPositions = positions;
+	shuffle(randomPositions.begin(), randomPositions.end(), mt19937(1));
+
+	bench::run(name("get/linear").c_str(), Chunk::size, [&]()
+	{
+		uint64_t sum = 0;
+		for (const auto& pos : positions)
+			sum += chunk->get(pos.x, pos.y, pos.z);
+		bench::sink = bench::sink + sum;
+	});
+	bench::run(name("get/random").c_str(), Chunk::size, [&]()
+	{
+		uint64_t sum = 0;
+		for (const auto& pos : randomPositions)
+			sum += chunk->get(pos.x, pos.y, pos.z);
+		bench::sink = bench::sink + sum;
+	});
+	bench::run(name("set/linear").c_str(), Chunk::size, [&]()
+	{
+		for (const auto& pos : positions)
+			chunk->set(pos.x, pos.y, pos.z, (V)pos.x);
+		bench::sink = bench::sink + chunk->get(1, 1, 1);
+	});
+	bench::run(name("set/random").c_str(), Chunk::size, [&]()
+	{
+		for (const auto& pos : randomPositions)
+			chunk->set(pos.x, pos.y, pos.z, (V)pos.y);
+		bench::sink = bench::sink + chunk->get(1, 1, 1);
+	});
+
+	bench::run(name("fill").c_str(), Chunk::size, [&]()
+	{
+		chunk->fill((V)voxel::unknown);
+		bench::sink = bench::sink + chunk->get(1, 1, 1);
+	});
+	bench::run(name("fill/region").c_str(), (size_t)(S - 2) * (S - 2) * (S - 2), [&]()
+	{
+		chunk->fill((V)voxel::null, S - 2, S - 2, S - 2, 1, 1, 1);
+		bench::sink = bench::sink + chunk->get(1, 1, 1);
+	});
+	bench::run(name("copy").c_str(), Chunk::size, [&]()
+	{
+		chunk->copy(source.get());
+		bench::sink = bench::sink + chunk->get(1, 1, 1);
+	});
+	bench::run(name("copy/region").c_str(), (size_t)(S - 2) * (S - 2) * (S - 2), [&]()
+	{
+		chunk->copy(source.get(), S - 2, S - 2, S - 2, 1, 1, 1);
+		bench::sink = bench::sink + chunk->get(1, 1, 1);
+	});
+
+	other->copy(chunk->getVoxels());
+	bench::run(name("compare").c_str(), Chunk::size, [&]()
+	{
+		bench::sink = bench::sink + (*chunk == *other);
+	});
+	bench::run(name("count").c_str(), Chunk::size, [&]()
+	{
+		bench::sink = bench::sink + chunk->count((V)voxel::predefinedCount);
+	});
+	bench::run(name("replace").c_str(), Chunk::size, [&]()
+	{
+		bench::sink = bench::sink + chunk->replace((V)voxel::predefinedCount, (V)voxel::predefinedCount);
+	});
+}
+
+template<uint8_t S, class L>
+static void benchLayout(const char* layoutName)
+{
+	typedef Chunk3<S, S, S, uint16_t, L> Chunk;
+	auto name = "chunk/" + to_string(S) + "x" + to_string(S) + "x" + to_string(S) + "/u16/" + layoutName + "/";
+	auto chunk = make_unique<Chunk>(voxel::null);
+	for (size_t i = 0; i < Chunk::size; i++)
+		chunk->set(i, (uint16_t)(i % 5));
+
+	bench::run((name + "neighbours").c_str(), (size_t)(S - 2) * (S - 2) * (S - 2), [&]()
+	{
+		uint64_t sum = 0;
+		for (uint8_t z = 1; z < S - 1; z++)
+		{
+			for (uint8_t y = 1; y < S - 1; y++)
+			{
+				for (uint8_t x = 1; x < S - 1; x++)
+				{
+					sum += chunk->get(x - 1, y, z) + chunk->get(x + 1, y, z) + chunk->get(x, y - 1, z) +
+						chunk->get(x, y + 1, z) + chunk->get(x, y, z - 1) + chunk->get(x, y, z + 1);
+				}
+			}
+		}
+		bench::sink = bench::sink + sum;
+	});
+	bench::run((name + "fill/region").c_str(), (size_t)(S / 2) * (S / 2) * (S / 2), [&]()
+	{
+		chunk->fill((uint16_t)voxel::unknown, S / 2, S / 2, S / 2, 1, 1, 1);
+		bench::sink = bench::sink + chunk->get(1, 1, 1);
+	});
+}
+
+template<uint8_t S>
+static void benchLayouts()
+{
+	benchLayout<S, layout::Linear>("linear");
+	benchLayout<S, layout::Morton>("morton");
+	benchLayout<S, layout::Brick>("brick");
+}
+
+template<uint8_t S>
+static void benchChunks()
+{
+	benchChunk<S, uint8_t>("u8");
+	benchChunk<S, uint16_t>("u16");
+	benchChunk<S, uint32_t>("u32");
+}
+
+int main(int argc, char* argv[])
+{
+	if (!bench::init(argc, argv))
+		return EXIT_FAILURE;
+
+	benchChunks<16>();
+	benchChunks<32>();
+	benchChunks<64>();
+	benchLayouts<32>();
+	benchLayouts<64>();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.hpp"
+#include "voxy/cluster.hpp"
+
+#include <random>
+#include <vector>
+#include <cstdlib>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint16_t> Chunk;
+typedef Cluster3<Chunk, uint16_t> Cluster;
+typedef Cluster27<Chunk, uint16_t> FullCluster;
+
+struct VoxelPos { int16_t x, y, z; };
+
+static constexpr size_t posCount = 1024 * 64;
+
+// Previous six-way if-chain neighbour chunk lookup.
+static uint16_t getBranched(const Cluster& cluster, int16_t x, int16_t y, int16_t z)
+{
+	if (x < 0)
+		return cluster.nx->get(x + Chunk::sizeX, y, z);
+	if (x >= Chunk::sizeX)
+		return cluster.px->get(x - Chunk::sizeX, y, z);
+	if (y < 0)
+		return cluster.ny->get(x, y + Chunk::sizeY, z);
+	if (y >= Chunk::sizeY)
+		return cluster.py->get(x, y - Chunk::sizeY, z);
+	if (z < 0)
+		return cluster.nz->get(x, y, z + Chunk::sizeZ);
+	if (z >= Chunk::sizeZ)
+		return cluster.pz->get(x, y, z - Chunk::sizeZ);
+	return cluster.c->get(x, y, z);
+}
+
+int main(int argc, char* argv[])
+{
+	if (!bench::init(argc, argv))
+		return EXIT_FAILURE;
+
+	vector<Chunk> chunks(FullCluster::chunkSize, Chunk(1));
+	FullCluster fullCluster;
+	for (uint8_t i = 0; i < FullCluster::chunkSize; i++)
+		fullCluster.chunks[i] = &chunks[i];
+	Cluster cluster(fullCluster.getChunk(0, 0, 0), fullCluster.getChunk(-1, 0, 0), fullCluster.getChunk(1, 0, 0),
+		fullCluster.getChunk(0, -1, 0), fullCluster.getChunk(0, 1, 0),
+		fullCluster.getChunk(0, 0, -1), fullCluster.getChunk(0, 0, 1));
+
+	mt19937 random(1);
+	uniform_int_distribution<int16_t> inner(0, 15), border(-1, 16);
+	vector<VoxelPos> innerPositions(posCount), borderPositions(posCount), neighbourPositions(posCount);
+	for (auto& pos : innerPositions)
+		pos = { inner(random), inner(random), inner(random) };
+	for (auto& pos : borderPositions)
+	{
+		// Only one axis is outside the central chunk, so that Cluster3 can access it.
+		pos = { inner(random), inner(random), inner(random) };
+		auto value = border(random);
+		switch (random() % 3)
+		{
+			case 0: pos.x = value; break;
+			case 1: pos.y = value; break;
+			default: pos.z = value; break;
+		}
+	}
+	for (auto& pos : neighbourPositions)
+	{
+		// Each of the seven cluster chunks is accessed with the same probability.
+		pos = { inner(random), inner(random), inner(random) };
+		auto chunk = random() % 7;
+		if (chunk == 0)
+			continue;
+		auto offset = (int16_t)(chunk % 2 ? -16 : 16);
+		switch ((chunk - 1) / 2)
+		{
+			case 0: pos.x += offset; break;
+			case 1: pos.y += offset; break;
+			default: pos.z += offset; break;
+		}
+	}
+
+	bench::run("cluster3/get/inner", posCount, [&]()
+	{
+		uint64_t sum = 0;
+		for (const auto& pos : innerPositions)
+			sum += cluster.get(pos.x, pos.y, pos.z);
+		bench::sink = bench::sink + sum;
+	});
+	bench::run("cluster27/get/inner", posCount, [&]()
+	{
+		uint64_t sum = 0;
+		for (const auto& pos : innerPositions)
+			sum += fullCluster.get(pos.x, pos.y, pos.z);
+		bench::sink = bench::sink + sum;
+	});
+
+	bench::run("cluster3/get/border/branched", posCount, [&]()
+	{
+		uint64_t sum = 0;
+		for (const auto& pos : borderPositions)
+			sum += getBranched(cluster, pos.x, pos.y, pos.z);
+		bench::sink = bench::sink + sum;
+	});
+	bench::run("cluster3/get/border", posCount, [&]()
+	{
+		uint64_t sum = 0;
+		for (const auto& pos : borderPositions)
+			sum += cluster.get(pos.x, pos.y, pos.z);
+		bench::sink = bench::sink + sum;
+	});
+	bench::run("cluster3/tryGet/border", posCount, [&]()
+	{
+		uint64_t sum = 0;
+		for (const auto& pos : borderPositions)
+		{
+			uint16_t voxel = 0;
+			cluster.tryGet(pos.x, pos.y, pos.z, voxel);
+			sum += voxel;
+		}
+		bench::sink = bench::sink + sum;
+	});
+	bench::run("cluster3/set/border", posCount, [&]()
+	{
+		uint16_t voxel = 0;
+		for (const auto& pos : borderPositions)
+			cluster.set(pos.x, pos.y, pos.z, voxel++);
+		bench::sink = bench::sink + cluster.get(0, 0, 0);
+	});
+	bench::run("cluster27/get/border", posCount, [&]()
+	{
+		uint64_t sum = 0;
+		for (const auto& pos : borderPositions)
+			sum += fullCluster.get(pos.x, pos.y, pos.z);
+		bench::sink = bench::sink + sum;
+	});
+
+	bench::run("cluster3/get/neighbour/branched", posCount, [&]()
+	{
+		uint64_t sum = 0;
+		for (const auto& pos : neighbourPositions)
+			sum += getBranched(cluster, pos.x, pos.y, pos.z);
+		bench::sink = bench::sink + sum;
+	});
+	bench::run("cluster3/get/neighbour", posCount, [&]()
+	{
+		uint64_t sum = 0;
+		for (const auto& pos : neighbourPositions)
+			sum += cluster.get(pos.x, pos.y, pos.z);
+		bench::sink = bench::sink + sum;
+	});
+	bench::run("cluster3/set/neighbour", posCount, [&]()
+	{
+		uint16_t voxel = 0;
+		for (const auto& pos : neighbourPositions)
+			cluster.set(pos.x, pos.y, pos.z, voxel++);
+		bench::sink = bench::sink + cluster.get(0, 0, 0);
+	});
+	bench::run("cluster27/get/neighbour", posCount, [&]()
+	{
+		uint64_t sum = 0;
+		for (const auto& pos : neighbourPositions)
+			sum += fullCluster.get(pos.x, pos.y, pos.z);
+		bench::sink = bench::sink + sum;
+	});
+
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,207 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.hpp"
+#include "voxy/collision.hpp"
+#include "voxy/occupancy.hpp"
+
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint16_t> Chunk;
+typedef OccupancyChunk3<Chunk> OccupancyChunk;
+
+static constexpr int32_t worldSize = 8;
+static constexpr size_t entityCount = 4096;
+
+// Checks each voxel layer with the per voxel world lookups.
+template<class W>
+static float sweepAxisNaive(const W& world, const Aabb& box, uint8_t axis, float move)
+{
+	const float boxMin[3] = { box.minX, box.minY, box.minZ };
+	const float boxMax[3] = { box.maxX, box.maxY, box.maxZ };
+	int32_t min[3], max[3];
+	for (uint8_t i = 0; i < 3; i++)
+		calcVoxelRange(boxMin[i], boxMax[i], min[i], max[i]);
+
+	auto isBlocked = [&](int32_t layer)
+	{
+		min[axis] = layer; max[axis] = layer + 1;
+		for (auto z = min[2]; z < max[2]; z++)
+		{
+			for (auto y = min[1]; y < max[1]; y++)
+			{
+				for (auto x = min[0]; x < max[0]; x++)
+				{
+					uint16_t voxel;
+					if (world.tryGet(x, y, z, voxel) && voxel != voxel::null)
+						return true;
+				}
+			}
+		}
+		return false;
+	};
+
+	if (move > 0.0f)
+	{
+		auto end = ceilVoxel(boxMax[axis] + move);
+		for (auto layer = ceilVoxel(boxMax[axis]); layer < end; layer++)
+		{
+			if (isBlocked(layer))
+				return std::max((float)layer - boxMax[axis], 0.0f);
+		}
+	}
+	else if (move < 0.0f)
+	{
+		auto end = floorVoxel(boxMin[axis] + move);
+		for (auto layer = floorVoxel(boxMin[axis]) - 1; layer >= end; layer--)
+		{
+			if (isBlocked(layer))
+				return std::min((float)(layer + 1) - boxMin[axis], 0.0f);
+		}
+	}
+	return move;
+}
+
+template<class C>
+static void fillWorld(World3<C>& world)
+{
+	mt19937 random(1);
+	uniform_int_distribution<int32_t> height(8, 24);
+	for (int32_t z = 0; z < worldSize; z++)
+	{
+		for (int32_t y = 0; y < 4; y++)
+		{
+			for (int32_t x = 0; x < worldSize; x++)
+				world.createChunk(x, y, z)->fill(voxel::null);
+		}
+	}
+	for (int32_t z = 0; z < worldSize * 16; z++)
+	{
+		for (int32_t x = 0; x < worldSize * 16; x++)
+		{
+			auto h = height(random);
+			for (int32_t y = 0; y < h; y++)
+				world.set(x, y, z, 1);
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (!bench::init(argc, argv))
+		return EXIT_FAILURE;
+
+	// Falling and walking entity boxes above the height map terrain.
+	World3<Chunk> world;
+	World3<OccupancyChunk> occupancyWorld;
+	fillWorld(world);
+	fillWorld(occupancyWorld);
+
+	mt19937 random(2);
+	uniform_real_distribution<float> position(16.0f, worldSize * 16.0f - 16.0f), height(24.0f, 60.0f), walk(-0.3f, 0.3f);
+	vector<SweepQuery> queries(entityCount);
+	for (auto& query : queries)
+	{
+		auto x = position(random), y = height(random), z = position(random);
+		query.box = { x, y, z, x + 0.6f, y + 1.8f, z + 0.6f };
+		query.moveX = walk(random); query.moveY = -2.0f; query.moveZ = walk(random);
+	}
+	vector<SweepResult> results(entityCount);
+
+	bench::run("collision/sweep/naive", entityCount, [&]()
+	{
+		for (size_t i = 0; i < entityCount; i++)
+		{
+			const auto& query = queries[i];
+			auto& result = results[i];
+			result.box = query.box;
+			result.moveY = sweepAxisNaive(world, result.box, 1, query.moveY);
+			result.box.minY += result.moveY; result.box.maxY += result.moveY;
+			result.moveX = sweepAxisNaive(world, result.box, 0, query.moveX);
+			result.box.minX += result.moveX; result.box.maxX += result.moveX;
+			result.moveZ = sweepAxisNaive(world, result.box, 2, query.moveZ);
+		}
+		bench::sink = bench::sink + (uint64_t)results[0].moveY;
+	});
+	bench::run("collision/sweep/world", entityCount, [&]()
+	{
+		for (size_t i = 0; i < entityCount; i++)
+			results[i] = sweepWorld(world, queries[i]);
+		bench::sink = bench::sink + (uint64_t)results[0].moveY;
+	});
+	bench::run("collision/sweep/world/batch", entityCount, [&]()
+	{
+		sweepWorld(world, queries.data(), results.data(), entityCount);
+		bench::sink = bench::sink + (uint64_t)results[0].moveY;
+	});
+	// Queries sorted by the chunk position share the cached chunk lookups.
+	auto sortedQueries = queries;
+	sort(sortedQueries.begin(), sortedQueries.end(), [](const SweepQuery& a, const SweepQuery& b)
+	{
+		auto ax = (int32_t)a.box.minX >> 4, ay = (int32_t)a.box.minY >> 4, az = (int32_t)a.box.minZ >> 4;
+		auto bx = (int32_t)b.box.minX >> 4, by = (int32_t)b.box.minY >> 4, bz = (int32_t)b.box.minZ >> 4;
+		return az != bz ? az < bz : (ay != by ? ay < by : ax < bx);
+	});
+	bench::run("collision/sweep/world/batch/sorted", entityCount, [&]()
+	{
+		sweepWorld(world, sortedQueries.data(), results.data(), entityCount);
+		bench::sink = bench::sink + (uint64_t)results[0].moveY;
+	});
+	bench::run("collision/sweep/occupancy/batch", entityCount, [&]()
+	{
+		sweepWorld(occupancyWorld, queries.data(), results.data(), entityCount);
+		bench::sink = bench::sink + (uint64_t)results[0].moveY;
+	});
+	// Bigger boxes (vehicles, bosses) cover more voxels per chunk lookup.
+	auto largeQueries = queries;
+	for (auto& query : largeQueries)
+	{
+		query.box.maxX = query.box.minX + 2.6f; query.box.maxY = query.box.minY + 3.8f;
+		query.box.maxZ = query.box.minZ + 2.6f;
+	}
+	bench::run("collision/sweep/naive/large", entityCount, [&]()
+	{
+		for (size_t i = 0; i < entityCount; i++)
+		{
+			const auto& query = largeQueries[i];
+			auto& result = results[i];
+			result.box = query.box;
+			result.moveY = sweepAxisNaive(world, result.box, 1, query.moveY);
+			result.box.minY += result.moveY; result.box.maxY += result.moveY;
+			result.moveX = sweepAxisNaive(world, result.box, 0, query.moveX);
+			result.box.minX += result.moveX; result.box.maxX += result.moveX;
+			result.moveZ = sweepAxisNaive(world, result.box, 2, query.moveZ);
+		}
+		bench::sink = bench::sink + (uint64_t)results[0].moveY;
+	});
+	bench::run("collision/sweep/world/batch/large", entityCount, [&]()
+	{
+		sweepWorld(world, largeQueries.data(), results.data(), entityCount);
+		bench::sink = bench::sink + (uint64_t)results[0].moveY;
+	});
+	bench::run("collision/overlap/occupancy", entityCount, [&]()
+	{
+		uint64_t sum = 0;
+		for (const auto& query : queries)
+			sum += overlapWorld(occupancyWorld, query.box);
+		bench::sink = bench::sink + sum;
+	});
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
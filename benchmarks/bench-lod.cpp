@@ -0,0 +1,91 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.hpp"
+#include "voxy/lod.hpp"
+
+#include <random>
+#include <vector>
+#include <cstdlib>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint8_t> Chunk;
+typedef lod::ReducedChunk3<Chunk, 2> ReducedChunk;
+
+static constexpr size_t chunkCount = 64;
+
+// Reduces each 2x2x2 block with the per-voxel get calls.
+static void downsampleNaive(const Chunk& chunk, ReducedChunk& reduced)
+{
+	for (uint8_t z = 0; z < ReducedChunk::sizeZ; z++)
+	{
+		for (uint8_t y = 0; y < ReducedChunk::sizeY; y++)
+		{
+			for (uint8_t x = 0; x < ReducedChunk::sizeX; x++)
+			{
+				uint8_t block[8];
+				for (uint8_t i = 0; i < 8; i++)
+					block[i] = chunk.get(x * 2 + (i & 1), y * 2 + (i >> 1 & 1), z * 2 + (i >> 2));
+				reduced.set(x, y, z, lod::Majority()((const uint8_t*)block, 8));
+			}
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (!bench::init(argc, argv))
+		return EXIT_FAILURE;
+
+	// Height map terrain chunks, with the air above and solid voxels below the surface.
+	mt19937 random(1);
+	uniform_int_distribution<int32_t> height(4, 12);
+	vector<Chunk> chunks(chunkCount);
+	for (auto& chunk : chunks)
+	{
+		chunk.fill(voxel::null);
+		for (uint8_t z = 0; z < Chunk::sizeZ; z++)
+		{
+			for (uint8_t x = 0; x < Chunk::sizeX; x++)
+			{
+				auto h = height(random);
+				for (int32_t y = 0; y < h; y++)
+					chunk.set(x, (uint8_t)y, z, y + 1 < h ? 2 : 3);
+			}
+		}
+	}
+	ReducedChunk reduced;
+
+	bench::run("lod/naive", chunkCount, [&]()
+	{
+		for (const auto& chunk : chunks)
+			downsampleNaive(chunk, reduced);
+		bench::sink = bench::sink + reduced.get(3, 3, 3);
+	});
+	bench::run("lod/majority", chunkCount, [&]()
+	{
+		for (const auto& chunk : chunks)
+			lod::downsample<2>(chunk, reduced);
+		bench::sink = bench::sink + reduced.get(3, 3, 3);
+	});
+	bench::run("lod/first-not-null", chunkCount, [&]()
+	{
+		for (const auto& chunk : chunks)
+			lod::downsample<2, lod::FirstNotNull>(chunk, reduced);
+		bench::sink = bench::sink + reduced.get(3, 3, 3);
+	});
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.hpp"
+#include "voxy/mesh.hpp"
+
+#include <vector>
+#include <cstdlib>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<32, 32, 32, uint16_t> Chunk;
+typedef Cluster3<Chunk, uint16_t> Cluster;
+typedef mesh::Quad<uint16_t> Quad;
+
+static size_t buildNaive(const Cluster& cluster, Quad* quads)
+{
+	static const int8_t offsets[6][3] = { { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 } };
+	size_t quadCount = 0;
+	for (uint8_t z = 0; z < Chunk::sizeZ; z++)
+	{
+		for (uint8_t y = 0; y < Chunk::sizeY; y++)
+		{
+			for (uint8_t x = 0; x < Chunk::sizeX; x++)
+			{
+				auto voxel = cluster.c->get(x, y, z);
+				if (voxel == voxel::null)
+					continue;
+				for (uint8_t f = 0; f < 6; f++)
+				{
+					auto nearby = cluster.get(x + offsets[f][0], y + offsets[f][1], z + offsets[f][2]);
+					if (nearby == voxel::null)
+						quads[quadCount++] = { x, y, z, 1, 1, (mesh::Face)f, voxel };
+				}
+			}
+		}
+	}
+	return quadCount;
+}
+
+int main(int argc, char* argv[])
+{
+	if (!bench::init(argc, argv))
+		return EXIT_FAILURE;
+
+	static constexpr size_t voxelCount = Chunk::sizeX * Chunk::sizeY * Chunk::sizeZ;
+	vector<Chunk> chunks(7);
+	for (auto& chunk : chunks)
+		chunk.fill(1);
+	for (uint8_t z = 0; z < Chunk::sizeZ; z++)
+	{
+		for (uint8_t y = 0; y < Chunk::sizeY; y++)
+		{
+			for (uint8_t x = 0; x < Chunk::sizeX; x++)
+			{
+				auto height = (x * 7 + z * 13) % 9 + 12;
+				chunks[0].set(x, y, z, y < height ? (y < height - 3 ? 1 : 2) : voxel::null);
+			}
+		}
+	}
+
+	Cluster cluster(&chunks[0], &chunks[1], &chunks[2], &chunks[3], nullptr, &chunks[5], &chunks[6]);
+	vector<Quad> quads(voxelCount * 6);
+
+	bench::run("mesh/naive", voxelCount, [&]()
+	{
+		bench::sink = bench::sink + buildNaive(cluster, quads.data());
+	});
+	bench::run("mesh/greedy", voxelCount, [&]()
+	{
+		size_t quadCount;
+		mesh::buildGreedy(cluster, quads.data(), quads.size(), quadCount);
+		bench::sink = bench::sink + quadCount;
+	});
+
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.hpp"
+#include "voxy/pool.hpp"
+#include "voxy/chunk.hpp"
+
+#include <vector>
+#include <cstdlib>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint16_t> Chunk;
+
+static constexpr size_t chunkCount = 1024;
+
+int main(int argc, char* argv[])
+{
+	if (!bench::init(argc, argv))
+		return EXIT_FAILURE;
+
+	vector<Chunk*> chunks(chunkCount);
+	bench::run("pool/new_delete", chunkCount, [&]()
+	{
+		for (auto& chunk : chunks)
+			chunk = new Chunk;
+		for (auto chunk : chunks)
+			delete chunk;
+	});
+
+	ChunkPool<Chunk> pool(256);
+	bench::run("pool/allocate", chunkCount, [&]()
+	{
+		for (auto& chunk : chunks)
+			chunk = pool.allocate();
+		for (auto chunk : chunks)
+			pool.deallocate(chunk);
+	});
+
+	{
+		ChunkPool<Chunk>::LocalCache cache(pool, 64);
+		bench::run("pool/cache/allocate", chunkCount, [&]()
+		{
+			for (auto& chunk : chunks)
+				chunk = cache.allocate();
+			for (auto chunk : chunks)
+				cache.deallocate(chunk);
+		});
+	}
+
+	ChunkPool<Chunk> hugePool(256, true);
+	bench::run("pool/huge/allocate", chunkCount, [&]()
+	{
+		for (auto& chunk : chunks)
+		{
+			chunk = hugePool.allocate();
+			chunk->set(0, 0, 0, 1);
+		}
+		for (auto chunk : chunks)
+			hugePool.deallocate(chunk);
+	});
+
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.hpp"
+#include "voxy/raycast.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <cstdlib>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint16_t> Chunk;
+typedef World3<Chunk> World;
+
+static constexpr int32_t worldSize = 8;
+static constexpr size_t rayCount = 4096;
+
+// Steps voxel by voxel, looking up the chunk on each step.
+static bool raycastNaive(const World& world, const Ray& ray, RayHit<uint16_t>& hit)
+{
+	const float origin[3] = { ray.originX, ray.originY, ray.originZ };
+	const float direction[3] = { ray.directionX, ray.directionY, ray.directionZ };
+	int32_t pos[3], step[3];
+	float tMax[3], tDelta[3];
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		pos[i] = (int32_t)floor(origin[i]);
+		step[i] = direction[i] > 0.0f ? 1 : -1;
+		tDelta[i] = direction[i] != 0.0f ? fabs(1.0f / direction[i]) : INFINITY;
+		tMax[i] = direction[i] > 0.0f ? (pos[i] + 1.0f - origin[i]) / direction[i] :
+			(direction[i] < 0.0f ? (pos[i] - origin[i]) / direction[i] : INFINITY);
+	}
+
+	float distance = 0.0f;
+	while (distance <= ray.maxDistance)
+	{
+		uint16_t voxel;
+		if (world.tryGet(pos[0], pos[1], pos[2], voxel) && voxel != voxel::null)
+		{
+			hit.x = pos[0]; hit.y = pos[1]; hit.z = pos[2];
+			hit.distance = distance; hit.voxel = voxel;
+			return true;
+		}
+		auto axis = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+		pos[axis] += step[axis];
+		distance = tMax[axis];
+		tMax[axis] += tDelta[axis];
+	}
+	return false;
+}
+
+int main(int argc, char* argv[])
+{
+	if (!bench::init(argc, argv))
+		return EXIT_FAILURE;
+
+	// Height map terrain with the air chunks above it.
+	World world;
+	mt19937 random(1);
+	uniform_int_distribution<int32_t> height(8, 24);
+	for (int32_t z = 0; z < worldSize; z++)
+	{
+		for (int32_t y = 0; y < 4; y++)
+		{
+			for (int32_t x = 0; x < worldSize; x++)
+				world.createChunk(x, y, z)->fill(voxel::null);
+		}
+	}
+	for (int32_t z = 0; z < worldSize * 16; z++)
+	{
+		for (int32_t x = 0; x < worldSize * 16; x++)
+		{
+			auto h = height(random);
+			for (int32_t y = 0; y < h; y++)
+				world.set(x, y, z, 1);
+		}
+	}
+
+	uniform_real_distribution<float> position(16.0f, worldSize * 16.0f - 16.0f), angle(0.0f, 6.2831853f);
+	vector<Ray> rays(rayCount);
+	for (auto& ray : rays)
+	{
+		auto a = angle(random);
+		ray.originX = position(random); ray.originY = 56.0f; ray.originZ = position(random);
+		ray.directionX = cos(a) * 0.6f; ray.directionY = -0.4f; ray.directionZ = sin(a) * 0.6f;
+		auto length = sqrt(ray.directionX * ray.directionX +
+			ray.directionY * ray.directionY + ray.directionZ * ray.directionZ);
+		ray.directionX /= length; ray.directionY /= length; ray.directionZ /= length;
+		ray.maxDistance = 128.0f;
+	}
+	vector<RayHit<uint16_t>> hits(rayCount);
+
+	bench::run("raycast/naive", rayCount, [&]()
+	{
+		uint64_t sum = 0;
+		for (size_t i = 0; i < rayCount; i++)
+			sum += raycastNaive(world, rays[i], hits[i]);
+		bench::sink = bench::sink + sum;
+	});
+	bench::run("raycast/world", rayCount, [&]()
+	{
+		uint64_t sum = 0;
+		for (size_t i = 0; i < rayCount; i++)
+			sum += raycastWorld(world, rays[i], hits[i]);
+		bench::sink = bench::sink + sum;
+	});
+	bench::run("raycast/world/batch", rayCount, [&]()
+	{
+		bench::sink = bench::sink + raycastWorld(world, rays.data(), rayCount, hits.data());
+	});
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.hpp"
+#include "voxy/serialize.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<32, 32, 32, uint16_t> Chunk;
+
+int main(int argc, char* argv[])
+{
+	if (!bench::init(argc, argv))
+		return EXIT_FAILURE;
+
+	vector<Chunk> chunks(2);
+	auto& chunk = chunks[0];
+	for (uint8_t z = 0; z < Chunk::sizeZ; z++)
+	{
+		for (uint8_t y = 0; y < Chunk::sizeY; y++)
+		{
+			for (uint8_t x = 0; x < Chunk::sizeX; x++)
+			{
+				auto height = (x * 7 + z * 13) % 9 + 12;
+				chunk.set(x, y, z, y < height ? (y < height - 3 ? 3 : 2) : voxel::null);
+			}
+		}
+	}
+
+	const pair<serial::Encoding, const char*> encodings[] =
+	{
+		{ serial::Encoding::raw, "raw" },
+		{ serial::Encoding::rle, "rle" },
+		{ serial::Encoding::paletteRle, "palette_rle" },
+	};
+
+	vector<uint8_t> buffer(serial::calcMaxEncodedSize<Chunk>());
+	for (const auto& encoding : encodings)
+	{
+		auto name = string("serialize/") + encoding.second + "/";
+		size_t size = 0;
+		bench::run((name + "encode").c_str(), Chunk::size, [&]()
+		{
+			serial::encode(chunk, buffer.data(), buffer.size(), size, encoding.first);
+			bench::sink = bench::sink + size;
+		});
+		bench::run((name + "decode").c_str(), Chunk::size, [&]()
+		{
+			bench::sink = bench::sink + serial::decode(buffer.data(), size, chunks[1]);
+		});
+	}
+
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.hpp"
+#include "voxy/world.hpp"
+#include "voxy/uniform.hpp"
+
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+#include <unordered_map>
+
+using namespace std;
+using namespace voxy;
+
+typedef UniformChunk3<16, 16, 16, uint16_t> Chunk;
+typedef World3<Chunk> World;
+
+struct ChunkPos { int32_t x, y, z; };
+
+static constexpr int32_t worldSize = 64;
+
+int main(int argc, char* argv[])
+{
+	if (!bench::init(argc, argv))
+		return EXIT_FAILURE;
+
+	vector<ChunkPos> positions;
+	for (int32_t z = -worldSize / 2; z < worldSize / 2; z++)
+	{
+		for (int32_t y = -worldSize / 2; y < worldSize / 2; y++)
+		{
+			for (int32_t x = -worldSize / 2; x < worldSize / 2; x++)
+				positions.push_back({ x, y, z });
+		}
+	}
+	shuffle(positions.begin(), positions.end(), mt19937(1));
+
+	World world;
+	bench::run("world/create", positions.size(), [&]()
+	{
+		world.clear();
+		for (const auto& pos : positions)
+			world.createChunk(pos.x, pos.y, pos.z)->fill((uint16_t)pos.x);
+	});
+
+	bench::run("world/lookup/hit", positions.size(), [&]()
+	{
+		uint64_t sum = 0;
+		for (const auto& pos : positions)
+			sum += world.getChunk(pos.x, pos.y, pos.z)->getValue();
+		bench::sink = sum;
+	});
+	bench::run("world/lookup/miss", positions.size(), [&]()
+	{
+		uint64_t sum = 0;
+		for (const auto& pos : positions)
+			sum += world.getChunk(pos.x + worldSize, pos.y, pos.z) != nullptr;
+		bench::sink = sum;
+	});
+	bench::run("world/iterate", positions.size(), [&]()
+	{
+		uint64_t sum = 0;
+		world.forEach([&](int32_t, int32_t, int32_t, Chunk& chunk) { sum += chunk.getValue(); });
+		bench::sink = sum;
+	});
+	bench::run("world/voxel/get", positions.size(), [&]()
+	{
+		uint64_t sum = 0;
+		for (const auto& pos : positions)
+			sum += world.get(pos.x * 16 + 1, pos.y * 16 + 2, pos.z * 16 + 3);
+		bench::sink = sum;
+	});
+	bench::run("world/cluster/get", positions.size(), [&]()
+	{
+		uint64_t sum = 0;
+		for (const auto& pos : positions)
+			sum += (uintptr_t)world.getCluster(pos.x, pos.y, pos.z).px;
+		bench::sink = sum;
+	});
+
+	auto hash = [](const ChunkPos& pos) { return (size_t)hashChunkPos(pos.x, pos.y, pos.z); };
+	auto equal = [](const ChunkPos& a, const ChunkPos& b) { return a.x == b.x && a.y == b.y && a.z == b.z; };
+	unordered_map<ChunkPos, Chunk*, decltype(hash), decltype(equal)> map(0, hash, equal);
+	for (const auto& pos : positions)
+		map.emplace(pos, world.getChunk(pos.x, pos.y, pos.z));
+
+	bench::run("unordered_map/lookup/hit", positions.size(), [&]()
+	{
+		uint64_t sum = 0;
+		for (const auto& pos : positions)
+			sum += map.find(pos)->second->getValue();
+		bench::sink = sum;
+	});
+	bench::run("unordered_map/iterate", positions.size(), [&]()
+	{
+		uint64_t sum = 0;
+		for (const auto& pair : map)
+			sum += pair.second->getValue();
+		bench::sink = sum;
+	});
+
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
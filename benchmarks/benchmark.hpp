@@ -0,0 +1,156 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Common benchmark functions.
+ *
+ * @details
+ * Benchmark executables accept the following arguments:
+ *   --format=text|csv|json  result output format (json prints one object per line)
+ *   --filter=<substring>    run only benchmarks which name contains the substring
+ *   --time=<milliseconds>   minimal measurement time of one benchmark (100 by default)
+ */
+
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdlib>
+
+namespace voxy::bench
+{
+
+/**
+ * @brief Benchmark result output format.
+ */
+enum class Format : uint8_t
+{
+	text, /**< Human readable aligned text. */
+	csv,  /**< Comma separated values with the header line. */
+	json, /**< JSON object per result line. */
+};
+
+/**
+ * @brief Benchmark result sink, prevents compiler from optimizing out measured code.
+ */
+static volatile uint64_t sink = 0;
+
+/**
+ * @brief Benchmark run options.
+ */
+struct Options
+{
+	Format format = Format::text; /**< Result output format. */
+	const char* filter = nullptr; /**< Benchmark name filter substring, or null. */
+	uint32_t minTime = 100;       /**< Minimal measurement time in milliseconds. */
+	bool isHeaderPrinted = false; /**< Is CSV header line already printed. */
+};
+
+/**
+ * @brief Returns global benchmark run options.
+ */
+static Options& getOptions() noexcept
+{
+	static Options options;
+	return options;
+}
+
+/**
+ * @brief Parses benchmark executable arguments.
+ * @return True on success, otherwise false if argument is unknown.
+ *
+ * @param argc argument count
+ * @param[in] argv argument array
+ */
+static bool init(int argc, char* argv[]) noexcept
+{
+	auto& options = getOptions();
+	for (int i = 1; i < argc; i++)
+	{
+		auto arg = argv[i];
+		if (strcmp(arg, "--format=text") == 0)
+			options.format = Format::text;
+		else if (strcmp(arg, "--format=csv") == 0)
+			options.format = Format::csv;
+		else if (strcmp(arg, "--format=json") == 0)
+			options.format = Format::json;
+		else if (strncmp(arg, "--filter=", 9) == 0)
+			options.filter = arg + 9;
+		else if (strncmp(arg, "--time=", 7) == 0)
+			options.minTime = (uint32_t)strtoul(arg + 7, nullptr, 10);
+		else
+		{
+			fprintf(stderr, "Unknown benchmark argument: %s\n"
+				"Usage: [--format=text|csv|json] [--filter=<substring>] [--time=<milliseconds>]\n", arg);
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Measures and prints specified function average operation time.
+ * @details Function is called repeatedly until at least minimal measurement time elapsed.
+ *
+ * @param[in] name benchmark name
+ * @param opCount operation count inside one function call
+ * @param func target function to measure
+ */
+template<typename F>
+static void run(const char* name, size_t opCount, F&& func)
+{
+	auto& options = getOptions();
+	if (options.filter && !strstr(name, options.filter))
+		return;
+
+	func();
+
+	size_t callCount = 0;
+	auto start = std::chrono::steady_clock::now();
+	std::chrono::steady_clock::duration elapsed;
+	do
+	{
+		func(); callCount++;
+		elapsed = std::chrono::steady_clock::now() - start;
+	}
+	while (elapsed < std::chrono::milliseconds(options.minTime));
+
+	auto ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+	auto nsPerOp = ns / ((double)callCount * opCount);
+
+	switch (options.format)
+	{
+		case Format::csv:
+			if (!options.isHeaderPrinted)
+			{
+				printf("name,ns_per_op,op_count,call_count\n");
+				options.isHeaderPrinted = true;
+			}
+			printf("%s,%.3f,%zu,%zu\n", name, nsPerOp, opCount, callCount);
+			break;
+		case Format::json:
+			printf("{\"name\":\"%s\",\"ns_per_op\":%.3f,\"op_count\":%zu,\"call_count\":%zu}\n",
+				name, nsPerOp, opCount, callCount);
+			break;
+		default:
+			printf("%-48s %12.3f ns/op\n", name, nsPerOp);
+			break;
+	}
+	fflush(stdout);
+}
+
+};
\ No newline at end of file
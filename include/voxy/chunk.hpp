@@ -19,6 +19,9 @@
 
 #pragma once
 #include "voxy/voxel.hpp"
+#include "voxy/simd.hpp"
+#include "voxy/layout.hpp"
+#include "voxy/stats.hpp"
 
 #include <cstdint>
 #include <cstddef>
@@ -45,12 +48,17 @@ static constexpr size_t posToVoxelIndex(uint8_t x, uint8_t y, uint8_t z, uint8_t
 /**
  * @brief Voxel 3D container. (array)
  * 
+ * @details
+ * Voxel array index order is defined by the layout policy (@ref layout::Linear by default).
+ * Part (region) operations of the non-linear layouts are processed voxel by voxel.
+ * 
  * @tparam SX chunk size in voxels along X-axis
  * @tparam SY chunk size in voxels along Y-axis
  * @tparam SZ chunk size in voxels along Z-axis
  * @tparam V chunk voxel ID type
+ * @tparam L chunk voxel array layout
  */
-template<uint8_t SX, uint8_t SY, uint8_t SZ, typename V>
+template<uint8_t SX, uint8_t SY, uint8_t SZ, typename V, class L = layout::Linear>
 struct Chunk3
 {
 public:
@@ -78,8 +86,54 @@ public:
 	 * @brief Chunk voxel ID type.
 	 */
 	typedef V Voxel;
+	/**
+	 * @brief Chunk voxel array layout.
+	 */
+	typedef L Layout;
+
+	static_assert(L::template isSupported<SX, SY, SZ>, "Chunk size is not supported by the layout");
 protected:
 	Voxel voxels[size];
+
+	template<typename F>
+	static void forEachRow(uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX, uint8_t offsetY, uint8_t offsetZ, F&& func) noexcept
+	{
+		assert(_sizeX + offsetX <= SX);
+		assert(_sizeY + offsetY <= SY);
+		assert(_sizeZ + offsetZ <= SZ);
+
+		if constexpr (!L::isLinear)
+		{
+			for (uint8_t z = 0; z < _sizeZ; z++)
+			{
+				for (uint8_t y = 0; y < _sizeY; y++)
+				{
+					for (uint8_t x = 0; x < _sizeX; x++)
+						func(posToIndex(offsetX + x, offsetY + y, offsetZ + z), (size_t)1);
+				}
+			}
+			return;
+		}
+
+		if (_sizeX == SX && _sizeY == SY)
+		{
+			func(posToIndex(0, 0, offsetZ), (size_t)_sizeZ * sizeXY);
+			return;
+		}
+
+		for (uint8_t z = 0; z < _sizeZ; z++)
+		{
+			if (_sizeX == SX)
+			{
+				func(posToIndex(0, offsetY, offsetZ + z), (size_t)_sizeY * SX);
+				continue;
+			}
+
+			for (uint8_t y = 0; y < _sizeY; y++)
+				func(posToIndex(offsetX, offsetY + y, offsetZ + z), (size_t)_sizeX);
+		}
+	}
 public:
 	/**
 	 * @brief Creates a new uninitialized chunk.
@@ -100,9 +154,14 @@ public:
 	 * @brief Returns constant chunk voxel array.
 	 */
 	const Voxel* getVoxels() const noexcept { return voxels; }
+	/**
+	 * @brief Returns chunk memory usage in bytes.
+	 */
+	static constexpr size_t getMemoryUsage() noexcept { return sizeof(Chunk3); }
 
 	/**
 	 * @brief Calculates chunk voxel index from the position.
+	 * @details Index order depends on the chunk layout.
 	 *
 	 * @param x voxel position along X-axis
 	 * @param y voxel position along Y-axis
@@ -110,7 +169,21 @@ public:
 	 */
 	static constexpr size_t posToIndex(uint8_t x, uint8_t y, uint8_t z) noexcept
 	{
-		return (size_t)z * sizeXY + (size_t)y * sizeX + x;
+		return L::template posToIndex<SX, SY, SZ>(x, y, z);
+	}
+	/**
+	 * @brief Calculates voxel position from the chunk voxel index.
+	 * @details Inverse of the @ref posToIndex, depends on the chunk layout.
+	 *
+	 * @param index target voxel index inside array
+	 * @param[out] x voxel position along X-axis
+	 * @param[out] y voxel position along Y-axis
+	 * @param[out] z voxel position along Z-axis
+	 */
+	static constexpr void indexToPos(size_t index, uint8_t& x, uint8_t& y, uint8_t& z) noexcept
+	{
+		assert(index < size);
+		L::template indexToPos<SX, SY, SZ>(index, x, y, z);
 	}
 
 	/**
@@ -236,30 +309,145 @@ public:
 	 */
 	void fill(Voxel voxel) noexcept
 	{
+		VOXY_STATS_COUNT(chunkFill);
 		if (voxel == voxel::null)
-		{
 			memset(voxels, 0, size * sizeof(Voxel));
-		}
 		else
+			simd::fill(voxels, voxel, size);
+	}
+	/**
+	 * @brief Fills chunk part with specified voxel ID.
+	 * @details Continuous rows and layers of the part are filled at once.
+	 *
+	 * @param voxel target voxel ID
+	 * @param _sizeX chunk part size along X-axis
+	 * @param _sizeY chunk part size along Y-axis
+	 * @param _sizeZ chunk part size along Z-axis
+	 * @param offsetX chunk part offset along X-axis
+	 * @param offsetY chunk part offset along Y-axis
+	 * @param offsetZ chunk part offset along Z-axis
+	 */
+	void fill(Voxel voxel, uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX = 0, uint8_t offsetY = 0, uint8_t offsetZ = 0) noexcept
+	{
+		VOXY_STATS_COUNT(chunkFill);
+		forEachRow(_sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ, [&](size_t index, size_t count)
+		{
+			simd::fill(voxels + index, voxel, count);
+		});
+	}
+
+	/**
+	 * @brief Replaces all chunk voxels with specified ID.
+	 * @return Replaced voxel count.
+	 *
+	 * @param from voxel ID to replace
+	 * @param to new voxel ID
+	 */
+	size_t replace(Voxel from, Voxel to) noexcept { return simd::replace(voxels, from, to, size); }
+	/**
+	 * @brief Replaces chunk part voxels with specified ID.
+	 * @return Replaced voxel count.
+	 *
+	 * @param from voxel ID to replace
+	 * @param to new voxel ID
+	 * @param _sizeX chunk part size along X-axis
+	 * @param _sizeY chunk part size along Y-axis
+	 * @param _sizeZ chunk part size along Z-axis
+	 * @param offsetX chunk part offset along X-axis
+	 * @param offsetY chunk part offset along Y-axis
+	 * @param offsetZ chunk part offset along Z-axis
+	 */
+	size_t replace(Voxel from, Voxel to, uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX = 0, uint8_t offsetY = 0, uint8_t offsetZ = 0) noexcept
+	{
+		size_t result = 0;
+		forEachRow(_sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ, [&](size_t index, size_t count)
 		{
-			for (size_t i = 0; i < size; i++)
-				voxels[i] = voxel;
+			result += simd::replace(voxels + index, from, to, count);
+		});
+		return result;
+	}
+
+	/**
+	 * @brief Returns chunk voxel count with specified ID.
+	 * @param voxel target voxel ID
+	 */
+	size_t count(Voxel voxel) const noexcept { return simd::count(voxels, voxel, size); }
+	/**
+	 * @brief Returns chunk part voxel count with specified ID.
+	 *
+	 * @param voxel target voxel ID
+	 * @param _sizeX chunk part size along X-axis
+	 * @param _sizeY chunk part size along Y-axis
+	 * @param _sizeZ chunk part size along Z-axis
+	 * @param offsetX chunk part offset along X-axis
+	 * @param offsetY chunk part offset along Y-axis
+	 * @param offsetZ chunk part offset along Z-axis
+	 */
+	size_t count(Voxel voxel, uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX = 0, uint8_t offsetY = 0, uint8_t offsetZ = 0) const noexcept
+	{
+		size_t result = 0;
+		forEachRow(_sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ, [&](size_t index, size_t count)
+		{
+			result += simd::count(voxels + index, voxel, count);
+		});
+		return result;
+	}
+
+	/**
+	 * @brief Adds chunk voxel ID counts to the specified histogram.
+	 * @details Voxels with ID bigger or equal to the bin count are skipped.
+	 * @note Histogram is not cleared, so it can accumulate several chunks.
+	 *
+	 * @param[in,out] histogram target voxel ID count array
+	 * @param binCount histogram array size
+	 */
+	void calcHistogram(uint32_t* histogram, size_t binCount) const noexcept
+	{
+		assert(histogram);
+		if constexpr (sizeof(Voxel) == 1 && size >= 1024)
+		{
+			if (binCount >= 256)
+			{
+				uint32_t counts[4][256] = {};
+				for (size_t i = 0; i + 4 <= size; i += 4)
+				{
+					counts[0][(uint8_t)voxels[i]]++; counts[1][(uint8_t)voxels[i + 1]]++;
+					counts[2][(uint8_t)voxels[i + 2]]++; counts[3][(uint8_t)voxels[i + 3]]++;
+				}
+				for (size_t i = size & ~(size_t)3; i < size; i++)
+					counts[0][(uint8_t)voxels[i]]++;
+				for (size_t i = 0; i < 256; i++)
+					histogram[i] += counts[0][i] + counts[1][i] + counts[2][i] + counts[3][i];
+				return;
+			}
+		}
+
+		for (size_t i = 0; i < size; i++)
+		{
+			auto voxel = (size_t)voxels[i];
+			if (voxel < binCount)
+				histogram[voxel]++;
 		}
 	}
 
 	/**
 	 * @brief Copies voxels from specified array to this chunk.
-	 * @note Voxel array should have bigger or the same size as chunk!
+	 * @note Voxel array should have bigger or the same size as chunk, and the same layout!
 	 * @param[in] voxels target voxel array
 	 */
 	void copy(const Voxel* voxels) noexcept
 	{
 		assert(voxels);
+		VOXY_STATS_COUNT(chunkCopy);
 		memcpy(this->voxels, voxels, size * sizeof(Voxel));
 	}
 	/**
 	 * @brief Copies voxels from specified array part to this chunk.
-	 * @note Voxel array should have bigger or the same size as specified part!
+	 * @details Continuous rows and layers of the part are copied at once.
+	 * @note Voxel array should have bigger or the same size as specified part, and linear layout!
 	 * 
 	 * @param[in] target voxel array
 	 * @param _sizeX voxel array part size along X-axis
@@ -276,10 +464,38 @@ public:
 		assert(_sizeX + offsetX <= SX);
 		assert(_sizeY + offsetY <= SY);
 		assert(_sizeZ + offsetZ <= SZ);
+		VOXY_STATS_COUNT(chunkCopy);
 
 		auto _sizeXY = _sizeX * _sizeY;
+		if constexpr (!L::isLinear)
+		{
+			for (uint8_t z = 0; z < _sizeZ; z++)
+			{
+				for (uint8_t y = 0; y < _sizeY; y++)
+				{
+					auto row = voxels + posToVoxelIndex(0, y, z, _sizeX, _sizeXY);
+					for (uint8_t x = 0; x < _sizeX; x++)
+						this->voxels[posToIndex(offsetX + x, offsetY + y, offsetZ + z)] = row[x];
+				}
+			}
+			return;
+		}
+
+		if (_sizeX == SX && _sizeY == SY)
+		{
+			memcpy(this->voxels + posToIndex(0, 0, offsetZ), voxels, (size_t)_sizeZ * sizeXY * sizeof(Voxel));
+			return;
+		}
+
 		for (uint8_t z = 0; z < _sizeZ; z++)
 		{
+			if (_sizeX == SX)
+			{
+				memcpy(this->voxels + posToIndex(0, offsetY, offsetZ + z),
+					voxels + (size_t)z * _sizeXY, (size_t)_sizeXY * sizeof(Voxel));
+				continue;
+			}
+
 			for (uint8_t y = 0; y < _sizeY; y++)
 			{
 				memcpy(this->voxels + posToIndex(offsetX, offsetY + y, offsetZ + z),
@@ -287,6 +503,53 @@ public:
 			}
 		}
 	}
+
+	/**
+	 * @brief Copies voxels from specified chunk, converting the voxel array layout if it's different.
+	 * @param[in] chunk source chunk
+	 */
+	template<class SL>
+	void copy(const Chunk3<SX, SY, SZ, V, SL>& chunk) noexcept
+	{
+		if constexpr (std::is_same_v<L, SL>)
+		{
+			copy(chunk.getVoxels());
+		}
+		else
+		{
+			VOXY_STATS_COUNT(chunkCopy);
+			for (uint8_t z = 0; z < SZ; z++)
+			{
+				for (uint8_t y = 0; y < SY; y++)
+				{
+					for (uint8_t x = 0; x < SX; x++)
+						voxels[posToIndex(x, y, z)] = chunk.get(x, y, z);
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Returns index of the first different voxel in two chunks, or chunk size if they are equal.
+	 *
+	 * @param[in] chunk target chunk to compare with
+	 * @param offset voxel index to start comparison from
+	 */
+	size_t findDifference(const Chunk3& chunk, size_t offset = 0) const noexcept
+	{
+		assert(offset <= size);
+		return offset + simd::findMismatch(voxels + offset, chunk.voxels + offset, size - offset);
+	}
+	/**
+	 * @brief Returns true if all chunk voxels are equal.
+	 * @param[in] chunk target chunk to compare with
+	 */
+	bool operator==(const Chunk3& chunk) const noexcept { return simd::isEqual(voxels, chunk.voxels, size); }
+	/**
+	 * @brief Returns true if any chunk voxel is different.
+	 * @param[in] chunk target chunk to compare with
+	 */
+	bool operator!=(const Chunk3& chunk) const noexcept { return !simd::isEqual(voxels, chunk.voxels, size); }
 };
 
 };
\ No newline at end of file
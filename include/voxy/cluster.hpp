@@ -22,6 +22,11 @@
  *      [X]
  *   [X][X][X]
  *      [X]
+ *
+ * 2D full chunk cluster representation:
+ *   [X][X][X]
+ *   [X][X][X]
+ *   [X][X][X]
  */
 
 #pragma once
@@ -30,6 +35,28 @@
 namespace voxy
 {
 
+/**
+ * @brief Default solid voxel predicate. (not null voxels)
+ */
+struct IsNotNullVoxel
+{
+	template<typename V>
+	constexpr bool operator()(V voxel) const noexcept { return voxel != voxel::null; }
+};
+
+/**
+ * @brief Calculates cluster chunk offset [-1, 1] from the voxel position along one axis.
+ * @details Uses position sign bits: -1 if negative, 1 if greater or equal to the chunk size.
+ *
+ * @tparam S chunk size in voxels along the axis
+ * @param position voxel position along the axis
+ */
+template<uint8_t S>
+static constexpr int8_t calcClusterChunkOffset(int16_t position) noexcept
+{
+	return (int8_t)(((int32_t)position >> 31) + (int32_t)((uint32_t)(S - 1 - position) >> 31));
+}
+
 /***********************************************************************************************************************
  * @brief Nearby chunk group container. (including center one)
  * 
@@ -41,6 +68,9 @@ namespace voxy
  * py - positive Y-axis chunk (+y)
  * nz - negative Z-axis chunk (-z)
  * pz - positive Z-axis chunk (+z)
+ *
+ * Voxel chunk is resolved without the if-chain, from the position sign bit chunk offsets
+ * and the 3x3x3 chunk index table. Edge and corner offsets are outside the cluster.
  * 
  * @tparam C cluster chunk type
  * @tparam V chunk voxel ID type
@@ -69,6 +99,33 @@ struct Cluster3
 	C* py = nullptr; /**< Positive Y-axis chunk instance (+y) */
 	C* nz = nullptr; /**< Negative Z-axis chunk instance (-z) */
 	C* pz = nullptr; /**< Positive Z-axis chunk instance (+z) */
+protected:
+	static constexpr int8_t chunkIndices[27] =
+	{
+		-1, -1, -1, -1, 5, -1, -1, -1, -1,
+		-1, 3, -1, 1, 0, 2, -1, 4, -1,
+		-1, -1, -1, -1, 6, -1, -1, -1, -1,
+	};
+	static constexpr C* Cluster3::* chunkMembers[chunkSize] =
+	{
+		&Cluster3::c, &Cluster3::nx, &Cluster3::px, &Cluster3::ny, &Cluster3::py, &Cluster3::nz, &Cluster3::pz,
+	};
+	static constexpr C* Cluster3::* offsetMembers[27] =
+	{
+		nullptr, nullptr, nullptr, nullptr, &Cluster3::nz, nullptr, nullptr, nullptr, nullptr,
+		nullptr, &Cluster3::ny, nullptr, &Cluster3::nx, &Cluster3::c, &Cluster3::px, nullptr, &Cluster3::py, nullptr,
+		nullptr, nullptr, nullptr, nullptr, &Cluster3::pz, nullptr, nullptr, nullptr, nullptr,
+	};
+
+	static constexpr auto findMember(int16_t& x, int16_t& y, int16_t& z) noexcept
+	{
+		auto dx = calcClusterChunkOffset<C::sizeX>(x);
+		auto dy = calcClusterChunkOffset<C::sizeY>(y);
+		auto dz = calcClusterChunkOffset<C::sizeZ>(z);
+		x -= dx * C::sizeX; y -= dy * C::sizeY; z -= dz * C::sizeZ;
+		return offsetMembers[(dz + 1) * 9 + (dy + 1) * 3 + (dx + 1)];
+	}
+public:
 
 	/**
 	 * @brief Creates a new chunk cluster.
@@ -85,6 +142,43 @@ struct Cluster3
 		Chunk* ny = nullptr, Chunk* py = nullptr, Chunk* nz = nullptr, Chunk* pz = nullptr) noexcept :
 		c(c), nx(nx), px(px), ny(ny), py(py), nz(nz), pz(pz) { }
 
+	/**
+	 * @brief Calculates cluster chunk index from the chunk offset.
+	 * @return Chunk index (c, nx, px, ny, py, nz, pz), or -1 for the edge and corner offsets.
+	 *
+	 * @param x chunk offset along X-axis [-1, 1]
+	 * @param y chunk offset along Y-axis [-1, 1]
+	 * @param z chunk offset along Z-axis [-1, 1]
+	 */
+	static constexpr int8_t getChunkIndex(int8_t x, int8_t y, int8_t z) noexcept
+	{
+		assert(x >= -1 && x <= 1);
+		assert(y >= -1 && y <= 1);
+		assert(z >= -1 && z <= 1);
+		return chunkIndices[(z + 1) * 9 + (y + 1) * 3 + (x + 1)];
+	}
+	/**
+	 * @brief Returns cluster chunk at specified chunk index.
+	 * @param index chunk index (c, nx, px, ny, py, nz, pz)
+	 */
+	constexpr C* getChunk(int8_t index) const noexcept
+	{
+		assert(index >= 0 && index < chunkSize);
+		return this->*chunkMembers[index];
+	}
+	/**
+	 * @brief Returns cluster chunk at specified chunk offset, or null for the edge and corner offsets.
+	 *
+	 * @param x chunk offset along X-axis [-1, 1]
+	 * @param y chunk offset along Y-axis [-1, 1]
+	 * @param z chunk offset along Z-axis [-1, 1]
+	 */
+	constexpr C* getChunk(int8_t x, int8_t y, int8_t z) const noexcept
+	{
+		auto index = getChunkIndex(x, y, z);
+		return index < 0 ? nullptr : this->*chunkMembers[index];
+	}
+
 	/**
 	 * @brief Are all cluster chunks not null.
 	 */
@@ -94,7 +188,7 @@ struct Cluster3
 	}
 
 	/**
-	 * @breaf Returns cluster voxel at specified 3D position.
+	 * @brief Returns cluster voxel at specified 3D position.
 	 * @note Use with care, it doesn't checks for out of cluster bounds!
 	 * 
 	 * @param x voxel position along X-axis
@@ -103,23 +197,214 @@ struct Cluster3
 	 */
 	Voxel get(int16_t x, int16_t y, int16_t z) const noexcept
 	{
-		assert(isComplete());
-		if (x < 0)
-			return nx->get(x + Chunk::sizeX, y, z);
-		if (x >= Chunk::SizeX)
-			return px->get(x - Chunk::sizeX, y, z);
-		if (y < 0)
-			return ny->get(x, y + Chunk::sizeY, z);
-		if (y >= Chunk::SizeY)
-			return py->get(x, y - Chunk::sizeY, z);
-		if (z < 0)
-			return nz->get(x, y, z + Chunk::sizeZ);
-		if (z >= Chunk::sizeZ)
-			return pz->get(x, y, z - Chunk::sizeZ);
-		return c->get(x, y, z);
-	}
-	/**
-	 * @breaf Sets cluster voxel at specified 3D position.
+		VOXY_STATS_COUNT(clusterAccess);
+		auto member = findMember(x, y, z);
+		assert(member && this->*member);
+		auto chunk = this->*member;
+		return chunk->get((uint8_t)x, (uint8_t)y, (uint8_t)z);
+	}
+	/**
+	 * @brief Sets cluster voxel at specified 3D position.
+	 * @note Use with care, it doesn't checks for out of cluster bounds!
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param voxel target voxel ID
+	 */
+	void set(int16_t x, int16_t y, int16_t z, Voxel voxel) noexcept
+	{
+		VOXY_STATS_COUNT(clusterAccess);
+		auto member = findMember(x, y, z);
+		assert(member && this->*member);
+		auto chunk = this->*member;
+		chunk->set((uint8_t)x, (uint8_t)y, (uint8_t)z, voxel);
+	}
+
+	/**
+	 * @brief Returns cluster voxel at specified 3D position if inside cluster bounds.
+	 * @return True if voxel position is inside cluster bounds and chunk is not null, otherwise false.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param[out] voxel target voxel ID
+	 */
+	bool tryGet(int16_t x, int16_t y, int16_t z, Voxel& voxel) const noexcept
+	{
+		VOXY_STATS_COUNT(clusterAccess);
+		if (x < -Chunk::sizeX || x >= Chunk::sizeX * 2 || y < -Chunk::sizeY ||
+			y >= Chunk::sizeY * 2 || z < -Chunk::sizeZ || z >= Chunk::sizeZ * 2)
+		{
+			return false;
+		}
+
+		auto member = findMember(x, y, z);
+		if (!member || !(this->*member))
+			return false;
+		auto chunk = this->*member;
+		voxel = chunk->get((uint8_t)x, (uint8_t)y, (uint8_t)z);
+		return true;
+	}
+	/**
+	 * @brief Sets cluster voxel at specified 3D position if inside cluster bounds.
+	 * @return True if voxel position is inside cluster bounds and chunk is not null, otherwise false.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param voxel target voxel ID
+	 */
+	bool trySet(int16_t x, int16_t y, int16_t z, Voxel voxel) noexcept
+	{
+		VOXY_STATS_COUNT(clusterAccess);
+		if (x < -Chunk::sizeX || x >= Chunk::sizeX * 2 || y < -Chunk::sizeY ||
+			y >= Chunk::sizeY * 2 || z < -Chunk::sizeZ || z >= Chunk::sizeZ * 2)
+		{
+			return false;
+		}
+
+		auto member = findMember(x, y, z);
+		if (!member || !(this->*member))
+			return false;
+		auto chunk = this->*member;
+		chunk->set((uint8_t)x, (uint8_t)y, (uint8_t)z, voxel);
+		return true;
+	}
+};
+
+/***********************************************************************************************************************
+ * @brief Full nearby chunk group container. (including face, edge and corner ones)
+ *
+ * @details
+ * Chunks are stored in the 3x3x3 array, neighbour chunk index is calculated from the voxel
+ * position sign bits without branches: (dz + 1) * 9 + (dy + 1) * 3 + (dx + 1), where
+ * dx, dy, dz are the chunk offsets in range [-1, 1] from the central chunk.
+ *
+ * @tparam C cluster chunk type
+ * @tparam V chunk voxel ID type
+ */
+template<class C, typename V>
+struct Cluster27
+{
+	/**
+	 * @brief Cluster chunk type.
+	 */
+	typedef C Chunk;
+	/**
+	 * @brief Chunk voxel ID type.
+	 */
+	typedef V Voxel;
+
+	/**
+	 * @brief Chunk group size around center chunk. (including center one)
+	 */
+	static constexpr uint8_t chunkSize = 27;
+	/**
+	 * @brief Central chunk index inside the chunk array.
+	 */
+	static constexpr uint8_t centerIndex = 13;
+
+	C* chunks[chunkSize] = {}; /**< Cluster chunk instances. (3x3x3 array) */
+
+	/**
+	 * @brief Creates a new empty full chunk cluster.
+	 */
+	constexpr Cluster27() noexcept = default;
+	/**
+	 * @brief Creates a new full chunk cluster from the face neighbour cluster.
+	 * @note Edge and corner chunks are set to null.
+	 * @param[in] cluster source chunk cluster
+	 */
+	constexpr Cluster27(const Cluster3<C, V>& cluster) noexcept
+	{
+		chunks[centerIndex] = cluster.c;
+		chunks[getChunkIndex(-1, 0, 0)] = cluster.nx;
+		chunks[getChunkIndex(1, 0, 0)] = cluster.px;
+		chunks[getChunkIndex(0, -1, 0)] = cluster.ny;
+		chunks[getChunkIndex(0, 1, 0)] = cluster.py;
+		chunks[getChunkIndex(0, 0, -1)] = cluster.nz;
+		chunks[getChunkIndex(0, 0, 1)] = cluster.pz;
+	}
+
+	/**
+	 * @brief Calculates chunk array index from the chunk offset.
+	 *
+	 * @param x chunk offset along X-axis [-1, 1]
+	 * @param y chunk offset along Y-axis [-1, 1]
+	 * @param z chunk offset along Z-axis [-1, 1]
+	 */
+	static constexpr uint8_t getChunkIndex(int8_t x, int8_t y, int8_t z) noexcept
+	{
+		assert(x >= -1 && x <= 1);
+		assert(y >= -1 && y <= 1);
+		assert(z >= -1 && z <= 1);
+		return (uint8_t)(centerIndex + z * 9 + y * 3 + x);
+	}
+	/**
+	 * @brief Calculates chunk offset [-1, 1] from the cluster voxel position along one axis.
+	 * @details Uses position sign bits: -1 if negative, 1 if greater or equal to the chunk size.
+	 *
+	 * @tparam S chunk size in voxels along the axis
+	 * @param position voxel position along the axis
+	 */
+	template<uint8_t S>
+	static constexpr int8_t calcChunkOffset(int16_t position) noexcept
+	{
+		return calcClusterChunkOffset<S>(position);
+	}
+
+	/**
+	 * @brief Returns cluster chunk at specified chunk offset.
+	 *
+	 * @param x chunk offset along X-axis [-1, 1]
+	 * @param y chunk offset along Y-axis [-1, 1]
+	 * @param z chunk offset along Z-axis [-1, 1]
+	 */
+	constexpr C* getChunk(int8_t x, int8_t y, int8_t z) const noexcept { return chunks[getChunkIndex(x, y, z)]; }
+	/**
+	 * @brief Sets cluster chunk at specified chunk offset.
+	 *
+	 * @param x chunk offset along X-axis [-1, 1]
+	 * @param y chunk offset along Y-axis [-1, 1]
+	 * @param z chunk offset along Z-axis [-1, 1]
+	 * @param[in] chunk target chunk instance or null
+	 */
+	constexpr void setChunk(int8_t x, int8_t y, int8_t z, C* chunk) noexcept { chunks[getChunkIndex(x, y, z)] = chunk; }
+
+	/**
+	 * @brief Are all cluster chunks not null.
+	 */
+	constexpr bool isComplete() const noexcept
+	{
+		for (auto chunk : chunks)
+		{
+			if (!chunk)
+				return false;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Returns cluster voxel at specified 3D position.
+	 * @note Use with care, it doesn't checks for out of cluster bounds!
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 */
+	Voxel get(int16_t x, int16_t y, int16_t z) const noexcept
+	{
+		VOXY_STATS_COUNT(clusterAccess);
+		auto dx = calcChunkOffset<Chunk::sizeX>(x);
+		auto dy = calcChunkOffset<Chunk::sizeY>(y);
+		auto dz = calcChunkOffset<Chunk::sizeZ>(z);
+		auto chunk = chunks[getChunkIndex(dx, dy, dz)];
+		assert(chunk);
+		return chunk->get(x - dx * Chunk::sizeX, y - dy * Chunk::sizeY, z - dz * Chunk::sizeZ);
+	}
+	/**
+	 * @brief Sets cluster voxel at specified 3D position.
 	 * @note Use with care, it doesn't checks for out of cluster bounds!
 	 *
 	 * @param x voxel position along X-axis
@@ -127,73 +412,70 @@ struct Cluster3
 	 * @param z voxel position along Z-axis
 	 * @param voxel target voxel ID
 	 */
-	void set(uint16_t x, uint16_t y, uint16_t z, Voxel voxel) noexcept
+	void set(int16_t x, int16_t y, int16_t z, Voxel voxel) noexcept
 	{
-		assert(isComplete());
-		if (x < 0)
-			return nx->set(x + Chunk::sizeX, y, z, voxel);
-		if (x >= Chunk::sizeX)
-			return px->set(x - Chunk::sizeX, y, z, voxel);
-		if (y < 0)
-			return ny->set(x, y + Chunk::sizeY, z, voxel);
-		if (y >= Chunk::sizeY)
-			return py->set(x, y - Chunk::sizeY, z, voxel);
-		if (z < 0)
-			return nz->set(x, y, z + Chunk::sizeZ, voxel);
-		if (z >= Chunk::sizeZ)
-			return pz->set(x, y, z - Chunk::sizeZ, voxel);
-		return c->set(x, y, z, voxel);
+		VOXY_STATS_COUNT(clusterAccess);
+		auto dx = calcChunkOffset<Chunk::sizeX>(x);
+		auto dy = calcChunkOffset<Chunk::sizeY>(y);
+		auto dz = calcChunkOffset<Chunk::sizeZ>(z);
+		auto chunk = chunks[getChunkIndex(dx, dy, dz)];
+		assert(chunk);
+		chunk->set(x - dx * Chunk::sizeX, y - dy * Chunk::sizeY, z - dz * Chunk::sizeZ, voxel);
 	}
 
 	/**
 	 * @brief Returns cluster voxel at specified 3D position if inside cluster bounds.
-	 * @return True if voxel position is inside cluster bounds, otherwise false.
+	 * @return True if voxel position is inside cluster bounds and chunk is not null, otherwise false.
 	 *
 	 * @param x voxel position along X-axis
 	 * @param y voxel position along Y-axis
 	 * @param z voxel position along Z-axis
 	 * @param[out] voxel target voxel ID
 	 */
-	bool tryGet(uint16_t x, uint16_t y, uint16_t z, Voxel& voxel) const noexcept
+	bool tryGet(int16_t x, int16_t y, int16_t z, Voxel& voxel) const noexcept
 	{
-		if (x < 0)
-			return nx ? nx->tryGet(x + Chunk::sizeX, y, z, voxel) : false;
-		if (x >= Chunk::sizeX)
-			return px ? px->tryGet(x - Chunk::sizeX, y, z, voxel) : false;
-		if (y < 0)
-			return ny ? ny->tryGet(x, y + Chunk::sizeY, z, voxel) : false;
-		if (y >= Chunk::sizeY)
-			return py ? py->tryGet(x, y - Chunk::sizeY, z, voxel) : false;
-		if (z < 0)
-			return nz ? nz->tryGet(x, y, z + Chunk::sizeZ, voxel) : false;
-		if (z >= Chunk::sizeZ)
-			return pz ? pz->tryGet(x, y, z - Chunk::sizeZ, voxel) : false;
-		return c ? c->tryGet(x, y, z, voxel) : false;
+		VOXY_STATS_COUNT(clusterAccess);
+		if (x < -Chunk::sizeX || x >= Chunk::sizeX * 2 || y < -Chunk::sizeY ||
+			y >= Chunk::sizeY * 2 || z < -Chunk::sizeZ || z >= Chunk::sizeZ * 2)
+		{
+			return false;
+		}
+
+		auto dx = calcChunkOffset<Chunk::sizeX>(x);
+		auto dy = calcChunkOffset<Chunk::sizeY>(y);
+		auto dz = calcChunkOffset<Chunk::sizeZ>(z);
+		auto chunk = chunks[getChunkIndex(dx, dy, dz)];
+		if (!chunk)
+			return false;
+		voxel = chunk->get(x - dx * Chunk::sizeX, y - dy * Chunk::sizeY, z - dz * Chunk::sizeZ);
+		return true;
 	}
 	/**
 	 * @brief Sets cluster voxel at specified 3D position if inside cluster bounds.
-	 * @return True if voxel position is inside cluster bounds, otherwise false.
+	 * @return True if voxel position is inside cluster bounds and chunk is not null, otherwise false.
 	 *
 	 * @param x voxel position along X-axis
 	 * @param y voxel position along Y-axis
 	 * @param z voxel position along Z-axis
 	 * @param voxel target voxel ID
 	 */
-	bool trySet(uint16_t x, uint16_t y, uint16_t z, Voxel voxel) noexcept
-	{
-		if (x < 0)
-			return nx ? nx->trySet(x + Chunk::sizeX, y, z, voxel) : false;
-		if (x >= Chunk::sizeX)
-			return px ? px->trySet(x - Chunk::sizeX, y, z, voxel) : false;
-		if (y < 0)
-			return ny ? ny->trySet(x, y + Chunk::sizeY, z, voxel) : false;
-		if (y >= Chunk::sizeY)
-			return py ? py->trySet(x, y - Chunk::sizeY, z, voxel) : false;
-		if (z < 0)
-			return nz ? nz->trySet(x, y, z + Chunk::sizeZ, voxel) : false;
-		if (z >= Chunk::sizeZ)
-			return pz ? pz->trySet(x, y, z - Chunk::sizeZ, voxel) : false;
-		return c ? c->trySet(x, y, z, voxel) : false;
+	bool trySet(int16_t x, int16_t y, int16_t z, Voxel voxel) noexcept
+	{
+		VOXY_STATS_COUNT(clusterAccess);
+		if (x < -Chunk::sizeX || x >= Chunk::sizeX * 2 || y < -Chunk::sizeY ||
+			y >= Chunk::sizeY * 2 || z < -Chunk::sizeZ || z >= Chunk::sizeZ * 2)
+		{
+			return false;
+		}
+
+		auto dx = calcChunkOffset<Chunk::sizeX>(x);
+		auto dy = calcChunkOffset<Chunk::sizeY>(y);
+		auto dz = calcChunkOffset<Chunk::sizeZ>(z);
+		auto chunk = chunks[getChunkIndex(dx, dy, dz)];
+		if (!chunk)
+			return false;
+		chunk->set(x - dx * Chunk::sizeX, y - dy * Chunk::sizeY, z - dz * Chunk::sizeZ, voxel);
+		return true;
 	}
 };
 
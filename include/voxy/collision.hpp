@@ -0,0 +1,509 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Axis aligned bounding box (AABB) collision functions.
+ *
+ * @details
+ * Box overlaps voxel (x, y, z) if it intersects the [x, x + 1) range along each axis, touching faces are not
+ * overlapping. Box is swept one axis at a time (Y, X, Z), each axis is scanned by voxel layers in the movement
+ * direction and stopped at the first solid voxel face. Not created chunks are not solid. Empty chunk parts are
+ * skipped with the occupancy masks (@ref OccupancyChunk3) and uniform chunks are checked with one voxel.
+ */
+
+#pragma once
+#include "voxy/raycast.hpp"
+
+namespace voxy
+{
+
+/**
+ * @brief Box position tolerance, so the box touching voxel face after sweep is not overlapping it.
+ */
+constexpr float collisionEpsilon = 1.0e-4f;
+
+/**
+ * @brief Axis aligned bounding box. (in voxels)
+ */
+struct Aabb
+{
+	float minX = 0.0f, minY = 0.0f, minZ = 0.0f; /**< Box minimum corner position. */
+	float maxX = 0.0f, maxY = 0.0f, maxZ = 0.0f; /**< Box maximum corner position. */
+};
+
+/**
+ * @brief Swept box collision query.
+ */
+struct SweepQuery
+{
+	Aabb box;                                       /**< Box to sweep. */
+	float moveX = 0.0f, moveY = 0.0f, moveZ = 0.0f; /**< Box movement vector. */
+};
+/**
+ * @brief Swept box collision result.
+ */
+struct SweepResult
+{
+	Aabb box;                                       /**< Box at the resolved position. */
+	float moveX = 0.0f, moveY = 0.0f, moveZ = 0.0f; /**< Resolved box movement vector. */
+	int8_t normalX = 0, normalY = 0, normalZ = 0;   /**< Hit voxel face normal per axis, zero if not blocked. */
+};
+
+/**
+ * @brief Solid voxel table predicate.
+ * @details Voxel IDs outside the table are not solid.
+ */
+struct SolidTable
+{
+	const bool* solids = nullptr; /**< Solid flag array indexed by the voxel ID. */
+	size_t count = 0;             /**< Solid flag array size. */
+
+	template<typename V>
+	constexpr bool operator()(V voxel) const noexcept { return (size_t)voxel < count && solids[(size_t)voxel]; }
+};
+
+/**
+ * @brief Returns the first voxel position overlapped from the box minimum position.
+ * @details Faster than the floor call without SSE4.1.
+ * @param position box minimum position along the axis
+ */
+static int32_t floorVoxel(float position) noexcept
+{
+	position += collisionEpsilon;
+	auto voxel = (int32_t)position;
+	return voxel - ((float)voxel > position);
+}
+/**
+ * @brief Returns the position after the last voxel overlapped from the box maximum position.
+ * @details Faster than the ceil call without SSE4.1.
+ * @param position box maximum position along the axis
+ */
+static int32_t ceilVoxel(float position) noexcept
+{
+	position -= collisionEpsilon;
+	auto voxel = (int32_t)position;
+	return voxel + ((float)voxel < position);
+}
+/**
+ * @brief Calculates voxel range overlapped by the box along the axis. [start, end)
+ *
+ * @param min box minimum position along the axis
+ * @param max box maximum position along the axis
+ * @param[out] start first overlapped voxel position
+ * @param[out] end position after the last overlapped voxel
+ */
+static void calcVoxelRange(float min, float max, int32_t& start, int32_t& end) noexcept
+{
+	start = floorVoxel(min);
+	end = ceilVoxel(max);
+}
+
+/***********************************************************************************************************************
+ * @brief Returns true if any solid voxel is inside the chunk part.
+ * @details Occupancy masks are used to skip the empty parts if null voxel is not solid,
+ *          with the default predicate they are used without voxel access.
+ *
+ * @param[in] chunk target chunk
+ * @param _sizeX chunk part size along X-axis
+ * @param _sizeY chunk part size along Y-axis
+ * @param _sizeZ chunk part size along Z-axis
+ * @param offsetX chunk part offset along X-axis
+ * @param offsetY chunk part offset along Y-axis
+ * @param offsetZ chunk part offset along Z-axis
+ * @param isSolid solid voxel predicate
+ */
+template<class C, typename F = IsNotNullVoxel>
+static bool overlapVoxels(const C& chunk, uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+	uint8_t offsetX, uint8_t offsetY, uint8_t offsetZ, const F& isSolid = F()) noexcept
+{
+	typedef typename C::Voxel Voxel;
+	assert(_sizeX + offsetX <= C::sizeX);
+	assert(_sizeY + offsetY <= C::sizeY);
+	assert(_sizeZ + offsetZ <= C::sizeZ);
+
+	if constexpr (hasUniformValue<C>::value)
+	{
+		if (chunk.isUniform())
+			return _sizeX > 0 && _sizeY > 0 && _sizeZ > 0 && isSolid(chunk.getValue());
+	}
+	if constexpr (hasOccupancy<C>::value)
+	{
+		if constexpr (std::is_same_v<F, IsNotNullVoxel>)
+			return !chunk.isEmpty() && !chunk.isEmpty(_sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ);
+		if (!isSolid((Voxel)voxel::null) && (chunk.isEmpty() ||
+			chunk.isEmpty(_sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ)))
+		{
+			return false;
+		}
+	}
+
+	for (uint8_t z = offsetZ; z < offsetZ + _sizeZ; z++)
+	{
+		for (uint8_t y = offsetY; y < offsetY + _sizeY; y++)
+		{
+			for (uint8_t x = offsetX; x < offsetX + _sizeX; x++)
+			{
+				if (isSolid(chunk.get(x, y, z)))
+					return true;
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Returns true if any solid voxel is inside the voxel range. [min, max)
+ * @details Chunk getter signature: const C*(int32_t x, int32_t y, int32_t z), returns null for missing chunks.
+ *
+ * @param getChunk chunk getter function
+ * @param minX range start along X-axis
+ * @param minY range start along Y-axis
+ * @param minZ range start along Z-axis
+ * @param maxX range end along X-axis
+ * @param maxY range end along Y-axis
+ * @param maxZ range end along Z-axis
+ * @param isSolid solid voxel predicate
+ */
+template<class C, typename G, typename F>
+static bool overlapChunks(const G& getChunk, int32_t minX, int32_t minY, int32_t minZ,
+	int32_t maxX, int32_t maxY, int32_t maxZ, const F& isSolid) noexcept
+{
+	if (minX >= maxX || minY >= maxY || minZ >= maxZ)
+		return false;
+
+	auto startX = worldToChunkPos<C::sizeX>(minX), endX = worldToChunkPos<C::sizeX>(maxX - 1);
+	auto startY = worldToChunkPos<C::sizeY>(minY), endY = worldToChunkPos<C::sizeY>(maxY - 1);
+	auto startZ = worldToChunkPos<C::sizeZ>(minZ), endZ = worldToChunkPos<C::sizeZ>(maxZ - 1);
+
+	if (startX == endX && startY == endY && startZ == endZ)
+	{
+		const C* chunk = getChunk(startX, startY, startZ);
+		if (!chunk)
+			return false;
+		auto offsetX = minX - startX * C::sizeX, offsetY = minY - startY * C::sizeY, offsetZ = minZ - startZ * C::sizeZ;
+		return overlapVoxels(*chunk, (uint8_t)(maxX - minX), (uint8_t)(maxY - minY), (uint8_t)(maxZ - minZ),
+			(uint8_t)offsetX, (uint8_t)offsetY, (uint8_t)offsetZ, isSolid);
+	}
+
+	for (auto cz = startZ; cz <= endZ; cz++)
+	{
+		auto originZ = cz * C::sizeZ;
+		auto offsetZ = std::max(minZ - originZ, 0), sizeZ = std::min(maxZ - originZ, (int32_t)C::sizeZ) - offsetZ;
+		for (auto cy = startY; cy <= endY; cy++)
+		{
+			auto originY = cy * C::sizeY;
+			auto offsetY = std::max(minY - originY, 0), sizeY = std::min(maxY - originY, (int32_t)C::sizeY) - offsetY;
+			for (auto cx = startX; cx <= endX; cx++)
+			{
+				const C* chunk = getChunk(cx, cy, cz);
+				if (!chunk)
+					continue;
+
+				auto originX = cx * C::sizeX;
+				auto offsetX = std::max(minX - originX, 0);
+				auto sizeX = std::min(maxX - originX, (int32_t)C::sizeX) - offsetX;
+				if (overlapVoxels(*chunk, (uint8_t)sizeX, (uint8_t)sizeY, (uint8_t)sizeZ,
+					(uint8_t)offsetX, (uint8_t)offsetY, (uint8_t)offsetZ, isSolid))
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Returns true if box overlaps any solid voxel.
+ * @details Chunk getter signature: const C*(int32_t x, int32_t y, int32_t z), returns null for missing chunks.
+ *
+ * @param getChunk chunk getter function
+ * @param[in] box target box
+ * @param isSolid solid voxel predicate
+ */
+template<class C, typename G, typename F>
+static bool overlapBox(const G& getChunk, const Aabb& box, const F& isSolid) noexcept
+{
+	int32_t minX, minY, minZ, maxX, maxY, maxZ;
+	calcVoxelRange(box.minX, box.maxX, minX, maxX);
+	calcVoxelRange(box.minY, box.maxY, minY, maxY);
+	calcVoxelRange(box.minZ, box.maxZ, minZ, maxZ);
+	return overlapChunks<C>(getChunk, minX, minY, minZ, maxX, maxY, maxZ, isSolid);
+}
+
+/**
+ * @brief Sweeps box along one axis, returns movement until the first solid voxel face.
+ *
+ * @details
+ * Swept part is visited by chunk slabs in the movement direction, each chunk is looked up once and its
+ * voxel layers are checked in the movement order. Voxels already overlapped by the box are ignored,
+ * so it can leave the solid voxels.
+ *
+ * @param getChunk chunk getter function
+ * @param[in] box target box
+ * @param axis movement axis (0 - X, 1 - Y, 2 - Z)
+ * @param move box movement along the axis
+ * @param isSolid solid voxel predicate
+ */
+template<class C, typename G, typename F>
+static float sweepAxis(const G& getChunk, const Aabb& box, uint8_t axis, float move, const F& isSolid) noexcept
+{
+	assert(axis < 3);
+	if (move == 0.0f)
+		return 0.0f;
+
+	const float boxMin[3] = { box.minX, box.minY, box.minZ };
+	const float boxMax[3] = { box.maxX, box.maxY, box.maxZ };
+	const int32_t sizes[3] = { C::sizeX, C::sizeY, C::sizeZ };
+	int32_t min[3], max[3], first, last;
+	for (uint8_t i = 0; i < 3; i++)
+		calcVoxelRange(boxMin[i], boxMax[i], min[i], max[i]);
+
+	int32_t step;
+	if (move > 0.0f)
+	{
+		first = ceilVoxel(boxMax[axis]);
+		last = ceilVoxel(boxMax[axis] + move) - 1;
+		step = 1;
+	}
+	else
+	{
+		first = floorVoxel(boxMin[axis]) - 1;
+		last = floorVoxel(boxMin[axis] + move);
+		step = -1;
+	}
+	if ((last - first) * step < 0 || min[0] >= max[0] || min[1] >= max[1] || min[2] >= max[2])
+		return move;
+	min[axis] = std::min(first, last); max[axis] = std::max(first, last) + 1;
+
+	auto toChunkPos = [](uint8_t i, int32_t position)
+	{
+		if (i == 0)
+			return worldToChunkPos<C::sizeX>(position);
+		if (i == 1)
+			return worldToChunkPos<C::sizeY>(position);
+		return worldToChunkPos<C::sizeZ>(position);
+	};
+	uint8_t axis1 = (axis + 1) % 3, axis2 = (axis + 2) % 3;
+	auto start1 = toChunkPos(axis1, min[axis1]), end1 = toChunkPos(axis1, max[axis1] - 1);
+	auto start2 = toChunkPos(axis2, min[axis2]), end2 = toChunkPos(axis2, max[axis2] - 1);
+	auto lastSlab = toChunkPos(axis, last);
+
+	for (auto slab = toChunkPos(axis, first); true; slab += step)
+	{
+		auto hitLayer = last + step;
+		for (auto c2 = start2; c2 <= end2; c2++)
+		{
+			for (auto c1 = start1; c1 <= end1; c1++)
+			{
+				int32_t chunkPos[3];
+				chunkPos[axis] = slab; chunkPos[axis1] = c1; chunkPos[axis2] = c2;
+				const C* chunk = getChunk(chunkPos[0], chunkPos[1], chunkPos[2]);
+				if (!chunk)
+					continue;
+
+				int32_t origin[3], offset[3], size[3];
+				for (uint8_t i = 0; i < 3; i++)
+				{
+					origin[i] = chunkPos[i] * sizes[i];
+					offset[i] = std::max(min[i] - origin[i], 0);
+					size[i] = std::min(max[i] - origin[i], sizes[i]) - offset[i];
+				}
+
+				// Checks chunk layers in the movement order, only nearer than the hit in other slab chunks.
+				auto layer = step > 0 ? offset[axis] : offset[axis] + size[axis] - 1;
+				for (int32_t i = 0; i < size[axis] && (hitLayer - (origin[axis] + layer)) * step > 0; i++, layer += step)
+				{
+					int32_t layerOffset[3] = { offset[0], offset[1], offset[2] };
+					int32_t layerSize[3] = { size[0], size[1], size[2] };
+					layerOffset[axis] = layer; layerSize[axis] = 1;
+					if (overlapVoxels(*chunk, (uint8_t)layerSize[0], (uint8_t)layerSize[1], (uint8_t)layerSize[2],
+						(uint8_t)layerOffset[0], (uint8_t)layerOffset[1], (uint8_t)layerOffset[2], isSolid))
+					{
+						hitLayer = origin[axis] + layer;
+						break;
+					}
+				}
+			}
+		}
+
+		if (hitLayer != last + step)
+		{
+			if (step > 0)
+				return std::max((float)hitLayer - boxMax[axis], 0.0f);
+			return std::min((float)(hitLayer + 1) - boxMin[axis], 0.0f);
+		}
+		if (slab == lastSlab)
+			break;
+	}
+	return move;
+}
+
+/**
+ * @brief Sweeps box by the movement vector, resolving collisions one axis at a time. (Y, X, Z)
+ * @details Chunk getter signature: const C*(int32_t x, int32_t y, int32_t z), returns null for missing chunks.
+ *
+ * @param getChunk chunk getter function
+ * @param[in] query swept box query
+ * @param isSolid solid voxel predicate
+ */
+template<class C, typename G, typename F>
+static SweepResult sweepBox(const G& getChunk, const SweepQuery& query, const F& isSolid) noexcept
+{
+	SweepResult result;
+	result.box = query.box;
+	auto& box = result.box;
+
+	result.moveY = sweepAxis<C>(getChunk, box, 1, query.moveY, isSolid);
+	box.minY += result.moveY; box.maxY += result.moveY;
+	if (result.moveY != query.moveY)
+		result.normalY = query.moveY > 0.0f ? -1 : 1;
+
+	result.moveX = sweepAxis<C>(getChunk, box, 0, query.moveX, isSolid);
+	box.minX += result.moveX; box.maxX += result.moveX;
+	if (result.moveX != query.moveX)
+		result.normalX = query.moveX > 0.0f ? -1 : 1;
+
+	result.moveZ = sweepAxis<C>(getChunk, box, 2, query.moveZ, isSolid);
+	box.minZ += result.moveZ; box.maxZ += result.moveZ;
+	if (result.moveZ != query.moveZ)
+		result.normalZ = query.moveZ > 0.0f ? -1 : 1;
+	return result;
+}
+
+/***********************************************************************************************************************
+ * @brief Returns true if box overlaps any solid chunk voxel.
+ *
+ * @param[in] chunk target chunk
+ * @param[in] box target box (relative to the chunk)
+ * @param isSolid solid voxel predicate
+ */
+template<class C, typename F = IsNotNullVoxel>
+static bool overlapChunk(const C& chunk, const Aabb& box, const F& isSolid = F()) noexcept
+{
+	return overlapBox<C>([&](int32_t x, int32_t y, int32_t z) -> const C*
+	{
+		return x == 0 && y == 0 && z == 0 ? &chunk : nullptr;
+	}, box, isSolid);
+}
+/**
+ * @brief Returns true if box overlaps any solid world voxel.
+ *
+ * @param[in] world target world (@ref World3)
+ * @param[in] box target box
+ * @param isSolid solid voxel predicate
+ */
+template<class W, typename F = IsNotNullVoxel>
+static bool overlapWorld(const W& world, const Aabb& box, const F& isSolid = F()) noexcept
+{
+	typedef typename W::Chunk Chunk;
+	return overlapBox<Chunk>([&](int32_t x, int32_t y, int32_t z) { return world.getChunk(x, y, z); }, box, isSolid);
+}
+/**
+ * @brief Returns true if box overlaps any solid cluster voxel.
+ * @details Edge and corner cluster chunk parts are not solid.
+ *
+ * @param[in] cluster target cluster (@ref Cluster3)
+ * @param[in] box target box (relative to the central chunk)
+ * @param isSolid solid voxel predicate
+ */
+template<class C, typename V, typename F = IsNotNullVoxel>
+static bool overlapCluster(const Cluster3<C, V>& cluster, const Aabb& box, const F& isSolid = F()) noexcept
+{
+	return overlapBox<C>([&](int32_t x, int32_t y, int32_t z) -> const C*
+	{
+		if (x < -1 || x > 1 || y < -1 || y > 1 || z < -1 || z > 1)
+			return nullptr;
+		return cluster.getChunk((int8_t)x, (int8_t)y, (int8_t)z);
+	}, box, isSolid);
+}
+
+/**
+ * @brief Sweeps box through the world voxels.
+ *
+ * @param[in] world target world (@ref World3)
+ * @param[in] query swept box query
+ * @param isSolid solid voxel predicate
+ */
+template<class W, typename F = IsNotNullVoxel>
+static SweepResult sweepWorld(const W& world, const SweepQuery& query, const F& isSolid = F()) noexcept
+{
+	typedef typename W::Chunk Chunk;
+	return sweepBox<Chunk>([&](int32_t x, int32_t y, int32_t z) { return world.getChunk(x, y, z); }, query, isSolid);
+}
+/**
+ * @brief Sweeps box through the cluster voxels.
+ * @details Edge and corner cluster chunk parts are not solid.
+ *
+ * @param[in] cluster target cluster (@ref Cluster3)
+ * @param[in] query swept box query (relative to the central chunk)
+ * @param isSolid solid voxel predicate
+ */
+template<class C, typename V, typename F = IsNotNullVoxel>
+static SweepResult sweepCluster(const Cluster3<C, V>& cluster, const SweepQuery& query, const F& isSolid = F()) noexcept
+{
+	return sweepBox<C>([&](int32_t x, int32_t y, int32_t z) -> const C*
+	{
+		if (x < -1 || x > 1 || y < -1 || y > 1 || z < -1 || z > 1)
+			return nullptr;
+		return cluster.getChunk((int8_t)x, (int8_t)y, (int8_t)z);
+	}, query, isSolid);
+}
+
+/***********************************************************************************************************************
+ * @brief Sweeps many boxes through the world voxels.
+ *
+ * @details
+ * World chunks are looked up through a small cache (2x2x2 chunk positions by parity), which is kept between the
+ * queries, so boxes near each other (sorted by position) share the lookups. Several batches can be run from
+ * different threads at once, while the world is not modified.
+ *
+ * @param[in] world target world (@ref World3)
+ * @param[in] queries swept box query array
+ * @param[out] results swept box result array
+ * @param count query and result array size
+ * @param isSolid solid voxel predicate
+ */
+template<class W, typename F = IsNotNullVoxel>
+static void sweepWorld(const W& world, const SweepQuery* queries,
+	SweepResult* results, size_t count, const F& isSolid = F()) noexcept
+{
+	typedef typename W::Chunk Chunk;
+	assert((queries && results) || count == 0);
+
+	struct CacheEntry
+	{
+		int32_t x = INT32_MIN, y = 0, z = 0;
+		const Chunk* chunk = nullptr;
+	};
+	CacheEntry cache[8];
+
+	auto getChunk = [&](int32_t x, int32_t y, int32_t z)
+	{
+		auto& entry = cache[(x & 1) | (y & 1) << 1 | (z & 1) << 2];
+		if (entry.x != x || entry.y != y || entry.z != z)
+		{
+			entry.x = x; entry.y = y; entry.z = z;
+			entry.chunk = world.getChunk(x, y, z);
+		}
+		return entry.chunk;
+	};
+
+	for (size_t i = 0; i < count; i++)
+		results[i] = sweepBox<Chunk>(getChunk, queries[i], isSolid);
+}
+
+};
\ No newline at end of file
@@ -0,0 +1,609 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Thread-safe voxel world (concurrent chunk map) functions.
+ *
+ * @details
+ * Concurrent world stores chunks in the fixed capacity open addressing hash table, entries are inserted
+ * with the atomic compare-and-swap, so lookup never locks. Each chunk has a sequence lock (seqlock):
+ * readers copy voxels optimistically and retry if the chunk was changed, writers take an exclusive lease.
+ *
+ * Destroyed chunks and their table entries are reclaimed by @ref ConcurrentWorld3::collect, which should
+ * be called when no other thread accesses the world. (for example at the end of the simulation tick)
+ *
+ * Optimistic reads copy voxels while a writer may change them (validated by the sequence afterwards),
+ * so thread sanitizer reports them as data races by design.
+ */
+
+#pragma once
+#include "voxy/world.hpp"
+
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace voxy
+{
+
+/***********************************************************************************************************************
+ * @brief Thread-safe sparse voxel chunk 3D container. (map)
+ *
+ * @details
+ * Chunk positions are packed into the 63-bit table keys, so each position component
+ * should be in range [-2^20, 2^20). Version of a chunk is incremented by each write lease.
+ *
+ * @tparam C world chunk type
+ */
+template<class C>
+class ConcurrentWorld3
+{
+public:
+	/**
+	 * @brief World chunk type.
+	 */
+	typedef C Chunk;
+	/**
+	 * @brief Chunk voxel ID type.
+	 */
+	typedef typename C::Voxel Voxel;
+	/**
+	 * @brief World chunk cluster type.
+	 */
+	typedef Cluster3<C, Voxel> Cluster;
+
+	/**
+	 * @brief Minimum chunk position component value.
+	 */
+	static constexpr int32_t minPosition = -(1 << 20);
+	/**
+	 * @brief Maximum chunk position component value.
+	 */
+	static constexpr int32_t maxPosition = (1 << 20) - 1;
+protected:
+	struct Slot
+	{
+		std::atomic<uint32_t> sequence;
+		C chunk;
+	};
+	struct Entry
+	{
+		std::atomic<uint64_t> key;
+		std::atomic<Slot*> slot;
+	};
+
+	ChunkPool<Slot> pool;
+	std::unique_ptr<Entry[]> entries;
+	std::vector<Slot*> retiredSlots;
+	std::mutex retireMutex;
+	size_t capacity = 0;
+	std::atomic<size_t> chunkCount = 0;
+	std::atomic<size_t> deadCount = 0;
+
+	static constexpr uint64_t packPos(int32_t x, int32_t y, int32_t z) noexcept
+	{
+		assert(x >= minPosition && x <= maxPosition);
+		assert(y >= minPosition && y <= maxPosition);
+		assert(z >= minPosition && z <= maxPosition);
+		constexpr uint64_t mask = (1u << 21) - 1;
+		return ((uint64_t)x & mask) | ((uint64_t)y & mask) << 21 | ((uint64_t)z & mask) << 42 | (uint64_t)1 << 63;
+	}
+	static constexpr void unpackPos(uint64_t key, int32_t& x, int32_t& y, int32_t& z) noexcept
+	{
+		constexpr uint64_t mask = (1u << 21) - 1;
+		x = (int32_t)(key & mask); y = (int32_t)(key >> 21 & mask); z = (int32_t)(key >> 42 & mask);
+		if (x > maxPosition) x -= 1 << 21;
+		if (y > maxPosition) y -= 1 << 21;
+		if (z > maxPosition) z -= 1 << 21;
+	}
+
+	static void allocateEntries(std::unique_ptr<Entry[]>& entries, size_t capacity)
+	{
+		entries = std::make_unique<Entry[]>(capacity);
+		for (size_t i = 0; i < capacity; i++)
+		{
+			entries[i].key.store(0, std::memory_order_relaxed);
+			entries[i].slot.store(nullptr, std::memory_order_relaxed);
+		}
+	}
+
+	Entry* findEntry(int32_t x, int32_t y, int32_t z) const noexcept
+	{
+		auto key = packPos(x, y, z);
+		auto mask = capacity - 1;
+		auto index = hashChunkPos(x, y, z) & mask;
+		for (size_t i = 0; i < capacity; i++)
+		{
+			auto& entry = entries[index];
+			auto entryKey = entry.key.load(std::memory_order_acquire);
+			if (entryKey == key)
+				return &entry;
+			if (entryKey == 0)
+				return nullptr;
+			index = (index + 1) & mask;
+		}
+		return nullptr;
+	}
+	Entry* insertEntry(int32_t x, int32_t y, int32_t z) noexcept
+	{
+		auto key = packPos(x, y, z);
+		auto mask = capacity - 1;
+		auto index = hashChunkPos(x, y, z) & mask;
+		for (size_t i = 0; i < capacity; i++)
+		{
+			auto& entry = entries[index];
+			auto entryKey = entry.key.load(std::memory_order_acquire);
+			if (entryKey == 0 && entry.key.compare_exchange_strong(entryKey, key, std::memory_order_acq_rel))
+				return &entry;
+			if (entryKey == key)
+				return &entry;
+			index = (index + 1) & mask;
+		}
+		return nullptr;
+	}
+	Slot* findSlot(int32_t x, int32_t y, int32_t z) const noexcept
+	{
+		auto entry = findEntry(x, y, z);
+		return entry ? entry->slot.load(std::memory_order_acquire) : nullptr;
+	}
+
+	static bool tryLock(Slot* slot) noexcept
+	{
+		auto sequence = slot->sequence.load(std::memory_order_relaxed);
+		if (sequence & 1 || !slot->sequence.compare_exchange_strong(sequence,
+			sequence + 1, std::memory_order_acquire, std::memory_order_relaxed))
+		{
+			return false;
+		}
+		std::atomic_thread_fence(std::memory_order_release);
+		return true;
+	}
+	static uint32_t beginRead(const Slot* slot) noexcept
+	{
+		while (true)
+		{
+			auto sequence = slot->sequence.load(std::memory_order_acquire);
+			if ((sequence & 1) == 0)
+				return sequence;
+			std::this_thread::yield();
+		}
+	}
+	static bool endRead(const Slot* slot, uint32_t sequence) noexcept
+	{
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return slot->sequence.load(std::memory_order_relaxed) == sequence;
+	}
+public:
+	/*******************************************************************************************************************
+	 * @brief Exclusive chunk write access.
+	 * @details Lease is released on destruction, optimistic readers retry until then.
+	 * @note Keep leases short, readers of the leased chunk are spinning.
+	 */
+	class WriteLease
+	{
+		Slot* slot = nullptr;
+		friend class ConcurrentWorld3;
+		WriteLease(Slot* slot) noexcept : slot(slot) { }
+	public:
+		/**
+		 * @brief Creates a new empty write lease.
+		 */
+		WriteLease() = default;
+		/**
+		 * @brief Releases chunk write lease.
+		 */
+		~WriteLease() { release(); }
+
+		WriteLease(const WriteLease&) = delete;
+		WriteLease& operator=(const WriteLease&) = delete;
+		WriteLease(WriteLease&& lease) noexcept { std::swap(slot, lease.slot); }
+		WriteLease& operator=(WriteLease&& lease) noexcept
+		{
+			if (this != &lease)
+			{
+				release();
+				std::swap(slot, lease.slot);
+			}
+			return *this;
+		}
+
+		/**
+		 * @brief Returns true if lease owns the chunk.
+		 */
+		explicit operator bool() const noexcept { return slot; }
+		/**
+		 * @brief Returns leased chunk.
+		 */
+		C& getChunk() const noexcept { assert(slot); return slot->chunk; }
+		/**
+		 * @brief Returns leased chunk.
+		 */
+		C* operator->() const noexcept { assert(slot); return &slot->chunk; }
+
+		/**
+		 * @brief Releases chunk write lease, incrementing chunk version.
+		 */
+		void release() noexcept
+		{
+			if (!slot)
+				return;
+			slot->sequence.fetch_add(1, std::memory_order_release);
+			slot = nullptr;
+		}
+	};
+
+	/*******************************************************************************************************************
+	 * @brief Consistent copy of the chunk cluster.
+	 * @details Chunk order is the same as in the cluster: c, nx, px, ny, py, nz, pz.
+	 */
+	struct ClusterSnapshot
+	{
+		C chunks[7];          /**< Cluster chunk copies. */
+		uint32_t versions[7]; /**< Cluster chunk versions at snapshot time. */
+		bool isCreated[7];    /**< Is cluster chunk created. */
+
+		/**
+		 * @brief Returns snapshot chunk cluster.
+		 * @note Not created cluster chunks are set to null.
+		 */
+		Cluster getCluster() noexcept
+		{
+			C* c[7];
+			for (uint8_t i = 0; i < 7; i++)
+				c[i] = isCreated[i] ? chunks + i : nullptr;
+			return Cluster(c[0], c[1], c[2], c[3], c[4], c[5], c[6]);
+		}
+	};
+
+	/**
+	 * @brief Creates a new empty concurrent world.
+	 * @param capacity maximum chunk count before the @ref collect call
+	 */
+	ConcurrentWorld3(size_t capacity = 1024)
+	{
+		assert(capacity > 0);
+		this->capacity = 16;
+		while (this->capacity / 2 < capacity)
+			this->capacity *= 2;
+		allocateEntries(entries, this->capacity);
+	}
+	/**
+	 * @brief Destroys all world chunks.
+	 */
+	~ConcurrentWorld3()
+	{
+		for (size_t i = 0; i < capacity; i++)
+		{
+			auto slot = entries[i].slot.load(std::memory_order_relaxed);
+			if (slot)
+				pool.deallocate(slot);
+		}
+		for (auto slot : retiredSlots)
+			pool.deallocate(slot);
+	}
+
+	ConcurrentWorld3(const ConcurrentWorld3&) = delete;
+	ConcurrentWorld3& operator=(const ConcurrentWorld3&) = delete;
+
+	/**
+	 * @brief Returns world chunk count.
+	 */
+	size_t getChunkCount() const noexcept { return chunkCount.load(std::memory_order_relaxed); }
+	/**
+	 * @brief Returns world hash table capacity.
+	 */
+	size_t getCapacity() const noexcept { return capacity; }
+
+	/**
+	 * @brief Returns true if world chunk at specified position is created.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 */
+	bool hasChunk(int32_t x, int32_t y, int32_t z) const noexcept { return findSlot(x, y, z); }
+
+	/**
+	 * @brief Creates a new world chunk at specified position.
+	 * @details Chunk is published only after it is filled, does nothing if it is already created.
+	 * @return True if chunk is created, otherwise false if the hash table is full. (call @ref collect)
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 * @param voxel target voxel to fill new chunk with
+	 */
+	bool createChunk(int32_t x, int32_t y, int32_t z, Voxel voxel = voxel::null)
+	{
+		auto entry = insertEntry(x, y, z);
+		if (!entry)
+			return false;
+		if (entry->slot.load(std::memory_order_acquire))
+			return true;
+
+		auto slot = pool.allocate();
+		slot->sequence.store(0, std::memory_order_relaxed);
+		slot->chunk.fill(voxel);
+
+		Slot* expected = nullptr;
+		if (entry->slot.compare_exchange_strong(expected, slot, std::memory_order_acq_rel))
+			chunkCount.fetch_add(1, std::memory_order_relaxed);
+		else
+			pool.deallocate(slot);
+		return true;
+	}
+	/**
+	 * @brief Destroys world chunk at specified position.
+	 * @details Chunk memory is reclaimed by the @ref collect, current readers and writers can finish safely.
+	 * @return True if chunk was destroyed, otherwise false if it is not created.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 */
+	bool destroyChunk(int32_t x, int32_t y, int32_t z)
+	{
+		auto entry = findEntry(x, y, z);
+		if (!entry)
+			return false;
+		auto slot = entry->slot.exchange(nullptr, std::memory_order_acq_rel);
+		if (!slot)
+			return false;
+
+		chunkCount.fetch_sub(1, std::memory_order_relaxed);
+		deadCount.fetch_add(1, std::memory_order_relaxed);
+		std::lock_guard lock(retireMutex);
+		retiredSlots.push_back(slot);
+		return true;
+	}
+	/**
+	 * @brief Reclaims destroyed chunks and removes their hash table entries.
+	 * @details Hash table grows if it is more than half full.
+	 * @warning It is not thread-safe, call it only when no other thread accesses the world!
+	 */
+	void collect()
+	{
+		for (auto slot : retiredSlots)
+			pool.deallocate(slot);
+		retiredSlots.clear();
+
+		auto count = chunkCount.load(std::memory_order_relaxed);
+		auto newCapacity = capacity;
+		while (newCapacity / 2 < count + 1)
+			newCapacity *= 2;
+		if (deadCount.load(std::memory_order_relaxed) == 0 && newCapacity == capacity)
+			return;
+
+		auto oldEntries = std::move(entries);
+		auto oldCapacity = capacity;
+		allocateEntries(entries, newCapacity);
+		capacity = newCapacity;
+
+		for (size_t i = 0; i < oldCapacity; i++)
+		{
+			auto slot = oldEntries[i].slot.load(std::memory_order_relaxed);
+			if (!slot)
+				continue;
+			int32_t x, y, z;
+			unpackPos(oldEntries[i].key.load(std::memory_order_relaxed), x, y, z);
+			insertEntry(x, y, z)->slot.store(slot, std::memory_order_relaxed);
+		}
+		deadCount.store(0, std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Tries to take exclusive chunk write lease without waiting.
+	 * @return Empty lease if chunk is not created or already leased.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 */
+	WriteLease tryLease(int32_t x, int32_t y, int32_t z) noexcept
+	{
+		auto slot = findSlot(x, y, z);
+		return slot && tryLock(slot) ? WriteLease(slot) : WriteLease();
+	}
+	/**
+	 * @brief Takes exclusive chunk write lease, waiting for the current writer.
+	 * @return Empty lease if chunk is not created.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 */
+	WriteLease lease(int32_t x, int32_t y, int32_t z) noexcept
+	{
+		auto slot = findSlot(x, y, z);
+		if (!slot)
+			return WriteLease();
+		while (!tryLock(slot))
+			std::this_thread::yield();
+		return WriteLease(slot);
+	}
+
+	/**
+	 * @brief Reads world chunk optimistically.
+	 * @details Function signature: void(const C& chunk)
+	 * @return True if chunk is created, otherwise false.
+	 *
+	 * @note Function is called again if the chunk was changed during the read, so it may see
+	 *       inconsistent voxels. Only copy the data inside it, and use it after the return!
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 * @param func target read function
+	 */
+	template<typename F>
+	bool read(int32_t x, int32_t y, int32_t z, F&& func) const
+	{
+		auto slot = findSlot(x, y, z);
+		if (!slot)
+			return false;
+
+		while (true)
+		{
+			auto sequence = beginRead(slot);
+			func((const C&)slot->chunk);
+			if (endRead(slot, sequence))
+				return true;
+		}
+	}
+	/**
+	 * @brief Returns consistent world chunk copy.
+	 * @return True if chunk is created, otherwise false.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 * @param[out] chunk target chunk copy
+	 */
+	bool tryRead(int32_t x, int32_t y, int32_t z, C& chunk) const noexcept
+	{
+		static_assert(std::is_trivially_copyable_v<C>, "Chunk should be trivially copyable for seqlock reads");
+		return read(x, y, z, [&](const C& source) { memcpy((void*)&chunk, (const void*)&source, sizeof(C)); });
+	}
+	/**
+	 * @brief Returns world chunk version. (write lease count)
+	 * @return True if chunk is created, otherwise false.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 * @param[out] version target chunk version
+	 */
+	bool tryGetVersion(int32_t x, int32_t y, int32_t z, uint32_t& version) const noexcept
+	{
+		auto slot = findSlot(x, y, z);
+		if (!slot)
+			return false;
+		version = slot->sequence.load(std::memory_order_acquire) >> 1;
+		return true;
+	}
+
+	/**
+	 * @brief Returns consistent copy of the chunk cluster at specified chunk position.
+	 * @details All 7 chunks are copied at the same moment, retries if any of them was changed.
+	 * @return True if central cluster chunk is created, otherwise false.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 * @param[out] snapshot target cluster snapshot
+	 */
+	bool snapshotCluster(int32_t x, int32_t y, int32_t z, ClusterSnapshot& snapshot) const noexcept
+	{
+		static_assert(std::is_trivially_copyable_v<C>, "Chunk should be trivially copyable for seqlock reads");
+		const Slot* slots[7] =
+		{
+			findSlot(x, y, z), findSlot(x - 1, y, z), findSlot(x + 1, y, z),
+			findSlot(x, y - 1, z), findSlot(x, y + 1, z), findSlot(x, y, z - 1), findSlot(x, y, z + 1)
+		};
+
+		while (true)
+		{
+			uint32_t sequences[7];
+			for (uint8_t i = 0; i < 7; i++)
+			{
+				snapshot.isCreated[i] = slots[i];
+				if (!slots[i])
+					continue;
+				sequences[i] = beginRead(slots[i]);
+				memcpy((void*)(snapshot.chunks + i), (const void*)&slots[i]->chunk, sizeof(C));
+			}
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			bool isConsistent = true;
+			for (uint8_t i = 0; i < 7; i++)
+			{
+				if (!slots[i])
+					continue;
+				if (slots[i]->sequence.load(std::memory_order_relaxed) != sequences[i])
+				{
+					isConsistent = false;
+					break;
+				}
+				snapshot.versions[i] = sequences[i] >> 1;
+			}
+			if (isConsistent)
+				return slots[0];
+		}
+	}
+
+	/**
+	 * @brief Returns world voxel at specified 3D position if chunk is created.
+	 * @return True if voxel chunk is created, otherwise false.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param[out] voxel target voxel ID
+	 */
+	bool tryGet(int32_t x, int32_t y, int32_t z, Voxel& voxel) const noexcept
+	{
+		auto chunkX = worldToChunkPos<C::sizeX>(x);
+		auto chunkY = worldToChunkPos<C::sizeY>(y);
+		auto chunkZ = worldToChunkPos<C::sizeZ>(z);
+		auto localX = (uint8_t)(x - chunkX * C::sizeX);
+		auto localY = (uint8_t)(y - chunkY * C::sizeY);
+		auto localZ = (uint8_t)(z - chunkZ * C::sizeZ);
+		return read(chunkX, chunkY, chunkZ, [&](const C& chunk) { voxel = chunk.get(localX, localY, localZ); });
+	}
+	/**
+	 * @brief Sets world voxel at specified 3D position if chunk is created.
+	 * @details Takes short chunk write lease.
+	 * @return True if voxel chunk is created, otherwise false.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param voxel target voxel ID
+	 */
+	bool trySet(int32_t x, int32_t y, int32_t z, Voxel voxel) noexcept
+	{
+		auto chunkX = worldToChunkPos<C::sizeX>(x);
+		auto chunkY = worldToChunkPos<C::sizeY>(y);
+		auto chunkZ = worldToChunkPos<C::sizeZ>(z);
+		auto lease = this->lease(chunkX, chunkY, chunkZ);
+		if (!lease)
+			return false;
+		lease->set((uint8_t)(x - chunkX * C::sizeX),
+			(uint8_t)(y - chunkY * C::sizeY), (uint8_t)(z - chunkZ * C::sizeZ), voxel);
+		return true;
+	}
+
+	/**
+	 * @brief Calls specified function for each world chunk.
+	 * @details Function signature: void(int32_t x, int32_t y, int32_t z, C& chunk)
+	 * @warning It is not thread-safe, call it only when no other thread accesses the world!
+	 * @param func target function
+	 */
+	template<typename F>
+	void forEach(F&& func)
+	{
+		for (size_t i = 0; i < capacity; i++)
+		{
+			auto slot = entries[i].slot.load(std::memory_order_relaxed);
+			if (!slot)
+				continue;
+			int32_t x, y, z;
+			unpackPos(entries[i].key.load(std::memory_order_relaxed), x, y, z);
+			func(x, y, z, slot->chunk);
+		}
+	}
+};
+
+};
\ No newline at end of file
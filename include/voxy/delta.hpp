@@ -0,0 +1,218 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Chunk delta (difference) encoding functions.
+ *
+ * @details
+ * Delta is a sequence of changed voxel spans along the chunk layout order, until the end of data:
+ *   [skip varint][length varint][length voxel IDs]
+ * where skip is the unchanged voxel count since the end of the previous span. Spans separated by a
+ * small gap are merged, because the gap voxels are cheaper than a new span header.
+ *
+ * Varints are unsigned LEB128, voxel IDs are stored in the host byte order, the same as in @ref serialize.hpp.
+ */
+
+#pragma once
+#include "voxy/serialize.hpp"
+#include <algorithm>
+
+namespace voxy::delta
+{
+
+/**
+ * @brief Maximum merged unchanged gap size between the spans in bytes.
+ */
+constexpr size_t maxGapSize = 2;
+
+/**
+ * @brief Returns maximum chunk delta size in bytes. (all voxels are changed)
+ * @tparam C target chunk type (@ref Chunk3)
+ */
+template<class C>
+static constexpr size_t calcMaxSize() noexcept
+{
+	return serial::calcVarintSize(0) + serial::calcVarintSize(C::size) + C::size * sizeof(typename C::Voxel);
+}
+
+/**
+ * @brief Writes changed voxel span to the delta buffer.
+ * @return True on success, otherwise false if buffer is too small.
+ *
+ * @param skip unchanged voxel count since the previous span
+ * @param[in] voxels span voxel IDs
+ * @param length span voxel count
+ * @param[out] buffer destination delta buffer
+ * @param capacity destination buffer size in bytes
+ * @param[in,out] size written delta size in bytes
+ */
+template<typename V>
+static bool writeSpan(size_t skip, const V* voxels, size_t length,
+	uint8_t* buffer, size_t capacity, size_t& size) noexcept
+{
+	auto dataSize = length * sizeof(V);
+	if (serial::calcVarintSize(skip) + serial::calcVarintSize(length) + dataSize > capacity - size)
+		return false;
+	size += serial::writeVarint(skip, buffer + size);
+	size += serial::writeVarint(length, buffer + size);
+	memcpy(buffer + size, voxels, dataSize);
+	size += dataSize;
+	return true;
+}
+
+/**
+ * @brief Reads unsigned LEB128 varint from the data.
+ * @return True on success, otherwise false if data is invalid or incomplete.
+ *
+ * @param[in] data source data
+ * @param size source data size in bytes
+ * @param[in,out] offset data read offset in bytes
+ * @param[out] value decoded varint value
+ */
+static bool readVarint(const uint8_t* data, size_t size, size_t& offset, uint64_t& value) noexcept
+{
+	value = 0;
+	for (uint8_t shift = 0; offset < size && shift < 64; shift += 7)
+	{
+		auto byte = data[offset++];
+		value |= (uint64_t)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+			return true;
+	}
+	return false;
+}
+
+/***********************************************************************************************************************
+ * @brief Encodes delta between two chunk states.
+ * @details Changed spans are found with the vectorized compare functions.
+ * @return True on success, otherwise false if buffer is too small.
+ *
+ * @param[in] from previous chunk state
+ * @param[in] to current chunk state
+ * @param[out] buffer destination delta buffer (use @ref calcMaxSize)
+ * @param capacity destination buffer size in bytes
+ * @param[out] size written delta size in bytes (zero if chunks are equal)
+ */
+template<class C>
+static bool encode(const C& from, const C& to, uint8_t* buffer, size_t capacity, size_t& size) noexcept
+{
+	assert(buffer || capacity == 0);
+	auto a = from.getVoxels(), b = to.getVoxels();
+	size_t index = 0, lastEnd = 0;
+	size = 0;
+
+	while (true)
+	{
+		index += simd::findMismatch(a + index, b + index, C::size - index);
+		if (index == C::size)
+			return true;
+
+		auto start = index;
+		index += simd::findMatch(a + index, b + index, C::size - index);
+		while (index < C::size)
+		{
+			auto next = index + simd::findMismatch(a + index, b + index, C::size - index);
+			if (next == C::size || (next - index) * sizeof(typename C::Voxel) > maxGapSize)
+				break;
+			index = next + simd::findMatch(a + next, b + next, C::size - next);
+		}
+
+		if (!writeSpan(start - lastEnd, b + start, index - start, buffer, capacity, size))
+			return false;
+		lastEnd = index;
+	}
+}
+
+/**
+ * @brief Encodes delta from the changed voxel index list.
+ * @details Index list is sorted in place, duplicate indices are allowed.
+ * @return True on success, otherwise false if buffer is too small.
+ *
+ * @param[in] chunk current chunk state
+ * @param[in,out] indices changed voxel indices (see @ref Chunk3::posToIndex)
+ * @param indexCount changed voxel index count
+ * @param[out] buffer destination delta buffer (use @ref calcMaxSize)
+ * @param capacity destination buffer size in bytes
+ * @param[out] size written delta size in bytes
+ */
+template<class C>
+static bool encode(const C& chunk, size_t* indices, size_t indexCount,
+	uint8_t* buffer, size_t capacity, size_t& size) noexcept
+{
+	assert(indices || indexCount == 0);
+	assert(buffer || capacity == 0);
+	std::sort(indices, indices + indexCount);
+	auto voxels = chunk.getVoxels();
+	size_t lastEnd = 0;
+	size = 0;
+
+	for (size_t i = 0; i < indexCount;)
+	{
+		auto start = indices[i], end = start + 1;
+		assert(start < C::size);
+		for (i++; i < indexCount; i++)
+		{
+			auto index = indices[i];
+			assert(index < C::size);
+			if (index >= end && (index - end) * sizeof(typename C::Voxel) > maxGapSize)
+				break;
+			if (index >= end)
+				end = index + 1;
+		}
+
+		if (!writeSpan(start - lastEnd, voxels + start, end - start, buffer, capacity, size))
+			return false;
+		lastEnd = end;
+	}
+	return true;
+}
+
+/**
+ * @brief Applies delta to the chunk.
+ * @return True on success, otherwise false if delta data is invalid.
+ * @note Chunk may be partially modified if delta data is invalid.
+ *
+ * @param[in] data source delta data
+ * @param size source delta data size in bytes
+ * @param[in,out] chunk target chunk to apply delta to
+ */
+template<class C>
+static bool apply(const uint8_t* data, size_t size, C& chunk) noexcept
+{
+	assert(data || size == 0);
+	auto voxels = chunk.getVoxels();
+	size_t offset = 0, index = 0;
+
+	while (offset < size)
+	{
+		uint64_t skip, length;
+		if (!readVarint(data, size, offset, skip) || !readVarint(data, size, offset, length) ||
+			length == 0 || skip > C::size - index || length > C::size - index - skip)
+		{
+			return false;
+		}
+
+		index += (size_t)skip;
+		auto dataSize = (size_t)length * sizeof(typename C::Voxel);
+		if (dataSize > size - offset)
+			return false;
+		memcpy(voxels + index, data + offset, dataSize);
+		index += (size_t)length;
+		offset += dataSize;
+	}
+	return true;
+}
+
+};
\ No newline at end of file
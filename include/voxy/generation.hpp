@@ -0,0 +1,323 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Procedural world generation pipeline.
+ *
+ * @details
+ * Pipeline stages (density, surface, decoration...) are run in the order they were added, each stage is run
+ * for all batch chunks on the batch executor before the next one. Noise callbacks are batched, they fill whole
+ * voxel rows along X-axis at once, so they can be vectorized. Resulting rows are written with the chunk part copy.
+ */
+
+#pragma once
+#include "voxy/world.hpp"
+#include "voxy/scheduler.hpp"
+
+namespace voxy
+{
+
+/**
+ * @brief Chunk voxel column view. (along Y-axis)
+ * @tparam C type of the chunk
+ */
+template<class C>
+struct ChunkColumn3
+{
+	/**
+	 * @brief Chunk voxel type.
+	 */
+	typedef typename C::Voxel Voxel;
+	/**
+	 * @brief Column voxel count.
+	 */
+	static constexpr uint8_t size = C::sizeY;
+
+	C* chunk = nullptr;  /**< Column chunk instance. */
+	int32_t worldX = 0;  /**< Column position in the world along X-axis. */
+	int32_t worldY = 0;  /**< Column bottom voxel position in the world along Y-axis. */
+	int32_t worldZ = 0;  /**< Column position in the world along Z-axis. */
+	uint8_t x = 0;       /**< Column position inside chunk along X-axis. */
+	uint8_t z = 0;       /**< Column position inside chunk along Z-axis. */
+
+	/**
+	 * @brief Returns column voxel.
+	 * @param y voxel position inside column
+	 */
+	Voxel get(uint8_t y) const noexcept
+	{
+		assert(y < size);
+		return chunk->get(x, y, z);
+	}
+	/**
+	 * @brief Sets column voxel.
+	 *
+	 * @param y voxel position inside column
+	 * @param voxel target voxel value
+	 */
+	void set(uint8_t y, Voxel voxel) noexcept
+	{
+		assert(y < size);
+		chunk->set(x, y, z, voxel);
+	}
+};
+
+/***********************************************************************************************************************
+ * @brief Procedural world generation pipeline.
+ *
+ * @details
+ * Density and height stages overwrite whole chunk with the noise result, use them first. Column and chunk stages
+ * access only their own chunk, so they are run without dependency. Cluster stages borrow the chunk cluster and
+ * are run with the neighbour dependency, they should write only the central chunk and read neighbours.
+ * (decorations crossing chunk border should be placed by each chunk for its own part, using the same seed)
+ *
+ * @tparam C type of the world chunk
+ */
+template<class C>
+class GenerationPipeline3
+{
+public:
+	/**
+	 * @brief World chunk type.
+	 */
+	typedef C Chunk;
+	/**
+	 * @brief Chunk voxel type.
+	 */
+	typedef typename C::Voxel Voxel;
+	/**
+	 * @brief Generated world type.
+	 */
+	typedef World3<C> World;
+	/**
+	 * @brief World chunk cluster type.
+	 */
+	typedef typename World::Cluster Cluster;
+	/**
+	 * @brief Chunk column view type.
+	 */
+	typedef ChunkColumn3<C> Column;
+
+	/**
+	 * @brief Batched 3D density noise: fills values for count voxels along X-axis, starting at world position.
+	 * @note Called from multiple threads at once!
+	 */
+	typedef std::function<void(int32_t x, int32_t y, int32_t z, uint8_t count, float* values)> DensityNoise;
+	/**
+	 * @brief Batched 2D height noise: fills column heights for count columns along X-axis, starting at world position.
+	 * @note Called from multiple threads at once!
+	 */
+	typedef std::function<void(int32_t x, int32_t z, uint8_t count, int32_t* heights)> HeightNoise;
+	/**
+	 * @brief Chunk column stage function.
+	 */
+	typedef std::function<void(Column& column)> ColumnStage;
+	/**
+	 * @brief Chunk stage function, receives chunk and its position.
+	 */
+	typedef std::function<void(C& chunk, int32_t x, int32_t y, int32_t z)> ChunkStage;
+	/**
+	 * @brief Cluster stage function, receives chunk cluster and central chunk position.
+	 * @note Not created neighbour chunks are null, use try get functions.
+	 */
+	typedef std::function<void(Cluster& cluster, int32_t x, int32_t y, int32_t z)> ClusterStage;
+protected:
+	struct Stage
+	{
+		std::function<void(World&, int32_t, int32_t, int32_t)> kernel;
+		BatchDependency dependency;
+	};
+
+	std::vector<Stage> stages;
+public:
+	/**
+	 * @brief Adds density stage, voxels with density greater than threshold are set, others are nulled.
+	 *
+	 * @param noise batched density noise
+	 * @param voxel solid voxel value
+	 * @param threshold density threshold
+	 */
+	void addDensityStage(DensityNoise noise, Voxel voxel, float threshold = 0.0f)
+	{
+		assert(noise);
+		stages.push_back({ [noise = std::move(noise), voxel, threshold](World& world, int32_t x, int32_t y, int32_t z)
+		{
+			auto chunk = world.getChunk(x, y, z);
+			auto originX = x * C::sizeX, originY = y * C::sizeY, originZ = z * C::sizeZ;
+			float values[C::sizeX]; Voxel row[C::sizeX];
+
+			for (uint8_t vz = 0; vz < C::sizeZ; vz++)
+			{
+				for (uint8_t vy = 0; vy < C::sizeY; vy++)
+				{
+					noise(originX, originY + vy, originZ + vz, C::sizeX, values);
+					for (uint8_t vx = 0; vx < C::sizeX; vx++)
+						row[vx] = values[vx] > threshold ? voxel : (Voxel)voxel::null;
+					chunk->copy(row, C::sizeX, 1, 1, 0, vy, vz);
+				}
+			}
+		}, BatchDependency::none });
+	}
+	/**
+	 * @brief Adds height stage, voxels below column height are set, others are nulled.
+	 *
+	 * @param noise batched height noise
+	 * @param voxel solid voxel value
+	 */
+	void addHeightStage(HeightNoise noise, Voxel voxel)
+	{
+		assert(noise);
+		stages.push_back({ [noise = std::move(noise), voxel](World& world, int32_t x, int32_t y, int32_t z)
+		{
+			auto chunk = world.getChunk(x, y, z);
+			auto originX = x * C::sizeX, originY = y * C::sizeY, originZ = z * C::sizeZ;
+			int32_t heights[C::sizeX]; Voxel row[C::sizeX];
+
+			for (uint8_t vz = 0; vz < C::sizeZ; vz++)
+			{
+				noise(originX, originZ + vz, C::sizeX, heights);
+				for (uint8_t vx = 0; vx < C::sizeX; vx++)
+					heights[vx] -= originY;
+
+				for (uint8_t vy = 0; vy < C::sizeY; vy++)
+				{
+					for (uint8_t vx = 0; vx < C::sizeX; vx++)
+						row[vx] = vy < heights[vx] ? voxel : (Voxel)voxel::null;
+					chunk->copy(row, C::sizeX, 1, 1, 0, vy, vz);
+				}
+			}
+		}, BatchDependency::none });
+	}
+	/**
+	 * @brief Adds column stage, function is called for each chunk column.
+	 * @param function target column function
+	 */
+	void addColumnStage(ColumnStage function)
+	{
+		assert(function);
+		stages.push_back({ [function = std::move(function)](World& world, int32_t x, int32_t y, int32_t z)
+		{
+			Column column;
+			column.chunk = world.getChunk(x, y, z);
+			column.worldY = y * C::sizeY;
+
+			for (uint8_t vz = 0; vz < C::sizeZ; vz++)
+			{
+				for (uint8_t vx = 0; vx < C::sizeX; vx++)
+				{
+					column.worldX = x * C::sizeX + vx;
+					column.worldZ = z * C::sizeZ + vz;
+					column.x = vx; column.z = vz;
+					function(column);
+				}
+			}
+		}, BatchDependency::none });
+	}
+	/**
+	 * @brief Adds chunk stage, function is called for each chunk.
+	 * @param function target chunk function
+	 */
+	void addChunkStage(ChunkStage function)
+	{
+		assert(function);
+		stages.push_back({ [function = std::move(function)](World& world, int32_t x, int32_t y, int32_t z)
+		{
+			function(*world.getChunk(x, y, z), x, y, z);
+		}, BatchDependency::none });
+	}
+	/**
+	 * @brief Adds cluster stage, function is called for each chunk with its neighbours.
+	 * @param function target cluster function
+	 */
+	void addClusterStage(ClusterStage function)
+	{
+		assert(function);
+		stages.push_back({ [function = std::move(function)](World& world, int32_t x, int32_t y, int32_t z)
+		{
+			auto cluster = world.getCluster(x, y, z);
+			function(cluster, x, y, z);
+		}, BatchDependency::neighbours });
+	}
+
+	/**
+	 * @brief Returns pipeline stage count.
+	 */
+	size_t getStageCount() const noexcept { return stages.size(); }
+	/**
+	 * @brief Removes all pipeline stages.
+	 */
+	void clear() noexcept { stages.clear(); }
+
+	/*******************************************************************************************************************
+	 * @brief Generates world chunks on the batch executor.
+	 * @details Not created chunks are created and filled with null voxels before the first stage.
+	 * @return True if all stages were run, otherwise false if cancelled.
+	 *
+	 * @note Other world chunks can be read by cluster stages, don't modify world while it is running.
+	 *
+	 * @param[in,out] executor target batch executor
+	 * @param[in,out] world target world
+	 * @param[in,out] chunks chunks to generate (sorted in the processing order)
+	 * @param chunkCount chunk array size
+	 * @param[in] isCancelled optional cancellation flag
+	 */
+	bool generate(BatchExecutor& executor, World& world, BatchChunk* chunks,
+		size_t chunkCount, const std::atomic<bool>* isCancelled = nullptr)
+	{
+		assert(chunks || chunkCount == 0);
+		for (size_t i = 0; i < chunkCount; i++)
+		{
+			auto& batchChunk = chunks[i];
+			if (world.getChunk(batchChunk.x, batchChunk.y, batchChunk.z))
+				continue;
+			world.createChunk(batchChunk.x, batchChunk.y, batchChunk.z)->fill(voxel::null);
+		}
+
+		for (auto& stage : stages)
+		{
+			auto processed = executor.run(chunks, chunkCount, [&](int32_t x, int32_t y, int32_t z)
+			{
+				stage.kernel(world, x, y, z);
+			}, stage.dependency, isCancelled);
+			if (processed < chunkCount)
+				return false;
+		}
+		return true;
+	}
+	/**
+	 * @brief Generates one world chunk on the calling thread.
+	 * @details Not created chunk is created and filled with null voxels before the first stage.
+	 *
+	 * @param[in,out] world target world
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 */
+	C* generate(World& world, int32_t x, int32_t y, int32_t z)
+	{
+		auto chunk = world.getChunk(x, y, z);
+		if (!chunk)
+		{
+			chunk = world.createChunk(x, y, z);
+			chunk->fill(voxel::null);
+		}
+
+		for (auto& stage : stages)
+			stage.kernel(world, x, y, z);
+		return chunk;
+	}
+};
+
+};
\ No newline at end of file
@@ -0,0 +1,250 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Chunk voxel array layout (index order) policies.
+ *
+ * @details
+ * Layout converts 3D voxel position into the chunk voxel array index. Linear layout stores whole X-axis
+ * rows one after another, Morton (Z-order) and brick layouts keep nearby voxels close in memory along
+ * all axes, which reduces cache misses of the 3D neighbourhood walks.
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+#if !defined(VOXY_NO_SIMD) && (defined(__BMI2__) || (defined(_MSC_VER) && defined(__AVX2__)))
+#define VOXY_BMI2
+#include <immintrin.h>
+#endif
+
+namespace voxy::layout
+{
+
+/**
+ * @brief Linear chunk layout. (z * sizeXY + y * sizeX + x)
+ */
+struct Linear
+{
+	/**
+	 * @brief Layout identifier. (stored in serialized data)
+	 */
+	static constexpr uint8_t id = 0;
+	/**
+	 * @brief Are voxel rows along X-axis continuous in memory.
+	 */
+	static constexpr bool isLinear = true;
+	/**
+	 * @brief Is layout supported for specified chunk size.
+	 */
+	template<uint8_t SX, uint8_t SY, uint8_t SZ>
+	static constexpr bool isSupported = true;
+
+	/**
+	 * @brief Calculates chunk voxel index from the position.
+	 *
+	 * @tparam SX chunk size in voxels along X-axis
+	 * @tparam SY chunk size in voxels along Y-axis
+	 * @tparam SZ chunk size in voxels along Z-axis
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 */
+	template<uint8_t SX, uint8_t SY, uint8_t SZ>
+	static constexpr size_t posToIndex(uint8_t x, uint8_t y, uint8_t z) noexcept
+	{
+		return ((size_t)z * SY + y) * SX + x;
+	}
+	/**
+	 * @brief Calculates voxel position from the chunk voxel index.
+	 *
+	 * @tparam SX chunk size in voxels along X-axis
+	 * @tparam SY chunk size in voxels along Y-axis
+	 * @tparam SZ chunk size in voxels along Z-axis
+	 * @param index target voxel index inside array
+	 * @param[out] x voxel position along X-axis
+	 * @param[out] y voxel position along Y-axis
+	 * @param[out] z voxel position along Z-axis
+	 */
+	template<uint8_t SX, uint8_t SY, uint8_t SZ>
+	static constexpr void indexToPos(size_t index, uint8_t& x, uint8_t& y, uint8_t& z) noexcept
+	{
+		x = (uint8_t)(index % SX);
+		y = (uint8_t)(index / SX % SY);
+		z = (uint8_t)(index / ((size_t)SX * SY));
+	}
+};
+
+/***********************************************************************************************************************
+ * @brief Morton (Z-order curve) chunk layout.
+ * @details Index bits are interleaved position bits: ...z1y1x1z0y0x0.
+ * @note Chunk should be a cube with power of two size.
+ */
+struct Morton
+{
+	/**
+	 * @brief Layout identifier. (stored in serialized data)
+	 */
+	static constexpr uint8_t id = 1;
+	/**
+	 * @brief Are voxel rows along X-axis continuous in memory.
+	 */
+	static constexpr bool isLinear = false;
+	/**
+	 * @brief Is layout supported for specified chunk size.
+	 */
+	template<uint8_t SX, uint8_t SY, uint8_t SZ>
+	static constexpr bool isSupported = SX == SY && SY == SZ && SX > 0 && (SX & (SX - 1)) == 0;
+
+	/**
+	 * @brief Inserts two zero bits between each of the 8 value bits.
+	 * @param value target position value
+	 */
+	static constexpr uint32_t spreadBits(uint8_t value) noexcept
+	{
+		uint32_t result = value;
+		result = (result | (result << 8)) & 0x0000F00Fu;
+		result = (result | (result << 4)) & 0x000C30C3u;
+		result = (result | (result << 2)) & 0x00249249u;
+		return result;
+	}
+	/**
+	 * @brief Removes two bits between each of the 8 value bits. (inverse of the @ref spreadBits)
+	 * @param value target spread bits value
+	 */
+	static constexpr uint8_t compactBits(uint32_t value) noexcept
+	{
+		value &= 0x00249249u;
+		value = (value | (value >> 2)) & 0x000C30C3u;
+		value = (value | (value >> 4)) & 0x0000F00Fu;
+		value = (value | (value >> 8)) & 0x000000FFu;
+		return (uint8_t)value;
+	}
+
+	/**
+	 * @brief Calculates chunk voxel index from the position.
+	 * @details Uses BMI2 parallel bit deposit instruction if available.
+	 *
+	 * @tparam SX chunk size in voxels along X-axis
+	 * @tparam SY chunk size in voxels along Y-axis
+	 * @tparam SZ chunk size in voxels along Z-axis
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 */
+	template<uint8_t SX, uint8_t SY, uint8_t SZ>
+	static constexpr size_t posToIndex(uint8_t x, uint8_t y, uint8_t z) noexcept
+	{
+		#if defined(VOXY_BMI2)
+		if (!__builtin_is_constant_evaluated())
+			return _pdep_u32(x, 0x00249249u) | _pdep_u32(y, 0x00492492u) | _pdep_u32(z, 0x00924924u);
+		#endif
+		return spreadBits(x) | (spreadBits(y) << 1) | (spreadBits(z) << 2);
+	}
+	/**
+	 * @brief Calculates voxel position from the chunk voxel index.
+	 * @details Uses BMI2 parallel bit extract instruction if available.
+	 *
+	 * @tparam SX chunk size in voxels along X-axis
+	 * @tparam SY chunk size in voxels along Y-axis
+	 * @tparam SZ chunk size in voxels along Z-axis
+	 * @param index target voxel index inside array
+	 * @param[out] x voxel position along X-axis
+	 * @param[out] y voxel position along Y-axis
+	 * @param[out] z voxel position along Z-axis
+	 */
+	template<uint8_t SX, uint8_t SY, uint8_t SZ>
+	static constexpr void indexToPos(size_t index, uint8_t& x, uint8_t& y, uint8_t& z) noexcept
+	{
+		#if defined(VOXY_BMI2)
+		if (!__builtin_is_constant_evaluated())
+		{
+			x = (uint8_t)_pext_u32((uint32_t)index, 0x00249249u);
+			y = (uint8_t)_pext_u32((uint32_t)index, 0x00492492u);
+			z = (uint8_t)_pext_u32((uint32_t)index, 0x00924924u);
+			return;
+		}
+		#endif
+		x = compactBits((uint32_t)index);
+		y = compactBits((uint32_t)index >> 1);
+		z = compactBits((uint32_t)index >> 2);
+	}
+};
+
+/***********************************************************************************************************************
+ * @brief Bricked chunk layout. (linear array of 4x4x4 voxel bricks)
+ * @details Each brick is 64 continuous voxels, bricks and voxels inside brick are stored in linear order.
+ * @note Chunk size should be a multiple of 4 along each axis.
+ */
+struct Brick
+{
+	/**
+	 * @brief Layout identifier. (stored in serialized data)
+	 */
+	static constexpr uint8_t id = 2;
+	/**
+	 * @brief Are voxel rows along X-axis continuous in memory.
+	 */
+	static constexpr bool isLinear = false;
+	/**
+	 * @brief Brick size in voxels along each axis.
+	 */
+	static constexpr uint8_t brickSize = 4;
+	/**
+	 * @brief Is layout supported for specified chunk size.
+	 */
+	template<uint8_t SX, uint8_t SY, uint8_t SZ>
+	static constexpr bool isSupported = SX % brickSize == 0 && SY % brickSize == 0 && SZ % brickSize == 0;
+
+	/**
+	 * @brief Calculates chunk voxel index from the position.
+	 *
+	 * @tparam SX chunk size in voxels along X-axis
+	 * @tparam SY chunk size in voxels along Y-axis
+	 * @tparam SZ chunk size in voxels along Z-axis
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 */
+	template<uint8_t SX, uint8_t SY, uint8_t SZ>
+	static constexpr size_t posToIndex(uint8_t x, uint8_t y, uint8_t z) noexcept
+	{
+		auto brickIndex = ((size_t)(z >> 2) * (SY / brickSize) + (y >> 2)) * (SX / brickSize) + (x >> 2);
+		return brickIndex * 64 + (size_t)((z & 3) << 4 | (y & 3) << 2 | (x & 3));
+	}
+	/**
+	 * @brief Calculates voxel position from the chunk voxel index.
+	 *
+	 * @tparam SX chunk size in voxels along X-axis
+	 * @tparam SY chunk size in voxels along Y-axis
+	 * @tparam SZ chunk size in voxels along Z-axis
+	 * @param index target voxel index inside array
+	 * @param[out] x voxel position along X-axis
+	 * @param[out] y voxel position along Y-axis
+	 * @param[out] z voxel position along Z-axis
+	 */
+	template<uint8_t SX, uint8_t SY, uint8_t SZ>
+	static constexpr void indexToPos(size_t index, uint8_t& x, uint8_t& y, uint8_t& z) noexcept
+	{
+		constexpr size_t bricksX = SX / brickSize, bricksY = SY / brickSize;
+		auto brickIndex = index >> 6;
+		x = (uint8_t)((brickIndex % bricksX) * brickSize + (index & 3));
+		y = (uint8_t)((brickIndex / bricksX % bricksY) * brickSize + (index >> 2 & 3));
+		z = (uint8_t)((brickIndex / (bricksX * bricksY)) * brickSize + (index >> 4 & 3));
+	}
+};
+
+};
\ No newline at end of file
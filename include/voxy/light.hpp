@@ -0,0 +1,540 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Voxel light propagation functions.
+ *
+ * @details
+ * Light levels are stored in the separate nibble packed chunks, one chunk per light channel (sun, block).
+ * Light engine updates levels incrementally with the breadth-first flood fill, removal pass clears levels
+ * depending on the removed light, and addition pass spreads light back, crossing cluster chunk borders.
+ */
+
+#pragma once
+#include "voxy/cluster.hpp"
+
+#include <vector>
+
+namespace voxy
+{
+
+/**
+ * @brief Maximal voxel light level.
+ */
+constexpr uint8_t maxLightLevel = 15;
+
+/**
+ * @brief Voxel light channel type.
+ */
+enum class LightChannel : uint8_t
+{
+	block, /**< Light emitted by voxels, decreases by one with each step. */
+	sun,   /**< Sky light, maximal level spreads downwards without decreasing. */
+};
+
+/***********************************************************************************************************************
+ * @brief Voxel light level 3D container. (nibble array)
+ * @details Two 4-bit light levels are packed into each byte, even voxel index is stored in the low bits.
+ *
+ * @tparam SX chunk size in voxels along X-axis
+ * @tparam SY chunk size in voxels along Y-axis
+ * @tparam SZ chunk size in voxels along Z-axis
+ * @tparam L chunk voxel array layout
+ */
+template<uint8_t SX, uint8_t SY, uint8_t SZ, class L = layout::Linear>
+struct LightChunk3
+{
+public:
+	/**
+	 * @brief Chunk size in voxels along X-axis.
+	 */
+	static constexpr uint8_t sizeX = SX;
+	/**
+	 * @brief Chunk size in voxels along Y-axis.
+	 */
+	static constexpr uint8_t sizeY = SY;
+	/**
+	 * @brief Chunk size in voxels along Z-axis.
+	 */
+	static constexpr uint8_t sizeZ = SZ;
+	/**
+	 * @brief Chunk array size in voxels, or chunk volume. (sizeX * sizeY * sizeZ)
+	 */
+	static constexpr size_t size = SX * SY * SZ;
+	/**
+	 * @brief Chunk light data size in bytes.
+	 */
+	static constexpr size_t dataSize = (size + 1) / 2;
+	/**
+	 * @brief Chunk light level type.
+	 */
+	typedef uint8_t Voxel;
+	/**
+	 * @brief Chunk voxel array layout.
+	 */
+	typedef L Layout;
+
+	static_assert(L::template isSupported<SX, SY, SZ>, "Chunk size is not supported by the layout");
+protected:
+	uint8_t data[dataSize];
+public:
+	/**
+	 * @brief Creates a new uninitialized light chunk.
+	 * @note Chunk may contain garbage light levels.
+	 */
+	LightChunk3() = default;
+	/**
+	 * @brief Creates a new initialized light chunk.
+	 * @param level target light level to fill chunk with
+	 */
+	LightChunk3(uint8_t level) { fill(level); }
+
+	/**
+	 * @brief Returns chunk packed light data.
+	 */
+	uint8_t* getData() noexcept { return data; }
+	/**
+	 * @brief Returns constant chunk packed light data.
+	 */
+	const uint8_t* getData() const noexcept { return data; }
+
+	/**
+	 * @brief Calculates chunk voxel index from the position.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 */
+	static constexpr size_t posToIndex(uint8_t x, uint8_t y, uint8_t z) noexcept
+	{
+		return L::template posToIndex<SX, SY, SZ>(x, y, z);
+	}
+
+	/**
+	 * @brief Returns chunk light level at specified array index.
+	 * @param index target voxel index inside array
+	 */
+	uint8_t get(size_t index) const noexcept
+	{
+		assert(index < size);
+		return data[index >> 1] >> ((index & 1) << 2) & 15;
+	}
+	/**
+	 * @brief Sets chunk light level at specified array index.
+	 *
+	 * @param index target voxel index inside array
+	 * @param level target light level [0, 15]
+	 */
+	void set(size_t index, uint8_t level) noexcept
+	{
+		assert(index < size);
+		assert(level <= maxLightLevel);
+		auto shift = (index & 1) << 2;
+		auto& pair = data[index >> 1];
+		pair = (uint8_t)((pair & ~(15 << shift)) | level << shift);
+	}
+	/**
+	 * @brief Returns chunk light level at specified 3D position.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 */
+	uint8_t get(uint8_t x, uint8_t y, uint8_t z) const noexcept
+	{
+		assert(x < SX);
+		assert(y < SY);
+		assert(z < SZ);
+		return get(posToIndex(x, y, z));
+	}
+	/**
+	 * @brief Sets chunk light level at specified 3D position.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param level target light level [0, 15]
+	 */
+	void set(uint8_t x, uint8_t y, uint8_t z, uint8_t level) noexcept
+	{
+		assert(x < SX);
+		assert(y < SY);
+		assert(z < SZ);
+		set(posToIndex(x, y, z), level);
+	}
+
+	/**
+	 * @brief Fills chunk with specified light level.
+	 * @param level target light level [0, 15]
+	 */
+	void fill(uint8_t level) noexcept
+	{
+		assert(level <= maxLightLevel);
+		memset(data, level | level << 4, dataSize);
+	}
+};
+
+/**
+ * @brief Default voxel light properties, null voxels are transparent, others are opaque.
+ */
+struct DefaultLightProperties
+{
+	/**
+	 * @brief Returns additional light level decrease through the voxel, 15 or more for opaque voxels.
+	 * @param voxel target voxel ID
+	 */
+	template<typename V>
+	constexpr uint8_t getOpacity(V voxel) const noexcept { return voxel == voxel::null ? 0 : maxLightLevel; }
+	/**
+	 * @brief Returns block light level emitted by the voxel.
+	 * @param voxel target voxel ID
+	 */
+	template<typename V>
+	constexpr uint8_t getEmission(V voxel) const noexcept { (void)voxel; return 0; }
+};
+
+/***********************************************************************************************************************
+ * @brief Incremental voxel light propagation engine.
+ *
+ * @details
+ * Light changes are queued with @ref addLight, @ref removeLight and @ref updateVoxel, then processed at once
+ * by the @ref update over the voxel and light chunk clusters. Cluster positions are relative to the central
+ * chunk, light is not spread into missing chunks and outside the cluster (edge and corner chunks).
+ * Queue memory is kept between updates, so updates do not allocate after the warm-up.
+ *
+ * @note Use separate engine instance for each thread.
+ *
+ * @tparam C cluster voxel chunk type
+ * @tparam LC cluster light chunk type (@ref LightChunk3)
+ */
+template<class C, class LC = LightChunk3<C::sizeX, C::sizeY, C::sizeZ>>
+class LightEngine3
+{
+public:
+	/**
+	 * @brief Voxel chunk type.
+	 */
+	typedef C Chunk;
+	/**
+	 * @brief Light chunk type.
+	 */
+	typedef LC LightChunk;
+	/**
+	 * @brief Chunk voxel ID type.
+	 */
+	typedef typename C::Voxel Voxel;
+	/**
+	 * @brief Voxel chunk cluster type.
+	 */
+	typedef Cluster3<C, Voxel> Cluster;
+	/**
+	 * @brief Light chunk cluster type.
+	 */
+	typedef Cluster3<LC, uint8_t> LightCluster;
+
+	static_assert(C::sizeX == LC::sizeX && C::sizeY == LC::sizeY && C::sizeZ == LC::sizeZ,
+		"Voxel and light chunk sizes should be the same");
+protected:
+	struct Node
+	{
+		int16_t x, y, z;
+		uint8_t level;
+	};
+
+	static constexpr int8_t offsets[6][3] =
+	{
+		{ -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 },
+	};
+	static constexpr uint8_t downDirection = 2;
+
+	std::vector<Node> addQueue;
+	std::vector<Node> removeQueue;
+	std::vector<Node> voxelQueue;
+	const C* voxelChunks[Cluster::chunkSize] = {};
+	LC* lightChunks[Cluster::chunkSize] = {};
+	uint8_t changedMask = 0;
+
+	static int8_t toChunkPos(int16_t& x, int16_t& y, int16_t& z) noexcept
+	{
+		int8_t index = 0;
+		if (x < 0) { x += C::sizeX; index = 1; }
+		else if (x >= C::sizeX) { x -= C::sizeX; index = 2; }
+
+		if (y < 0)
+		{
+			if (index) return -1;
+			y += C::sizeY; index = 3;
+		}
+		else if (y >= C::sizeY)
+		{
+			if (index) return -1;
+			y -= C::sizeY; index = 4;
+		}
+
+		if (z < 0)
+		{
+			if (index) return -1;
+			z += C::sizeZ; index = 5;
+		}
+		else if (z >= C::sizeZ)
+		{
+			if (index) return -1;
+			z -= C::sizeZ; index = 6;
+		}
+
+		if ((uint16_t)x >= C::sizeX || (uint16_t)y >= C::sizeY || (uint16_t)z >= C::sizeZ)
+			return -1;
+		return index;
+	}
+	int8_t findChunk(int16_t& x, int16_t& y, int16_t& z) const noexcept
+	{
+		auto index = toChunkPos(x, y, z);
+		if (index < 0 || !voxelChunks[index] || !lightChunks[index])
+			return -1;
+		return index;
+	}
+	void setLight(int8_t index, int16_t x, int16_t y, int16_t z, uint8_t level) noexcept
+	{
+		lightChunks[index]->set((uint8_t)x, (uint8_t)y, (uint8_t)z, level);
+		changedMask |= 1 << index;
+	}
+
+	template<typename F>
+	void seedRemoval(bool isSunlight, const F& properties)
+	{
+		for (auto& node : removeQueue)
+		{
+			auto x = node.x, y = node.y, z = node.z;
+			auto index = findChunk(x, y, z);
+			node.level = 0;
+			if (index < 0)
+				continue;
+			node.level = lightChunks[index]->get((uint8_t)x, (uint8_t)y, (uint8_t)z);
+			if (node.level > 0)
+				setLight(index, x, y, z, 0);
+		}
+
+		for (const auto& node : voxelQueue)
+		{
+			auto x = node.x, y = node.y, z = node.z;
+			auto index = findChunk(x, y, z);
+			if (index < 0)
+				continue;
+
+			auto level = lightChunks[index]->get((uint8_t)x, (uint8_t)y, (uint8_t)z);
+			if (level > 0)
+			{
+				setLight(index, x, y, z, 0);
+				removeQueue.push_back({ node.x, node.y, node.z, level });
+			}
+			if (!isSunlight)
+			{
+				auto emission = properties.getEmission(voxelChunks[index]->get((uint8_t)x, (uint8_t)y, (uint8_t)z));
+				if (emission > 0)
+					addQueue.push_back({ node.x, node.y, node.z, emission });
+			}
+			for (const auto& offset : offsets)
+			{
+				addQueue.push_back({ (int16_t)(node.x + offset[0]),
+					(int16_t)(node.y + offset[1]), (int16_t)(node.z + offset[2]), 0 });
+			}
+		}
+		voxelQueue.clear();
+	}
+	template<typename F>
+	void propagateRemoval(bool isSunlight, const F& properties)
+	{
+		for (size_t i = 0; i < removeQueue.size(); i++)
+		{
+			auto node = removeQueue[i];
+			for (uint8_t d = 0; d < 6; d++)
+			{
+				auto x = (int16_t)(node.x + offsets[d][0]);
+				auto y = (int16_t)(node.y + offsets[d][1]);
+				auto z = (int16_t)(node.z + offsets[d][2]);
+				auto nodeX = x, nodeY = y, nodeZ = z;
+				auto index = findChunk(x, y, z);
+				if (index < 0)
+					continue;
+
+				auto level = lightChunks[index]->get((uint8_t)x, (uint8_t)y, (uint8_t)z);
+				if (level == 0)
+					continue;
+
+				if (level < node.level || (isSunlight && d == downDirection && node.level == maxLightLevel))
+				{
+					setLight(index, x, y, z, 0);
+					removeQueue.push_back({ nodeX, nodeY, nodeZ, level });
+					if (isSunlight)
+						continue;
+
+					auto emission = properties.getEmission(voxelChunks[index]->get((uint8_t)x, (uint8_t)y, (uint8_t)z));
+					if (emission > 0)
+						addQueue.push_back({ nodeX, nodeY, nodeZ, emission });
+				}
+				else
+				{
+					addQueue.push_back({ nodeX, nodeY, nodeZ, 0 });
+				}
+			}
+		}
+		removeQueue.clear();
+	}
+	template<typename F>
+	void propagateAddition(bool isSunlight, const F& properties)
+	{
+		for (size_t i = 0; i < addQueue.size(); i++)
+		{
+			auto node = addQueue[i];
+			auto x = node.x, y = node.y, z = node.z;
+			auto index = findChunk(x, y, z);
+			if (index < 0)
+				continue;
+
+			auto level = lightChunks[index]->get((uint8_t)x, (uint8_t)y, (uint8_t)z);
+			if (node.level > level)
+			{
+				setLight(index, x, y, z, node.level);
+				level = node.level;
+			}
+			if (level <= 1)
+				continue;
+
+			for (uint8_t d = 0; d < 6; d++)
+			{
+				x = (int16_t)(node.x + offsets[d][0]);
+				y = (int16_t)(node.y + offsets[d][1]);
+				z = (int16_t)(node.z + offsets[d][2]);
+				auto nodeX = x, nodeY = y, nodeZ = z;
+				index = findChunk(x, y, z);
+				if (index < 0)
+					continue;
+
+				auto opacity = properties.getOpacity(voxelChunks[index]->get((uint8_t)x, (uint8_t)y, (uint8_t)z));
+				if (opacity >= maxLightLevel || level <= opacity + 1)
+					continue;
+
+				auto newLevel = isSunlight && d == downDirection && level == maxLightLevel && opacity == 0 ?
+					maxLightLevel : (uint8_t)(level - opacity - 1);
+				if (lightChunks[index]->get((uint8_t)x, (uint8_t)y, (uint8_t)z) >= newLevel)
+					continue;
+
+				setLight(index, x, y, z, newLevel);
+				addQueue.push_back({ nodeX, nodeY, nodeZ, 0 });
+			}
+		}
+		addQueue.clear();
+	}
+public:
+	/**
+	 * @brief Creates a new light engine.
+	 */
+	LightEngine3() = default;
+
+	/**
+	 * @brief Returns true if there are queued light changes.
+	 */
+	bool hasPending() const noexcept
+	{
+		return !addQueue.empty() || !removeQueue.empty() || !voxelQueue.empty();
+	}
+	/**
+	 * @brief Preallocates light queue memory for the specified node count.
+	 * @param nodeCount target queue node count
+	 */
+	void reserve(size_t nodeCount)
+	{
+		addQueue.reserve(nodeCount);
+		removeQueue.reserve(nodeCount);
+	}
+	/**
+	 * @brief Removes all queued light changes.
+	 */
+	void clear() noexcept
+	{
+		addQueue.clear();
+		removeQueue.clear();
+		voxelQueue.clear();
+	}
+
+	/**
+	 * @brief Queues light source addition at specified cluster position.
+	 * @details Light level is set only if it is higher than the current one.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param level target light level [1, 15]
+	 */
+	void addLight(int16_t x, int16_t y, int16_t z, uint8_t level)
+	{
+		assert(level > 0 && level <= maxLightLevel);
+		addQueue.push_back({ x, y, z, level });
+	}
+	/**
+	 * @brief Queues light removal at specified cluster position.
+	 * @details Removes the light level and all levels spread from it.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 */
+	void removeLight(int16_t x, int16_t y, int16_t z)
+	{
+		removeQueue.push_back({ x, y, z, 0 });
+	}
+	/**
+	 * @brief Queues light update after the voxel change at specified cluster position.
+	 * @details Removes voxel light, then spreads neighbour and emitted voxel light again.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 */
+	void updateVoxel(int16_t x, int16_t y, int16_t z)
+	{
+		voxelQueue.push_back({ x, y, z, 0 });
+	}
+
+	/**
+	 * @brief Processes all queued light changes.
+	 * @details Properties should have functions: uint8_t getOpacity(Voxel) and uint8_t getEmission(Voxel).
+	 * @return Changed light chunk mask, bit index is the cluster chunk index (c, nx, px, ny, py, nz, pz).
+	 *
+	 * @param[in] voxels voxel chunk cluster
+	 * @param[in,out] lights light chunk cluster of the channel
+	 * @param channel light channel type
+	 * @param properties voxel light properties
+	 */
+	template<typename F = DefaultLightProperties>
+	uint8_t update(const Cluster& voxels, LightCluster& lights,
+		LightChannel channel = LightChannel::block, const F& properties = F())
+	{
+		VOXY_STATS_TIME(light);
+		voxelChunks[0] = voxels.c; voxelChunks[1] = voxels.nx; voxelChunks[2] = voxels.px;
+		voxelChunks[3] = voxels.ny; voxelChunks[4] = voxels.py; voxelChunks[5] = voxels.nz; voxelChunks[6] = voxels.pz;
+		lightChunks[0] = lights.c; lightChunks[1] = lights.nx; lightChunks[2] = lights.px;
+		lightChunks[3] = lights.ny; lightChunks[4] = lights.py; lightChunks[5] = lights.nz; lightChunks[6] = lights.pz;
+		changedMask = 0;
+
+		auto isSunlight = channel == LightChannel::sun;
+		seedRemoval(isSunlight, properties);
+		propagateRemoval(isSunlight, properties);
+		propagateAddition(isSunlight, properties);
+		return changedMask;
+	}
+};
+
+};
\ No newline at end of file
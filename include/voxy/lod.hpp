@@ -0,0 +1,275 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Chunk level of detail (LOD) downsampling functions.
+ *
+ * @details
+ * Each FxFxF voxel block of the source chunk is reduced to one voxel of the destination chunk. Block voxels are
+ * passed to the reducer in the array order (Z, Y, X). Source rows of the uniform block rows (the same voxel
+ * across F layers and F rows) are detected with the vectorized count and written with one fill.
+ */
+
+#pragma once
+#include "voxy/world.hpp"
+#include "voxy/scheduler.hpp"
+
+#include <algorithm>
+
+namespace voxy::lod
+{
+
+/**
+ * @brief Most frequent voxel reducer.
+ * @details Ties are resolved to the higher voxel ID, so not null voxels win over null ones.
+ *          Small blocks (2x) are counted pairwise, bigger ones are sorted.
+ */
+struct Majority
+{
+	/**
+	 * @brief Reduces block voxels to one voxel.
+	 *
+	 * @param[in] voxels block voxel array
+	 * @param count block voxel count
+	 */
+	template<typename V>
+	V operator()(const V* voxels, uint32_t count) const noexcept
+	{
+		assert(count > 0 && count <= 512);
+		if (count <= 8)
+		{
+			auto result = voxels[0];
+			uint32_t bestLength = 0;
+			for (uint32_t i = 0; i < count; i++)
+			{
+				uint32_t length = 0;
+				for (uint32_t j = 0; j < count; j++)
+					length += voxels[j] == voxels[i];
+				if (length * 2 > count)
+					return voxels[i];
+				if (length > bestLength || (length == bestLength && voxels[i] > result))
+				{
+					result = voxels[i];
+					bestLength = length;
+				}
+			}
+			return result;
+		}
+
+		V sorted[512];
+		std::copy(voxels, voxels + count, sorted);
+		std::sort(sorted, sorted + count);
+
+		auto result = sorted[0];
+		uint32_t bestLength = 0;
+		for (uint32_t i = 0; i < count;)
+		{
+			auto j = i + 1;
+			while (j < count && sorted[j] == sorted[i])
+				j++;
+			if (j - i >= bestLength)
+			{
+				result = sorted[i];
+				bestLength = j - i;
+			}
+			i = j;
+		}
+		return result;
+	}
+};
+/**
+ * @brief First not null voxel reducer. (in the block array order)
+ */
+struct FirstNotNull
+{
+	/**
+	 * @brief Reduces block voxels to one voxel.
+	 *
+	 * @param[in] voxels block voxel array
+	 * @param count block voxel count
+	 */
+	template<typename V>
+	V operator()(const V* voxels, uint32_t count) const noexcept
+	{
+		for (uint32_t i = 0; i < count; i++)
+		{
+			if (voxels[i] != voxel::null)
+				return voxels[i];
+		}
+		return voxel::null;
+	}
+};
+
+/**
+ * @brief Reduced chunk type for specified downsampling factor.
+ *
+ * @tparam C source chunk type
+ * @tparam F downsampling factor (2, 4 or 8)
+ */
+template<class C, uint8_t F>
+using ReducedChunk3 = Chunk3<C::sizeX / F, C::sizeY / F, C::sizeZ / F, typename C::Voxel>;
+
+/***********************************************************************************************************************
+ * @brief Downsamples source chunk voxels into the destination chunk part.
+ * @details Reducer signature: Voxel(const Voxel* voxels, uint32_t count)
+ * @note Reducer should return the voxel itself for the uniform block.
+ *
+ * @tparam F downsampling factor (2, 4 or 8)
+ * @param[in] source source chunk (@ref Chunk3)
+ * @param[out] destination destination chunk
+ * @param offsetX destination part offset along X-axis
+ * @param offsetY destination part offset along Y-axis
+ * @param offsetZ destination part offset along Z-axis
+ * @param reducer block voxel reducer
+ */
+template<uint8_t F, class R = Majority, class S, class D>
+static void downsample(const S& source, D& destination, uint8_t offsetX = 0,
+	uint8_t offsetY = 0, uint8_t offsetZ = 0, const R& reducer = R()) noexcept
+{
+	static_assert(F == 2 || F == 4 || F == 8, "Downsampling factor should be 2, 4 or 8");
+	static_assert(S::sizeX % F == 0 && S::sizeY % F == 0 && S::sizeZ % F == 0,
+		"Chunk size should be a multiple of the downsampling factor");
+	typedef typename S::Voxel Voxel;
+	constexpr uint8_t sizeX = S::sizeX / F, sizeY = S::sizeY / F, sizeZ = S::sizeZ / F;
+	assert(offsetX + sizeX <= D::sizeX);
+	assert(offsetY + sizeY <= D::sizeY);
+	assert(offsetZ + sizeZ <= D::sizeZ);
+
+	auto voxels = source.getVoxels();
+	Voxel block[F * F * F];
+	for (uint8_t z = 0; z < sizeZ; z++)
+	{
+		for (uint8_t y = 0; y < sizeY; y++)
+		{
+			if constexpr (S::Layout::isLinear)
+			{
+				auto value = voxels[S::posToIndex(0, y * F, z * F)];
+				auto isUniform = true;
+				for (uint8_t i = 0; i < F * F && isUniform; i++)
+				{
+					auto row = voxels + S::posToIndex(0, y * F + i % F, z * F + i / F);
+					isUniform = simd::count(row, value, S::sizeX) == S::sizeX;
+				}
+
+				if (isUniform)
+				{
+					destination.fill(value, sizeX, 1, 1, offsetX, offsetY + y, offsetZ + z);
+					continue;
+				}
+			}
+
+			for (uint8_t x = 0; x < sizeX; x++)
+			{
+				uint32_t count = 0;
+				for (uint8_t bz = 0; bz < F; bz++)
+				{
+					for (uint8_t by = 0; by < F; by++)
+					{
+						if constexpr (S::Layout::isLinear)
+						{
+							auto row = voxels + S::posToIndex(x * F, y * F + by, z * F + bz);
+							for (uint8_t bx = 0; bx < F; bx++)
+								block[count++] = row[bx];
+						}
+						else
+						{
+							for (uint8_t bx = 0; bx < F; bx++)
+								block[count++] = voxels[S::posToIndex(x * F + bx, y * F + by, z * F + bz)];
+						}
+					}
+				}
+				destination.set((uint8_t)(offsetX + x), (uint8_t)(offsetY + y),
+					(uint8_t)(offsetZ + z), reducer((const Voxel*)block, count));
+			}
+		}
+	}
+}
+
+/**
+ * @brief Downsamples child chunk into the part of the parent chunk.
+ * @details Parent chunk covers FxFxF child chunks, child position selects the written part. (octant for 2x)
+ *
+ * @tparam F downsampling factor (2, 4 or 8)
+ * @param[in] child source child chunk
+ * @param[out] parent destination parent chunk (the same size as child)
+ * @param x child chunk position along X-axis inside parent [0, F)
+ * @param y child chunk position along Y-axis inside parent [0, F)
+ * @param z child chunk position along Z-axis inside parent [0, F)
+ * @param reducer block voxel reducer
+ */
+template<uint8_t F, class R = Majority, class C, class P>
+static void downsampleToParent(const C& child, P& parent, uint8_t x, uint8_t y, uint8_t z, const R& reducer = R()) noexcept
+{
+	static_assert(C::sizeX == P::sizeX && C::sizeY == P::sizeY && C::sizeZ == P::sizeZ,
+		"Parent and child chunk sizes should be the same");
+	assert(x < F);
+	assert(y < F);
+	assert(z < F);
+	downsample<F>(child, parent, (uint8_t)(x * (C::sizeX / F)),
+		(uint8_t)(y * (C::sizeY / F)), (uint8_t)(z * (C::sizeZ / F)), reducer);
+}
+
+/***********************************************************************************************************************
+ * @brief Downsamples world chunks into the LOD world parent chunks on the batch executor.
+ *
+ * @details
+ * Parent chunk (x, y, z) is built from the FxFxF world chunks starting at (x * F, y * F, z * F).
+ * Parts of the not created world chunks are filled with null voxels, not created parent chunks are skipped.
+ *
+ * @note Create parent chunks before the call, worlds should not be modified while it is running.
+ * @return Processed parent chunk count. (less than chunk count if cancelled)
+ *
+ * @tparam F downsampling factor (2, 4 or 8)
+ * @param[in,out] executor target batch executor
+ * @param[in] world source world
+ * @param[out] lodWorld destination LOD world (the same chunk size as source)
+ * @param[in,out] chunks parent chunks to process
+ * @param chunkCount parent chunk count
+ * @param reducer block voxel reducer
+ * @param[in] isCancelled optional cancellation flag
+ */
+template<uint8_t F, class R = Majority, class W, class LW>
+static size_t downsampleWorld(BatchExecutor& executor, const W& world, LW& lodWorld, BatchChunk* chunks,
+	size_t chunkCount, const R& reducer = R(), const std::atomic<bool>* isCancelled = nullptr)
+{
+	typedef typename W::Chunk Chunk;
+	return executor.run(chunks, chunkCount, [&](int32_t x, int32_t y, int32_t z)
+	{
+		auto parent = lodWorld.getChunk(x, y, z);
+		if (!parent)
+			return;
+
+		for (uint8_t cz = 0; cz < F; cz++)
+		{
+			for (uint8_t cy = 0; cy < F; cy++)
+			{
+				for (uint8_t cx = 0; cx < F; cx++)
+				{
+					auto child = world.getChunk(x * F + cx, y * F + cy, z * F + cz);
+					if (child)
+					{
+						downsampleToParent<F>(*child, *parent, cx, cy, cz, reducer);
+						continue;
+					}
+
+					parent->fill(voxel::null, Chunk::sizeX / F, Chunk::sizeY / F, Chunk::sizeZ / F,
+						cx * (Chunk::sizeX / F), cy * (Chunk::sizeY / F), cz * (Chunk::sizeZ / F));
+				}
+			}
+		}
+	}, BatchDependency::none, isCancelled);
+}
+
+};
\ No newline at end of file
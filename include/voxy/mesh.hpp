@@ -0,0 +1,258 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Voxel chunk meshing functions.
+ *
+ * @details
+ * Greedy mesher builds solid bit masks for whole chunk rows, culls hidden faces with bitwise operations
+ * against the neighbour rows (including border rows of the cluster chunks), and then merges visible faces
+ * with the same voxel ID into the rectangle quads slice by slice.
+ */
+
+#pragma once
+#include "voxy/cluster.hpp"
+
+namespace voxy::mesh
+{
+
+/**
+ * @brief Voxel face direction.
+ */
+enum class Face : uint8_t
+{
+	nx, /**< Negative X-axis face (-x) */
+	px, /**< Positive X-axis face (+x) */
+	ny, /**< Negative Y-axis face (-y) */
+	py, /**< Positive Y-axis face (+y) */
+	nz, /**< Negative Z-axis face (-z) */
+	pz, /**< Positive Z-axis face (+z) */
+	count /**< Voxel face direction count. */
+};
+
+/**
+ * @brief Merged voxel face rectangle.
+ *
+ * @details
+ * Position is the chunk voxel with the minimal coordinates covered by the quad.
+ * Quad width and height axes depend on the face: X faces (Y, Z), Y faces (X, Z), Z faces (X, Y).
+ *
+ * @tparam V chunk voxel ID type
+ */
+template<typename V>
+struct Quad
+{
+	uint8_t x = 0;      /**< Quad position along X-axis. */
+	uint8_t y = 0;      /**< Quad position along Y-axis. */
+	uint8_t z = 0;      /**< Quad position along Z-axis. */
+	uint8_t width = 0;  /**< Quad size along the first face axis. */
+	uint8_t height = 0; /**< Quad size along the second face axis. */
+	Face face = {};     /**< Quad face direction. */
+	V voxel = {};       /**< Quad voxel ID. */
+};
+
+/**
+ * @brief Merges visible faces of the chunk slice into quads.
+ * @details Slice face masks are consumed (cleared) during the merge.
+ * @return True on success, otherwise false if quad buffer is too small.
+ *
+ * @tparam F slice face direction
+ * @param[in] chunk target chunk
+ * @param[in,out] masks visible face bit masks of the slice rows
+ * @param rowCount slice row count
+ * @param slice slice position along the face axis
+ * @param[out] quads quad buffer to write to
+ * @param capacity quad buffer size
+ * @param[in,out] quadCount written quad count
+ */
+template<Face F, class C, typename V>
+static bool mergeSlice(const C& chunk, uint64_t* masks, uint8_t rowCount, uint8_t slice,
+	Quad<V>* quads, size_t capacity, size_t& quadCount) noexcept
+{
+	auto getVoxel = [&](uint8_t u, uint8_t v)
+	{
+		if constexpr (F == Face::nx || F == Face::px)
+			return chunk.get(slice, u, v);
+		else if constexpr (F == Face::ny || F == Face::py)
+			return chunk.get(u, slice, v);
+		else
+			return chunk.get(u, v, slice);
+	};
+
+	for (uint8_t v = 0; v < rowCount; v++)
+	{
+		auto& mask = masks[v];
+		while (mask)
+		{
+			auto u = (uint8_t)simd::findFirstBit(mask);
+			auto voxel = getVoxel(u, v);
+
+			uint8_t width = 1;
+			while (u + width < 64 && (mask >> (u + width) & 1) && getVoxel(u + width, v) == voxel)
+				width++;
+			auto run = (width == 64 ? UINT64_MAX : ((uint64_t)1 << width) - 1) << u;
+			mask &= ~run;
+
+			uint8_t height = 1;
+			while (v + height < rowCount && (masks[v + height] & run) == run)
+			{
+				uint8_t i = 0;
+				while (i < width && getVoxel(u + i, v + height) == voxel)
+					i++;
+				if (i < width)
+					break;
+				masks[v + height] &= ~run;
+				height++;
+			}
+
+			if (quadCount == capacity)
+				return false;
+
+			auto& quad = quads[quadCount++];
+			if constexpr (F == Face::nx || F == Face::px)
+			{
+				quad.x = slice; quad.y = u; quad.z = v;
+			}
+			else if constexpr (F == Face::ny || F == Face::py)
+			{
+				quad.x = u; quad.y = slice; quad.z = v;
+			}
+			else
+			{
+				quad.x = u; quad.y = v; quad.z = slice;
+			}
+			quad.width = width; quad.height = height;
+			quad.face = F; quad.voxel = voxel;
+		}
+	}
+	return true;
+}
+
+/***********************************************************************************************************************
+ * @brief Builds greedy merged quads of the visible cluster central chunk faces.
+ * @return True on success, otherwise false if quad buffer is too small.
+ *
+ * @details
+ * Face is visible if the nearby voxel is not solid, missing (null) cluster neighbour chunks are treated
+ * as empty. It doesn't allocate heap memory. (use @ref VoxelRegistry predicate for the dense property table)
+ *
+ * @note Chunk size should be 64 voxels or less along each axis.
+ * @note The same predicate decides both face emission and occlusion, so opaque predicate drops transparent voxels.
+ *       Mesh them in a separate pass with their own predicate.
+ *
+ * @param[in] cluster target chunk cluster (central chunk should not be null)
+ * @param[out] quads quad buffer to write the mesh to
+ * @param capacity quad buffer size
+ * @param[out] quadCount written quad count
+ * @param isSolid solid voxel predicate, signature: bool(Voxel voxel)
+ */
+template<class C, typename V, typename F = IsNotNullVoxel>
+static bool buildGreedy(const Cluster3<C, V>& cluster, Quad<V>* quads,
+	size_t capacity, size_t& quadCount, const F& isSolid = F()) noexcept
+{
+	constexpr uint8_t sizeX = C::sizeX, sizeY = C::sizeY, sizeZ = C::sizeZ;
+	static_assert(sizeX <= 64 && sizeY <= 64 && sizeZ <= 64, "Chunk size should be 64 voxels or less");
+	assert(cluster.c);
+	VOXY_STATS_TIME(mesh);
+	assert(quads || capacity == 0);
+
+	const auto& chunk = *cluster.c;
+	uint64_t rowsX[sizeZ][sizeY] = {}, colsY[sizeZ][sizeX] = {};
+	for (uint8_t z = 0; z < sizeZ; z++)
+	{
+		for (uint8_t y = 0; y < sizeY; y++)
+		{
+			uint64_t row = 0;
+			for (uint8_t x = 0; x < sizeX; x++)
+			{
+				if (!isSolid(chunk.get(x, y, z)))
+					continue;
+				row |= (uint64_t)1 << x;
+				colsY[z][x] |= (uint64_t)1 << y;
+			}
+			rowsX[z][y] = row;
+		}
+	}
+
+	uint64_t nxCols[sizeZ] = {}, pxCols[sizeZ] = {}, nyRows[sizeZ] = {};
+	uint64_t pyRows[sizeZ] = {}, nzRows[sizeY] = {}, pzRows[sizeY] = {};
+	for (uint8_t z = 0; z < sizeZ; z++)
+	{
+		for (uint8_t y = 0; y < sizeY; y++)
+		{
+			if (cluster.nx && isSolid(cluster.nx->get(sizeX - 1, y, z)))
+				nxCols[z] |= (uint64_t)1 << y;
+			if (cluster.px && isSolid(cluster.px->get(0, y, z)))
+				pxCols[z] |= (uint64_t)1 << y;
+		}
+		for (uint8_t x = 0; x < sizeX; x++)
+		{
+			if (cluster.ny && isSolid(cluster.ny->get(x, sizeY - 1, z)))
+				nyRows[z] |= (uint64_t)1 << x;
+			if (cluster.py && isSolid(cluster.py->get(x, 0, z)))
+				pyRows[z] |= (uint64_t)1 << x;
+		}
+	}
+	for (uint8_t y = 0; y < sizeY; y++)
+	{
+		for (uint8_t x = 0; x < sizeX; x++)
+		{
+			if (cluster.nz && isSolid(cluster.nz->get(x, y, sizeZ - 1)))
+				nzRows[y] |= (uint64_t)1 << x;
+			if (cluster.pz && isSolid(cluster.pz->get(x, y, 0)))
+				pzRows[y] |= (uint64_t)1 << x;
+		}
+	}
+
+	quadCount = 0;
+	uint64_t masks[sizeZ > sizeY ? sizeZ : sizeY];
+
+	for (uint8_t x = 0; x < sizeX; x++)
+	{
+		for (uint8_t z = 0; z < sizeZ; z++)
+			masks[z] = colsY[z][x] & ~(x > 0 ? colsY[z][x - 1] : nxCols[z]);
+		if (!mergeSlice<Face::nx>(chunk, masks, sizeZ, x, quads, capacity, quadCount))
+			return false;
+		for (uint8_t z = 0; z < sizeZ; z++)
+			masks[z] = colsY[z][x] & ~(x + 1 < sizeX ? colsY[z][x + 1] : pxCols[z]);
+		if (!mergeSlice<Face::px>(chunk, masks, sizeZ, x, quads, capacity, quadCount))
+			return false;
+	}
+	for (uint8_t y = 0; y < sizeY; y++)
+	{
+		for (uint8_t z = 0; z < sizeZ; z++)
+			masks[z] = rowsX[z][y] & ~(y > 0 ? rowsX[z][y - 1] : nyRows[z]);
+		if (!mergeSlice<Face::ny>(chunk, masks, sizeZ, y, quads, capacity, quadCount))
+			return false;
+		for (uint8_t z = 0; z < sizeZ; z++)
+			masks[z] = rowsX[z][y] & ~(y + 1 < sizeY ? rowsX[z][y + 1] : pyRows[z]);
+		if (!mergeSlice<Face::py>(chunk, masks, sizeZ, y, quads, capacity, quadCount))
+			return false;
+	}
+	for (uint8_t z = 0; z < sizeZ; z++)
+	{
+		for (uint8_t y = 0; y < sizeY; y++)
+			masks[y] = rowsX[z][y] & ~(z > 0 ? rowsX[z - 1][y] : nzRows[y]);
+		if (!mergeSlice<Face::nz>(chunk, masks, sizeY, z, quads, capacity, quadCount))
+			return false;
+		for (uint8_t y = 0; y < sizeY; y++)
+			masks[y] = rowsX[z][y] & ~(z + 1 < sizeZ ? rowsX[z + 1][y] : pzRows[y]);
+		if (!mergeSlice<Face::pz>(chunk, masks, sizeY, z, quads, capacity, quadCount))
+			return false;
+	}
+	return true;
+}
+
+};
\ No newline at end of file
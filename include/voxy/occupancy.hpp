@@ -0,0 +1,522 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Hierarchical voxel occupancy chunk functions.
+ *
+ * @details
+ * Occupancy chunk keeps a 64-bit voxel mask for each 4x4x4 brick, a bit mask of the not empty bricks,
+ * and answers region emptiness queries without reading voxels. Empty voxels are null voxels.
+ * Occupied voxels are iterated with the count trailing zeros, skipping empty bricks at once.
+ */
+
+#pragma once
+#include "voxy/chunk.hpp"
+
+namespace voxy
+{
+
+/***********************************************************************************************************************
+ * @brief Chunk with the hierarchical voxel occupancy masks.
+ *
+ * @details
+ * Brick voxel mask bit index is (z & 3) << 4 | (y & 3) << 2 | (x & 3). All chunk modification
+ * functions update masks of the changed bricks. It can wrap the @ref TrackedChunk3 as well.
+ *
+ * @note Changes made through the @ref getVoxels array or a base chunk reference are
+ *       not tracked, use @ref updateOccupancy after them.
+ *
+ * @tparam C base chunk type (@ref Chunk3), size should be a multiple of 4 along each axis
+ */
+template<class C>
+struct OccupancyChunk3 : public C
+{
+public:
+	/**
+	 * @brief Base chunk type.
+	 */
+	typedef C Chunk;
+	/**
+	 * @brief Chunk voxel ID type.
+	 */
+	typedef typename C::Voxel Voxel;
+
+	/**
+	 * @brief Brick size in voxels along each axis.
+	 */
+	static constexpr uint8_t brickSize = 4;
+	/**
+	 * @brief Chunk brick count along X-axis.
+	 */
+	static constexpr uint8_t bricksX = C::sizeX / brickSize;
+	/**
+	 * @brief Chunk brick count along Y-axis.
+	 */
+	static constexpr uint8_t bricksY = C::sizeY / brickSize;
+	/**
+	 * @brief Chunk brick count along Z-axis.
+	 */
+	static constexpr uint8_t bricksZ = C::sizeZ / brickSize;
+	/**
+	 * @brief Chunk brick count.
+	 */
+	static constexpr size_t brickCount = (size_t)bricksX * bricksY * bricksZ;
+	/**
+	 * @brief Not empty brick mask word count.
+	 */
+	static constexpr size_t brickWordCount = (brickCount + 63) / 64;
+
+	static_assert(C::sizeX % brickSize == 0 && C::sizeY % brickSize == 0 && C::sizeZ % brickSize == 0,
+		"Chunk size should be a multiple of 4 along each axis");
+protected:
+	uint64_t voxelMasks[brickCount];
+	uint64_t brickMasks[brickWordCount];
+
+	static constexpr uint8_t posToBit(uint8_t x, uint8_t y, uint8_t z) noexcept
+	{
+		return (uint8_t)((z & 3) << 4 | (y & 3) << 2 | (x & 3));
+	}
+	static constexpr uint64_t calcBrickPartMask(uint8_t beginX, uint8_t beginY, uint8_t beginZ,
+		uint8_t endX, uint8_t endY, uint8_t endZ) noexcept
+	{
+		auto rowMask = ((uint64_t)1 << (endX - beginX + 1)) - 1;
+		uint64_t mask = 0;
+		for (uint8_t z = beginZ; z <= endZ; z++)
+		{
+			for (uint8_t y = beginY; y <= endY; y++)
+				mask |= rowMask << posToBit(beginX, y, z);
+		}
+		return mask;
+	}
+
+	void setVoxelMask(size_t brick, uint64_t mask) noexcept
+	{
+		voxelMasks[brick] = mask;
+		auto bit = (uint64_t)1 << (brick & 63);
+		if (mask)
+			brickMasks[brick >> 6] |= bit;
+		else
+			brickMasks[brick >> 6] &= ~bit;
+	}
+	uint64_t calcVoxelMask(uint8_t brickX, uint8_t brickY, uint8_t brickZ) const noexcept
+	{
+		auto voxels = this->getVoxels();
+		uint8_t offsetX = brickX * brickSize, offsetY = brickY * brickSize, offsetZ = brickZ * brickSize;
+		uint64_t mask = 0;
+		for (uint8_t z = 0; z < brickSize; z++)
+		{
+			for (uint8_t y = 0; y < brickSize; y++)
+			{
+				for (uint8_t x = 0; x < brickSize; x++)
+				{
+					if (voxels[C::posToIndex(offsetX + x, offsetY + y, offsetZ + z)] != voxel::null)
+						mask |= (uint64_t)1 << posToBit(x, y, z);
+				}
+			}
+		}
+		return mask;
+	}
+	void fillMasks(bool isOccupied) noexcept
+	{
+		for (size_t i = 0; i < brickCount; i++)
+			voxelMasks[i] = isOccupied ? UINT64_MAX : 0;
+		for (size_t i = 0; i < brickWordCount; i++)
+			brickMasks[i] = 0;
+		if (!isOccupied)
+			return;
+		for (size_t i = 0; i < brickCount; i++)
+			brickMasks[i >> 6] |= (uint64_t)1 << (i & 63);
+	}
+	template<typename F>
+	static void forEachBrick(uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX, uint8_t offsetY, uint8_t offsetZ, F&& func) noexcept
+	{
+		assert(_sizeX + offsetX <= C::sizeX);
+		assert(_sizeY + offsetY <= C::sizeY);
+		assert(_sizeZ + offsetZ <= C::sizeZ);
+		if (_sizeX == 0 || _sizeY == 0 || _sizeZ == 0)
+			return;
+
+		uint8_t endX = offsetX + _sizeX - 1, endY = offsetY + _sizeY - 1, endZ = offsetZ + _sizeZ - 1;
+		for (uint8_t bz = offsetZ / brickSize; bz <= endZ / brickSize; bz++)
+		{
+			for (uint8_t by = offsetY / brickSize; by <= endY / brickSize; by++)
+			{
+				for (uint8_t bx = offsetX / brickSize; bx <= endX / brickSize; bx++)
+					func(bx, by, bz, endX, endY, endZ);
+			}
+		}
+	}
+public:
+	/**
+	 * @brief Creates a new uninitialized chunk.
+	 * @note Chunk may contain garbage voxels and masks, use @ref fill or @ref updateOccupancy.
+	 */
+	OccupancyChunk3() = default;
+	/**
+	 * @brief Creates a new initialized chunk.
+	 * @param voxel target voxel to fill chunk with
+	 */
+	OccupancyChunk3(Voxel voxel) : C(voxel) { fillMasks(voxel != voxel::null); }
+
+	/**
+	 * @brief Returns chunk brick index from the brick position.
+	 *
+	 * @param x brick position along X-axis
+	 * @param y brick position along Y-axis
+	 * @param z brick position along Z-axis
+	 */
+	static constexpr size_t getBrickIndex(uint8_t x, uint8_t y, uint8_t z) noexcept
+	{
+		return ((size_t)z * bricksY + y) * bricksX + x;
+	}
+
+	/**
+	 * @brief Returns true if all chunk voxels are empty. (null)
+	 */
+	bool isEmpty() const noexcept
+	{
+		for (size_t i = 0; i < brickWordCount; i++)
+		{
+			if (brickMasks[i])
+				return false;
+		}
+		return true;
+	}
+	/**
+	 * @brief Returns true if chunk voxel at specified 3D position is not empty.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 */
+	bool isOccupied(uint8_t x, uint8_t y, uint8_t z) const noexcept
+	{
+		assert(x < C::sizeX);
+		assert(y < C::sizeY);
+		assert(z < C::sizeZ);
+		return voxelMasks[getBrickIndex(x >> 2, y >> 2, z >> 2)] >> posToBit(x, y, z) & 1;
+	}
+	/**
+	 * @brief Returns brick voxel occupancy mask. (bit per voxel)
+	 *
+	 * @param x brick position along X-axis
+	 * @param y brick position along Y-axis
+	 * @param z brick position along Z-axis
+	 */
+	uint64_t getVoxelMask(uint8_t x, uint8_t y, uint8_t z) const noexcept
+	{
+		assert(x < bricksX);
+		assert(y < bricksY);
+		assert(z < bricksZ);
+		return voxelMasks[getBrickIndex(x, y, z)];
+	}
+	/**
+	 * @brief Returns not empty brick mask word. (bit per brick index)
+	 * @param index target mask word index
+	 */
+	uint64_t getBrickMask(size_t index = 0) const noexcept
+	{
+		assert(index < brickWordCount);
+		return brickMasks[index];
+	}
+	/**
+	 * @brief Returns not empty chunk voxel count.
+	 * @details Counts bits of the not empty bricks only.
+	 */
+	size_t countOccupied() const noexcept
+	{
+		size_t count = 0;
+		for (size_t i = 0; i < brickWordCount; i++)
+		{
+			auto mask = brickMasks[i];
+			while (mask)
+			{
+				count += simd::countBits(voxelMasks[i * 64 + simd::findFirstBit(mask)]);
+				mask &= mask - 1;
+			}
+		}
+		return count;
+	}
+	/**
+	 * @brief Returns true if all chunk part voxels are empty.
+	 *
+	 * @param _sizeX chunk part size along X-axis
+	 * @param _sizeY chunk part size along Y-axis
+	 * @param _sizeZ chunk part size along Z-axis
+	 * @param offsetX chunk part offset along X-axis
+	 * @param offsetY chunk part offset along Y-axis
+	 * @param offsetZ chunk part offset along Z-axis
+	 */
+	bool isEmpty(uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX = 0, uint8_t offsetY = 0, uint8_t offsetZ = 0) const noexcept
+	{
+		bool result = true;
+		forEachBrick(_sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ,
+			[&](uint8_t bx, uint8_t by, uint8_t bz, uint8_t endX, uint8_t endY, uint8_t endZ)
+		{
+			auto mask = voxelMasks[getBrickIndex(bx, by, bz)];
+			if (!result || !mask)
+				return;
+
+			uint8_t brickX = bx * brickSize, brickY = by * brickSize, brickZ = bz * brickSize;
+			auto partMask = calcBrickPartMask(
+				offsetX > brickX ? offsetX - brickX : 0,
+				offsetY > brickY ? offsetY - brickY : 0,
+				offsetZ > brickZ ? offsetZ - brickZ : 0,
+				endX < brickX + 3 ? endX - brickX : 3,
+				endY < brickY + 3 ? endY - brickY : 3,
+				endZ < brickZ + 3 ? endZ - brickZ : 3);
+			if (mask & partMask)
+				result = false;
+		});
+		return result;
+	}
+
+	/**
+	 * @brief Calls specified function for each not empty chunk voxel.
+	 * @details Function signature: void(uint8_t x, uint8_t y, uint8_t z)
+	 * @param func target function
+	 */
+	template<typename F>
+	void forEachOccupied(F&& func) const
+	{
+		for (size_t i = 0; i < brickWordCount; i++)
+		{
+			auto brickMask = brickMasks[i];
+			while (brickMask)
+			{
+				auto brick = i * 64 + simd::findFirstBit(brickMask);
+				brickMask &= brickMask - 1;
+				uint8_t brickX = (uint8_t)(brick % bricksX) * brickSize;
+				uint8_t brickY = (uint8_t)(brick / bricksX % bricksY) * brickSize;
+				uint8_t brickZ = (uint8_t)(brick / ((size_t)bricksX * bricksY)) * brickSize;
+
+				auto voxelMask = voxelMasks[brick];
+				while (voxelMask)
+				{
+					auto bit = simd::findFirstBit(voxelMask);
+					voxelMask &= voxelMask - 1;
+					func((uint8_t)(brickX + (bit & 3)), (uint8_t)(brickY + (bit >> 2 & 3)),
+						(uint8_t)(brickZ + (bit >> 4)));
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief Recalculates all chunk occupancy masks from the voxels.
+	 */
+	void updateOccupancy() noexcept
+	{
+		updateOccupancy(C::sizeX, C::sizeY, C::sizeZ);
+	}
+	/**
+	 * @brief Recalculates chunk part brick occupancy masks from the voxels.
+	 *
+	 * @param _sizeX chunk part size along X-axis
+	 * @param _sizeY chunk part size along Y-axis
+	 * @param _sizeZ chunk part size along Z-axis
+	 * @param offsetX chunk part offset along X-axis
+	 * @param offsetY chunk part offset along Y-axis
+	 * @param offsetZ chunk part offset along Z-axis
+	 */
+	void updateOccupancy(uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX = 0, uint8_t offsetY = 0, uint8_t offsetZ = 0) noexcept
+	{
+		forEachBrick(_sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ,
+			[&](uint8_t bx, uint8_t by, uint8_t bz, uint8_t, uint8_t, uint8_t)
+		{
+			setVoxelMask(getBrickIndex(bx, by, bz), calcVoxelMask(bx, by, bz));
+		});
+	}
+
+	/**
+	 * @brief Sets chunk voxel at specified 3D position.
+	 * @note Use with care, it doesn't checks for out of chunk bounds!
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param voxel target voxel ID
+	 */
+	void set(uint8_t x, uint8_t y, uint8_t z, Voxel voxel) noexcept
+	{
+		C::set(x, y, z, voxel);
+		auto brick = getBrickIndex(x >> 2, y >> 2, z >> 2);
+		auto bit = (uint64_t)1 << posToBit(x, y, z);
+		setVoxelMask(brick, voxel != voxel::null ? voxelMasks[brick] | bit : voxelMasks[brick] & ~bit);
+	}
+	/**
+	 * @brief Sets chunk voxel at specified array index.
+	 * @note Use with care, it doesn't checks for out of array bounds!
+	 *
+	 * @param index target voxel index inside array
+	 * @param voxel target voxel ID
+	 */
+	void set(size_t index, Voxel voxel) noexcept
+	{
+		uint8_t x, y, z;
+		C::indexToPos(index, x, y, z);
+		set(x, y, z, voxel);
+	}
+	/**
+	 * @brief Sets chunk voxel at specified 3D position if inside chunk bounds.
+	 * @return True if voxel position is inside chunk bounds, otherwise false.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param voxel target voxel ID
+	 */
+	bool trySet(uint8_t x, uint8_t y, uint8_t z, Voxel voxel) noexcept
+	{
+		if (x >= C::sizeX || y >= C::sizeY || z >= C::sizeZ)
+			return false;
+		set(x, y, z, voxel);
+		return true;
+	}
+	/**
+	 * @brief Sets chunk voxel at specified array index if inside array bounds.
+	 * @return True if voxel index is inside array bounds, otherwise false.
+	 *
+	 * @param index target voxel index inside array
+	 * @param voxel target voxel ID
+	 */
+	bool trySet(size_t index, Voxel voxel) noexcept
+	{
+		if (index >= C::size)
+			return false;
+		set(index, voxel);
+		return true;
+	}
+
+	/**
+	 * @brief Fills chunk with specified voxel ID.
+	 * @param voxel target voxel ID
+	 */
+	void fill(Voxel voxel) noexcept
+	{
+		C::fill(voxel);
+		fillMasks(voxel != voxel::null);
+	}
+	/**
+	 * @brief Fills chunk part with specified voxel ID.
+	 *
+	 * @param voxel target voxel ID
+	 * @param _sizeX chunk part size along X-axis
+	 * @param _sizeY chunk part size along Y-axis
+	 * @param _sizeZ chunk part size along Z-axis
+	 * @param offsetX chunk part offset along X-axis
+	 * @param offsetY chunk part offset along Y-axis
+	 * @param offsetZ chunk part offset along Z-axis
+	 */
+	void fill(Voxel voxel, uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX = 0, uint8_t offsetY = 0, uint8_t offsetZ = 0) noexcept
+	{
+		C::fill(voxel, _sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ);
+		forEachBrick(_sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ,
+			[&](uint8_t bx, uint8_t by, uint8_t bz, uint8_t endX, uint8_t endY, uint8_t endZ)
+		{
+			uint8_t brickX = bx * brickSize, brickY = by * brickSize, brickZ = bz * brickSize;
+			auto partMask = calcBrickPartMask(
+				offsetX > brickX ? offsetX - brickX : 0,
+				offsetY > brickY ? offsetY - brickY : 0,
+				offsetZ > brickZ ? offsetZ - brickZ : 0,
+				endX < brickX + 3 ? endX - brickX : 3,
+				endY < brickY + 3 ? endY - brickY : 3,
+				endZ < brickZ + 3 ? endZ - brickZ : 3);
+			auto brick = getBrickIndex(bx, by, bz);
+			setVoxelMask(brick, voxel != voxel::null ? voxelMasks[brick] | partMask : voxelMasks[brick] & ~partMask);
+		});
+	}
+
+	/**
+	 * @brief Replaces all chunk voxels with specified ID.
+	 * @return Replaced voxel count.
+	 *
+	 * @param from voxel ID to replace
+	 * @param to new voxel ID
+	 */
+	size_t replace(Voxel from, Voxel to) noexcept
+	{
+		auto result = C::replace(from, to);
+		if (result > 0 && (from == voxel::null) != (to == voxel::null))
+			updateOccupancy();
+		return result;
+	}
+	/**
+	 * @brief Replaces chunk part voxels with specified ID.
+	 * @return Replaced voxel count.
+	 *
+	 * @param from voxel ID to replace
+	 * @param to new voxel ID
+	 * @param _sizeX chunk part size along X-axis
+	 * @param _sizeY chunk part size along Y-axis
+	 * @param _sizeZ chunk part size along Z-axis
+	 * @param offsetX chunk part offset along X-axis
+	 * @param offsetY chunk part offset along Y-axis
+	 * @param offsetZ chunk part offset along Z-axis
+	 */
+	size_t replace(Voxel from, Voxel to, uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX = 0, uint8_t offsetY = 0, uint8_t offsetZ = 0) noexcept
+	{
+		auto result = C::replace(from, to, _sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ);
+		if (result > 0 && (from == voxel::null) != (to == voxel::null))
+			updateOccupancy(_sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ);
+		return result;
+	}
+
+	/**
+	 * @brief Copies voxels from specified array to this chunk.
+	 * @note Voxel array should have bigger or the same size as chunk, and the same layout!
+	 * @param[in] voxels target voxel array
+	 */
+	void copy(const Voxel* voxels) noexcept
+	{
+		C::copy(voxels);
+		updateOccupancy();
+	}
+	/**
+	 * @brief Copies voxels from specified array part to this chunk.
+	 * @note Voxel array should have bigger or the same size as specified part, and linear layout!
+	 *
+	 * @param[in] target voxel array
+	 * @param _sizeX voxel array part size along X-axis
+	 * @param _sizeY voxel array part size along Y-axis
+	 * @param _sizeZ voxel array part size along Z-axis
+	 * @param offsetX voxel array part offset along X-axis
+	 * @param offsetY voxel array part offset along Y-axis
+	 * @param offsetZ voxel array part offset along Z-axis
+	 */
+	void copy(const Voxel* voxels, uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX = 0, uint8_t offsetY = 0, uint8_t offsetZ = 0) noexcept
+	{
+		C::copy(voxels, _sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ);
+		updateOccupancy(_sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ);
+	}
+	/**
+	 * @brief Copies voxels from specified chunk, converting the voxel array layout if it's different.
+	 * @param[in] chunk source chunk
+	 */
+	template<class SL>
+	void copy(const Chunk3<C::sizeX, C::sizeY, C::sizeZ, Voxel, SL>& chunk) noexcept
+	{
+		C::copy(chunk);
+		updateOccupancy();
+	}
+};
+
+};
\ No newline at end of file
@@ -0,0 +1,208 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Padded (bordered) chunk snapshot functions.
+ *
+ * @details
+ * Padded chunk stores a copy of the cluster central chunk voxels together with N-voxel borders
+ * of the neighbour chunks inside one contiguous array. Inner loops can access nearby voxels using
+ * constant index offsets, without checking which cluster chunk contains them.
+ */
+
+#pragma once
+#include "voxy/cluster.hpp"
+#include <type_traits>
+
+namespace voxy
+{
+
+/***********************************************************************************************************************
+ * @brief Chunk snapshot with the neighbour voxel borders.
+ *
+ * @details
+ * Voxel positions are relative to the central chunk, border voxels have negative
+ * or greater than chunk size coordinates. Edge and corner border voxels are not
+ * covered by the cluster, so they are filled with the border voxel value.
+ *
+ * @tparam C source cluster chunk type
+ * @tparam B border size in voxels
+ */
+template<class C, uint8_t B = 1>
+struct PaddedChunk3
+{
+public:
+	/**
+	 * @brief Source cluster chunk type.
+	 */
+	typedef C Chunk;
+	/**
+	 * @brief Chunk voxel ID type.
+	 */
+	typedef typename C::Voxel Voxel;
+	/**
+	 * @brief Source chunk cluster type.
+	 */
+	typedef Cluster3<C, Voxel> Cluster;
+
+	/**
+	 * @brief Border size in voxels.
+	 */
+	static constexpr uint8_t border = B;
+	/**
+	 * @brief Padded chunk size in voxels along X-axis. (including borders)
+	 */
+	static constexpr uint16_t sizeX = C::sizeX + B * 2;
+	/**
+	 * @brief Padded chunk size in voxels along Y-axis. (including borders)
+	 */
+	static constexpr uint16_t sizeY = C::sizeY + B * 2;
+	/**
+	 * @brief Padded chunk size in voxels along Z-axis. (including borders)
+	 */
+	static constexpr uint16_t sizeZ = C::sizeZ + B * 2;
+	/**
+	 * @brief Padded chunk layer size in voxels. (sizeX * sizeY)
+	 */
+	static constexpr size_t sizeXY = (size_t)sizeX * sizeY;
+	/**
+	 * @brief Padded chunk array size in voxels. (sizeX * sizeY * sizeZ)
+	 */
+	static constexpr size_t size = sizeXY * sizeZ;
+
+	static_assert(B > 0 && B <= C::sizeX && B <= C::sizeY && B <= C::sizeZ,
+		"Border size should be in range [1, chunk size]");
+protected:
+	Voxel voxels[size];
+
+	void copyRows(const C* chunk, uint8_t srcX, uint8_t srcY, uint8_t srcZ,
+		uint8_t countX, uint8_t countY, uint8_t countZ, int16_t dstX, int16_t dstY, int16_t dstZ) noexcept
+	{
+		if (!chunk)
+			return;
+
+		for (uint8_t z = 0; z < countZ; z++)
+		{
+			for (uint8_t y = 0; y < countY; y++)
+			{
+				auto row = voxels + posToIndex(dstX, dstY + y, dstZ + z);
+				if constexpr (std::is_same_v<C, Chunk3<C::sizeX, C::sizeY, C::sizeZ, Voxel>>)
+				{
+					auto chunkRow = chunk->getVoxels() + chunk->posToIndex(srcX, srcY + y, srcZ + z);
+					memcpy(row, chunkRow, countX * sizeof(Voxel));
+				}
+				else
+				{
+					for (uint8_t x = 0; x < countX; x++)
+						row[x] = chunk->get(srcX + x, srcY + y, srcZ + z);
+				}
+			}
+		}
+	}
+public:
+	/**
+	 * @brief Creates a new uninitialized padded chunk.
+	 * @note Padded chunk may contain garbage voxels.
+	 */
+	PaddedChunk3() = default;
+	/**
+	 * @brief Creates a new padded chunk from the cluster chunks.
+	 *
+	 * @param[in] cluster source chunk cluster (central chunk should not be null)
+	 * @param borderVoxel voxel ID for the missing border voxels
+	 */
+	PaddedChunk3(const Cluster& cluster, Voxel borderVoxel = voxel::null) noexcept
+	{
+		gather(cluster, borderVoxel);
+	}
+
+	/**
+	 * @brief Returns padded chunk voxel array.
+	 */
+	Voxel* getVoxels() noexcept { return voxels; }
+	/**
+	 * @brief Returns constant padded chunk voxel array.
+	 */
+	const Voxel* getVoxels() const noexcept { return voxels; }
+
+	/**
+	 * @brief Calculates padded chunk voxel index from the central chunk relative position.
+	 * @details Nearby voxel index offsets are: X-axis 1, Y-axis sizeX, Z-axis sizeXY.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 */
+	static constexpr size_t posToIndex(int16_t x, int16_t y, int16_t z) noexcept
+	{
+		return (size_t)(z + B) * sizeXY + (size_t)(y + B) * sizeX + (size_t)(x + B);
+	}
+
+	/**
+	 * @brief Returns padded chunk voxel at specified 3D position.
+	 * @note Use with care, it doesn't checks for out of padded chunk bounds!
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 */
+	Voxel get(int16_t x, int16_t y, int16_t z) const noexcept
+	{
+		assert(x >= -B && x < C::sizeX + B);
+		assert(y >= -B && y < C::sizeY + B);
+		assert(z >= -B && z < C::sizeZ + B);
+		return voxels[posToIndex(x, y, z)];
+	}
+	/**
+	 * @brief Sets padded chunk voxel at specified 3D position.
+	 * @note Use with care, it doesn't checks for out of padded chunk bounds!
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param voxel target voxel ID
+	 */
+	void set(int16_t x, int16_t y, int16_t z, Voxel voxel) noexcept
+	{
+		assert(x >= -B && x < C::sizeX + B);
+		assert(y >= -B && y < C::sizeY + B);
+		assert(z >= -B && z < C::sizeZ + B);
+		voxels[posToIndex(x, y, z)] = voxel;
+	}
+
+	/**
+	 * @brief Copies cluster central chunk and neighbour chunk border voxels.
+	 * @details Voxels are copied row by row, missing (null) neighbour chunks are filled with the border voxel.
+	 *
+	 * @param[in] cluster source chunk cluster (central chunk should not be null)
+	 * @param borderVoxel voxel ID for the missing border voxels
+	 */
+	void gather(const Cluster& cluster, Voxel borderVoxel = voxel::null) noexcept
+	{
+		assert(cluster.c);
+		constexpr uint8_t sx = C::sizeX, sy = C::sizeY, sz = C::sizeZ;
+		simd::fill(voxels, borderVoxel, size);
+
+		copyRows(cluster.c, 0, 0, 0, sx, sy, sz, 0, 0, 0);
+		copyRows(cluster.nx, sx - B, 0, 0, B, sy, sz, -B, 0, 0);
+		copyRows(cluster.px, 0, 0, 0, B, sy, sz, sx, 0, 0);
+		copyRows(cluster.ny, 0, sy - B, 0, sx, B, sz, 0, -B, 0);
+		copyRows(cluster.py, 0, 0, 0, sx, B, sz, 0, sy, 0);
+		copyRows(cluster.nz, 0, 0, sz - B, sx, sy, B, 0, 0, -B);
+		copyRows(cluster.pz, 0, 0, 0, sx, sy, B, 0, 0, sz);
+	}
+};
+
+};
\ No newline at end of file
@@ -0,0 +1,477 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Palette compressed voxel chunk functions.
+ *
+ * @details
+ * Palette chunk stores a local table of the distinct voxel IDs (palette) and a bit-packed array of palette indices.
+ * Index width grows 1/2/4/8-bit as new voxel IDs are added. When more than 256 distinct IDs are stored, the chunk
+ * switches to the direct mode, where the packed array holds voxel IDs themselves.
+ */
+
+#pragma once
+#include "voxy/chunk.hpp"
+#include <vector>
+
+namespace voxy
+{
+
+/**
+ * @brief Palette compressed voxel 3D container.
+ * @details It has the same voxel access interface as the @ref Chunk3, so it can be used inside a cluster.
+ *
+ * @tparam SX chunk size in voxels along X-axis
+ * @tparam SY chunk size in voxels along Y-axis
+ * @tparam SZ chunk size in voxels along Z-axis
+ * @tparam V chunk voxel ID type
+ */
+template<uint8_t SX, uint8_t SY, uint8_t SZ, typename V>
+struct PaletteChunk3
+{
+public:
+	/**
+	 * @brief Chunk size in voxels along X-axis.
+	 */
+	static constexpr uint8_t sizeX = SX;
+	/**
+	 * @brief Chunk size in voxels along Y-axis.
+	 */
+	static constexpr uint8_t sizeY = SY;
+	/**
+	 * @brief Chunk size in voxels along Z-axis.
+	 */
+	static constexpr uint8_t sizeZ = SZ;
+	/**
+	 * @brief Chunk layer size in voxels. (sizeX * sizeY)
+	 */
+	static constexpr uint16_t sizeXY = SX * SY;
+	/**
+	 * @brief Chunk array size in voxels, or chunk volume. (sizeX * sizeY * sizeZ)
+	 */
+	static constexpr size_t size = SX * SY * SZ;
+	/**
+	 * @brief Chunk voxel ID type.
+	 */
+	typedef V Voxel;
+	/**
+	 * @brief Dense chunk type with the same size and voxel type.
+	 */
+	typedef Chunk3<SX, SY, SZ, V> Dense;
+
+	/**
+	 * @brief Maximum palette size before switching to the direct mode.
+	 */
+	static constexpr uint16_t maxPaletteSize = 256;
+	/**
+	 * @brief Packed index width in the direct mode. (voxel ID size in bits)
+	 */
+	static constexpr uint8_t directBits = sizeof(V) * 8;
+protected:
+	std::vector<uint64_t> indices;
+	std::vector<Voxel> palette;
+	uint64_t indexMask = 0;
+	uint8_t indexBits = 0;
+	uint8_t indexShift = 0;
+
+	static constexpr size_t calcWordCount(uint8_t bits) noexcept { return (size * bits + 63) / 64; }
+	static constexpr uint8_t calcIndexBits(size_t paletteSize) noexcept
+	{
+		if (paletteSize <= 2)
+			return 1;
+		if (paletteSize <= 4)
+			return 2;
+		if (paletteSize <= 16)
+			return 4;
+		if (paletteSize <= maxPaletteSize)
+			return 8;
+		return directBits;
+	}
+
+	uint64_t getIndex(size_t index) const noexcept
+	{
+		auto bit = index << indexShift;
+		return (indices[bit >> 6] >> (bit & 63)) & indexMask;
+	}
+	void setIndex(size_t index, uint64_t value) noexcept
+	{
+		auto bit = index << indexShift; auto offset = bit & 63;
+		auto& word = indices[bit >> 6];
+		word = (word & ~(indexMask << offset)) | (value << offset);
+	}
+	void setBits(uint8_t bits)
+	{
+		indexBits = bits;
+		indexShift = 0;
+		while ((1u << indexShift) < bits)
+			indexShift++;
+		indexMask = bits == 64 ? UINT64_MAX : ((uint64_t)1 << bits) - 1;
+		indices = std::vector<uint64_t>(calcWordCount(bits));
+	}
+	bool isDirect() const noexcept { return indexBits > 8; }
+
+	void resize(uint8_t bits)
+	{
+		auto oldIndices = std::move(indices);
+		auto oldMask = indexMask; auto oldShift = indexShift;
+		auto wasDirect = isDirect();
+		setBits(bits);
+
+		for (size_t i = 0; i < size; i++)
+		{
+			auto bit = i << oldShift;
+			auto index = (oldIndices[bit >> 6] >> (bit & 63)) & oldMask;
+			if (isDirect() && !wasDirect)
+				index = (uint64_t)palette[index];
+			setIndex(i, index);
+		}
+
+		if (isDirect())
+		{
+			palette.clear();
+			palette.shrink_to_fit();
+		}
+	}
+	uint64_t findOrAdd(Voxel voxel)
+	{
+		if (isDirect())
+			return (uint64_t)voxel;
+
+		auto paletteSize = palette.size();
+		for (size_t i = 0; i < paletteSize; i++)
+		{
+			if (palette[i] == voxel)
+				return i;
+		}
+
+		if (paletteSize == ((size_t)1 << indexBits) || paletteSize == maxPaletteSize)
+		{
+			resize(calcIndexBits(paletteSize + 1));
+			if (isDirect())
+				return (uint64_t)voxel;
+		}
+
+		palette.push_back(voxel);
+		return paletteSize;
+	}
+public:
+	/**
+	 * @brief Creates a new initialized palette chunk.
+	 * @note Unlike the @ref Chunk3 it is always initialized, with null voxels by default.
+	 * @param voxel target voxel to fill chunk with
+	 */
+	PaletteChunk3(Voxel voxel = voxel::null) { fill(voxel); }
+	/**
+	 * @brief Creates a new palette chunk from the dense chunk voxels.
+	 * @param[in] chunk target dense chunk
+	 */
+	PaletteChunk3(const Dense& chunk) { copy(chunk.getVoxels()); }
+
+	/**
+	 * @brief Returns chunk palette voxel array.
+	 * @note Palette is empty in the direct mode.
+	 */
+	const Voxel* getPalette() const noexcept { return palette.data(); }
+	/**
+	 * @brief Returns chunk palette size. (distinct voxel ID count upper bound)
+	 */
+	size_t getPaletteSize() const noexcept { return palette.size(); }
+	/**
+	 * @brief Returns packed voxel index size in bits. (1/2/4/8 or @ref directBits)
+	 */
+	uint8_t getIndexBits() const noexcept { return indexBits; }
+	/**
+	 * @brief Returns chunk memory usage in bytes. (including heap allocated arrays)
+	 */
+	size_t getMemoryUsage() const noexcept
+	{
+		return sizeof(PaletteChunk3) + indices.capacity() * sizeof(uint64_t) + palette.capacity() * sizeof(Voxel);
+	}
+
+	/**
+	 * @brief Calculates chunk voxel index from the position.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 */
+	static constexpr size_t posToIndex(uint8_t x, uint8_t y, uint8_t z) noexcept
+	{
+		return (size_t)z * sizeXY + (size_t)y * sizeX + x;
+	}
+
+	/**
+	 * @brief Returns chunk voxel at specified array index.
+	 * @note Use with care, it doesn't checks for out of array bounds!
+	 * @param index target voxel index inside array
+	 */
+	Voxel get(size_t index) const noexcept
+	{
+		assert(index < size);
+		auto value = getIndex(index);
+		return isDirect() ? (Voxel)value : palette[value];
+	}
+	/**
+	 * @brief Sets chunk voxel at specified array index.
+	 * @note Use with care, it doesn't checks for out of array bounds!
+	 *
+	 * @param index target voxel index inside array
+	 * @param voxel target voxel ID
+	 */
+	void set(size_t index, Voxel voxel)
+	{
+		assert(index < size);
+		setIndex(index, findOrAdd(voxel));
+	}
+
+	/**
+	 * @brief Returns chunk voxel at specified 3D position.
+	 * @note Use with care, it doesn't checks for out of chunk bounds!
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 */
+	Voxel get(uint8_t x, uint8_t y, uint8_t z) const noexcept
+	{
+		assert(x < SX);
+		assert(y < SY);
+		assert(z < SZ);
+		return get(posToIndex(x, y, z));
+	}
+	/**
+	 * @brief Sets chunk voxel at specified 3D position.
+	 * @note Use with care, it doesn't checks for out of chunk bounds!
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param voxel target voxel ID
+	 */
+	void set(uint8_t x, uint8_t y, uint8_t z, Voxel voxel)
+	{
+		assert(x < SX);
+		assert(y < SY);
+		assert(z < SZ);
+		set(posToIndex(x, y, z), voxel);
+	}
+
+	/**
+	 * @brief Returns chunk voxel at specified 3D position if inside chunk bounds.
+	 * @return True if voxel position is inside chunk bounds, otherwise false.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param[out] voxel target voxel ID
+	 */
+	bool tryGet(uint8_t x, uint8_t y, uint8_t z, Voxel& voxel) const noexcept
+	{
+		if (x >= SX || y >= SY || z >= SZ)
+			return false;
+		voxel = get(posToIndex(x, y, z));
+		return true;
+	}
+	/**
+	 * @brief Sets chunk voxel at specified 3D position if inside chunk bounds.
+	 * @return True if voxel position is inside chunk bounds, otherwise false.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param voxel target voxel ID
+	 */
+	bool trySet(uint8_t x, uint8_t y, uint8_t z, Voxel voxel)
+	{
+		if (x >= SX || y >= SY || z >= SZ)
+			return false;
+		set(posToIndex(x, y, z), voxel);
+		return true;
+	}
+
+	/**
+	 * @brief Returns chunk voxel at specified array index if inside array bounds.
+	 * @return True if voxel index is inside array bounds, otherwise false.
+	 *
+	 * @param index target voxel index inside array
+	 * @param[out] voxel target voxel ID
+	 */
+	bool tryGet(size_t index, Voxel& voxel) const noexcept
+	{
+		if (index >= size)
+			return false;
+		voxel = get(index);
+		return true;
+	}
+	/**
+	 * @brief Sets chunk voxel at specified array index if inside array bounds.
+	 * @return True if voxel index is inside array bounds, otherwise false.
+	 *
+	 * @param index target voxel index inside array
+	 * @param voxel target voxel ID
+	 */
+	bool trySet(size_t index, Voxel voxel)
+	{
+		if (index >= size)
+			return false;
+		set(index, voxel);
+		return true;
+	}
+
+	/**
+	 * @brief Fills chunk with specified voxel ID.
+	 * @details Resets palette to the single voxel ID and index size to the 1-bit.
+	 * @param voxel target voxel ID
+	 */
+	void fill(Voxel voxel)
+	{
+		palette.assign(1, voxel);
+		setBits(1);
+	}
+
+	/**
+	 * @brief Copies voxels from specified array to this chunk.
+	 * @details Rebuilds chunk palette from scratch, using the smallest possible index size.
+	 * @note Voxel array should have bigger or the same size as chunk!
+	 * @param[in] voxels target voxel array
+	 */
+	void copy(const Voxel* voxels)
+	{
+		assert(voxels);
+		palette.clear();
+
+		auto lastVoxel = voxels[0]; palette.push_back(lastVoxel);
+		for (size_t i = 1; i < size && palette.size() <= maxPaletteSize; i++)
+		{
+			auto voxel = voxels[i];
+			if (voxel == lastVoxel)
+				continue;
+			lastVoxel = voxel;
+
+			auto paletteSize = palette.size(); size_t j = 0;
+			for (; j < paletteSize; j++)
+			{
+				if (palette[j] == voxel)
+					break;
+			}
+			if (j == paletteSize)
+				palette.push_back(voxel);
+		}
+
+		setBits(calcIndexBits(palette.size()));
+
+		if (isDirect())
+		{
+			palette.clear();
+			for (size_t i = 0; i < size; i++)
+				setIndex(i, (uint64_t)voxels[i]);
+			return;
+		}
+
+		lastVoxel = palette[0]; uint64_t lastIndex = 0;
+		for (size_t i = 0; i < size; i++)
+		{
+			auto voxel = voxels[i];
+			if (voxel != lastVoxel)
+			{
+				lastVoxel = voxel; lastIndex = 0;
+				while (palette[lastIndex] != voxel)
+					lastIndex++;
+				assert(lastIndex < palette.size());
+			}
+			setIndex(i, lastIndex);
+		}
+	}
+	/**
+	 * @brief Copies voxels from specified array part to this chunk.
+	 * @note Voxel array should have bigger or the same size as specified part!
+	 *
+	 * @param[in] voxels target voxel array
+	 * @param _sizeX voxel array part size along X-axis
+	 * @param _sizeY voxel array part size along Y-axis
+	 * @param _sizeZ voxel array part size along Z-axis
+	 * @param offsetX voxel array part offset along X-axis
+	 * @param offsetY voxel array part offset along Y-axis
+	 * @param offsetZ voxel array part offset along Z-axis
+	 */
+	void copy(const Voxel* voxels, uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX = 0, uint8_t offsetY = 0, uint8_t offsetZ = 0)
+	{
+		assert(voxels);
+		assert(_sizeX + offsetX <= SX);
+		assert(_sizeY + offsetY <= SY);
+		assert(_sizeZ + offsetZ <= SZ);
+
+		auto _sizeXY = _sizeX * _sizeY;
+		for (uint8_t z = 0; z < _sizeZ; z++)
+		{
+			for (uint8_t y = 0; y < _sizeY; y++)
+			{
+				auto row = voxels + posToVoxelIndex(0, y, z, _sizeX, _sizeXY);
+				auto index = posToIndex(offsetX, offsetY + y, offsetZ + z);
+				for (uint8_t x = 0; x < _sizeX; x++)
+					set(index + x, row[x]);
+			}
+		}
+	}
+	/**
+	 * @brief Copies voxels from specified dense chunk to this chunk.
+	 * @param[in] chunk target dense chunk
+	 */
+	void copy(const Dense& chunk) { copy(chunk.getVoxels()); }
+
+	/**
+	 * @brief Decompresses chunk voxels to the specified array.
+	 * @note Voxel array should have bigger or the same size as chunk!
+	 * @param[out] voxels target voxel array
+	 */
+	void unpack(Voxel* voxels) const noexcept
+	{
+		assert(voxels);
+		auto entryCount = (size_t)64 >> indexShift;
+		auto wordCount = indices.size();
+		auto direct = isDirect();
+
+		for (size_t i = 0, j = 0; i < wordCount; i++)
+		{
+			auto word = indices[i];
+			auto count = size - j < entryCount ? size - j : entryCount;
+			for (size_t k = 0; k < count; k++, j++)
+			{
+				auto index = word & indexMask;
+				voxels[j] = direct ? (Voxel)index : palette[index];
+				word = indexBits == 64 ? 0 : word >> indexBits;
+			}
+		}
+	}
+	/**
+	 * @brief Decompresses chunk voxels to the specified dense chunk.
+	 * @param[out] chunk target dense chunk
+	 */
+	void unpack(Dense& chunk) const noexcept { unpack(chunk.getVoxels()); }
+
+	/**
+	 * @brief Removes unused palette entries and shrinks index size if possible.
+	 * @details It may also switch chunk back from the direct mode.
+	 */
+	void compact()
+	{
+		std::vector<Voxel> voxels(size);
+		unpack(voxels.data());
+		copy(voxels.data());
+	}
+};
+
+};
\ No newline at end of file
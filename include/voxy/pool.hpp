@@ -0,0 +1,426 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Chunk pool (arena allocator) functions.
+ *
+ * @details
+ * Pool allocates chunk storage in fixed size slabs and keeps freed chunks in the intrusive free list.
+ * Slab memory is returned to the system only when the pool is destroyed.
+ */
+
+#pragma once
+#include "voxy/stats.hpp"
+
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
+
+namespace voxy
+{
+
+/**
+ * @brief Chunk pool occupancy statistics.
+ */
+struct PoolStats
+{
+	size_t slabCount = 0;   /**< Allocated slab count. */
+	size_t capacity = 0;    /**< Total chunk count inside all slabs. */
+	size_t usedCount = 0;   /**< Allocated (in use) chunk count. */
+	size_t freeCount = 0;   /**< Free chunk count inside the pool free list. */
+	size_t cachedCount = 0; /**< Free chunk count inside the local caches. */
+	size_t memorySize = 0;  /**< Total slab memory size in bytes. */
+	size_t hugeSlabCount = 0; /**< Slab count backed by the huge pages. */
+};
+
+/***********************************************************************************************************************
+ * @brief Thread-safe fixed size chunk allocator.
+ *
+ * @details
+ * Allocated chunks are regular chunk pointers, so they can be used inside the cluster directly.
+ * Use @ref ChunkPool::LocalCache inside each worker thread to allocate chunks without locking.
+ *
+ * @tparam C pool chunk type
+ */
+template<class C>
+class ChunkPool
+{
+public:
+	/**
+	 * @brief Pool chunk type.
+	 */
+	typedef C Chunk;
+	class LocalCache;
+
+	/**
+	 * @brief Huge memory page size in bytes. (2MB)
+	 */
+	static constexpr size_t hugePageSize = 2 * 1024 * 1024;
+protected:
+	union Slot
+	{
+		Slot* next;
+		alignas(C) uint8_t data[sizeof(C)];
+	};
+	struct Slab
+	{
+		void* memory;
+		size_t size;
+		bool isMapped;
+		bool isHuge;
+	};
+
+	std::vector<Slab> slabs;
+	std::mutex mutex;
+	Slot* freeSlot = nullptr;
+	size_t slabSize = 0;
+	size_t freeCount = 0;
+	std::vector<LocalCache*> caches;
+	bool useHugePages = false;
+
+	static void* allocateMemory(size_t size, bool useHugePages, bool& isMapped, bool& isHuge) noexcept
+	{
+		isMapped = isHuge = false;
+		if (useHugePages)
+		{
+			#if defined(_WIN32)
+			isMapped = isHuge = true;
+			auto memory = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if (memory)
+				return memory;
+			isHuge = false;
+			return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+			#elif defined(__unix__) || defined(__APPLE__)
+			auto memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (memory == MAP_FAILED)
+				return nullptr;
+			isMapped = true;
+			#if defined(MADV_HUGEPAGE)
+			isHuge = madvise(memory, size, MADV_HUGEPAGE) == 0;
+			#endif
+			return memory;
+			#endif
+		}
+		return ::operator new(size, std::align_val_t(alignof(Slot)), std::nothrow);
+	}
+	static void freeMemory(const Slab& slab) noexcept
+	{
+		VOXY_STATS_MEMORY(pool, -(int64_t)slab.size);
+		if (slab.isMapped)
+		{
+			#if defined(_WIN32)
+			VirtualFree(slab.memory, 0, MEM_RELEASE);
+			#elif defined(__unix__) || defined(__APPLE__)
+			munmap(slab.memory, slab.size);
+			#endif
+			return;
+		}
+		::operator delete(slab.memory, std::align_val_t(alignof(Slot)));
+	}
+
+	Slot* allocateSlab()
+	{
+		auto size = slabSize * sizeof(Slot);
+		bool isMapped, isHuge;
+		auto memory = allocateMemory(size, useHugePages, isMapped, isHuge);
+		if (!memory)
+			throw std::bad_alloc();
+		slabs.push_back({ memory, size, isMapped, isHuge });
+		VOXY_STATS_MEMORY(pool, size);
+
+		auto slab = (Slot*)memory;
+		for (size_t i = 0; i < slabSize - 1; i++)
+			slab[i].next = slab + i + 1;
+		slab[slabSize - 1].next = nullptr;
+		return slab;
+	}
+	Slot* popSlots(size_t count, size_t& popCount)
+	{
+		if (!freeSlot)
+		{
+			freeSlot = allocateSlab();
+			freeCount += slabSize;
+		}
+
+		auto first = freeSlot, last = freeSlot;
+		popCount = 1;
+		while (popCount < count && last->next)
+		{
+			last = last->next;
+			popCount++;
+		}
+
+		freeSlot = last->next;
+		last->next = nullptr;
+		freeCount -= popCount;
+		return first;
+	}
+public:
+	/*******************************************************************************************************************
+	 * @brief Per-thread chunk free list.
+	 *
+	 * @details
+	 * It takes free chunks from the pool in batches, so most allocations are lock-free.
+	 * Cached chunks are returned to the pool on destruction.
+	 *
+	 * @note It is not thread-safe, use one cache per thread!
+	 */
+	class LocalCache
+	{
+		ChunkPool* pool = nullptr;
+		Slot* freeSlot = nullptr;
+		Slot* batchSlot = nullptr;
+		std::atomic<size_t> freeCount = 0;
+		size_t batchSize = 0;
+
+		void flush(size_t count) noexcept
+		{
+			if (count == 0)
+				return;
+			auto first = freeSlot, last = batchSlot;
+			if (!last || count != batchSize)
+			{
+				last = freeSlot;
+				for (size_t i = 1; i < count; i++)
+					last = last->next;
+			}
+			freeSlot = last->next;
+			batchSlot = nullptr;
+
+			std::lock_guard lock(pool->mutex);
+			last->next = pool->freeSlot;
+			pool->freeSlot = first;
+			pool->freeCount += count;
+			freeCount.store(freeCount.load(std::memory_order_relaxed) - count, std::memory_order_relaxed);
+		}
+	public:
+		/**
+		 * @brief Creates a new pool local cache.
+		 *
+		 * @param[in] pool target chunk pool
+		 * @param batchSize free chunk count to take from the pool at once
+		 */
+		LocalCache(ChunkPool& pool, size_t batchSize = 16) : pool(&pool), batchSize(batchSize)
+		{
+			assert(batchSize > 0);
+			std::lock_guard lock(pool.mutex);
+			pool.caches.push_back(this);
+		}
+		/**
+		 * @brief Returns all cached chunks to the pool.
+		 */
+		~LocalCache()
+		{
+			flush(freeCount.load(std::memory_order_relaxed));
+			std::lock_guard lock(pool->mutex);
+			auto& caches = pool->caches;
+			for (size_t i = 0; i < caches.size(); i++)
+			{
+				if (caches[i] != this)
+					continue;
+				caches[i] = caches.back();
+				caches.pop_back();
+				break;
+			}
+		}
+
+		LocalCache(const LocalCache&) = delete;
+		LocalCache& operator=(const LocalCache&) = delete;
+
+		/**
+		 * @brief Returns cached free chunk count.
+		 */
+		size_t getFreeCount() const noexcept { return freeCount.load(std::memory_order_relaxed); }
+
+		/**
+		 * @brief Allocates a new default constructed chunk.
+		 * @note @ref Chunk3 may contain garbage voxels.
+		 */
+		C* allocate()
+		{
+			auto count = freeCount.load(std::memory_order_relaxed);
+			if (!freeSlot)
+			{
+				std::lock_guard lock(pool->mutex);
+				freeSlot = pool->popSlots(batchSize, count);
+			}
+
+			auto slot = freeSlot;
+			freeSlot = slot->next;
+			batchSlot = nullptr;
+			freeCount.store(count - 1, std::memory_order_relaxed);
+			VOXY_STATS_COUNT(poolAllocate);
+			return new (slot->data) C;
+		}
+		/**
+		 * @brief Destroys chunk and returns its memory to the cache.
+		 * @param[in] chunk target chunk allocated from the same pool
+		 */
+		void deallocate(C* chunk) noexcept
+		{
+			assert(chunk);
+			VOXY_STATS_COUNT(poolFree);
+			chunk->~C();
+			auto slot = (Slot*)chunk;
+			slot->next = freeSlot;
+			freeSlot = slot;
+
+			auto count = freeCount.load(std::memory_order_relaxed) + 1;
+			freeCount.store(count, std::memory_order_relaxed);
+			if (count == batchSize + 1)
+				batchSlot = slot;
+			if (count >= batchSize * 2)
+				flush(batchSize);
+		}
+	};
+
+	/**
+	 * @brief Creates a new chunk pool.
+	 * @details With huge pages, slab size is rounded up to fill whole 2MB pages.
+	 *
+	 * @param slabSize chunk count inside one slab
+	 * @param useHugePages use huge memory pages for slabs if supported by the system
+	 */
+	ChunkPool(size_t slabSize = 64, bool useHugePages = false) noexcept : slabSize(slabSize), useHugePages(useHugePages)
+	{
+		assert(slabSize > 0);
+		#if defined(_WIN32) || defined(__unix__) || defined(__APPLE__)
+		if (useHugePages)
+		{
+			auto size = (slabSize * sizeof(Slot) + hugePageSize - 1) / hugePageSize * hugePageSize;
+			this->slabSize = size / sizeof(Slot);
+		}
+		#endif
+	}
+	/**
+	 * @brief Frees all slab memory.
+	 * @note Allocated chunks are not destroyed, deallocate them before!
+	 */
+	~ChunkPool()
+	{
+		assert(caches.empty());
+		for (const auto& slab : slabs)
+			freeMemory(slab);
+	}
+
+	ChunkPool(const ChunkPool&) = delete;
+	ChunkPool& operator=(const ChunkPool&) = delete;
+
+	/**
+	 * @brief Returns chunk count inside one slab.
+	 */
+	size_t getSlabSize() const noexcept { return slabSize; }
+
+	/**
+	 * @brief Allocates a new default constructed chunk.
+	 * @note @ref Chunk3 may contain garbage voxels.
+	 */
+	C* allocate()
+	{
+		Slot* slot;
+		{
+			std::lock_guard lock(mutex);
+			size_t count;
+			slot = popSlots(1, count);
+		}
+		VOXY_STATS_COUNT(poolAllocate);
+		return new (slot->data) C;
+	}
+	/**
+	 * @brief Allocates a new copy constructed chunk.
+	 * @param[in] chunk source chunk to copy
+	 */
+	C* allocate(const C& chunk)
+	{
+		Slot* slot;
+		{
+			std::lock_guard lock(mutex);
+			size_t count;
+			slot = popSlots(1, count);
+		}
+		VOXY_STATS_COUNT(poolAllocate);
+		return new (slot->data) C(chunk);
+	}
+	/**
+	 * @brief Destroys chunk and returns its memory to the pool.
+	 * @param[in] chunk target chunk allocated from this pool
+	 */
+	void deallocate(C* chunk) noexcept
+	{
+		assert(chunk);
+		VOXY_STATS_COUNT(poolFree);
+		chunk->~C();
+		auto slot = (Slot*)chunk;
+		std::lock_guard lock(mutex);
+		slot->next = freeSlot;
+		freeSlot = slot;
+		freeCount++;
+	}
+
+	/**
+	 * @brief Preallocates slabs for the specified free chunk count.
+	 * @param chunkCount target free chunk count
+	 */
+	void reserve(size_t chunkCount)
+	{
+		std::lock_guard lock(mutex);
+		while (freeCount < chunkCount)
+		{
+			auto slab = allocateSlab();
+			slab[slabSize - 1].next = freeSlot;
+			freeSlot = slab;
+			freeCount += slabSize;
+		}
+	}
+
+	/**
+	 * @brief Returns pool occupancy statistics.
+	 */
+	PoolStats getStats() noexcept
+	{
+		std::lock_guard lock(mutex);
+		PoolStats stats;
+		stats.slabCount = slabs.size();
+		stats.capacity = slabs.size() * slabSize;
+		stats.freeCount = freeCount;
+		for (auto cache : caches)
+			stats.cachedCount += cache->getFreeCount();
+		stats.usedCount = stats.capacity - stats.freeCount - stats.cachedCount;
+		for (const auto& slab : slabs)
+		{
+			stats.memorySize += slab.size;
+			stats.hugeSlabCount += slab.isHuge;
+		}
+		return stats;
+	}
+};
+
+};
\ No newline at end of file
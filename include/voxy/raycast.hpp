@@ -0,0 +1,367 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Voxel raycasting (Amanatides-Woo DDA) functions.
+ *
+ * @details
+ * World raycast walks the chunk grid with the outer DDA and voxels of each visited chunk with the inner DDA,
+ * so the chunk is looked up only once per chunk crossing. Not created chunks and uniform chunks without solid
+ * voxels are skipped in one step. Voxel (x, y, z) occupies the [x, x + 1) range along each axis.
+ */
+
+#pragma once
+#include "voxy/world.hpp"
+
+#include <cmath>
+#include <type_traits>
+
+namespace voxy
+{
+
+/**
+ * @brief Ray to cast through the voxels.
+ * @details Direction should be normalized to measure distance in voxels.
+ */
+struct Ray
+{
+	float originX = 0.0f, originY = 0.0f, originZ = 0.0f;          /**< Ray origin position. */
+	float directionX = 0.0f, directionY = 0.0f, directionZ = 0.0f; /**< Ray direction vector. */
+	float maxDistance = INFINITY;                                   /**< Maximum ray travel distance. */
+};
+
+/**
+ * @brief Raycast hit information.
+ * @tparam V voxel ID type
+ */
+template<typename V>
+struct RayHit
+{
+	int32_t x = 0, y = 0, z = 0;                     /**< Hit voxel position. */
+	float distance = INFINITY;                       /**< Ray distance to the hit point, or infinity if missed. */
+	int8_t normalX = 0, normalY = 0, normalZ = 0;    /**< Hit face normal, zero if ray starts inside voxel. */
+	V voxel = voxel::null;                           /**< Hit voxel ID. */
+};
+
+/**
+ * @brief Returns true if chunk has the uniform value interface. (@ref UniformChunk3)
+ */
+template<class C, class = void>
+struct hasUniformValue : std::false_type { };
+template<class C>
+struct hasUniformValue<C, std::void_t<decltype(std::declval<const C&>().isUniform()),
+	decltype(std::declval<const C&>().getValue())>> : std::true_type { };
+
+/**
+ * @brief Returns true if chunk has the voxel occupancy interface. (@ref OccupancyChunk3)
+ */
+template<class C, class = void>
+struct hasOccupancy : std::false_type { };
+template<class C>
+struct hasOccupancy<C, std::void_t<decltype(std::declval<const C&>().isEmpty()),
+	decltype(std::declval<const C&>().countOccupied())>> : std::true_type { };
+
+/**
+ * @brief Casts ray through the chunk voxels from the start to the end distance.
+ * @details Ray position at the start distance should be inside the chunk bounds.
+ * @return True if solid voxel is hit, otherwise false.
+ *
+ * @param[in] chunk target chunk
+ * @param[in] ray target ray (origin is relative to the chunk)
+ * @param start ray start distance
+ * @param end ray end distance
+ * @param entryAxis axis of the face ray entered through at the start distance, or -1
+ * @param[out] hit ray hit information (position is relative to the chunk)
+ * @param isSolid solid voxel predicate
+ */
+template<class C, typename F>
+static bool raycastVoxels(const C& chunk, const Ray& ray, float start, float end,
+	int8_t entryAxis, RayHit<typename C::Voxel>& hit, const F& isSolid) noexcept
+{
+	const float origin[3] = { ray.originX, ray.originY, ray.originZ };
+	const float direction[3] = { ray.directionX, ray.directionY, ray.directionZ };
+	const int32_t size[3] = { C::sizeX, C::sizeY, C::sizeZ };
+	int32_t pos[3], step[3];
+	float tMax[3], tDelta[3];
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		auto value = (int32_t)std::floor(origin[i] + direction[i] * start);
+		pos[i] = value < 0 ? 0 : (value >= size[i] ? size[i] - 1 : value);
+		if (direction[i] > 0.0f)
+		{
+			step[i] = 1; tDelta[i] = 1.0f / direction[i];
+			tMax[i] = ((float)pos[i] + 1.0f - origin[i]) / direction[i];
+		}
+		else if (direction[i] < 0.0f)
+		{
+			step[i] = -1; tDelta[i] = -1.0f / direction[i];
+			tMax[i] = ((float)pos[i] - origin[i]) / direction[i];
+		}
+		else
+		{
+			step[i] = 0; tDelta[i] = tMax[i] = INFINITY;
+		}
+	}
+
+	auto distance = start;
+	auto axis = entryAxis;
+	while (true)
+	{
+		auto voxel = chunk.get((uint8_t)pos[0], (uint8_t)pos[1], (uint8_t)pos[2]);
+		if (isSolid(voxel))
+		{
+			hit.x = pos[0]; hit.y = pos[1]; hit.z = pos[2];
+			hit.distance = distance;
+			hit.normalX = axis == 0 ? (int8_t)-step[0] : 0;
+			hit.normalY = axis == 1 ? (int8_t)-step[1] : 0;
+			hit.normalZ = axis == 2 ? (int8_t)-step[2] : 0;
+			hit.voxel = voxel;
+			return true;
+		}
+
+		axis = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+		if (tMax[axis] > end)
+			return false;
+		pos[axis] += step[axis];
+		if ((uint32_t)pos[axis] >= (uint32_t)size[axis])
+			return false;
+		distance = tMax[axis];
+		tMax[axis] += tDelta[axis];
+	}
+}
+
+/***********************************************************************************************************************
+ * @brief Casts ray through the chunk voxels.
+ * @return True if solid voxel is hit, otherwise false.
+ *
+ * @param[in] chunk target chunk
+ * @param[in] ray target ray (origin is relative to the chunk, can be outside it)
+ * @param[out] hit ray hit information (position is relative to the chunk)
+ * @param isSolid solid voxel predicate, signature: bool(Voxel voxel)
+ */
+template<class C, typename F = IsNotNullVoxel>
+static bool raycastChunk(const C& chunk, const Ray& ray,
+	RayHit<typename C::Voxel>& hit, const F& isSolid = F()) noexcept
+{
+	assert(ray.directionX != 0.0f || ray.directionY != 0.0f || ray.directionZ != 0.0f);
+	const float origin[3] = { ray.originX, ray.originY, ray.originZ };
+	const float direction[3] = { ray.directionX, ray.directionY, ray.directionZ };
+	const float size[3] = { C::sizeX, C::sizeY, C::sizeZ };
+	float start = 0.0f, end = ray.maxDistance;
+	int8_t entryAxis = -1;
+	hit.distance = INFINITY;
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		if (direction[i] == 0.0f)
+		{
+			if (origin[i] < 0.0f || origin[i] >= size[i])
+				return false;
+			continue;
+		}
+
+		auto t0 = (0.0f - origin[i]) / direction[i], t1 = (size[i] - origin[i]) / direction[i];
+		if (t0 > t1)
+			std::swap(t0, t1);
+		if (t0 > start)
+		{
+			start = t0;
+			entryAxis = (int8_t)i;
+		}
+		end = std::min(end, t1);
+	}
+
+	if (start > end)
+		return false;
+	return raycastVoxels(chunk, ray, start, end, entryAxis, hit, isSolid);
+}
+
+/**
+ * @brief Casts ray through the world chunks using specified chunk lookup function.
+ * @details Lookup function signature: const C*(int32_t x, int32_t y, int32_t z)
+ * @return True if solid voxel is hit, otherwise false.
+ * @note Ray max distance should be finite, not created chunks are skipped until it.
+ *
+ * @param[in] ray target ray (world space)
+ * @param[out] hit ray hit information (world voxel position)
+ * @param getChunk chunk lookup function
+ * @param isSolid solid voxel predicate, signature: bool(Voxel voxel)
+ */
+template<class C, typename G, typename F>
+static bool raycastChunks(const Ray& ray, RayHit<typename C::Voxel>& hit, G&& getChunk, const F& isSolid) noexcept
+{
+	assert(ray.directionX != 0.0f || ray.directionY != 0.0f || ray.directionZ != 0.0f);
+	assert(std::isfinite(ray.maxDistance));
+	const float origin[3] = { ray.originX, ray.originY, ray.originZ };
+	const float direction[3] = { ray.directionX, ray.directionY, ray.directionZ };
+	const int32_t size[3] = { C::sizeX, C::sizeY, C::sizeZ };
+	int32_t pos[3], step[3];
+	float tMax[3], tDelta[3];
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		pos[i] = (int32_t)std::floor(origin[i] / (float)size[i]);
+		if (direction[i] > 0.0f)
+		{
+			step[i] = 1; tDelta[i] = (float)size[i] / direction[i];
+			tMax[i] = ((float)(pos[i] + 1) * size[i] - origin[i]) / direction[i];
+		}
+		else if (direction[i] < 0.0f)
+		{
+			step[i] = -1; tDelta[i] = (float)size[i] / -direction[i];
+			tMax[i] = ((float)pos[i] * size[i] - origin[i]) / direction[i];
+		}
+		else
+		{
+			step[i] = 0; tDelta[i] = tMax[i] = INFINITY;
+		}
+	}
+
+	float distance = 0.0f;
+	int8_t axis = -1;
+	while (distance <= ray.maxDistance)
+	{
+		auto exit = std::min(std::min(tMax[0], tMax[1]), std::min(tMax[2], ray.maxDistance));
+		const C* chunk = getChunk(pos[0], pos[1], pos[2]);
+
+		bool isSkipped = !chunk;
+		if constexpr (hasUniformValue<C>::value)
+			isSkipped = isSkipped || (chunk->isUniform() && !isSolid(chunk->getValue()));
+		if constexpr (hasOccupancy<C>::value && std::is_same_v<F, IsNotNullVoxel>)
+			isSkipped = isSkipped || chunk->isEmpty();
+
+		if (!isSkipped)
+		{
+			auto chunkX = pos[0] * size[0], chunkY = pos[1] * size[1], chunkZ = pos[2] * size[2];
+			Ray localRay = ray;
+			localRay.originX -= (float)chunkX; localRay.originY -= (float)chunkY; localRay.originZ -= (float)chunkZ;
+			if (raycastVoxels(*chunk, localRay, distance, exit, axis, hit, isSolid))
+			{
+				hit.x += chunkX; hit.y += chunkY; hit.z += chunkZ;
+				return true;
+			}
+		}
+
+		axis = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+		if (tMax[axis] == INFINITY)
+			break;
+		pos[axis] += step[axis];
+		distance = tMax[axis];
+		tMax[axis] += tDelta[axis];
+	}
+
+	hit.distance = INFINITY;
+	return false;
+}
+
+/**
+ * @brief Casts ray through the chunk cluster.
+ * @return True if solid voxel is hit, otherwise false.
+ *
+ * @param[in] cluster target full chunk cluster
+ * @param[in] ray target ray (origin is relative to the central chunk, inside the cluster)
+ * @param[out] hit ray hit information (position is relative to the central chunk)
+ * @param isSolid solid voxel predicate, signature: bool(Voxel voxel)
+ */
+template<class C, typename V, typename F = IsNotNullVoxel>
+static bool raycastCluster(const Cluster27<C, V>& cluster, const Ray& ray,
+	RayHit<V>& hit, const F& isSolid = F()) noexcept
+{
+	const float origin[3] = { ray.originX, ray.originY, ray.originZ };
+	const float direction[3] = { ray.directionX, ray.directionY, ray.directionZ };
+	const float size[3] = { C::sizeX, C::sizeY, C::sizeZ };
+	auto clusterRay = ray;
+
+	for (uint8_t i = 0; i < 3; i++)
+	{
+		assert(origin[i] >= -size[i] && origin[i] < size[i] * 2.0f);
+		if (direction[i] > 0.0f)
+			clusterRay.maxDistance = std::min(clusterRay.maxDistance, (size[i] * 2.0f - origin[i]) / direction[i]);
+		else if (direction[i] < 0.0f)
+			clusterRay.maxDistance = std::min(clusterRay.maxDistance, (-size[i] - origin[i]) / direction[i]);
+	}
+
+	return raycastChunks<C>(clusterRay, hit, [&](int32_t x, int32_t y, int32_t z) -> const C*
+	{
+		if (x < -1 || x > 1 || y < -1 || y > 1 || z < -1 || z > 1)
+			return nullptr;
+		return cluster.getChunk((int8_t)x, (int8_t)y, (int8_t)z);
+	}, isSolid);
+}
+
+/**
+ * @brief Casts ray through the world chunks.
+ * @return True if solid voxel is hit, otherwise false.
+ * @note Ray max distance should be finite.
+ *
+ * @param[in] world target world (@ref World3)
+ * @param[in] ray target ray (world space)
+ * @param[out] hit ray hit information (world voxel position)
+ * @param isSolid solid voxel predicate, signature: bool(Voxel voxel)
+ */
+template<class W, typename F = IsNotNullVoxel>
+static bool raycastWorld(const W& world, const Ray& ray,
+	RayHit<typename W::Voxel>& hit, const F& isSolid = F()) noexcept
+{
+	return raycastChunks<typename W::Chunk>(ray, hit, [&](int32_t x, int32_t y, int32_t z)
+	{
+		return world.getChunk(x, y, z);
+	}, isSolid);
+}
+
+/**
+ * @brief Casts multiple rays through the world chunks.
+ * @details Last looked up chunks are cached between the rays, so nearby rays share the hash table lookups.
+ * @return Ray hit count. (missed rays have infinite hit distance)
+ * @note Ray max distances should be finite.
+ *
+ * @param[in] world target world (@ref World3)
+ * @param[in] rays target ray array (world space)
+ * @param rayCount ray array size
+ * @param[out] hits ray hit information array (world voxel position)
+ * @param isSolid solid voxel predicate, signature: bool(Voxel voxel)
+ */
+template<class W, typename F = IsNotNullVoxel>
+static size_t raycastWorld(const W& world, const Ray* rays, size_t rayCount,
+	RayHit<typename W::Voxel>* hits, const F& isSolid = F()) noexcept
+{
+	assert(rays || rayCount == 0);
+	assert(hits || rayCount == 0);
+	typedef typename W::Chunk Chunk;
+
+	struct CacheEntry
+	{
+		int32_t x = INT32_MIN, y = INT32_MIN, z = INT32_MIN;
+		const Chunk* chunk = nullptr;
+	};
+	constexpr uint8_t cacheSize = 16;
+	CacheEntry cache[cacheSize];
+
+	auto getChunk = [&](int32_t x, int32_t y, int32_t z)
+	{
+		auto& entry = cache[hashChunkPos(x, y, z) & (cacheSize - 1)];
+		if (entry.x != x || entry.y != y || entry.z != z)
+			entry = { x, y, z, world.getChunk(x, y, z) };
+		return entry.chunk;
+	};
+
+	size_t hitCount = 0;
+	for (size_t i = 0; i < rayCount; i++)
+		hitCount += raycastChunks<Chunk>(rays[i], hits[i], getChunk, isSolid);
+	return hitCount;
+}
+
+};
\ No newline at end of file
@@ -0,0 +1,528 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Chunk region file functions.
+ *
+ * @details
+ * Region file stores RxRxR chunks in one file: 16 byte header, chunk offset table and serialized chunk data.
+ *   header - magic (4 bytes, "VOXR"), version, region size, voxel size, layout ID, chunk size X, Y, Z, reserved.
+ *   table  - R^3 entries (z * R * R + y * R + x): data offset (8 bytes), data size (4 bytes), type, reserved.
+ *
+ * Uniform chunks are stored inside the table entry (voxel ID in the offset field) without any data.
+ * Other chunks are stored in the @ref serialize.hpp format, raw voxel arrays are 16 byte aligned,
+ * so they can be accessed directly from the memory mapped file.
+ */
+
+#pragma once
+#include "voxy/serialize.hpp"
+#include <vector>
+#include <cstdio>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace voxy::region
+{
+
+/**
+ * @brief Region file format magic number. ("VOXR")
+ */
+constexpr uint32_t magic = 0x52584F56;
+/**
+ * @brief Region file format version.
+ */
+constexpr uint8_t version = 1;
+/**
+ * @brief Region file header size in bytes.
+ */
+constexpr size_t headerSize = 16;
+/**
+ * @brief Raw chunk voxel array alignment inside region file in bytes.
+ */
+constexpr size_t dataAlignment = 16;
+
+/**
+ * @brief Region chunk table entry type.
+ */
+enum class EntryType : uint8_t
+{
+	missing, /**< Chunk is not stored. */
+	data,    /**< Chunk is stored as serialized data. */
+	uniform, /**< Chunk is filled with one voxel ID. */
+	count    /**< Region entry type count. */
+};
+
+/**
+ * @brief Region chunk table entry.
+ */
+struct Entry
+{
+	uint64_t offset = 0;  /**< Chunk data offset in bytes, or uniform chunk voxel ID. */
+	uint32_t size = 0;    /**< Chunk data size in bytes. */
+	EntryType type = {};  /**< Chunk entry type. */
+	uint8_t _reserved[3] = {}; /**< Reserved for future use. (zero) */
+};
+
+static_assert(sizeof(Entry) == 16, "Region table entry should be 16 bytes");
+
+/**
+ * @brief Calculates region chunk table index from the region local chunk position.
+ *
+ * @tparam R region size in chunks along each axis
+ * @param x chunk position along X-axis inside region
+ * @param y chunk position along Y-axis inside region
+ * @param z chunk position along Z-axis inside region
+ */
+template<uint8_t R>
+static constexpr size_t posToIndex(uint8_t x, uint8_t y, uint8_t z) noexcept
+{
+	return ((size_t)z * R + y) * R + x;
+}
+
+/**
+ * @brief Writes region file header for specified chunk type.
+ *
+ * @tparam C region chunk type
+ * @param[out] header destination header buffer (at least @ref headerSize bytes)
+ * @param regionSize region size in chunks along each axis
+ */
+template<class C>
+static void writeHeader(uint8_t* header, uint8_t regionSize) noexcept
+{
+	header[0] = (uint8_t)magic; header[1] = (uint8_t)(magic >> 8);
+	header[2] = (uint8_t)(magic >> 16); header[3] = (uint8_t)(magic >> 24);
+	header[4] = version; header[5] = regionSize;
+	header[6] = (uint8_t)sizeof(typename C::Voxel); header[7] = C::Layout::id;
+	header[8] = C::sizeX; header[9] = C::sizeY; header[10] = C::sizeZ;
+	memset(header + 11, 0, headerSize - 11);
+}
+
+/***********************************************************************************************************************
+ * @brief Region file writer.
+ *
+ * @details
+ * Chunk data is appended to the file sequentially and the offset table is written on close.
+ * Writing the same chunk again replaces its table entry, but previous data stays inside the file.
+ *
+ * @tparam C region chunk type (@ref Chunk3)
+ * @tparam R region size in chunks along each axis
+ */
+template<class C, uint8_t R = 32>
+class Writer
+{
+public:
+	/**
+	 * @brief Region chunk type.
+	 */
+	typedef C Chunk;
+	/**
+	 * @brief Chunk voxel ID type.
+	 */
+	typedef typename C::Voxel Voxel;
+	/**
+	 * @brief Region size in chunks along each axis.
+	 */
+	static constexpr uint8_t regionSize = R;
+	/**
+	 * @brief Region chunk count. (R * R * R)
+	 */
+	static constexpr size_t chunkCount = (size_t)R * R * R;
+	/**
+	 * @brief Chunk data start offset inside the file in bytes.
+	 */
+	static constexpr size_t dataOffset = headerSize + chunkCount * sizeof(Entry);
+protected:
+	std::vector<Entry> entries;
+	FILE* file = nullptr;
+	uint64_t fileSize = 0;
+
+	bool writeData(const void* data, size_t size) noexcept
+	{
+		if (fwrite(data, 1, size, file) != size)
+			return false;
+		fileSize += size;
+		return true;
+	}
+public:
+	/**
+	 * @brief Creates a new region file writer.
+	 * @note Use @ref Writer::isOpen to check if file is created.
+	 * @param[in] path target region file path
+	 */
+	Writer(const char* path) : entries(chunkCount)
+	{
+		assert(path);
+		file = fopen(path, "wb");
+		if (!file)
+			return;
+
+		uint8_t header[headerSize];
+		writeHeader<C>(header, R);
+		if (!writeData(header, headerSize) || !writeData(entries.data(), chunkCount * sizeof(Entry)))
+		{
+			fclose(file);
+			file = nullptr;
+		}
+	}
+	/**
+	 * @brief Writes offset table and closes region file.
+	 */
+	~Writer() { close(); }
+
+	Writer(const Writer&) = delete;
+	Writer& operator=(const Writer&) = delete;
+
+	/**
+	 * @brief Returns true if region file is open for writing.
+	 */
+	bool isOpen() const noexcept { return file; }
+
+	/**
+	 * @brief Writes uniform chunk entry.
+	 * @return True on success, otherwise false.
+	 *
+	 * @param x chunk position along X-axis inside region
+	 * @param y chunk position along Y-axis inside region
+	 * @param z chunk position along Z-axis inside region
+	 * @param voxel uniform chunk voxel ID
+	 */
+	bool writeUniform(uint8_t x, uint8_t y, uint8_t z, Voxel voxel) noexcept
+	{
+		assert(x < R && y < R && z < R);
+		if (!file)
+			return false;
+
+		Entry entry;
+		memcpy(&entry.offset, &voxel, sizeof(Voxel));
+		entry.type = EntryType::uniform;
+		entries[posToIndex<R>(x, y, z)] = entry;
+		return true;
+	}
+	/**
+	 * @brief Serializes and writes chunk to the region file.
+	 * @details Chunks filled with one voxel ID are written as uniform entries.
+	 * @return True on success, otherwise false.
+	 *
+	 * @param x chunk position along X-axis inside region
+	 * @param y chunk position along Y-axis inside region
+	 * @param z chunk position along Z-axis inside region
+	 * @param[in] chunk target chunk to write
+	 * @param encoding chunk payload encoding
+	 */
+	bool write(uint8_t x, uint8_t y, uint8_t z, const C& chunk,
+		serial::Encoding encoding = serial::Encoding::smallest) noexcept
+	{
+		assert(x < R && y < R && z < R);
+		if (!file)
+			return false;
+
+		auto firstVoxel = chunk.get(0);
+		if (chunk.count(firstVoxel) == C::size)
+			return writeUniform(x, y, z, firstVoxel);
+
+		auto padding = (size_t)((dataAlignment - (fileSize + serial::headerSize) % dataAlignment) % dataAlignment);
+		uint8_t buffer[4096] = {};
+		if (padding > 0 && !writeData(buffer, padding))
+			return false;
+
+		serial::Encoder<C> encoder(chunk, encoding);
+		Entry entry;
+		entry.offset = fileSize;
+		entry.size = (uint32_t)encoder.getEncodedSize();
+		entry.type = EntryType::data;
+
+		while (!encoder.isDone())
+		{
+			auto size = encoder.write(buffer, sizeof(buffer));
+			if (!writeData(buffer, size))
+				return false;
+		}
+
+		entries[posToIndex<R>(x, y, z)] = entry;
+		return true;
+	}
+
+	/**
+	 * @brief Writes offset table and closes region file.
+	 * @return True on success, otherwise false.
+	 */
+	bool close() noexcept
+	{
+		if (!file)
+			return false;
+
+		auto result = fseek(file, (long)headerSize, SEEK_SET) == 0 &&
+			fwrite(entries.data(), sizeof(Entry), chunkCount, file) == chunkCount;
+		result &= fclose(file) == 0;
+		file = nullptr;
+		return result;
+	}
+};
+
+/***********************************************************************************************************************
+ * @brief Memory mapped region file reader.
+ *
+ * @details
+ * File is mapped once on open, chunks are decoded on demand directly from the mapped memory.
+ * Uniform chunks and raw voxel arrays can be accessed without decoding or copying.
+ *
+ * @tparam C region chunk type (@ref Chunk3)
+ * @tparam R region size in chunks along each axis
+ */
+template<class C, uint8_t R = 32>
+class Reader
+{
+public:
+	/**
+	 * @brief Region chunk type.
+	 */
+	typedef C Chunk;
+	/**
+	 * @brief Chunk voxel ID type.
+	 */
+	typedef typename C::Voxel Voxel;
+	/**
+	 * @brief Region size in chunks along each axis.
+	 */
+	static constexpr uint8_t regionSize = R;
+	/**
+	 * @brief Region chunk count. (R * R * R)
+	 */
+	static constexpr size_t chunkCount = (size_t)R * R * R;
+protected:
+	const uint8_t* data = nullptr;
+	const Entry* entries = nullptr;
+	size_t dataSize = 0;
+	#if defined(_WIN32)
+	HANDLE fileHandle = INVALID_HANDLE_VALUE;
+	HANDLE mappingHandle = nullptr;
+	#endif
+
+	bool map(const char* path) noexcept
+	{
+		#if defined(_WIN32)
+		fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE)
+			return false;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+			return false;
+		mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mappingHandle)
+			return false;
+		data = (const uint8_t*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+		dataSize = (size_t)fileSize.QuadPart;
+		return data;
+		#elif defined(__unix__) || defined(__APPLE__)
+		auto file = ::open(path, O_RDONLY);
+		if (file == -1)
+			return false;
+		struct stat fileStat;
+		if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0)
+		{
+			::close(file);
+			return false;
+		}
+		auto memory = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		::close(file);
+		if (memory == MAP_FAILED)
+			return false;
+		data = (const uint8_t*)memory;
+		dataSize = (size_t)fileStat.st_size;
+		return true;
+		#else
+		return false;
+		#endif
+	}
+	void unmap() noexcept
+	{
+		#if defined(_WIN32)
+		if (data)
+			UnmapViewOfFile(data);
+		if (mappingHandle)
+			CloseHandle(mappingHandle);
+		if (fileHandle != INVALID_HANDLE_VALUE)
+			CloseHandle(fileHandle);
+		fileHandle = INVALID_HANDLE_VALUE;
+		mappingHandle = nullptr;
+		#elif defined(__unix__) || defined(__APPLE__)
+		if (data)
+			munmap((void*)data, dataSize);
+		#endif
+		data = nullptr;
+		entries = nullptr;
+		dataSize = 0;
+	}
+	bool validate() const noexcept
+	{
+		if (dataSize < headerSize + chunkCount * sizeof(Entry))
+			return false;
+		uint8_t header[headerSize];
+		writeHeader<C>(header, R);
+		if (memcmp(data, header, headerSize) != 0)
+			return false;
+
+		for (size_t i = 0; i < chunkCount; i++)
+		{
+			const auto& entry = entries[i];
+			if (entry.type >= EntryType::count)
+				return false;
+			if (entry.type == EntryType::data && (entry.size < serial::headerSize ||
+				entry.offset > dataSize || entry.size > dataSize - entry.offset))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	const Entry& getEntry(uint8_t x, uint8_t y, uint8_t z) const noexcept
+	{
+		assert(x < R && y < R && z < R);
+		assert(isOpen());
+		return entries[posToIndex<R>(x, y, z)];
+	}
+public:
+	/**
+	 * @brief Opens and memory maps region file.
+	 * @note Use @ref Reader::isOpen to check if file is opened and valid.
+	 * @param[in] path target region file path
+	 */
+	Reader(const char* path) noexcept
+	{
+		assert(path);
+		if (!map(path))
+		{
+			unmap();
+			return;
+		}
+		entries = (const Entry*)(data + headerSize);
+		if (!validate())
+			unmap();
+	}
+	/**
+	 * @brief Unmaps and closes region file.
+	 */
+	~Reader() { unmap(); }
+
+	Reader(const Reader&) = delete;
+	Reader& operator=(const Reader&) = delete;
+
+	/**
+	 * @brief Returns true if region file is opened and valid.
+	 */
+	bool isOpen() const noexcept { return data; }
+
+	/**
+	 * @brief Returns true if region contains specified chunk.
+	 *
+	 * @param x chunk position along X-axis inside region
+	 * @param y chunk position along Y-axis inside region
+	 * @param z chunk position along Z-axis inside region
+	 */
+	bool hasChunk(uint8_t x, uint8_t y, uint8_t z) const noexcept
+	{
+		return getEntry(x, y, z).type != EntryType::missing;
+	}
+	/**
+	 * @brief Returns true if specified chunk is stored as uniform, and its voxel ID.
+	 *
+	 * @param x chunk position along X-axis inside region
+	 * @param y chunk position along Y-axis inside region
+	 * @param z chunk position along Z-axis inside region
+	 * @param[out] voxel uniform chunk voxel ID
+	 */
+	bool isUniform(uint8_t x, uint8_t y, uint8_t z, Voxel& voxel) const noexcept
+	{
+		const auto& entry = getEntry(x, y, z);
+		if (entry.type != EntryType::uniform)
+			return false;
+		memcpy(&voxel, &entry.offset, sizeof(Voxel));
+		return true;
+	}
+	/**
+	 * @brief Returns serialized chunk data inside the mapped file, or null if chunk is not stored as data.
+	 *
+	 * @param x chunk position along X-axis inside region
+	 * @param y chunk position along Y-axis inside region
+	 * @param z chunk position along Z-axis inside region
+	 * @param[out] size serialized chunk data size in bytes
+	 */
+	const uint8_t* getData(uint8_t x, uint8_t y, uint8_t z, size_t& size) const noexcept
+	{
+		const auto& entry = getEntry(x, y, z);
+		if (entry.type != EntryType::data)
+			return nullptr;
+		size = entry.size;
+		return data + entry.offset;
+	}
+	/**
+	 * @brief Returns raw chunk voxel array inside the mapped file, or null if chunk is not raw encoded.
+	 * @details Returned voxel array has the chunk layout and is valid until reader is destroyed.
+	 *
+	 * @param x chunk position along X-axis inside region
+	 * @param y chunk position along Y-axis inside region
+	 * @param z chunk position along Z-axis inside region
+	 */
+	const Voxel* getRawVoxels(uint8_t x, uint8_t y, uint8_t z) const noexcept
+	{
+		size_t size;
+		auto chunkData = getData(x, y, z, size);
+		if (!chunkData || size != serial::headerSize + C::size * sizeof(Voxel) ||
+			chunkData[5] != (uint8_t)serial::Encoding::raw)
+		{
+			return nullptr;
+		}
+		return (const Voxel*)(chunkData + serial::headerSize);
+	}
+
+	/**
+	 * @brief Reads and decodes specified chunk.
+	 * @return True on success, otherwise false if chunk is missing or data is invalid.
+	 *
+	 * @param x chunk position along X-axis inside region
+	 * @param y chunk position along Y-axis inside region
+	 * @param z chunk position along Z-axis inside region
+	 * @param[out] chunk destination chunk
+	 */
+	bool read(uint8_t x, uint8_t y, uint8_t z, C& chunk) const noexcept
+	{
+		Voxel voxel;
+		if (isUniform(x, y, z, voxel))
+		{
+			chunk.fill(voxel);
+			return true;
+		}
+
+		size_t size;
+		auto chunkData = getData(x, y, z, size);
+		return chunkData && serial::decode(chunkData, size, chunk);
+	}
+};
+
+};
\ No newline at end of file
@@ -0,0 +1,248 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Voxel type property registry.
+ *
+ * @details
+ * Voxel properties are stored in the dense arrays indexed by the voxel ID (structure of arrays), flags are packed
+ * into the bit sets. Whole registry of the 8-bit voxel IDs takes 608 bytes, so it stays in the L1 cache inside
+ * hot meshing, collision and lighting loops. Static voxel sets can be populated at compile time. (constexpr)
+ */
+
+#pragma once
+#include "voxy/voxel.hpp"
+
+#include <cstddef>
+#include <cassert>
+
+namespace voxy
+{
+
+/**
+ * @brief Voxel type properties.
+ */
+struct VoxelProperties
+{
+	bool isSolid = true;        /**< Is voxel blocking movement. (collision) */
+	bool isOpaque = true;       /**< Is voxel hiding nearby faces. (meshing) */
+	bool isTransparent = false; /**< Is voxel rendered in the transparent pass. (glass, water) */
+	uint8_t opacity = 15;       /**< Additional light level decrease through the voxel, 15 for opaque voxels. */
+	uint8_t emission = 0;       /**< Block light level emitted by the voxel. */
+};
+
+/**
+ * @brief Predefined empty (air) voxel properties.
+ */
+constexpr VoxelProperties emptyVoxelProperties = { false, false, false, 0, 0 };
+
+/***********************************************************************************************************************
+ * @brief Voxel type property registry.
+ *
+ * @details
+ * Not registered voxel IDs have the default (solid, opaque) properties, except predefined @ref voxel::null
+ * which is empty. Registry can be passed to the light engine as voxel light properties directly.
+ *
+ * @tparam N voxel ID count (256 for the 8-bit voxels)
+ */
+template<size_t N = 256>
+class alignas(64) VoxelRegistry
+{
+public:
+	/**
+	 * @brief Registry voxel ID count.
+	 */
+	static constexpr size_t capacity = N;
+
+	static_assert(N >= voxel::predefinedCount, "Registry should contain predefined voxels");
+protected:
+	static constexpr size_t wordCount = (N + 63) / 64;
+
+	uint64_t solids[wordCount] = {};
+	uint64_t opaques[wordCount] = {};
+	uint64_t transparents[wordCount] = {};
+	uint8_t opacities[N] = {};
+	uint8_t emissions[N] = {};
+
+	static constexpr bool getBit(const uint64_t* bits, size_t index) noexcept
+	{
+		return bits[index >> 6] >> (index & 63) & 1;
+	}
+	static constexpr void setBit(uint64_t* bits, size_t index, bool value) noexcept
+	{
+		auto mask = (uint64_t)1 << (index & 63);
+		bits[index >> 6] = value ? bits[index >> 6] | mask : bits[index >> 6] & ~mask;
+	}
+public:
+	/**
+	 * @brief Solid voxel predicate of the registry, signature: bool(Voxel voxel)
+	 */
+	struct IsSolid
+	{
+		const VoxelRegistry* registry = nullptr; /**< Target voxel registry. */
+
+		template<typename V>
+		constexpr bool operator()(V voxel) const noexcept { return registry->isSolid(voxel); }
+	};
+	/**
+	 * @brief Opaque voxel predicate of the registry, signature: bool(Voxel voxel)
+	 */
+	struct IsOpaque
+	{
+		const VoxelRegistry* registry = nullptr; /**< Target voxel registry. */
+
+		template<typename V>
+		constexpr bool operator()(V voxel) const noexcept { return registry->isOpaque(voxel); }
+	};
+
+	/**
+	 * @brief Creates a new voxel registry with default properties.
+	 */
+	constexpr VoxelRegistry() noexcept
+	{
+		for (size_t i = 0; i < N; i++)
+			set(i, VoxelProperties());
+		set(voxel::null, emptyVoxelProperties);
+	}
+	/**
+	 * @brief Creates a new voxel registry from the property array.
+	 * @details Array index is the voxel ID, predefined voxels are overwritten too.
+	 *
+	 * @param[in] properties voxel property array
+	 * @param count property array size
+	 */
+	constexpr VoxelRegistry(const VoxelProperties* properties, size_t count) noexcept : VoxelRegistry()
+	{
+		assert(properties || count == 0);
+		assert(count <= N);
+		for (size_t i = 0; i < count; i++)
+			set(i, properties[i]);
+	}
+
+	/**
+	 * @brief Sets voxel type properties.
+	 *
+	 * @param voxel target voxel ID
+	 * @param properties voxel type properties
+	 */
+	constexpr void set(size_t voxel, const VoxelProperties& properties) noexcept
+	{
+		assert(voxel < N);
+		setBit(solids, voxel, properties.isSolid);
+		setBit(opaques, voxel, properties.isOpaque);
+		setBit(transparents, voxel, properties.isTransparent);
+		opacities[voxel] = properties.opacity;
+		emissions[voxel] = properties.emission;
+	}
+	/**
+	 * @brief Returns voxel type properties.
+	 * @param voxel target voxel ID
+	 */
+	constexpr VoxelProperties get(size_t voxel) const noexcept
+	{
+		assert(voxel < N);
+		VoxelProperties properties;
+		properties.isSolid = getBit(solids, voxel);
+		properties.isOpaque = getBit(opaques, voxel);
+		properties.isTransparent = getBit(transparents, voxel);
+		properties.opacity = opacities[voxel];
+		properties.emission = emissions[voxel];
+		return properties;
+	}
+
+	/**
+	 * @brief Returns true if voxel is blocking movement.
+	 * @param voxel target voxel ID
+	 */
+	template<typename V>
+	constexpr bool isSolid(V voxel) const noexcept
+	{
+		assert((size_t)voxel < N);
+		return getBit(solids, (size_t)voxel);
+	}
+	/**
+	 * @brief Returns true if voxel is hiding nearby faces.
+	 * @param voxel target voxel ID
+	 */
+	template<typename V>
+	constexpr bool isOpaque(V voxel) const noexcept
+	{
+		assert((size_t)voxel < N);
+		return getBit(opaques, (size_t)voxel);
+	}
+	/**
+	 * @brief Returns true if voxel is rendered in the transparent pass.
+	 * @param voxel target voxel ID
+	 */
+	template<typename V>
+	constexpr bool isTransparent(V voxel) const noexcept
+	{
+		assert((size_t)voxel < N);
+		return getBit(transparents, (size_t)voxel);
+	}
+	/**
+	 * @brief Returns additional light level decrease through the voxel, 15 or more for opaque voxels.
+	 * @param voxel target voxel ID
+	 */
+	template<typename V>
+	constexpr uint8_t getOpacity(V voxel) const noexcept
+	{
+		assert((size_t)voxel < N);
+		return opacities[(size_t)voxel];
+	}
+	/**
+	 * @brief Returns block light level emitted by the voxel.
+	 * @param voxel target voxel ID
+	 */
+	template<typename V>
+	constexpr uint8_t getEmission(V voxel) const noexcept
+	{
+		assert((size_t)voxel < N);
+		return emissions[(size_t)voxel];
+	}
+
+	/**
+	 * @brief Returns solid voxel bit set. (bit index is the voxel ID)
+	 */
+	constexpr const uint64_t* getSolidBits() const noexcept { return solids; }
+	/**
+	 * @brief Returns opaque voxel bit set. (bit index is the voxel ID)
+	 */
+	constexpr const uint64_t* getOpaqueBits() const noexcept { return opaques; }
+	/**
+	 * @brief Returns transparent voxel bit set. (bit index is the voxel ID)
+	 */
+	constexpr const uint64_t* getTransparentBits() const noexcept { return transparents; }
+	/**
+	 * @brief Returns voxel light opacity array. (index is the voxel ID)
+	 */
+	constexpr const uint8_t* getOpacities() const noexcept { return opacities; }
+	/**
+	 * @brief Returns voxel light emission array. (index is the voxel ID)
+	 */
+	constexpr const uint8_t* getEmissions() const noexcept { return emissions; }
+
+	/**
+	 * @brief Returns solid voxel predicate for the collision functions.
+	 */
+	constexpr IsSolid getSolidPredicate() const noexcept { return { this }; }
+	/**
+	 * @brief Returns opaque voxel predicate for the meshing functions.
+	 */
+	constexpr IsOpaque getOpaquePredicate() const noexcept { return { this }; }
+};
+
+};
\ No newline at end of file
@@ -0,0 +1,354 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Parallel chunk batch processing functions.
+ *
+ * @details
+ * Thread pool keeps a task queue per worker thread, idle workers steal tasks from the other queues.
+ * Batch executor runs a kernel for each chunk of the set, splitting chunks into 8 phases by their
+ * position parity (2x2x2), so kernels of the same phase never touch neighbour chunks of each other.
+ */
+
+#pragma once
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+
+namespace voxy
+{
+
+/***********************************************************************************************************************
+ * @brief Work-stealing thread pool.
+ *
+ * @details
+ * Tasks added from a worker thread go to its own queue, other tasks are distributed round-robin.
+ * Workers take tasks in the queue order, so earlier added tasks are started first.
+ */
+class ThreadPool
+{
+public:
+	/**
+	 * @brief Thread pool task function.
+	 */
+	typedef std::function<void()> Task;
+protected:
+	struct Worker
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+	struct ThreadState
+	{
+		const ThreadPool* pool = nullptr;
+		uint32_t index = UINT32_MAX;
+	};
+
+	std::unique_ptr<Worker[]> workers;
+	std::vector<std::thread> threads;
+	std::mutex sleepMutex;
+	std::condition_variable sleepCondition;
+	std::condition_variable waitCondition;
+	std::atomic<size_t> queuedCount = 0;
+	std::atomic<size_t> pendingCount = 0;
+	std::atomic<uint32_t> nextWorker = 0;
+	uint32_t threadCount = 0;
+	bool isRunning = true;
+
+	static ThreadState& getThreadState() noexcept
+	{
+		static thread_local ThreadState state;
+		return state;
+	}
+	uint32_t getWorkerIndex() const noexcept
+	{
+		const auto& state = getThreadState();
+		return state.pool == this ? state.index : UINT32_MAX;
+	}
+
+	bool popTask(uint32_t index, Task& task)
+	{
+		auto first = index == UINT32_MAX ? 0 : index;
+		for (uint32_t i = 0; i < threadCount; i++)
+		{
+			auto& worker = workers[(first + i) % threadCount];
+			std::lock_guard lock(worker.mutex);
+			if (worker.tasks.empty())
+				continue;
+			task = std::move(worker.tasks.front());
+			worker.tasks.pop_front();
+			queuedCount.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+		return false;
+	}
+	void runTask(Task& task)
+	{
+		task();
+		task = nullptr;
+		if (pendingCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			std::lock_guard lock(sleepMutex);
+			waitCondition.notify_all();
+		}
+	}
+	void runWorker(uint32_t index)
+	{
+		auto& state = getThreadState();
+		state.pool = this;
+		state.index = index;
+
+		while (true)
+		{
+			Task task;
+			if (popTask(index, task))
+			{
+				runTask(task);
+				continue;
+			}
+
+			std::unique_lock lock(sleepMutex);
+			sleepCondition.wait(lock, [this]() { return !isRunning || queuedCount.load() > 0; });
+			if (!isRunning && queuedCount.load() == 0)
+				return;
+		}
+	}
+public:
+	/**
+	 * @brief Creates a new thread pool and starts worker threads.
+	 * @param threadCount worker thread count, or 0 to use hardware thread count
+	 */
+	ThreadPool(uint32_t threadCount = 0)
+	{
+		if (threadCount == 0)
+			threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+		this->threadCount = threadCount;
+		workers = std::make_unique<Worker[]>(threadCount);
+		threads.reserve(threadCount);
+		for (uint32_t i = 0; i < threadCount; i++)
+			threads.emplace_back(&ThreadPool::runWorker, this, i);
+	}
+	/**
+	 * @brief Waits for all tasks and stops worker threads.
+	 */
+	~ThreadPool()
+	{
+		wait();
+		{
+			std::lock_guard lock(sleepMutex);
+			isRunning = false;
+		}
+		sleepCondition.notify_all();
+		for (auto& thread : threads)
+			thread.join();
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/**
+	 * @brief Returns worker thread count.
+	 */
+	uint32_t getThreadCount() const noexcept { return threadCount; }
+	/**
+	 * @brief Returns added and not yet finished task count.
+	 */
+	size_t getPendingCount() const noexcept { return pendingCount.load(std::memory_order_relaxed); }
+
+	/**
+	 * @brief Adds a new task to the worker queue.
+	 * @param[in] task target task function
+	 */
+	void addTask(Task&& task)
+	{
+		assert(task);
+		auto index = getWorkerIndex();
+		if (index == UINT32_MAX)
+			index = nextWorker.fetch_add(1, std::memory_order_relaxed) % threadCount;
+
+		pendingCount.fetch_add(1, std::memory_order_relaxed);
+		{
+			auto& worker = workers[index];
+			std::lock_guard lock(worker.mutex);
+			worker.tasks.push_back(std::move(task));
+		}
+		queuedCount.fetch_add(1, std::memory_order_release);
+
+		std::lock_guard lock(sleepMutex);
+		sleepCondition.notify_one();
+	}
+	/**
+	 * @brief Waits until all added tasks are finished.
+	 * @details Calling thread executes queued tasks while waiting.
+	 * @warning Do not call it from the pool task, it will wait for itself!
+	 */
+	void wait()
+	{
+		assert(getWorkerIndex() == UINT32_MAX);
+		while (pendingCount.load(std::memory_order_acquire) > 0)
+		{
+			Task task;
+			if (popTask(UINT32_MAX, task))
+			{
+				runTask(task);
+				continue;
+			}
+
+			std::unique_lock lock(sleepMutex);
+			waitCondition.wait(lock, [this]() { return pendingCount.load(std::memory_order_acquire) == 0; });
+		}
+	}
+};
+
+/**
+ * @brief Batch chunk neighbour dependency mode.
+ */
+enum class BatchDependency : uint8_t
+{
+	none,       /**< Kernels only read chunks, or access only their own chunk. */
+	neighbours, /**< Kernels write their chunk and read neighbour chunks. (cluster) */
+};
+
+/**
+ * @brief Batch chunk to process.
+ */
+struct BatchChunk
+{
+	int32_t x = 0;         /**< Chunk position along X-axis. */
+	int32_t y = 0;         /**< Chunk position along Y-axis. */
+	int32_t z = 0;         /**< Chunk position along Z-axis. */
+	float priority = 0.0f; /**< Chunk processing priority, lower values are processed first. */
+};
+
+/***********************************************************************************************************************
+ * @brief Parallel chunk batch executor.
+ *
+ * @details
+ * With the neighbour dependency, chunks are processed in 8 phases by their position parity, so kernels running
+ * at the same time are at least one chunk apart. Phases are ordered by their best chunk priority, chunks inside
+ * the phase are started in the priority order.
+ *
+ * @note Executor waits for all thread pool tasks, do not share the pool with other work while running.
+ */
+class BatchExecutor
+{
+protected:
+	ThreadPool* pool = nullptr;
+
+	static uint8_t getPhase(const BatchChunk& chunk, BatchDependency dependency) noexcept
+	{
+		if (dependency == BatchDependency::none)
+			return 0;
+		return (uint8_t)((chunk.x & 1) | (chunk.y & 1) << 1 | (chunk.z & 1) << 2);
+	}
+public:
+	/**
+	 * @brief Creates a new batch executor.
+	 * @param[in] pool thread pool to run kernels on
+	 */
+	BatchExecutor(ThreadPool& pool) noexcept : pool(&pool) { }
+
+	/**
+	 * @brief Returns batch executor thread pool.
+	 */
+	ThreadPool& getPool() noexcept { return *pool; }
+
+	/**
+	 * @brief Calculates squared distance priority between chunk and origin chunk positions.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 * @param originX origin chunk position along X-axis (for example player chunk)
+	 * @param originY origin chunk position along Y-axis
+	 * @param originZ origin chunk position along Z-axis
+	 */
+	static constexpr float calcDistancePriority(int32_t x, int32_t y, int32_t z,
+		int32_t originX, int32_t originY, int32_t originZ) noexcept
+	{
+		auto dx = (float)x - originX, dy = (float)y - originY, dz = (float)z - originZ;
+		return dx * dx + dy * dy + dz * dz;
+	}
+
+	/**
+	 * @brief Runs kernel for each batch chunk and waits for completion.
+	 * @details Kernel signature: void(int32_t x, int32_t y, int32_t z)
+	 * @return Processed chunk count. (less than chunk count if cancelled)
+	 *
+	 * @note Chunk array is sorted in the processing order.
+	 * @note Kernel is called from multiple threads at once!
+	 *
+	 * @param[in,out] chunks target batch chunk array
+	 * @param chunkCount batch chunk array size
+	 * @param kernel target chunk kernel function
+	 * @param dependency kernel neighbour chunk dependency mode
+	 * @param[in] isCancelled optional cancellation flag, checked before each kernel call
+	 */
+	template<typename F>
+	size_t run(BatchChunk* chunks, size_t chunkCount, F&& kernel,
+		BatchDependency dependency = BatchDependency::neighbours, const std::atomic<bool>* isCancelled = nullptr)
+	{
+		assert(chunks || chunkCount == 0);
+		float phasePriorities[8];
+		std::fill(phasePriorities, phasePriorities + 8, INFINITY);
+		for (size_t i = 0; i < chunkCount; i++)
+		{
+			auto& priority = phasePriorities[getPhase(chunks[i], dependency)];
+			priority = std::min(priority, chunks[i].priority);
+		}
+
+		std::sort(chunks, chunks + chunkCount, [&](const BatchChunk& a, const BatchChunk& b)
+		{
+			auto phaseA = getPhase(a, dependency), phaseB = getPhase(b, dependency);
+			if (phaseA == phaseB)
+				return a.priority < b.priority;
+			if (phasePriorities[phaseA] != phasePriorities[phaseB])
+				return phasePriorities[phaseA] < phasePriorities[phaseB];
+			return phaseA < phaseB;
+		});
+
+		std::atomic<size_t> processedCount = 0;
+		for (size_t i = 0; i < chunkCount;)
+		{
+			if (isCancelled && isCancelled->load(std::memory_order_relaxed))
+				break;
+
+			auto phase = getPhase(chunks[i], dependency);
+			for (; i < chunkCount && getPhase(chunks[i], dependency) == phase; i++)
+			{
+				pool->addTask([&kernel, &processedCount, isCancelled, chunk = chunks[i]]()
+				{
+					if (isCancelled && isCancelled->load(std::memory_order_relaxed))
+						return;
+					kernel(chunk.x, chunk.y, chunk.z);
+					processedCount.fetch_add(1, std::memory_order_relaxed);
+				});
+			}
+			pool->wait();
+		}
+		return processedCount.load(std::memory_order_relaxed);
+	}
+};
+
+};
\ No newline at end of file
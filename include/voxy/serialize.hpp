@@ -0,0 +1,587 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Chunk binary serialization functions.
+ *
+ * @details
+ * Serialized chunk is a 12 byte header followed by the payload:
+ *   magic (4 bytes, "VOXC"), version, encoding, voxel size in bytes, layout ID, size X, Y, Z, reserved (zero).
+ *
+ * Payload encodings:
+ *   raw        - chunk voxel array as is.
+ *   rle        - runs along the layout order: [run length varint][voxel ID].
+ *   paletteRle - [palette size varint][palette voxel IDs], then runs: [run length varint][palette index varint].
+ *
+ * Varints are unsigned LEB128, voxel IDs are stored in the host byte order (little-endian on supported platforms).
+ * Encoder and decoder are streaming, they can process data in parts of any size without heap allocations.
+ */
+
+#pragma once
+#include "voxy/chunk.hpp"
+
+namespace voxy::serial
+{
+
+/**
+ * @brief Serialized chunk format magic number. ("VOXC")
+ */
+constexpr uint32_t magic = 0x43584F56;
+/**
+ * @brief Serialized chunk format version.
+ */
+constexpr uint8_t version = 1;
+/**
+ * @brief Serialized chunk header size in bytes.
+ */
+constexpr size_t headerSize = 12;
+/**
+ * @brief Maximum palette size of the palette encoding.
+ */
+constexpr uint16_t maxPaletteSize = 256;
+/**
+ * @brief Maximum unsigned LEB128 varint size in bytes.
+ */
+constexpr uint8_t maxVarintSize = 10;
+
+/**
+ * @brief Serialized chunk payload encoding.
+ */
+enum class Encoding : uint8_t
+{
+	raw,        /**< Uncompressed voxel array. */
+	rle,        /**< Run-length encoded voxel IDs. */
+	paletteRle, /**< Run-length encoded palette indices. */
+	count,      /**< Chunk encoding type count. */
+	smallest = count /**< Select encoding with the smallest size. (encoder only) */
+};
+
+/**
+ * @brief Returns unsigned LEB128 varint size in bytes.
+ * @param value target varint value
+ */
+static constexpr uint8_t calcVarintSize(uint64_t value) noexcept
+{
+	uint8_t size = 1;
+	while (value >= 0x80)
+	{
+		value >>= 7;
+		size++;
+	}
+	return size;
+}
+/**
+ * @brief Writes unsigned LEB128 varint to the buffer.
+ * @return Written byte count.
+ *
+ * @param value target varint value
+ * @param[out] buffer destination buffer (at least @ref maxVarintSize bytes)
+ */
+static uint8_t writeVarint(uint64_t value, uint8_t* buffer) noexcept
+{
+	uint8_t size = 0;
+	while (value >= 0x80)
+	{
+		buffer[size++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	buffer[size++] = (uint8_t)value;
+	return size;
+}
+
+/***********************************************************************************************************************
+ * @brief Streaming chunk serializer.
+ *
+ * @details
+ * Constructor scans chunk voxel runs once to build the palette and calculate encoded size,
+ * then @ref Encoder::write can be called repeatedly with any buffer size until it's done.
+ *
+ * @note Chunk should not be modified until encoding is done.
+ * @tparam C source chunk type (@ref Chunk3)
+ */
+template<class C>
+class Encoder
+{
+public:
+	/**
+	 * @brief Source chunk type.
+	 */
+	typedef C Chunk;
+	/**
+	 * @brief Chunk voxel ID type.
+	 */
+	typedef typename C::Voxel Voxel;
+protected:
+	enum class State : uint8_t { palette, runs, raw, done };
+
+	const Voxel* voxels = nullptr;
+	size_t voxelIndex = 0;
+	size_t byteOffset = 0;
+	size_t encodedSize = 0;
+	Voxel palette[maxPaletteSize];
+	uint16_t paletteSize = 0;
+	uint16_t paletteIndex = 0;
+	Encoding encoding = {};
+	State state = {};
+	uint8_t pendingOffset = 0;
+	uint8_t pendingSize = 0;
+	uint8_t pending[maxVarintSize * 2 + sizeof(Voxel)];
+
+	size_t calcRunLength(size_t index) const noexcept
+	{
+		return simd::findMismatch(voxels + index, voxels + index + 1, C::size - index - 1) + 1;
+	}
+	uint16_t findPaletteIndex(Voxel voxel) const noexcept
+	{
+		uint16_t index = 0;
+		while (palette[index] != voxel)
+			index++;
+		return index;
+	}
+	void nextToken() noexcept
+	{
+		pendingOffset = pendingSize = 0;
+		if (state == State::palette)
+		{
+			if (paletteIndex == 0)
+				pendingSize = writeVarint(paletteSize, pending);
+			if (paletteIndex < paletteSize)
+			{
+				memcpy(pending + pendingSize, palette + paletteIndex++, sizeof(Voxel));
+				pendingSize += sizeof(Voxel);
+				return;
+			}
+			state = State::runs;
+			if (pendingSize > 0)
+				return;
+		}
+
+		if (voxelIndex == C::size)
+		{
+			state = State::done;
+			return;
+		}
+
+		auto voxel = voxels[voxelIndex];
+		auto runLength = calcRunLength(voxelIndex);
+		voxelIndex += runLength;
+		pendingSize = writeVarint(runLength, pending);
+
+		if (encoding == Encoding::rle)
+		{
+			memcpy(pending + pendingSize, &voxel, sizeof(Voxel));
+			pendingSize += sizeof(Voxel);
+		}
+		else
+		{
+			pendingSize += writeVarint(findPaletteIndex(voxel), pending + pendingSize);
+		}
+	}
+public:
+	/**
+	 * @brief Creates a new chunk encoder.
+	 * @details If chunk has more than 256 unique voxels, palette encoding falls back to the RLE.
+	 *
+	 * @param[in] chunk source chunk to serialize
+	 * @param encoding target chunk payload encoding
+	 */
+	Encoder(const C& chunk, Encoding encoding = Encoding::smallest) noexcept : voxels(chunk.getVoxels())
+	{
+		assert(encoding <= Encoding::smallest);
+		size_t rleSize = 0, paletteRleSize = 0;
+		bool hasPalette = true;
+
+		for (size_t i = 0; i < C::size && encoding != Encoding::raw;)
+		{
+			auto voxel = voxels[i];
+			auto runLength = calcRunLength(i);
+			i += runLength;
+
+			auto lengthSize = calcVarintSize(runLength);
+			rleSize += lengthSize + sizeof(Voxel);
+			if (!hasPalette)
+				continue;
+
+			uint16_t index = 0;
+			while (index < paletteSize && palette[index] != voxel)
+				index++;
+			if (index == paletteSize)
+			{
+				if (paletteSize == maxPaletteSize)
+				{
+					hasPalette = false;
+					continue;
+				}
+				palette[paletteSize++] = voxel;
+			}
+			paletteRleSize += lengthSize + calcVarintSize(index);
+		}
+
+		auto rawSize = C::size * sizeof(Voxel);
+		paletteRleSize += calcVarintSize(paletteSize) + paletteSize * sizeof(Voxel);
+		if (encoding == Encoding::paletteRle && !hasPalette)
+			encoding = Encoding::rle;
+
+		if (encoding == Encoding::smallest)
+		{
+			encoding = rleSize < rawSize ? Encoding::rle : Encoding::raw;
+			if (hasPalette && paletteRleSize < (encoding == Encoding::rle ? rleSize : rawSize))
+				encoding = Encoding::paletteRle;
+		}
+
+		this->encoding = encoding;
+		if (encoding == Encoding::raw)
+		{
+			encodedSize = headerSize + rawSize;
+			state = State::raw;
+		}
+		else if (encoding == Encoding::rle)
+		{
+			encodedSize = headerSize + rleSize;
+			state = State::runs;
+		}
+		else
+		{
+			encodedSize = headerSize + paletteRleSize;
+			state = State::palette;
+		}
+
+		pending[0] = (uint8_t)magic; pending[1] = (uint8_t)(magic >> 8);
+		pending[2] = (uint8_t)(magic >> 16); pending[3] = (uint8_t)(magic >> 24);
+		pending[4] = version; pending[5] = (uint8_t)encoding;
+		pending[6] = (uint8_t)sizeof(Voxel); pending[7] = C::Layout::id;
+		pending[8] = C::sizeX; pending[9] = C::sizeY; pending[10] = C::sizeZ; pending[11] = 0;
+		pendingSize = (uint8_t)headerSize;
+	}
+
+	/**
+	 * @brief Returns selected chunk payload encoding.
+	 */
+	Encoding getEncoding() const noexcept { return encoding; }
+	/**
+	 * @brief Returns total encoded chunk size in bytes. (including header)
+	 */
+	size_t getEncodedSize() const noexcept { return encodedSize; }
+	/**
+	 * @brief Returns true if all chunk data is written.
+	 */
+	bool isDone() const noexcept { return state == State::done && pendingOffset == pendingSize; }
+
+	/**
+	 * @brief Writes next part of the encoded chunk data to the buffer.
+	 * @return Written byte count, less than capacity only if encoding is done.
+	 *
+	 * @param[out] buffer destination buffer
+	 * @param capacity destination buffer size in bytes
+	 */
+	size_t write(uint8_t* buffer, size_t capacity) noexcept
+	{
+		assert(buffer || capacity == 0);
+		size_t offset = 0;
+		while (offset < capacity)
+		{
+			if (pendingOffset < pendingSize)
+			{
+				auto count = (size_t)(pendingSize - pendingOffset);
+				if (count > capacity - offset)
+					count = capacity - offset;
+				memcpy(buffer + offset, pending + pendingOffset, count);
+				pendingOffset += (uint8_t)count;
+				offset += count;
+				continue;
+			}
+
+			if (state == State::raw)
+			{
+				auto count = C::size * sizeof(Voxel) - byteOffset;
+				if (count > capacity - offset)
+					count = capacity - offset;
+				memcpy(buffer + offset, (const uint8_t*)voxels + byteOffset, count);
+				byteOffset += count;
+				offset += count;
+				if (byteOffset == C::size * sizeof(Voxel))
+					state = State::done;
+				continue;
+			}
+			if (state == State::done)
+				break;
+			nextToken();
+		}
+		return offset;
+	}
+};
+
+/***********************************************************************************************************************
+ * @brief Streaming chunk deserializer.
+ *
+ * @details
+ * @ref Decoder::read can be called repeatedly with any data part size until it's done or failed.
+ * Decoding fails if header doesn't match the chunk type, or if the data is corrupted.
+ *
+ * @tparam C destination chunk type (@ref Chunk3)
+ */
+template<class C>
+class Decoder
+{
+public:
+	/**
+	 * @brief Destination chunk type.
+	 */
+	typedef C Chunk;
+	/**
+	 * @brief Chunk voxel ID type.
+	 */
+	typedef typename C::Voxel Voxel;
+protected:
+	enum class State : uint8_t { header, paletteSize, palette, runLength, runValue, raw, done, failed };
+
+	Voxel* voxels = nullptr;
+	size_t voxelIndex = 0;
+	size_t byteOffset = 0;
+	uint64_t varint = 0;
+	uint64_t runLength = 0;
+	Voxel palette[maxPaletteSize];
+	uint16_t paletteSize = 0;
+	uint16_t paletteIndex = 0;
+	Encoding encoding = {};
+	State state = State::header;
+	uint8_t varintShift = 0;
+	uint8_t pendingSize = 0;
+	uint8_t pending[sizeof(Voxel) > headerSize ? sizeof(Voxel) : headerSize];
+
+	bool readVarint(const uint8_t*& data, const uint8_t* end) noexcept
+	{
+		while (data < end)
+		{
+			auto byte = *data++;
+			if (varintShift >= 64)
+			{
+				state = State::failed;
+				return false;
+			}
+			varint |= (uint64_t)(byte & 0x7F) << varintShift;
+			varintShift += 7;
+			if ((byte & 0x80) == 0)
+				return true;
+		}
+		return false;
+	}
+	bool readPending(const uint8_t*& data, const uint8_t* end, uint8_t size) noexcept
+	{
+		auto count = (size_t)(end - data);
+		if (count > (size_t)(size - pendingSize))
+			count = size - pendingSize;
+		memcpy(pending + pendingSize, data, count);
+		pendingSize += (uint8_t)count;
+		data += count;
+		return pendingSize == size;
+	}
+	void readHeader() noexcept
+	{
+		auto fileMagic = (uint32_t)pending[0] | (uint32_t)pending[1] << 8 |
+			(uint32_t)pending[2] << 16 | (uint32_t)pending[3] << 24;
+		encoding = (Encoding)pending[5];
+
+		if (fileMagic != magic || pending[4] != version || encoding >= Encoding::count ||
+			pending[6] != sizeof(Voxel) || pending[7] != C::Layout::id || pending[8] != C::sizeX ||
+			pending[9] != C::sizeY || pending[10] != C::sizeZ)
+		{
+			state = State::failed;
+			return;
+		}
+
+		if (encoding == Encoding::raw)
+			state = State::raw;
+		else if (encoding == Encoding::rle)
+			state = State::runLength;
+		else
+			state = State::paletteSize;
+	}
+	void fillRun(Voxel voxel) noexcept
+	{
+		simd::fill(voxels + voxelIndex, voxel, (size_t)runLength);
+		voxelIndex += (size_t)runLength;
+		state = voxelIndex == C::size ? State::done : State::runLength;
+	}
+public:
+	/**
+	 * @brief Creates a new chunk decoder.
+	 * @param[out] chunk destination chunk to deserialize to
+	 */
+	Decoder(C& chunk) noexcept : voxels(chunk.getVoxels()) { }
+
+	/**
+	 * @brief Returns decoded chunk payload encoding.
+	 * @note Valid only after the header is read.
+	 */
+	Encoding getEncoding() const noexcept { return encoding; }
+	/**
+	 * @brief Returns true if all chunk voxels are decoded.
+	 */
+	bool isDone() const noexcept { return state == State::done; }
+	/**
+	 * @brief Returns true if chunk data is invalid.
+	 */
+	bool isFailed() const noexcept { return state == State::failed; }
+
+	/**
+	 * @brief Reads next part of the encoded chunk data.
+	 * @return Consumed byte count, less than size if decoding is done or failed.
+	 *
+	 * @param[in] data source data part
+	 * @param size source data part size in bytes
+	 */
+	size_t read(const uint8_t* data, size_t size) noexcept
+	{
+		assert(data || size == 0);
+		auto start = data, end = data + size;
+
+		while (data < end)
+		{
+			switch (state)
+			{
+				case State::header:
+					if (readPending(data, end, (uint8_t)headerSize))
+					{
+						pendingSize = 0;
+						readHeader();
+					}
+					break;
+				case State::paletteSize:
+					if (!readVarint(data, end))
+						break;
+					if (varint == 0 || varint > maxPaletteSize)
+					{
+						state = State::failed;
+						break;
+					}
+					paletteSize = (uint16_t)varint;
+					varint = varintShift = 0;
+					state = State::palette;
+					break;
+				case State::palette:
+					if (!readPending(data, end, sizeof(Voxel)))
+						break;
+					memcpy(palette + paletteIndex++, pending, sizeof(Voxel));
+					pendingSize = 0;
+					if (paletteIndex == paletteSize)
+						state = State::runLength;
+					break;
+				case State::runLength:
+					if (!readVarint(data, end))
+						break;
+					if (varint == 0 || varint > C::size - voxelIndex)
+					{
+						state = State::failed;
+						break;
+					}
+					runLength = varint;
+					varint = varintShift = 0;
+					state = State::runValue;
+					break;
+				case State::runValue:
+					if (encoding == Encoding::rle)
+					{
+						if (!readPending(data, end, sizeof(Voxel)))
+							break;
+						Voxel voxel;
+						memcpy(&voxel, pending, sizeof(Voxel));
+						pendingSize = 0;
+						fillRun(voxel);
+					}
+					else
+					{
+						if (!readVarint(data, end))
+							break;
+						if (varint >= paletteSize)
+						{
+							state = State::failed;
+							break;
+						}
+						auto index = varint;
+						varint = varintShift = 0;
+						fillRun(palette[index]);
+					}
+					break;
+				case State::raw:
+				{
+					auto count = C::size * sizeof(Voxel) - byteOffset;
+					if (count > (size_t)(end - data))
+						count = end - data;
+					memcpy((uint8_t*)voxels + byteOffset, data, count);
+					byteOffset += count;
+					data += count;
+					if (byteOffset == C::size * sizeof(Voxel))
+						state = State::done;
+					break;
+				}
+				default:
+					return data - start;
+			}
+		}
+		return data - start;
+	}
+};
+
+/**
+ * @brief Returns maximum serialized chunk size in bytes. (with the smallest encoding)
+ * @tparam C source chunk type (@ref Chunk3)
+ */
+template<class C>
+static constexpr size_t calcMaxEncodedSize() noexcept
+{
+	return headerSize + C::size * sizeof(typename C::Voxel);
+}
+
+/**
+ * @brief Serializes chunk to the buffer.
+ * @return True on success, otherwise false if buffer is too small.
+ *
+ * @param[in] chunk source chunk to serialize
+ * @param[out] buffer destination buffer
+ * @param capacity destination buffer size in bytes
+ * @param[out] size written byte count
+ * @param encoding target chunk payload encoding
+ */
+template<class C>
+static bool encode(const C& chunk, uint8_t* buffer, size_t capacity,
+	size_t& size, Encoding encoding = Encoding::smallest) noexcept
+{
+	VOXY_STATS_TIME(encode);
+	Encoder<C> encoder(chunk, encoding);
+	size = encoder.getEncodedSize();
+	if (size > capacity)
+		return false;
+	encoder.write(buffer, size);
+	return true;
+}
+/**
+ * @brief Deserializes chunk from the data.
+ * @return True on success, otherwise false if data is invalid or incomplete.
+ *
+ * @param[in] data source serialized chunk data
+ * @param size source data size in bytes
+ * @param[out] chunk destination chunk to deserialize to
+ */
+template<class C>
+static bool decode(const uint8_t* data, size_t size, C& chunk) noexcept
+{
+	VOXY_STATS_TIME(decode);
+	Decoder<C> decoder(chunk);
+	decoder.read(data, size);
+	return decoder.isDone();
+}
+
+};
\ No newline at end of file
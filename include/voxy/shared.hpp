@@ -0,0 +1,385 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Copy-on-write shared chunk functions.
+ *
+ * @details
+ * Shared chunk is a reference counted handle to the chunk storage. Handle copy only increments the reference
+ * count, storage is cloned by the first modification of the shared handle. So the world of the shared chunks
+ * can be copied (snapshot) with one pointer copy per chunk and saved asynchronously, while the original world
+ * is still modified by the simulation thread.
+ */
+
+#pragma once
+#include "voxy/chunk.hpp"
+
+#include <atomic>
+#include <utility>
+
+namespace voxy
+{
+
+/**
+ * @brief Copy-on-write shared chunk 3D handle.
+ *
+ * @details
+ * Reference count is atomic, so handles sharing the same storage can be used from different threads.
+ * One handle instance itself should not be accessed from several threads at once without synchronization.
+ *
+ * @tparam C shared chunk type
+ */
+template<class C>
+class SharedChunk3
+{
+public:
+	/**
+	 * @brief Shared chunk type.
+	 */
+	typedef C Chunk;
+	/**
+	 * @brief Chunk voxel ID type.
+	 */
+	typedef typename C::Voxel Voxel;
+	/**
+	 * @brief Chunk voxel array layout.
+	 */
+	typedef typename C::Layout Layout;
+
+	/**
+	 * @brief Chunk size in voxels along X-axis.
+	 */
+	static constexpr uint8_t sizeX = C::sizeX;
+	/**
+	 * @brief Chunk size in voxels along Y-axis.
+	 */
+	static constexpr uint8_t sizeY = C::sizeY;
+	/**
+	 * @brief Chunk size in voxels along Z-axis.
+	 */
+	static constexpr uint8_t sizeZ = C::sizeZ;
+	/**
+	 * @brief Chunk voxel count.
+	 */
+	static constexpr size_t size = C::size;
+protected:
+	struct Storage
+	{
+		C chunk;
+		std::atomic<uint32_t> refCount;
+
+		Storage() noexcept : refCount(1) { }
+		Storage(const C& chunk) noexcept : chunk(chunk), refCount(1) { }
+	};
+
+	Storage* storage = nullptr;
+
+	void release() noexcept
+	{
+		if (storage && storage->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			delete storage;
+		storage = nullptr;
+	}
+public:
+	/**
+	 * @brief Creates a new unique chunk storage.
+	 * @note @ref Chunk3 storage may contain garbage voxels.
+	 */
+	SharedChunk3() : storage(new Storage()) { }
+	/**
+	 * @brief Creates a new unique chunk storage filled with specified voxel.
+	 * @param voxel target voxel value
+	 */
+	SharedChunk3(Voxel voxel) : SharedChunk3() { storage->chunk.fill(voxel); }
+	/**
+	 * @brief Creates a new unique chunk storage copy of specified chunk.
+	 * @param[in] chunk source chunk
+	 */
+	explicit SharedChunk3(const C& chunk) : storage(new Storage(chunk)) { }
+	/**
+	 * @brief Releases chunk storage reference, storage is destroyed by the last one.
+	 */
+	~SharedChunk3() { release(); }
+
+	/**
+	 * @brief Shares chunk storage with specified handle. (no voxel copy)
+	 * @param[in] chunk source shared chunk
+	 */
+	SharedChunk3(const SharedChunk3& chunk) noexcept : storage(chunk.storage)
+	{
+		assert(storage);
+		storage->refCount.fetch_add(1, std::memory_order_relaxed);
+	}
+	SharedChunk3(SharedChunk3&& chunk) noexcept : storage(chunk.storage) { chunk.storage = nullptr; }
+	SharedChunk3& operator=(const SharedChunk3& chunk) noexcept
+	{
+		assert(chunk.storage);
+		if (storage == chunk.storage)
+			return *this;
+		chunk.storage->refCount.fetch_add(1, std::memory_order_relaxed);
+		release();
+		storage = chunk.storage;
+		return *this;
+	}
+	SharedChunk3& operator=(SharedChunk3&& chunk) noexcept
+	{
+		if (this == &chunk)
+			return *this;
+		release();
+		storage = chunk.storage;
+		chunk.storage = nullptr;
+		return *this;
+	}
+
+	/**
+	 * @brief Returns true if chunk storage is shared with other handles.
+	 */
+	bool isShared() const noexcept
+	{
+		assert(storage);
+		return storage->refCount.load(std::memory_order_acquire) > 1;
+	}
+	/**
+	 * @brief Returns chunk storage reference count.
+	 */
+	uint32_t getRefCount() const noexcept
+	{
+		assert(storage);
+		return storage->refCount.load(std::memory_order_acquire);
+	}
+	/**
+	 * @brief Returns true if both handles share the same chunk storage.
+	 * @param[in] chunk target shared chunk
+	 */
+	bool isSharedWith(const SharedChunk3& chunk) const noexcept { return storage == chunk.storage; }
+
+	/**
+	 * @brief Clones shared chunk storage, so this handle becomes unique.
+	 * @return True if storage was cloned, otherwise false if it is already unique.
+	 */
+	bool detach()
+	{
+		if (!isShared())
+			return false;
+		auto newStorage = new Storage(storage->chunk);
+		release();
+		storage = newStorage;
+		return true;
+	}
+
+	/**
+	 * @brief Returns constant shared chunk.
+	 */
+	const C& getChunk() const noexcept
+	{
+		assert(storage);
+		return storage->chunk;
+	}
+	/**
+	 * @brief Returns unique chunk for modification. (clones shared storage)
+	 */
+	C& getUniqueChunk()
+	{
+		detach();
+		return storage->chunk;
+	}
+
+	/**
+	 * @brief Returns chunk voxel array. (clones shared storage)
+	 */
+	Voxel* getVoxels() { return getUniqueChunk().getVoxels(); }
+	/**
+	 * @brief Returns constant chunk voxel array.
+	 */
+	const Voxel* getVoxels() const noexcept { return getChunk().getVoxels(); }
+
+	/**
+	 * @brief Returns voxel index in the chunk array.
+	 *
+	 * @param x voxel position inside chunk along X-axis
+	 * @param y voxel position inside chunk along Y-axis
+	 * @param z voxel position inside chunk along Z-axis
+	 */
+	static constexpr size_t posToIndex(uint8_t x, uint8_t y, uint8_t z) noexcept { return C::posToIndex(x, y, z); }
+	/**
+	 * @brief Returns voxel position from the chunk array index.
+	 *
+	 * @param index voxel index in the chunk array
+	 * @param[out] x voxel position inside chunk along X-axis
+	 * @param[out] y voxel position inside chunk along Y-axis
+	 * @param[out] z voxel position inside chunk along Z-axis
+	 */
+	static constexpr void indexToPos(size_t index, uint8_t& x, uint8_t& y, uint8_t& z) noexcept
+	{
+		C::indexToPos(index, x, y, z);
+	}
+
+	/**
+	 * @brief Returns chunk voxel.
+	 *
+	 * @param x voxel position inside chunk along X-axis
+	 * @param y voxel position inside chunk along Y-axis
+	 * @param z voxel position inside chunk along Z-axis
+	 */
+	Voxel get(uint8_t x, uint8_t y, uint8_t z) const noexcept { return getChunk().get(x, y, z); }
+	/**
+	 * @brief Sets chunk voxel. (clones shared storage)
+	 *
+	 * @param x voxel position inside chunk along X-axis
+	 * @param y voxel position inside chunk along Y-axis
+	 * @param z voxel position inside chunk along Z-axis
+	 * @param voxel target voxel value
+	 */
+	void set(uint8_t x, uint8_t y, uint8_t z, Voxel voxel) { getUniqueChunk().set(x, y, z, voxel); }
+	/**
+	 * @brief Returns chunk voxel by array index.
+	 * @param index voxel index in the chunk array
+	 */
+	Voxel get(size_t index) const noexcept { return getChunk().get(index); }
+	/**
+	 * @brief Sets chunk voxel by array index. (clones shared storage)
+	 *
+	 * @param index voxel index in the chunk array
+	 * @param voxel target voxel value
+	 */
+	void set(size_t index, Voxel voxel) { getUniqueChunk().set(index, voxel); }
+
+	/**
+	 * @brief Returns chunk voxel if position is inside chunk bounds.
+	 *
+	 * @param x voxel position inside chunk along X-axis
+	 * @param y voxel position inside chunk along Y-axis
+	 * @param z voxel position inside chunk along Z-axis
+	 * @param[out] voxel reference to the voxel value
+	 */
+	bool tryGet(uint8_t x, uint8_t y, uint8_t z, Voxel& voxel) const noexcept { return getChunk().tryGet(x, y, z, voxel); }
+	/**
+	 * @brief Sets chunk voxel if position is inside chunk bounds. (clones shared storage)
+	 *
+	 * @param x voxel position inside chunk along X-axis
+	 * @param y voxel position inside chunk along Y-axis
+	 * @param z voxel position inside chunk along Z-axis
+	 * @param voxel target voxel value
+	 */
+	bool trySet(uint8_t x, uint8_t y, uint8_t z, Voxel voxel)
+	{
+		if (x >= sizeX || y >= sizeY || z >= sizeZ)
+			return false;
+		getUniqueChunk().set(x, y, z, voxel);
+		return true;
+	}
+
+	/**
+	 * @brief Fills chunk with specified voxel.
+	 * @details Shared storage is replaced with a new one instead of cloning, all voxels are overwritten.
+	 * @param voxel target voxel value
+	 */
+	void fill(Voxel voxel)
+	{
+		if (isShared())
+		{
+			release();
+			storage = new Storage();
+		}
+		storage->chunk.fill(voxel);
+	}
+	/**
+	 * @brief Fills chunk part with specified voxel. (clones shared storage)
+	 *
+	 * @param voxel target voxel value
+	 * @param _sizeX part size along X-axis
+	 * @param _sizeY part size along Y-axis
+	 * @param _sizeZ part size along Z-axis
+	 * @param offsetX part offset along X-axis
+	 * @param offsetY part offset along Y-axis
+	 * @param offsetZ part offset along Z-axis
+	 */
+	void fill(Voxel voxel, uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX = 0, uint8_t offsetY = 0, uint8_t offsetZ = 0)
+	{
+		getUniqueChunk().fill(voxel, _sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ);
+	}
+
+	/**
+	 * @brief Replaces all specified voxels in the chunk.
+	 * @details Shared storage is cloned only if there is a voxel to replace.
+	 * @return Replaced voxel count.
+	 *
+	 * @param from voxel value to replace
+	 * @param to new voxel value
+	 */
+	size_t replace(Voxel from, Voxel to)
+	{
+		if (isShared() && getChunk().count(from) == 0)
+			return 0;
+		return getUniqueChunk().replace(from, to);
+	}
+	/**
+	 * @brief Returns specified voxel count in the chunk.
+	 * @param voxel target voxel value
+	 */
+	size_t count(Voxel voxel) const noexcept { return getChunk().count(voxel); }
+
+	/**
+	 * @brief Copies voxels from specified array to this chunk.
+	 * @details Shared storage is replaced with a new one instead of cloning, all voxels are overwritten.
+	 * @note Voxel array should have bigger or the same size as chunk, and the same layout!
+	 * @param[in] voxels target voxel array
+	 */
+	void copy(const Voxel* voxels)
+	{
+		if (isShared())
+		{
+			release();
+			storage = new Storage();
+		}
+		storage->chunk.copy(voxels);
+	}
+	/**
+	 * @brief Copies voxels from specified array part to this chunk. (clones shared storage)
+	 * @note Voxel array should have bigger or the same size as specified part, and linear layout!
+	 *
+	 * @param[in] voxels target voxel array
+	 * @param _sizeX part size along X-axis
+	 * @param _sizeY part size along Y-axis
+	 * @param _sizeZ part size along Z-axis
+	 * @param offsetX part offset along X-axis
+	 * @param offsetY part offset along Y-axis
+	 * @param offsetZ part offset along Z-axis
+	 */
+	void copy(const Voxel* voxels, uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX = 0, uint8_t offsetY = 0, uint8_t offsetZ = 0)
+	{
+		getUniqueChunk().copy(voxels, _sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ);
+	}
+
+	/**
+	 * @brief Returns true if all chunk voxels are equal.
+	 * @details Handles sharing the same storage are compared without voxel access.
+	 * @param[in] chunk target chunk to compare with
+	 */
+	bool operator==(const SharedChunk3& chunk) const noexcept
+	{
+		return storage == chunk.storage || getChunk() == chunk.getChunk();
+	}
+	/**
+	 * @brief Returns true if any chunk voxel is different.
+	 * @param[in] chunk target chunk to compare with
+	 */
+	bool operator!=(const SharedChunk3& chunk) const noexcept { return !(*this == chunk); }
+};
+
+};
\ No newline at end of file
@@ -0,0 +1,498 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Vectorized voxel array functions.
+ *
+ * @details
+ * Instruction set is selected at compile time: AVX2, SSE2 or NEON (AArch64), with a scalar fallback.
+ * Define VOXY_NO_SIMD to force scalar implementation.
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#if !defined(VOXY_NO_SIMD)
+#if defined(__AVX2__)
+#define VOXY_SIMD_AVX2
+#define VOXY_SIMD_SSE2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VOXY_SIMD_SSE2
+#include <emmintrin.h>
+#elif (defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64)
+#define VOXY_SIMD_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace voxy::simd
+{
+
+/**
+ * @brief Vector register size in bytes, or 0 if scalar implementation is used.
+ */
+#if defined(VOXY_SIMD_AVX2)
+constexpr size_t vectorSize = 32;
+#elif defined(VOXY_SIMD_SSE2) || defined(VOXY_SIMD_NEON)
+constexpr size_t vectorSize = 16;
+#else
+constexpr size_t vectorSize = 0;
+#endif
+
+/**
+ * @brief Returns index of the first set bit. (count trailing zeros)
+ * @note Value should not be zero!
+ * @param value target bit mask
+ */
+static inline uint32_t findFirstBit(uint32_t value) noexcept
+{
+	#if defined(_MSC_VER)
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return (uint32_t)index;
+	#else
+	return (uint32_t)__builtin_ctz(value);
+	#endif
+}
+
+/**
+ * @brief Returns index of the first set bit. (count trailing zeros)
+ * @note Value should not be zero!
+ * @param value target bit mask
+ */
+static inline uint32_t findFirstBit(uint64_t value) noexcept
+{
+	#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+	unsigned long index;
+	_BitScanForward64(&index, value);
+	return (uint32_t)index;
+	#elif defined(_MSC_VER)
+	return (uint32_t)value ? findFirstBit((uint32_t)value) : findFirstBit((uint32_t)(value >> 32)) + 32;
+	#else
+	return (uint32_t)__builtin_ctzll(value);
+	#endif
+}
+
+/**
+ * @brief Returns set bit count. (population count)
+ * @param value target bit mask
+ */
+static inline uint32_t countBits(uint32_t value) noexcept
+{
+	#if defined(_MSC_VER)
+	value = value - ((value >> 1) & 0x55555555u);
+	value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+	return (((value + (value >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+	#else
+	return (uint32_t)__builtin_popcount(value);
+	#endif
+}
+/**
+ * @brief Returns set bit count. (population count)
+ * @param value target bit mask
+ */
+static inline uint32_t countBits(uint64_t value) noexcept
+{
+	#if defined(_MSC_VER)
+	return countBits((uint32_t)value) + countBits((uint32_t)(value >> 32));
+	#else
+	return (uint32_t)__builtin_popcountll(value);
+	#endif
+}
+
+#if defined(VOXY_SIMD_SSE2)
+template<typename V>
+static inline __m128i broadcast128(V value) noexcept
+{
+	if constexpr (sizeof(V) == 1)
+		return _mm_set1_epi8((char)value);
+	else if constexpr (sizeof(V) == 2)
+		return _mm_set1_epi16((short)value);
+	else if constexpr (sizeof(V) == 4)
+		return _mm_set1_epi32((int)value);
+	else
+		return _mm_set1_epi64x((long long)value);
+}
+template<typename V>
+static inline __m128i compareEqual128(__m128i a, __m128i b) noexcept
+{
+	if constexpr (sizeof(V) == 1)
+		return _mm_cmpeq_epi8(a, b);
+	else if constexpr (sizeof(V) == 2)
+		return _mm_cmpeq_epi16(a, b);
+	else if constexpr (sizeof(V) == 4)
+		return _mm_cmpeq_epi32(a, b);
+	else
+	{
+		auto equal = _mm_cmpeq_epi32(a, b);
+		return _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+	}
+}
+#endif
+#if defined(VOXY_SIMD_AVX2)
+template<typename V>
+static inline __m256i broadcast256(V value) noexcept
+{
+	if constexpr (sizeof(V) == 1)
+		return _mm256_set1_epi8((char)value);
+	else if constexpr (sizeof(V) == 2)
+		return _mm256_set1_epi16((short)value);
+	else if constexpr (sizeof(V) == 4)
+		return _mm256_set1_epi32((int)value);
+	else
+		return _mm256_set1_epi64x((long long)value);
+}
+template<typename V>
+static inline __m256i compareEqual256(__m256i a, __m256i b) noexcept
+{
+	if constexpr (sizeof(V) == 1)
+		return _mm256_cmpeq_epi8(a, b);
+	else if constexpr (sizeof(V) == 2)
+		return _mm256_cmpeq_epi16(a, b);
+	else if constexpr (sizeof(V) == 4)
+		return _mm256_cmpeq_epi32(a, b);
+	else
+		return _mm256_cmpeq_epi64(a, b);
+}
+#endif
+#if defined(VOXY_SIMD_NEON)
+template<typename V>
+static inline uint8x16_t broadcast128(V value) noexcept
+{
+	if constexpr (sizeof(V) == 1)
+		return vdupq_n_u8((uint8_t)value);
+	else if constexpr (sizeof(V) == 2)
+		return vreinterpretq_u8_u16(vdupq_n_u16((uint16_t)value));
+	else if constexpr (sizeof(V) == 4)
+		return vreinterpretq_u8_u32(vdupq_n_u32((uint32_t)value));
+	else
+		return vreinterpretq_u8_u64(vdupq_n_u64((uint64_t)value));
+}
+template<typename V>
+static inline uint8x16_t compareEqual128(uint8x16_t a, uint8x16_t b) noexcept
+{
+	if constexpr (sizeof(V) == 1)
+		return vceqq_u8(a, b);
+	else if constexpr (sizeof(V) == 2)
+		return vreinterpretq_u8_u16(vceqq_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+	else if constexpr (sizeof(V) == 4)
+		return vreinterpretq_u8_u32(vceqq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));
+	else
+		return vreinterpretq_u8_u64(vceqq_u64(vreinterpretq_u64_u8(a), vreinterpretq_u64_u8(b)));
+}
+#endif
+
+/**
+ * @brief Is voxel type supported by the vectorized functions.
+ * @tparam V voxel ID type
+ */
+template<typename V>
+constexpr bool isVectorizable = vectorSize > 0 && (std::is_integral_v<V> || std::is_enum_v<V>) &&
+	(sizeof(V) == 1 || sizeof(V) == 2 || sizeof(V) == 4 || sizeof(V) == 8);
+
+/**
+ * @brief Fills voxel array with specified value.
+ *
+ * @param[out] voxels target voxel array
+ * @param value voxel ID to fill with
+ * @param count voxel count to fill
+ */
+template<typename V>
+static void fill(V* voxels, V value, size_t count) noexcept
+{
+	size_t i = 0;
+	if constexpr (isVectorizable<V>)
+	{
+		auto bytes = (uint8_t*)voxels;
+		auto byteCount = count * sizeof(V);
+		size_t j = 0;
+
+		#if defined(VOXY_SIMD_AVX2)
+		auto pattern256 = broadcast256(value);
+		for (; j + 32 <= byteCount; j += 32)
+			_mm256_storeu_si256((__m256i*)(bytes + j), pattern256);
+		#endif
+		#if defined(VOXY_SIMD_SSE2)
+		auto pattern = broadcast128(value);
+		for (; j + 16 <= byteCount; j += 16)
+			_mm_storeu_si128((__m128i*)(bytes + j), pattern);
+		#elif defined(VOXY_SIMD_NEON)
+		auto pattern = broadcast128(value);
+		for (; j + 16 <= byteCount; j += 16)
+			vst1q_u8(bytes + j, pattern);
+		#endif
+
+		i = j / sizeof(V);
+	}
+
+	if (i < count)
+	{
+		for (auto voxel = voxels + i, end = voxels + count; voxel < end; voxel++)
+			*voxel = value;
+	}
+}
+
+/**
+ * @brief Returns index of the first different voxel in two arrays, or count if they are equal.
+ *
+ * @param[in] a first voxel array
+ * @param[in] b second voxel array
+ * @param count voxel count to compare
+ */
+template<typename V>
+static size_t findMismatch(const V* a, const V* b, size_t count) noexcept
+{
+	size_t i = 0;
+	if constexpr (isVectorizable<V>)
+	{
+		auto bytesA = (const uint8_t*)a, bytesB = (const uint8_t*)b;
+		auto byteCount = count * sizeof(V);
+		size_t j = 0;
+
+		#if defined(VOXY_SIMD_AVX2)
+		for (; j + 32 <= byteCount; j += 32)
+		{
+			auto mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+				_mm256_loadu_si256((const __m256i*)(bytesA + j)), _mm256_loadu_si256((const __m256i*)(bytesB + j))));
+			if (mask != UINT32_MAX)
+				return (j + findFirstBit(~mask)) / sizeof(V);
+		}
+		#endif
+		#if defined(VOXY_SIMD_SSE2)
+		for (; j + 16 <= byteCount; j += 16)
+		{
+			auto mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(
+				_mm_loadu_si128((const __m128i*)(bytesA + j)), _mm_loadu_si128((const __m128i*)(bytesB + j))));
+			if (mask != 0xFFFF)
+				return (j + findFirstBit(~mask)) / sizeof(V);
+		}
+		#elif defined(VOXY_SIMD_NEON)
+		for (; j + 16 <= byteCount; j += 16)
+		{
+			auto equal = vceqq_u8(vld1q_u8(bytesA + j), vld1q_u8(bytesB + j));
+			if (vminvq_u8(equal) != UINT8_MAX)
+				break;
+		}
+		#endif
+
+		i = j / sizeof(V);
+	}
+
+	for (; i < count; i++)
+	{
+		if (a[i] != b[i])
+			return i;
+	}
+	return count;
+}
+
+/**
+ * @brief Returns index of the first equal voxel in two arrays, or count if all are different.
+ *
+ * @param[in] a first voxel array
+ * @param[in] b second voxel array
+ * @param count voxel count to compare
+ */
+template<typename V>
+static size_t findMatch(const V* a, const V* b, size_t count) noexcept
+{
+	size_t i = 0;
+	if constexpr (isVectorizable<V>)
+	{
+		auto bytesA = (const uint8_t*)a, bytesB = (const uint8_t*)b;
+		auto byteCount = count * sizeof(V);
+		size_t j = 0;
+
+		#if defined(VOXY_SIMD_AVX2)
+		for (; j + 32 <= byteCount; j += 32)
+		{
+			auto mask = (uint32_t)_mm256_movemask_epi8(compareEqual256<V>(
+				_mm256_loadu_si256((const __m256i*)(bytesA + j)), _mm256_loadu_si256((const __m256i*)(bytesB + j))));
+			if (mask != 0)
+				return (j + findFirstBit(mask)) / sizeof(V);
+		}
+		#endif
+		#if defined(VOXY_SIMD_SSE2)
+		for (; j + 16 <= byteCount; j += 16)
+		{
+			auto mask = (uint32_t)_mm_movemask_epi8(compareEqual128<V>(
+				_mm_loadu_si128((const __m128i*)(bytesA + j)), _mm_loadu_si128((const __m128i*)(bytesB + j))));
+			if (mask != 0)
+				return (j + findFirstBit(mask)) / sizeof(V);
+		}
+		#elif defined(VOXY_SIMD_NEON)
+		for (; j + 16 <= byteCount; j += 16)
+		{
+			if (vmaxvq_u8(compareEqual128<V>(vld1q_u8(bytesA + j), vld1q_u8(bytesB + j))) != 0)
+				break;
+		}
+		#endif
+
+		i = j / sizeof(V);
+	}
+
+	for (; i < count; i++)
+	{
+		if (a[i] == b[i])
+			return i;
+	}
+	return count;
+}
+
+/**
+ * @brief Returns voxel count with specified value in the array.
+ *
+ * @param[in] voxels target voxel array
+ * @param value voxel ID to count
+ * @param voxelCount voxel array size
+ */
+template<typename V>
+static size_t count(const V* voxels, V value, size_t voxelCount) noexcept
+{
+	size_t i = 0, result = 0;
+	if constexpr (isVectorizable<V>)
+	{
+		auto bytes = (const uint8_t*)voxels;
+		auto byteCount = voxelCount * sizeof(V);
+		size_t j = 0, byteResult = 0;
+
+		#if defined(VOXY_SIMD_AVX2)
+		auto pattern256 = broadcast256(value);
+		for (; j + 32 <= byteCount; j += 32)
+		{
+			byteResult += countBits((uint32_t)_mm256_movemask_epi8(compareEqual256<V>(
+				_mm256_loadu_si256((const __m256i*)(bytes + j)), pattern256)));
+		}
+		#endif
+		#if defined(VOXY_SIMD_SSE2)
+		auto pattern = broadcast128(value);
+		for (; j + 16 <= byteCount; j += 16)
+		{
+			byteResult += countBits((uint32_t)_mm_movemask_epi8(compareEqual128<V>(
+				_mm_loadu_si128((const __m128i*)(bytes + j)), pattern)));
+		}
+		#elif defined(VOXY_SIMD_NEON)
+		auto pattern = broadcast128(value); auto one = vdupq_n_u8(1);
+		for (; j + 16 <= byteCount; j += 16)
+			byteResult += vaddvq_u8(vandq_u8(compareEqual128<V>(vld1q_u8(bytes + j), pattern), one));
+		#endif
+
+		i = j / sizeof(V);
+		result = byteResult / sizeof(V);
+	}
+
+	for (auto voxel = voxels + i, end = voxels + voxelCount; voxel < end; voxel++)
+		result += *voxel == value;
+	return result;
+}
+
+/**
+ * @brief Replaces all voxels with specified value in the array.
+ * @return Replaced voxel count.
+ *
+ * @param[in,out] voxels target voxel array
+ * @param from voxel ID to replace
+ * @param to new voxel ID
+ * @param count voxel array size
+ */
+template<typename V>
+static size_t replace(V* voxels, V from, V to, size_t count) noexcept
+{
+	size_t i = 0, result = 0;
+	if constexpr (isVectorizable<V>)
+	{
+		auto bytes = (uint8_t*)voxels;
+		auto byteCount = count * sizeof(V);
+		size_t j = 0, byteResult = 0;
+
+		#if defined(VOXY_SIMD_AVX2)
+		auto from256 = broadcast256(from), to256 = broadcast256(to);
+		for (; j + 32 <= byteCount; j += 32)
+		{
+			auto data = _mm256_loadu_si256((const __m256i*)(bytes + j));
+			auto equal = compareEqual256<V>(data, from256);
+			auto mask = (uint32_t)_mm256_movemask_epi8(equal);
+			if (mask == 0)
+				continue;
+			_mm256_storeu_si256((__m256i*)(bytes + j), _mm256_blendv_epi8(data, to256, equal));
+			byteResult += countBits(mask);
+		}
+		#endif
+		#if defined(VOXY_SIMD_SSE2)
+		auto from128 = broadcast128(from), to128 = broadcast128(to);
+		for (; j + 16 <= byteCount; j += 16)
+		{
+			auto data = _mm_loadu_si128((const __m128i*)(bytes + j));
+			auto equal = compareEqual128<V>(data, from128);
+			auto mask = (uint32_t)_mm_movemask_epi8(equal);
+			if (mask == 0)
+				continue;
+			_mm_storeu_si128((__m128i*)(bytes + j), _mm_or_si128(
+				_mm_andnot_si128(equal, data), _mm_and_si128(equal, to128)));
+			byteResult += countBits(mask);
+		}
+		#elif defined(VOXY_SIMD_NEON)
+		auto from128 = broadcast128(from), to128 = broadcast128(to); auto one = vdupq_n_u8(1);
+		for (; j + 16 <= byteCount; j += 16)
+		{
+			auto data = vld1q_u8(bytes + j);
+			auto equal = compareEqual128<V>(data, from128);
+			vst1q_u8(bytes + j, vbslq_u8(equal, to128, data));
+			byteResult += vaddvq_u8(vandq_u8(equal, one));
+		}
+		#endif
+
+		i = j / sizeof(V);
+		result = byteResult / sizeof(V);
+	}
+
+	if (i < count)
+	{
+		for (auto voxel = voxels + i, end = voxels + count; voxel < end; voxel++)
+		{
+			if (*voxel != from)
+				continue;
+			*voxel = to;
+			result++;
+		}
+	}
+	return result;
+}
+
+/**
+ * @brief Returns true if two voxel arrays are equal.
+ *
+ * @param[in] a first voxel array
+ * @param[in] b second voxel array
+ * @param count voxel count to compare
+ */
+template<typename V>
+static bool isEqual(const V* a, const V* b, size_t count) noexcept
+{
+	if constexpr (std::is_integral_v<V> || std::is_enum_v<V>)
+		return memcmp(a, b, count * sizeof(V)) == 0;
+	else
+		return findMismatch(a, b, count) == count;
+}
+
+};
\ No newline at end of file
@@ -0,0 +1,320 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Chunk operation statistics and timings.
+ *
+ * @details
+ * Statistics are collected only if VOXY_ENABLE_STATS is defined (VOXY_ENABLE_STATS CMake option), otherwise
+ * hot path hooks are compiled out entirely and snapshots are zeroed. Counters are relaxed atomics placed on
+ * separate cache lines, timings are accumulated into the log2 nanosecond histograms.
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+#if defined(VOXY_ENABLE_STATS)
+#include <atomic>
+#include <chrono>
+
+/**
+ * @brief Increments statistics operation counter. (compiled out if stats are disabled)
+ */
+#define VOXY_STATS_COUNT(counter) ::voxy::stats::count(::voxy::stats::Counter::counter)
+/**
+ * @brief Measures statistics timing until the end of the scope. (compiled out if stats are disabled)
+ */
+#define VOXY_STATS_TIME(timer) ::voxy::stats::ScopedTimer voxyStatsTimer(::voxy::stats::Timer::timer)
+/**
+ * @brief Adds bytes to the statistics memory usage. (compiled out if stats are disabled)
+ */
+#define VOXY_STATS_MEMORY(memory, size) ::voxy::stats::addMemory(::voxy::stats::Memory::memory, (int64_t)(size))
+#else
+#define VOXY_STATS_COUNT(counter) ((void)0)
+#define VOXY_STATS_TIME(timer) ((void)0)
+#define VOXY_STATS_MEMORY(memory, size) ((void)0)
+#endif
+
+namespace voxy::stats
+{
+
+/**
+ * @brief Are statistics collected.
+ */
+#if defined(VOXY_ENABLE_STATS)
+constexpr bool isEnabled = true;
+#else
+constexpr bool isEnabled = false;
+#endif
+
+/**
+ * @brief Statistics operation counter type.
+ */
+enum class Counter : uint8_t
+{
+	chunkFill,     /**< Dense chunk (or chunk part) fill count. (@ref Chunk3) */
+	chunkCopy,     /**< Dense chunk (or chunk part) copy count. (@ref Chunk3) */
+	clusterAccess, /**< Voxel get and set count through the chunk cluster. */
+	poolAllocate,  /**< Chunk pool allocation count. */
+	poolFree,      /**< Chunk pool deallocation count. */
+	count          /**< Statistics counter type count. */
+};
+/**
+ * @brief Statistics timing type.
+ */
+enum class Timer : uint8_t
+{
+	mesh,   /**< Greedy chunk meshing duration. (@ref mesh::buildGreedy) */
+	light,  /**< Light engine update duration. (@ref LightEngine3::update) */
+	encode, /**< Chunk serialization duration. (@ref serial::encode) */
+	decode, /**< Chunk deserialization duration. (@ref serial::decode) */
+	count   /**< Statistics timing type count. */
+};
+/**
+ * @brief Statistics memory usage type. (chunk representation)
+ * @details Pool memory is tracked automatically, others are reported with @ref setMemory.
+ */
+enum class Memory : uint8_t
+{
+	pool,    /**< Chunk pool slab memory. */
+	dense,   /**< Dense chunk memory. (@ref Chunk3) */
+	palette, /**< Palette chunk memory. (@ref PaletteChunk3) */
+	uniform, /**< Uniform chunk memory. (@ref UniformChunk3) */
+	octree,  /**< Sparse voxel octree memory. (@ref SparseOctree3) */
+	count    /**< Statistics memory type count. */
+};
+
+/**
+ * @brief Timing histogram bucket count, bucket i contains durations in [2^i, 2^(i+1)) nanoseconds.
+ */
+constexpr uint8_t histogramBucketCount = 32;
+
+/**
+ * @brief Statistics timing histogram.
+ */
+struct Histogram
+{
+	uint64_t count = 0;                          /**< Measured operation count. */
+	uint64_t totalTime = 0;                      /**< Total operation duration in nanoseconds. */
+	uint64_t maxTime = 0;                        /**< Maximal operation duration in nanoseconds. */
+	uint64_t buckets[histogramBucketCount] = {}; /**< Operation count per duration bucket. */
+
+	/**
+	 * @brief Returns average operation duration in nanoseconds.
+	 */
+	uint64_t getAverageTime() const noexcept { return count > 0 ? totalTime / count : 0; }
+	/**
+	 * @brief Returns upper duration bound in nanoseconds of the specified percentile bucket.
+	 * @param percentile target percentile [0.0, 1.0]
+	 */
+	uint64_t getPercentileTime(float percentile) const noexcept
+	{
+		auto target = (uint64_t)(percentile * (float)count + 0.5f);
+		uint64_t sum = 0;
+		for (uint8_t i = 0; i < histogramBucketCount; i++)
+		{
+			sum += buckets[i];
+			if (sum >= target && sum > 0)
+				return (uint64_t)1 << (i + 1);
+		}
+		return 0;
+	}
+};
+
+/**
+ * @brief Statistics snapshot.
+ */
+struct Snapshot
+{
+	uint64_t counters[(size_t)Counter::count] = {}; /**< Operation counter values. */
+	Histogram timers[(size_t)Timer::count] = {};    /**< Operation timing histograms. */
+	int64_t memory[(size_t)Memory::count] = {};     /**< Memory usage in bytes. */
+
+	/**
+	 * @brief Returns operation counter value.
+	 * @param counter target counter type
+	 */
+	uint64_t getCounter(Counter counter) const noexcept { return counters[(size_t)counter]; }
+	/**
+	 * @brief Returns operation timing histogram.
+	 * @param timer target timing type
+	 */
+	const Histogram& getTimer(Timer timer) const noexcept { return timers[(size_t)timer]; }
+	/**
+	 * @brief Returns memory usage in bytes.
+	 * @param memory target memory type
+	 */
+	int64_t getMemory(Memory memory) const noexcept { return this->memory[(size_t)memory]; }
+};
+
+#if defined(VOXY_ENABLE_STATS)
+struct alignas(64) AtomicCounter
+{
+	std::atomic<uint64_t> value = 0;
+};
+struct alignas(64) AtomicHistogram
+{
+	std::atomic<uint64_t> count = 0;
+	std::atomic<uint64_t> totalTime = 0;
+	std::atomic<uint64_t> maxTime = 0;
+	std::atomic<uint64_t> buckets[histogramBucketCount] = {};
+};
+
+inline AtomicCounter counters[(size_t)Counter::count];
+inline AtomicHistogram timers[(size_t)Timer::count];
+inline AtomicCounter memory[(size_t)Memory::count];
+#endif
+
+/**
+ * @brief Increments operation counter.
+ *
+ * @param counter target counter type
+ * @param value counter increment
+ */
+static inline void count(Counter counter, uint64_t value = 1) noexcept
+{
+	#if defined(VOXY_ENABLE_STATS)
+	counters[(size_t)counter].value.fetch_add(value, std::memory_order_relaxed);
+	#else
+	(void)counter; (void)value;
+	#endif
+}
+/**
+ * @brief Adds operation duration to the timing histogram.
+ *
+ * @param timer target timing type
+ * @param time operation duration in nanoseconds
+ */
+static inline void addTime(Timer timer, uint64_t time) noexcept
+{
+	#if defined(VOXY_ENABLE_STATS)
+	auto& histogram = timers[(size_t)timer];
+	histogram.count.fetch_add(1, std::memory_order_relaxed);
+	histogram.totalTime.fetch_add(time, std::memory_order_relaxed);
+
+	auto maxTime = histogram.maxTime.load(std::memory_order_relaxed);
+	while (time > maxTime && !histogram.maxTime.compare_exchange_weak(maxTime, time, std::memory_order_relaxed)) { }
+
+	uint8_t bucket = 0;
+	while ((time >>= 1) > 0 && bucket + 1 < histogramBucketCount)
+		bucket++;
+	histogram.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	#else
+	(void)timer; (void)time;
+	#endif
+}
+/**
+ * @brief Adds bytes to the memory usage, negative size to subtract.
+ *
+ * @param memory target memory type
+ * @param size memory size in bytes
+ */
+static inline void addMemory(Memory memory, int64_t size) noexcept
+{
+	#if defined(VOXY_ENABLE_STATS)
+	stats::memory[(size_t)memory].value.fetch_add((uint64_t)size, std::memory_order_relaxed);
+	#else
+	(void)memory; (void)size;
+	#endif
+}
+/**
+ * @brief Sets memory usage. (for example, sum of the world chunk getMemoryUsage)
+ *
+ * @param memory target memory type
+ * @param size memory size in bytes
+ */
+static inline void setMemory(Memory memory, int64_t size) noexcept
+{
+	#if defined(VOXY_ENABLE_STATS)
+	stats::memory[(size_t)memory].value.store((uint64_t)size, std::memory_order_relaxed);
+	#else
+	(void)memory; (void)size;
+	#endif
+}
+
+/**
+ * @brief Returns current statistics snapshot.
+ * @details Values are read separately, snapshot is not atomic while operations are running.
+ */
+static inline Snapshot getSnapshot() noexcept
+{
+	Snapshot snapshot;
+	#if defined(VOXY_ENABLE_STATS)
+	for (size_t i = 0; i < (size_t)Counter::count; i++)
+		snapshot.counters[i] = counters[i].value.load(std::memory_order_relaxed);
+	for (size_t i = 0; i < (size_t)Timer::count; i++)
+	{
+		auto& histogram = snapshot.timers[i];
+		histogram.count = timers[i].count.load(std::memory_order_relaxed);
+		histogram.totalTime = timers[i].totalTime.load(std::memory_order_relaxed);
+		histogram.maxTime = timers[i].maxTime.load(std::memory_order_relaxed);
+		for (uint8_t j = 0; j < histogramBucketCount; j++)
+			histogram.buckets[j] = timers[i].buckets[j].load(std::memory_order_relaxed);
+	}
+	for (size_t i = 0; i < (size_t)Memory::count; i++)
+		snapshot.memory[i] = (int64_t)memory[i].value.load(std::memory_order_relaxed);
+	#endif
+	return snapshot;
+}
+/**
+ * @brief Resets operation counters and timings. (memory usage is kept)
+ */
+static inline void reset() noexcept
+{
+	#if defined(VOXY_ENABLE_STATS)
+	for (auto& counter : counters)
+		counter.value.store(0, std::memory_order_relaxed);
+	for (auto& histogram : timers)
+	{
+		histogram.count.store(0, std::memory_order_relaxed);
+		histogram.totalTime.store(0, std::memory_order_relaxed);
+		histogram.maxTime.store(0, std::memory_order_relaxed);
+		for (auto& bucket : histogram.buckets)
+			bucket.store(0, std::memory_order_relaxed);
+	}
+	#endif
+}
+
+#if defined(VOXY_ENABLE_STATS)
+/**
+ * @brief Scoped operation timer, adds duration to the timing histogram on destruction.
+ */
+class ScopedTimer
+{
+	std::chrono::steady_clock::time_point start;
+	Timer timer;
+public:
+	/**
+	 * @brief Starts a new scoped operation timer.
+	 * @param timer target timing type
+	 */
+	ScopedTimer(Timer timer) noexcept : start(std::chrono::steady_clock::now()), timer(timer) { }
+	/**
+	 * @brief Stops scoped operation timer.
+	 */
+	~ScopedTimer()
+	{
+		auto time = std::chrono::steady_clock::now() - start;
+		addTime(timer, (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(time).count());
+	}
+
+	ScopedTimer(const ScopedTimer&) = delete;
+	ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+#endif
+
+};
\ No newline at end of file
@@ -0,0 +1,445 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Asynchronous chunk streaming around moving viewpoints.
+ *
+ * @details
+ * Chunks around the viewpoints are loaded (from region files) or generated on the thread pool, in the order of their
+ * distance to the viewpoint or to its predicted position, so chunks in the movement direction are prefetched first.
+ * In flight load count is bounded, so a newly required chunk waits only behind a short queue. Loaded chunks are
+ * allocated from the world pool and adopted by the world on the owner thread, distant chunks are returned back.
+ */
+
+#pragma once
+#include "voxy/world.hpp"
+#include "voxy/region.hpp"
+#include "voxy/scheduler.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace voxy
+{
+
+/**
+ * @brief Chunk position hash table key.
+ */
+struct ChunkPos
+{
+	int32_t x = 0; /**< Chunk position along X-axis. */
+	int32_t y = 0; /**< Chunk position along Y-axis. */
+	int32_t z = 0; /**< Chunk position along Z-axis. */
+
+	/**
+	 * @brief Returns true if chunk positions are equal.
+	 * @param[in] pos target chunk position
+	 */
+	bool operator==(const ChunkPos& pos) const noexcept { return x == pos.x && y == pos.y && z == pos.z; }
+};
+/**
+ * @brief Chunk position hash function.
+ */
+struct ChunkPosHash
+{
+	/**
+	 * @brief Returns chunk position hash.
+	 * @param[in] pos target chunk position
+	 */
+	size_t operator()(const ChunkPos& pos) const noexcept { return (size_t)hashChunkPos(pos.x, pos.y, pos.z); }
+};
+
+/**
+ * @brief Chunk streaming viewpoint.
+ */
+struct StreamViewpoint
+{
+	float x = 0.0f, y = 0.0f, z = 0.0f;                         /**< Viewpoint position in the world. (in voxels) */
+	float velocityX = 0.0f, velocityY = 0.0f, velocityZ = 0.0f; /**< Viewpoint velocity. (in voxels per second) */
+};
+/**
+ * @brief Chunk streaming settings.
+ */
+struct StreamSettings
+{
+	float loadRadius = 8.0f;         /**< Chunk loading radius around viewpoints. (in chunks) */
+	float unloadRadius = 10.0f;      /**< Chunk unloading radius, bigger than the load radius. (in chunks) */
+	float prefetchTime = 1.0f;       /**< Viewpoint movement prediction time for prefetching. (in seconds) */
+	uint32_t maxLoadCount = 64;      /**< Maximum in flight chunk load count. (bounds chunk arrival latency) */
+	size_t maxChunkCount = SIZE_MAX; /**< World chunk count budget, the farthest chunks are unloaded above it. */
+};
+
+/***********************************************************************************************************************
+ * @brief Asynchronous world chunk streamer.
+ *
+ * @details
+ * Loader is called first, generator is called if the loader is not set or chunk is missing. (null filled without
+ * generator) Both are called from the thread pool workers at once, they should not access the streamed world!
+ * Unloader is called on the owner thread before the chunk is destroyed, it can be used to save modified chunks.
+ *
+ * @note Streamer methods should be called from the world owner thread, which also modifies the world.
+ * @tparam C world chunk type
+ */
+template<class C>
+class ChunkStreamer3
+{
+public:
+	/**
+	 * @brief World chunk type.
+	 */
+	typedef C Chunk;
+	/**
+	 * @brief Streamed world type.
+	 */
+	typedef World3<C> World;
+	/**
+	 * @brief Chunk loader function, returns false if chunk is missing.
+	 */
+	typedef std::function<bool(int32_t x, int32_t y, int32_t z, C& chunk)> Loader;
+	/**
+	 * @brief Chunk generator function.
+	 */
+	typedef std::function<void(int32_t x, int32_t y, int32_t z, C& chunk)> Generator;
+	/**
+	 * @brief Chunk unloader function.
+	 */
+	typedef std::function<void(int32_t x, int32_t y, int32_t z, const C& chunk)> Unloader;
+protected:
+	struct Load
+	{
+		ChunkPos pos;
+		C* chunk;
+	};
+
+	World* world = nullptr;
+	ChunkPool<C>* chunkPool = nullptr;
+	ThreadPool* threadPool = nullptr;
+	Loader loader;
+	Generator generator;
+	Unloader unloader;
+	StreamSettings settings;
+	std::vector<StreamViewpoint> viewpoints;
+	std::vector<BatchChunk> candidates;
+	std::vector<Load> adoptedChunks;
+	std::unordered_set<ChunkPos, ChunkPosHash> loadingChunks;
+	std::unordered_set<ChunkPos, ChunkPosHash> candidateChunks;
+	std::vector<Load> loadedChunks;
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::atomic<bool> isCancelled { false };
+
+	float calcPriority(int32_t x, int32_t y, int32_t z) const noexcept
+	{
+		auto priority = INFINITY;
+		for (const auto& viewpoint : viewpoints)
+		{
+			auto dx = (float)x + 0.5f - viewpoint.x / C::sizeX;
+			auto dy = (float)y + 0.5f - viewpoint.y / C::sizeY;
+			auto dz = (float)z + 0.5f - viewpoint.z / C::sizeZ;
+			priority = std::min(priority, dx * dx + dy * dy + dz * dz);
+
+			dx -= viewpoint.velocityX * settings.prefetchTime / C::sizeX;
+			dy -= viewpoint.velocityY * settings.prefetchTime / C::sizeY;
+			dz -= viewpoint.velocityZ * settings.prefetchTime / C::sizeZ;
+			priority = std::min(priority, dx * dx + dy * dy + dz * dz);
+		}
+		return priority;
+	}
+	void addLoadTask(int32_t x, int32_t y, int32_t z)
+	{
+		loadingChunks.insert({ x, y, z });
+		threadPool->addTask([this, x, y, z]()
+		{
+			C* chunk = nullptr;
+			if (!isCancelled.load(std::memory_order_relaxed))
+			{
+				chunk = chunkPool->allocate();
+				if (!loader || !loader(x, y, z, *chunk))
+				{
+					if (generator)
+						generator(x, y, z, *chunk);
+					else
+						chunk->fill(voxel::null);
+				}
+			}
+
+			std::lock_guard lock(mutex);
+			loadedChunks.push_back({ { x, y, z }, chunk });
+			condition.notify_all();
+		});
+	}
+
+	size_t adoptLoaded()
+	{
+		{
+			std::lock_guard lock(mutex);
+			std::swap(loadedChunks, adoptedChunks);
+		}
+
+		auto unloadRadius = settings.unloadRadius * settings.unloadRadius;
+		size_t adoptedCount = 0;
+		for (const auto& load : adoptedChunks)
+		{
+			const auto& pos = load.pos;
+			loadingChunks.erase(pos);
+			if (!load.chunk)
+				continue;
+
+			if (calcPriority(pos.x, pos.y, pos.z) <= unloadRadius && world->adoptChunk(pos.x, pos.y, pos.z, load.chunk))
+			{
+				adoptedCount++;
+				continue;
+			}
+			chunkPool->deallocate(load.chunk);
+		}
+		adoptedChunks.clear();
+		return adoptedCount;
+	}
+	void unloadDistant()
+	{
+		candidates.clear();
+		world->forEach([this](int32_t x, int32_t y, int32_t z, C&)
+		{
+			candidates.push_back({ x, y, z, calcPriority(x, y, z) });
+		});
+
+		auto unloadRadius = settings.unloadRadius * settings.unloadRadius;
+		auto middle = std::partition(candidates.begin(), candidates.end(),
+			[unloadRadius](const BatchChunk& chunk) { return chunk.priority > unloadRadius; });
+		auto keptCount = (size_t)(candidates.end() - middle);
+		if (keptCount > settings.maxChunkCount)
+		{
+			auto end = middle + (keptCount - settings.maxChunkCount);
+			std::nth_element(middle, end, candidates.end(), [](const BatchChunk& a, const BatchChunk& b)
+			{
+				return a.priority > b.priority;
+			});
+			middle = end;
+		}
+
+		for (auto i = candidates.begin(); i != middle; i++)
+		{
+			if (unloader)
+				unloader(i->x, i->y, i->z, *world->getChunk(i->x, i->y, i->z));
+			world->destroyChunk(i->x, i->y, i->z);
+		}
+	}
+	void loadNearest()
+	{
+		candidates.clear();
+		auto loadRadius = settings.loadRadius * settings.loadRadius;
+		for (const auto& viewpoint : viewpoints)
+		{
+			float minPos[3], maxPos[3];
+			const float pos[3] = { viewpoint.x / C::sizeX, viewpoint.y / C::sizeY, viewpoint.z / C::sizeZ };
+			const float offset[3] =
+			{
+				viewpoint.velocityX * settings.prefetchTime / C::sizeX,
+				viewpoint.velocityY * settings.prefetchTime / C::sizeY,
+				viewpoint.velocityZ * settings.prefetchTime / C::sizeZ
+			};
+			for (uint8_t i = 0; i < 3; i++)
+			{
+				minPos[i] = std::floor(std::min(pos[i], pos[i] + offset[i]) - settings.loadRadius);
+				maxPos[i] = std::floor(std::max(pos[i], pos[i] + offset[i]) + settings.loadRadius);
+			}
+
+			for (auto z = (int32_t)minPos[2]; z <= (int32_t)maxPos[2]; z++)
+			{
+				for (auto y = (int32_t)minPos[1]; y <= (int32_t)maxPos[1]; y++)
+				{
+					for (auto x = (int32_t)minPos[0]; x <= (int32_t)maxPos[0]; x++)
+					{
+						auto priority = calcPriority(x, y, z);
+						if (priority > loadRadius || world->getChunk(x, y, z) ||
+							loadingChunks.count({ x, y, z }) || !candidateChunks.insert({ x, y, z }).second)
+						{
+							continue;
+						}
+						candidates.push_back({ x, y, z, priority });
+					}
+				}
+			}
+		}
+		candidateChunks.clear();
+
+		auto usedCount = world->getChunkCount() + loadingChunks.size();
+		if (loadingChunks.size() >= settings.maxLoadCount || usedCount >= settings.maxChunkCount)
+			return;
+		auto loadCount = std::min(std::min(candidates.size(), (size_t)settings.maxLoadCount -
+			loadingChunks.size()), settings.maxChunkCount - usedCount);
+
+		std::partial_sort(candidates.begin(), candidates.begin() + loadCount, candidates.end(),
+			[](const BatchChunk& a, const BatchChunk& b) { return a.priority < b.priority; });
+		for (size_t i = 0; i < loadCount; i++)
+			addLoadTask(candidates[i].x, candidates[i].y, candidates[i].z);
+	}
+public:
+	/**
+	 * @brief Creates a new world chunk streamer.
+	 *
+	 * @param[in,out] world target world to stream chunks into
+	 * @param[in,out] threadPool thread pool to load chunks on
+	 * @param loader chunk loader function, or null
+	 * @param generator chunk generator function, or null
+	 * @param unloader chunk unloader function, or null
+	 * @param settings chunk streaming settings
+	 */
+	ChunkStreamer3(World& world, ThreadPool& threadPool, Loader loader = {}, Generator generator = {},
+		Unloader unloader = {}, const StreamSettings& settings = {}) : world(&world), chunkPool(&world.getPool()),
+		threadPool(&threadPool), loader(std::move(loader)), generator(std::move(generator)),
+		unloader(std::move(unloader)), settings(settings)
+	{
+		assert(settings.unloadRadius >= settings.loadRadius);
+		assert(settings.maxLoadCount > 0);
+	}
+	/**
+	 * @brief Cancels not started loads and waits for the in flight ones.
+	 */
+	~ChunkStreamer3()
+	{
+		isCancelled.store(true, std::memory_order_relaxed);
+		wait();
+		for (const auto& load : loadedChunks)
+		{
+			if (load.chunk)
+				chunkPool->deallocate(load.chunk);
+		}
+	}
+
+	ChunkStreamer3(const ChunkStreamer3&) = delete;
+	ChunkStreamer3& operator=(const ChunkStreamer3&) = delete;
+
+	/**
+	 * @brief Returns chunk streaming settings.
+	 */
+	const StreamSettings& getSettings() const noexcept { return settings; }
+	/**
+	 * @brief Sets chunk streaming settings.
+	 * @param[in] settings target streaming settings
+	 */
+	void setSettings(const StreamSettings& settings) noexcept
+	{
+		assert(settings.unloadRadius >= settings.loadRadius);
+		assert(settings.maxLoadCount > 0);
+		this->settings = settings;
+	}
+	/**
+	 * @brief Returns in flight chunk load count. (including loaded and not yet adopted)
+	 */
+	size_t getLoadingCount() const noexcept { return loadingChunks.size(); }
+
+	/*******************************************************************************************************************
+	 * @brief Adopts loaded chunks, unloads distant ones and starts loading of the nearest missing chunks.
+	 * @details Call it once per tick, loaded chunks are adopted only inside this call.
+	 * @return Adopted chunk count.
+	 *
+	 * @param[in] viewpoints streaming viewpoint array
+	 * @param viewpointCount viewpoint array size
+	 */
+	size_t update(const StreamViewpoint* viewpoints, size_t viewpointCount)
+	{
+		assert(viewpoints || viewpointCount == 0);
+		this->viewpoints.assign(viewpoints, viewpoints + viewpointCount);
+		auto adoptedCount = adoptLoaded();
+		unloadDistant();
+		loadNearest();
+		return adoptedCount;
+	}
+	/**
+	 * @brief Waits until all in flight chunk loads are finished.
+	 * @note Loaded chunks are adopted by the next update call.
+	 */
+	void wait()
+	{
+		std::unique_lock lock(mutex);
+		condition.wait(lock, [this]() { return loadedChunks.size() == loadingChunks.size(); });
+	}
+};
+
+/***********************************************************************************************************************
+ * @brief Thread-safe region file chunk loader.
+ * @details
+ * Region files are opened on the first access and kept mapped until loader is destroyed or cleared.
+ * Only region reader creation and lookup is serialized, chunks are decoded from mapped files in parallel.
+ *
+ * @tparam C region chunk type
+ * @tparam R region size in chunks along each axis
+ */
+template<class C, uint8_t R = 32>
+class RegionLoader
+{
+public:
+	/**
+	 * @brief Region file path function, receives region position.
+	 */
+	typedef std::function<std::string(int32_t x, int32_t y, int32_t z)> PathFunction;
+	/**
+	 * @brief Region file reader type.
+	 */
+	typedef region::Reader<C, R> Reader;
+protected:
+	PathFunction getPath;
+	std::unordered_map<ChunkPos, std::unique_ptr<Reader>, ChunkPosHash> readers;
+	std::mutex mutex;
+public:
+	/**
+	 * @brief Creates a new region file chunk loader.
+	 * @param getPath region file path function
+	 */
+	RegionLoader(PathFunction getPath) : getPath(std::move(getPath)) { assert(this->getPath); }
+
+	RegionLoader(const RegionLoader&) = delete;
+	RegionLoader& operator=(const RegionLoader&) = delete;
+
+	/**
+	 * @brief Reads and decodes chunk from its region file.
+	 * @return True on success, otherwise false if region file or chunk is missing, or data is invalid.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 * @param[out] chunk destination chunk
+	 */
+	bool read(int32_t x, int32_t y, int32_t z, C& chunk)
+	{
+		auto regionX = worldToChunkPos<R>(x), regionY = worldToChunkPos<R>(y), regionZ = worldToChunkPos<R>(z);
+		const Reader* reader;
+		{
+			std::lock_guard lock(mutex);
+			auto& slot = readers[{ regionX, regionY, regionZ }];
+			if (!slot)
+				slot = std::make_unique<Reader>(getPath(regionX, regionY, regionZ).c_str());
+			reader = slot.get();
+		}
+
+		if (!reader->isOpen())
+			return false;
+		return reader->read((uint8_t)(x - regionX * R), (uint8_t)(y - regionY * R), (uint8_t)(z - regionZ * R), chunk);
+	}
+	/**
+	 * @brief Unmaps all opened region files, missing files are checked again.
+	 * @warning Do not call it while chunks are being read!
+	 */
+	void clear()
+	{
+		std::lock_guard lock(mutex);
+		readers.clear();
+	}
+};
+
+};
\ No newline at end of file
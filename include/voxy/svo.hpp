@@ -0,0 +1,439 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Sparse voxel octree (SVO) and directed acyclic graph (DAG) functions.
+ *
+ * @details
+ * Octree covers a cubic region of chunks, each node stores 8 child references. Reference with the high bit set
+ * is a leaf with the voxel ID in the low bits, otherwise it is an index of the child node. Nodes with 8 equal leaf
+ * children are collapsed into one leaf. In the DAG mode identical nodes are stored once and shared between parents.
+ *
+ * Child index is (x & 1) | (y & 1) << 1 | (z & 1) << 2, where x, y, z are the position bits of the node level.
+ */
+
+#pragma once
+#include "voxy/raycast.hpp"
+
+#include <array>
+#include <vector>
+#include <unordered_map>
+
+namespace voxy
+{
+
+/***********************************************************************************************************************
+ * @brief Sparse voxel octree built from chunks.
+ *
+ * @details
+ * Region voxel (x, y, z) is the voxel of the chunk (x / sizeX, y / sizeY, z / sizeZ). Not created chunks are
+ * stored as null voxels. Chunk update replaces nodes on the path from the root, replaced nodes stay unused
+ * until the @ref compact call.
+ *
+ * @tparam C source chunk type, size should be the same power of two along each axis
+ */
+template<class C>
+class SparseOctree3
+{
+public:
+	/**
+	 * @brief Source chunk type.
+	 */
+	typedef C Chunk;
+	/**
+	 * @brief Chunk voxel ID type.
+	 */
+	typedef typename C::Voxel Voxel;
+	/**
+	 * @brief Octree node child references.
+	 */
+	typedef std::array<uint32_t, 8> Node;
+
+	/**
+	 * @brief Leaf reference flag bit.
+	 */
+	static constexpr uint32_t leafFlag = 0x80000000u;
+
+	static_assert(C::sizeX == C::sizeY && C::sizeY == C::sizeZ && (C::sizeX & (C::sizeX - 1)) == 0,
+		"Chunk size should be the same power of two along each axis");
+	static_assert(sizeof(Voxel) <= 2, "Voxel ID should fit into the leaf reference");
+protected:
+	struct NodeHash
+	{
+		size_t operator()(const Node& node) const noexcept
+		{
+			uint64_t hash = 0;
+			for (auto reference : node)
+				hash = (hash ^ reference) * 0x9E3779B185EBCA87ull;
+			return (size_t)(hash ^ (hash >> 32));
+		}
+	};
+
+	std::vector<Node> nodes;
+	std::unordered_map<Node, uint32_t, NodeHash> nodeMap;
+	uint32_t root = leafFlag;
+	uint32_t sizeInChunks = 0;
+	uint8_t depth = 0;
+	uint8_t chunkDepth = 0;
+	bool isDag = true;
+
+	static constexpr uint8_t calcLog2(uint32_t value) noexcept
+	{
+		uint8_t result = 0;
+		while (value > 1)
+		{
+			value >>= 1;
+			result++;
+		}
+		return result;
+	}
+	static constexpr uint32_t makeLeaf(Voxel voxel) noexcept { return leafFlag | (uint32_t)voxel; }
+	static constexpr uint8_t getChildIndex(uint32_t x, uint32_t y, uint32_t z, uint8_t shift) noexcept
+	{
+		return (uint8_t)((x >> shift & 1) | (y >> shift & 1) << 1 | (z >> shift & 1) << 2);
+	}
+
+	uint32_t addNode(const Node& node)
+	{
+		auto isUniform = (node[0] & leafFlag) != 0;
+		for (uint8_t i = 1; i < 8 && isUniform; i++)
+			isUniform = node[i] == node[0];
+		if (isUniform)
+			return node[0];
+
+		if (isDag)
+		{
+			auto result = nodeMap.find(node);
+			if (result != nodeMap.end())
+				return result->second;
+		}
+
+		assert(nodes.size() < leafFlag);
+		auto index = (uint32_t)nodes.size();
+		nodes.push_back(node);
+		if (isDag)
+			nodeMap.emplace(node, index);
+		return index;
+	}
+	uint32_t buildChunk(const C& chunk, uint8_t x, uint8_t y, uint8_t z, uint8_t size)
+	{
+		if (size == 1)
+			return makeLeaf(chunk.get(x, y, z));
+
+		auto half = (uint8_t)(size / 2);
+		Node node;
+		for (uint8_t i = 0; i < 8; i++)
+		{
+			node[i] = buildChunk(chunk, (uint8_t)(x + (i & 1) * half),
+				(uint8_t)(y + (i >> 1 & 1) * half), (uint8_t)(z + (i >> 2) * half), half);
+		}
+		return addNode(node);
+	}
+	uint32_t buildChunk(const C* chunk)
+	{
+		if (!chunk)
+			return makeLeaf(voxel::null);
+		if constexpr (hasUniformValue<C>::value)
+		{
+			if (chunk->isUniform())
+				return makeLeaf(chunk->getValue());
+		}
+		return buildChunk(*chunk, 0, 0, 0, C::sizeX);
+	}
+	template<typename G>
+	uint32_t buildRegion(G& getChunk, uint32_t x, uint32_t y, uint32_t z, uint32_t size)
+	{
+		if (size == 1)
+			return buildChunk(getChunk(x, y, z));
+
+		auto half = size / 2;
+		Node node;
+		for (uint8_t i = 0; i < 8; i++)
+		{
+			node[i] = buildRegion(getChunk, x + (i & 1) * half,
+				y + (i >> 1 & 1) * half, z + (i >> 2) * half, half);
+		}
+		return addNode(node);
+	}
+	uint32_t replaceChunk(uint32_t reference, uint8_t level,
+		uint32_t x, uint32_t y, uint32_t z, uint32_t chunkReference)
+	{
+		if (level == 0)
+			return chunkReference;
+
+		Node node;
+		if (reference & leafFlag)
+			node.fill(reference);
+		else
+			node = nodes[reference];
+
+		auto index = getChildIndex(x, y, z, level - 1);
+		node[index] = replaceChunk(node[index], level - 1, x, y, z, chunkReference);
+		return addNode(node);
+	}
+	uint32_t copyNode(const std::vector<Node>& oldNodes, std::vector<uint32_t>& remap, uint32_t reference)
+	{
+		if (reference & leafFlag)
+			return reference;
+		if (remap[reference] != UINT32_MAX)
+			return remap[reference];
+
+		auto node = oldNodes[reference];
+		for (auto& child : node)
+			child = copyNode(oldNodes, remap, child);
+		return remap[reference] = addNode(node);
+	}
+	uint32_t findLeaf(uint32_t x, uint32_t y, uint32_t z, uint8_t& shift) const noexcept
+	{
+		auto reference = root;
+		shift = depth;
+		while (!(reference & leafFlag))
+		{
+			shift--;
+			reference = nodes[reference][getChildIndex(x, y, z, shift)];
+		}
+		return reference;
+	}
+public:
+	/**
+	 * @brief Creates a new empty sparse voxel octree.
+	 * @param isDag deduplicate identical nodes (directed acyclic graph)
+	 */
+	SparseOctree3(bool isDag = true) : isDag(isDag) { }
+
+	/**
+	 * @brief Returns true if identical nodes are deduplicated. (DAG)
+	 */
+	bool isDeduplicated() const noexcept { return isDag; }
+	/**
+	 * @brief Returns octree region size in chunks along each axis.
+	 */
+	uint32_t getSizeInChunks() const noexcept { return sizeInChunks; }
+	/**
+	 * @brief Returns octree region size in voxels along each axis.
+	 */
+	uint32_t getSize() const noexcept { return sizeInChunks * C::sizeX; }
+	/**
+	 * @brief Returns octree depth. (log2 of the size in voxels)
+	 */
+	uint8_t getDepth() const noexcept { return depth; }
+	/**
+	 * @brief Returns octree node count, including unused ones.
+	 */
+	size_t getNodeCount() const noexcept { return nodes.size(); }
+	/**
+	 * @brief Returns octree node memory size in bytes.
+	 * @details Deduplication hash map memory is not included.
+	 */
+	size_t getMemorySize() const noexcept { return nodes.size() * sizeof(Node); }
+	/**
+	 * @brief Returns octree root reference.
+	 */
+	uint32_t getRoot() const noexcept { return root; }
+	/**
+	 * @brief Returns octree node array.
+	 */
+	const std::vector<Node>& getNodes() const noexcept { return nodes; }
+
+	/**
+	 * @brief Builds octree from the region chunks.
+	 * @details Chunk getter signature: const Chunk*(uint32_t x, uint32_t y, uint32_t z)
+	 *
+	 * @param sizeInChunks region size in chunks along each axis (power of two)
+	 * @param getChunk region chunk getter, returns null for not created chunks
+	 */
+	template<typename G>
+	void build(uint32_t sizeInChunks, G&& getChunk)
+	{
+		assert(sizeInChunks > 0 && (sizeInChunks & (sizeInChunks - 1)) == 0);
+		assert((uint64_t)sizeInChunks * C::sizeX <= leafFlag);
+		clear();
+		this->sizeInChunks = sizeInChunks;
+		chunkDepth = calcLog2(sizeInChunks);
+		depth = chunkDepth + calcLog2(C::sizeX);
+		root = buildRegion(getChunk, 0, 0, 0, sizeInChunks);
+	}
+	/**
+	 * @brief Rebuilds octree part of the specified chunk.
+	 *
+	 * @param x chunk position along X-axis inside the region
+	 * @param y chunk position along Y-axis inside the region
+	 * @param z chunk position along Z-axis inside the region
+	 * @param[in] chunk new chunk instance, or null if chunk is destroyed
+	 */
+	void update(uint32_t x, uint32_t y, uint32_t z, const C* chunk)
+	{
+		assert(x < sizeInChunks);
+		assert(y < sizeInChunks);
+		assert(z < sizeInChunks);
+		root = replaceChunk(root, chunkDepth, x, y, z, buildChunk(chunk));
+	}
+	/**
+	 * @brief Removes unused octree nodes left after the chunk updates.
+	 */
+	void compact()
+	{
+		std::vector<Node> oldNodes;
+		oldNodes.swap(nodes);
+		nodeMap.clear();
+		std::vector<uint32_t> remap(oldNodes.size(), UINT32_MAX);
+		root = copyNode(oldNodes, remap, root);
+	}
+	/**
+	 * @brief Removes all octree nodes.
+	 */
+	void clear() noexcept
+	{
+		nodes.clear();
+		nodeMap.clear();
+		root = leafFlag;
+	}
+
+	/**
+	 * @brief Returns octree voxel at specified 3D position.
+	 * @note Use with care, it doesn't checks for out of octree bounds!
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 */
+	Voxel get(uint32_t x, uint32_t y, uint32_t z) const noexcept
+	{
+		assert(x < getSize());
+		assert(y < getSize());
+		assert(z < getSize());
+		uint8_t shift;
+		return (Voxel)(findLeaf(x, y, z, shift) & ~leafFlag);
+	}
+	/**
+	 * @brief Returns octree voxel at specified 3D position if inside octree bounds.
+	 * @return True if voxel position is inside octree bounds, otherwise false.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param[out] voxel target voxel ID
+	 */
+	bool tryGet(uint32_t x, uint32_t y, uint32_t z, Voxel& voxel) const noexcept
+	{
+		auto size = getSize();
+		if (x >= size || y >= size || z >= size)
+			return false;
+		voxel = get(x, y, z);
+		return true;
+	}
+
+	/**
+	 * @brief Casts ray through the octree voxels.
+	 * @details Not solid leaves are skipped at once, regardless of their size.
+	 * @return True if solid voxel is hit, otherwise false.
+	 *
+	 * @param[in] ray target ray (origin is relative to the octree region)
+	 * @param[out] hit ray hit information
+	 * @param isSolid solid voxel predicate, signature: bool(Voxel voxel)
+	 */
+	template<typename F = IsNotNullVoxel>
+	bool raycast(const Ray& ray, RayHit<Voxel>& hit, const F& isSolid = F()) const noexcept
+	{
+		assert(ray.directionX != 0.0f || ray.directionY != 0.0f || ray.directionZ != 0.0f);
+		const float origin[3] = { ray.originX, ray.originY, ray.originZ };
+		const float direction[3] = { ray.directionX, ray.directionY, ray.directionZ };
+		auto size = (int32_t)getSize();
+		float start = 0.0f, end = ray.maxDistance;
+		int8_t axis = -1;
+		hit.distance = INFINITY;
+		if (size == 0)
+			return false;
+
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			if (direction[i] == 0.0f)
+			{
+				if (origin[i] < 0.0f || origin[i] >= (float)size)
+					return false;
+				continue;
+			}
+
+			auto t0 = (0.0f - origin[i]) / direction[i], t1 = ((float)size - origin[i]) / direction[i];
+			if (t0 > t1)
+				std::swap(t0, t1);
+			if (t0 > start)
+			{
+				start = t0;
+				axis = (int8_t)i;
+			}
+			end = std::min(end, t1);
+		}
+		if (start > end)
+			return false;
+
+		int32_t pos[3];
+		for (uint8_t i = 0; i < 3; i++)
+		{
+			auto value = (int32_t)std::floor(origin[i] + direction[i] * start);
+			pos[i] = value < 0 ? 0 : (value >= size ? size - 1 : value);
+		}
+
+		auto distance = start;
+		while (true)
+		{
+			uint8_t shift;
+			auto reference = findLeaf((uint32_t)pos[0], (uint32_t)pos[1], (uint32_t)pos[2], shift);
+			auto voxel = (Voxel)(reference & ~leafFlag);
+			if (isSolid(voxel))
+			{
+				hit.x = pos[0]; hit.y = pos[1]; hit.z = pos[2];
+				hit.distance = distance;
+				hit.normalX = axis == 0 ? (direction[0] > 0.0f ? -1 : 1) : 0;
+				hit.normalY = axis == 1 ? (direction[1] > 0.0f ? -1 : 1) : 0;
+				hit.normalZ = axis == 2 ? (direction[2] > 0.0f ? -1 : 1) : 0;
+				hit.voxel = voxel;
+				return true;
+			}
+
+			auto leafSize = (int32_t)1 << shift;
+			int32_t low[3];
+			float exit[3];
+			for (uint8_t i = 0; i < 3; i++)
+			{
+				low[i] = pos[i] & ~(leafSize - 1);
+				if (direction[i] > 0.0f)
+					exit[i] = ((float)(low[i] + leafSize) - origin[i]) / direction[i];
+				else if (direction[i] < 0.0f)
+					exit[i] = ((float)low[i] - origin[i]) / direction[i];
+				else
+					exit[i] = INFINITY;
+			}
+
+			axis = exit[0] < exit[1] ? (exit[0] < exit[2] ? 0 : 2) : (exit[1] < exit[2] ? 1 : 2);
+			if (exit[axis] > end)
+				return false;
+			distance = std::max(distance, exit[axis]);
+
+			for (uint8_t i = 0; i < 3; i++)
+			{
+				if (i == axis)
+					continue;
+				auto value = (int32_t)std::floor(origin[i] + direction[i] * distance);
+				pos[i] = value < low[i] ? low[i] : (value >= low[i] + leafSize ? low[i] + leafSize - 1 : value);
+			}
+			pos[axis] = direction[axis] > 0.0f ? low[axis] + leafSize : low[axis] - 1;
+			if ((uint32_t)pos[axis] >= (uint32_t)size)
+				return false;
+		}
+	}
+};
+
+};
\ No newline at end of file
@@ -0,0 +1,488 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Tiered (compressed cold chunk) world functions.
+ *
+ * @details
+ * Chunks not accessed for the configured tick count are compressed with the serialization encodings (RLE or
+ * palette RLE) on the thread pool, and decompressed back on the first access. Recency tracking is a tick store
+ * into the hash table entry, which is already loaded by the chunk lookup. Compression reads a chunk copy, so the
+ * world owner can modify chunks meanwhile, result is dropped if chunk was accessed before it was adopted.
+ */
+
+#pragma once
+#include "voxy/world.hpp"
+#include "voxy/serialize.hpp"
+#include "voxy/scheduler.hpp"
+
+#include <algorithm>
+
+namespace voxy
+{
+
+/**
+ * @brief Tiered world settings.
+ */
+struct TierSettings
+{
+	uint32_t coldTickCount = 600;                           /**< Tick count without access before chunk compression. */
+	uint32_t maxCompressCount = 64;                         /**< Maximum in flight chunk compression count. */
+	uint32_t scanCount = 4096;                              /**< Hash table entries checked for cold chunks per tick. */
+	serial::Encoding encoding = serial::Encoding::smallest; /**< Compressed chunk encoding. */
+};
+
+/***********************************************************************************************************************
+ * @brief Sparse voxel chunk 3D container with compressed cold chunks. (map)
+ *
+ * @details
+ * Hash table is the same as in @ref World3, each entry stores either a dense chunk or its compressed data.
+ * Returned chunk pointers stay valid until the next update call, which can compress untouched chunks.
+ *
+ * @note Methods should be called from the world owner thread, without thread pool chunks are compressed inside update.
+ * @tparam C world chunk type (@ref Chunk3)
+ */
+template<class C>
+class TieredWorld3
+{
+public:
+	/**
+	 * @brief World chunk type.
+	 */
+	typedef C Chunk;
+	/**
+	 * @brief Chunk voxel ID type.
+	 */
+	typedef typename C::Voxel Voxel;
+	/**
+	 * @brief World chunk cluster type.
+	 */
+	typedef Cluster3<C, Voxel> Cluster;
+	/**
+	 * @brief World chunk pool type.
+	 */
+	typedef ChunkPool<C> Pool;
+protected:
+	struct Entry
+	{
+		int32_t x, y, z;
+		uint32_t lastTick;
+		C* chunk;
+		uint8_t* data;
+		uint32_t dataSize;
+		bool isCompressing;
+	};
+	struct Compression
+	{
+		int32_t x, y, z;
+		uint32_t lastTick;
+		uint8_t* data;
+		uint32_t dataSize;
+	};
+
+	std::unique_ptr<Pool> ownedPool;
+	std::unique_ptr<Entry[]> entries;
+	Pool* pool = nullptr;
+	ThreadPool* threadPool = nullptr;
+	TierSettings settings;
+	size_t capacity = 0;
+	size_t chunkCount = 0;
+	size_t coldCount = 0;
+	size_t compressedSize = 0;
+	size_t scanIndex = 0;
+	uint32_t tick = 0;
+	uint32_t compressingCount = 0;
+	std::vector<Compression> compressedChunks;
+	std::vector<Compression> adoptedChunks;
+	std::mutex mutex;
+	std::condition_variable condition;
+
+	static bool isUsed(const Entry& entry) noexcept { return entry.chunk || entry.data; }
+
+	size_t findEntry(int32_t x, int32_t y, int32_t z) const noexcept
+	{
+		if (capacity == 0)
+			return SIZE_MAX;
+
+		auto mask = capacity - 1;
+		auto index = hashChunkPos(x, y, z) & mask;
+		while (true)
+		{
+			const auto& entry = entries[index];
+			if (!isUsed(entry))
+				return SIZE_MAX;
+			if (entry.x == x && entry.y == y && entry.z == z)
+				return index;
+			index = (index + 1) & mask;
+		}
+	}
+	void insertEntry(Entry* _entries, size_t _capacity, const Entry& entry) noexcept
+	{
+		auto mask = _capacity - 1;
+		auto index = hashChunkPos(entry.x, entry.y, entry.z) & mask;
+		while (isUsed(_entries[index]))
+			index = (index + 1) & mask;
+		_entries[index] = entry;
+	}
+	void rehash(size_t newCapacity)
+	{
+		auto newEntries = new Entry[newCapacity];
+		for (size_t i = 0; i < newCapacity; i++)
+			newEntries[i] = {};
+
+		for (size_t i = 0; i < capacity; i++)
+		{
+			if (isUsed(entries[i]))
+				insertEntry(newEntries, newCapacity, entries[i]);
+		}
+
+		entries.reset(newEntries);
+		capacity = newCapacity;
+	}
+
+	C* decompress(Entry& entry)
+	{
+		auto chunk = pool->allocate();
+		auto result = serial::decode(entry.data, entry.dataSize, *chunk);
+		assert(result);
+		(void)result;
+
+		delete[] entry.data;
+		compressedSize -= entry.dataSize;
+		coldCount--;
+		entry.chunk = chunk;
+		entry.data = nullptr;
+		entry.dataSize = 0;
+		return chunk;
+	}
+	static void compress(const C& chunk, serial::Encoding encoding, Compression& compression)
+	{
+		serial::Encoder<C> encoder(chunk, encoding);
+		compression.dataSize = (uint32_t)encoder.getEncodedSize();
+		compression.data = new uint8_t[compression.dataSize];
+		encoder.write(compression.data, compression.dataSize);
+	}
+	void addCompressTask(const Entry& entry)
+	{
+		Compression compression = { entry.x, entry.y, entry.z, entry.lastTick, nullptr, 0 };
+		if (!threadPool)
+		{
+			compress(*entry.chunk, settings.encoding, compression);
+			compressedChunks.push_back(compression);
+			return;
+		}
+
+		auto copy = pool->allocate(*entry.chunk);
+		threadPool->addTask([this, compression, copy, encoding = settings.encoding]() mutable
+		{
+			compress(*copy, encoding, compression);
+			pool->deallocate(copy);
+
+			std::lock_guard lock(mutex);
+			compressedChunks.push_back(compression);
+			condition.notify_all();
+		});
+	}
+
+	size_t adoptCompressed()
+	{
+		{
+			std::lock_guard lock(mutex);
+			std::swap(compressedChunks, adoptedChunks);
+		}
+
+		size_t adoptedCount = 0;
+		for (const auto& compression : adoptedChunks)
+		{
+			compressingCount--;
+			auto index = findEntry(compression.x, compression.y, compression.z);
+			if (index != SIZE_MAX)
+			{
+				auto& entry = entries[index];
+				if (entry.isCompressing && entry.chunk && entry.lastTick == compression.lastTick)
+				{
+					pool->deallocate(entry.chunk);
+					entry.chunk = nullptr;
+					entry.data = compression.data;
+					entry.dataSize = compression.dataSize;
+					entry.isCompressing = false;
+					compressedSize += compression.dataSize;
+					coldCount++;
+					adoptedCount++;
+					continue;
+				}
+				entry.isCompressing = false;
+			}
+			delete[] compression.data;
+		}
+		adoptedChunks.clear();
+		return adoptedCount;
+	}
+	void compressCold()
+	{
+		auto scanCount = std::min((size_t)settings.scanCount, capacity);
+		for (size_t i = 0; i < scanCount && compressingCount < settings.maxCompressCount; i++)
+		{
+			auto& entry = entries[scanIndex];
+			scanIndex = (scanIndex + 1) & (capacity - 1);
+			if (!entry.chunk || entry.isCompressing || tick - entry.lastTick < settings.coldTickCount)
+				continue;
+
+			entry.isCompressing = true;
+			compressingCount++;
+			addCompressTask(entry);
+		}
+	}
+public:
+	/**
+	 * @brief Creates a new empty tiered world.
+	 *
+	 * @param[in,out] threadPool thread pool to compress chunks on, or null to compress inside update
+	 * @param[in] settings tiered world settings
+	 * @param[in] pool chunk pool to allocate chunks from, or null to create own one
+	 */
+	TieredWorld3(ThreadPool* threadPool = nullptr, const TierSettings& settings = {}, Pool* pool = nullptr) :
+		pool(pool), threadPool(threadPool), settings(settings)
+	{
+		assert(settings.maxCompressCount > 0);
+		if (!pool)
+		{
+			ownedPool = std::make_unique<Pool>();
+			this->pool = ownedPool.get();
+		}
+	}
+	/**
+	 * @brief Waits for the in flight compressions and destroys all world chunks.
+	 */
+	~TieredWorld3()
+	{
+		wait();
+		adoptCompressed();
+		clear();
+	}
+
+	TieredWorld3(const TieredWorld3&) = delete;
+	TieredWorld3& operator=(const TieredWorld3&) = delete;
+
+	/**
+	 * @brief Returns world chunk pool.
+	 */
+	Pool& getPool() noexcept { return *pool; }
+	/**
+	 * @brief Returns tiered world settings.
+	 */
+	const TierSettings& getSettings() const noexcept { return settings; }
+	/**
+	 * @brief Sets tiered world settings.
+	 * @param[in] settings target tiered world settings
+	 */
+	void setSettings(const TierSettings& settings) noexcept
+	{
+		assert(settings.maxCompressCount > 0);
+		this->settings = settings;
+	}
+
+	/**
+	 * @brief Returns world chunk count. (including compressed ones)
+	 */
+	size_t getChunkCount() const noexcept { return chunkCount; }
+	/**
+	 * @brief Returns compressed (cold) chunk count.
+	 */
+	size_t getColdCount() const noexcept { return coldCount; }
+	/**
+	 * @brief Returns compressed chunk data size in bytes.
+	 */
+	size_t getCompressedSize() const noexcept { return compressedSize; }
+	/**
+	 * @brief Returns world memory usage in bytes. (dense chunks and compressed data, without hash table)
+	 */
+	size_t getMemoryUsage() const noexcept { return (chunkCount - coldCount) * sizeof(C) + compressedSize; }
+	/**
+	 * @brief Returns in flight chunk compression count. (including compressed and not yet adopted)
+	 */
+	uint32_t getCompressingCount() const noexcept { return compressingCount; }
+	/**
+	 * @brief Returns current world tick. (update call count)
+	 */
+	uint32_t getTick() const noexcept { return tick; }
+
+	/**
+	 * @brief Preallocates hash table memory for the specified chunk count.
+	 * @param chunkCount target chunk count
+	 */
+	void reserve(size_t chunkCount)
+	{
+		auto newCapacity = capacity > 0 ? capacity : 16;
+		while (newCapacity / 2 < chunkCount)
+			newCapacity *= 2;
+		if (newCapacity != capacity)
+			rehash(newCapacity);
+	}
+
+	/**
+	 * @brief Returns true if world chunk at specified position is compressed.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 */
+	bool isCompressed(int32_t x, int32_t y, int32_t z) const noexcept
+	{
+		auto index = findEntry(x, y, z);
+		return index != SIZE_MAX && entries[index].data;
+	}
+	/**
+	 * @brief Returns world chunk at specified position, or null if it is not created.
+	 * @details Compressed chunk is decompressed, chunk is marked as accessed in the current tick.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 */
+	C* getChunk(int32_t x, int32_t y, int32_t z)
+	{
+		auto index = findEntry(x, y, z);
+		if (index == SIZE_MAX)
+			return nullptr;
+		auto& entry = entries[index];
+		entry.lastTick = tick;
+		return entry.chunk ? entry.chunk : decompress(entry);
+	}
+
+	/**
+	 * @brief Creates a new world chunk at specified position.
+	 * @details Returns existing chunk if it is already created. (decompressed)
+	 * @note New chunk is default constructed, so @ref Chunk3 may contain garbage voxels.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 */
+	C* createChunk(int32_t x, int32_t y, int32_t z)
+	{
+		auto chunk = getChunk(x, y, z);
+		if (chunk)
+			return chunk;
+
+		reserve(chunkCount + 1);
+		chunk = pool->allocate();
+		insertEntry(entries.get(), capacity, { x, y, z, tick, chunk, nullptr, 0, false });
+		chunkCount++;
+		return chunk;
+	}
+	/**
+	 * @brief Destroys world chunk at specified position.
+	 * @return True if chunk was destroyed, otherwise false if it is not created.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 */
+	bool destroyChunk(int32_t x, int32_t y, int32_t z) noexcept
+	{
+		auto index = findEntry(x, y, z);
+		if (index == SIZE_MAX)
+			return false;
+
+		auto& entry = entries[index];
+		if (entry.chunk)
+		{
+			pool->deallocate(entry.chunk);
+		}
+		else
+		{
+			delete[] entry.data;
+			compressedSize -= entry.dataSize;
+			coldCount--;
+		}
+		entry = {};
+		chunkCount--;
+
+		auto mask = capacity - 1;
+		auto next = (index + 1) & mask;
+		while (isUsed(entries[next]))
+		{
+			const auto& entry = entries[next];
+			auto home = hashChunkPos(entry.x, entry.y, entry.z) & mask;
+			if (((next - home) & mask) >= ((next - index) & mask))
+			{
+				entries[index] = entry;
+				entries[next] = {};
+				index = next;
+			}
+			next = (next + 1) & mask;
+		}
+		return true;
+	}
+	/**
+	 * @brief Destroys all world chunks.
+	 * @note It keeps allocated hash table memory, in flight compression results are dropped.
+	 */
+	void clear() noexcept
+	{
+		for (size_t i = 0; i < capacity; i++)
+		{
+			auto& entry = entries[i];
+			if (entry.chunk)
+				pool->deallocate(entry.chunk);
+			delete[] entry.data;
+			entry = {};
+		}
+		chunkCount = coldCount = compressedSize = 0;
+	}
+
+	/**
+	 * @brief Returns chunk cluster at specified chunk position. (decompressing cluster chunks)
+	 * @note Not created cluster chunks are set to null.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 */
+	Cluster getCluster(int32_t x, int32_t y, int32_t z)
+	{
+		return Cluster(getChunk(x, y, z), getChunk(x - 1, y, z), getChunk(x + 1, y, z),
+			getChunk(x, y - 1, z), getChunk(x, y + 1, z), getChunk(x, y, z - 1), getChunk(x, y, z + 1));
+	}
+
+	/*******************************************************************************************************************
+	 * @brief Advances world tick, adopts compressed chunks and starts compression of the cold ones.
+	 * @details Call it once per tick, chunks are compressed only inside this call.
+	 * @return Adopted (compressed) chunk count.
+	 */
+	size_t update()
+	{
+		tick++;
+		if (!threadPool && capacity > 0)
+			compressCold();
+		auto adoptedCount = adoptCompressed();
+		if (threadPool && capacity > 0)
+			compressCold();
+		return adoptedCount;
+	}
+	/**
+	 * @brief Waits until all in flight chunk compressions are finished.
+	 * @note Compressed chunks are adopted by the next update call.
+	 */
+	void wait()
+	{
+		std::unique_lock lock(mutex);
+		condition.wait(lock, [this]() { return compressedChunks.size() == compressingCount; });
+	}
+};
+
+};
\ No newline at end of file
@@ -0,0 +1,519 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Dirty (changed) voxel tracking chunk functions.
+ *
+ * @details
+ * Tracked chunk records which of its 4x4x4 subregions were changed since the last @ref clearDirty call,
+ * and optionally the changed voxel indices in a bounded journal. It allows to remesh or save only the
+ * changed chunk parts, instead of comparing all the voxels. Plain @ref Chunk3 has no tracking cost.
+ */
+
+#pragma once
+#include "voxy/chunk.hpp"
+
+namespace voxy
+{
+
+/**
+ * @brief Bounded changed voxel index journal.
+ * @details Journal is overflowed when there are more changes than its capacity.
+ * @tparam J maximum journal index count
+ */
+template<size_t J>
+struct ChangeJournal
+{
+public:
+	/**
+	 * @brief Maximum journal index count.
+	 */
+	static constexpr size_t capacity = J;
+protected:
+	size_t indices[J];
+	size_t count = 0;
+	bool overflowed = false;
+public:
+	/**
+	 * @brief Returns changed voxel index array. (in the change order, may contain duplicates)
+	 * @details Array can be passed to the @ref delta::encode, which sorts it in place.
+	 */
+	size_t* getIndices() noexcept { return indices; }
+	/**
+	 * @brief Returns constant changed voxel index array. (in the change order, may contain duplicates)
+	 */
+	const size_t* getIndices() const noexcept { return indices; }
+	/**
+	 * @brief Returns changed voxel index count.
+	 */
+	size_t getCount() const noexcept { return count; }
+	/**
+	 * @brief Returns true if journal has lost some changes, indices are incomplete.
+	 */
+	bool isOverflowed() const noexcept { return overflowed; }
+
+	/**
+	 * @brief Adds changed voxel index to the journal.
+	 * @param index changed voxel index
+	 */
+	void add(size_t index) noexcept
+	{
+		if (count == J)
+			overflowed = true;
+		if (overflowed)
+			return;
+		indices[count++] = index;
+	}
+	/**
+	 * @brief Checks if there is enough free space for the specified change count.
+	 * @details Journal is marked as overflowed if there is not enough space.
+	 * @return True if changes can be added, otherwise false.
+	 *
+	 * @param changeCount target voxel change count
+	 */
+	bool reserve(size_t changeCount) noexcept
+	{
+		if (changeCount > J - count)
+			overflowed = true;
+		return !overflowed;
+	}
+	/**
+	 * @brief Marks journal as overflowed. (changes are unknown)
+	 */
+	void overflow() noexcept { overflowed = true; }
+	/**
+	 * @brief Removes all journal indices and overflow state.
+	 */
+	void clear() noexcept
+	{
+		count = 0;
+		overflowed = false;
+	}
+};
+
+/**
+ * @brief Disabled changed voxel index journal.
+ * @details Disabled journal has no indices and is always overflowed.
+ */
+template<>
+struct ChangeJournal<0>
+{
+	/**
+	 * @brief Maximum journal index count.
+	 */
+	static constexpr size_t capacity = 0;
+
+	/**
+	 * @brief Returns changed voxel index array. (always null)
+	 */
+	size_t* getIndices() noexcept { return nullptr; }
+	/**
+	 * @brief Returns constant changed voxel index array. (always null)
+	 */
+	const size_t* getIndices() const noexcept { return nullptr; }
+	/**
+	 * @brief Returns changed voxel index count. (always zero)
+	 */
+	size_t getCount() const noexcept { return 0; }
+	/**
+	 * @brief Returns true if journal has lost some changes. (always true)
+	 */
+	bool isOverflowed() const noexcept { return true; }
+
+	/**
+	 * @brief Does nothing, journal is disabled.
+	 */
+	void add(size_t) noexcept { }
+	/**
+	 * @brief Does nothing, journal is disabled.
+	 */
+	bool reserve(size_t) noexcept { return false; }
+	/**
+	 * @brief Does nothing, journal is disabled.
+	 */
+	void overflow() noexcept { }
+	/**
+	 * @brief Does nothing, journal is disabled.
+	 */
+	void clear() noexcept { }
+};
+
+/***********************************************************************************************************************
+ * @brief Chunk with dirty (changed) voxel tracking.
+ *
+ * @details
+ * Each chunk axis is split into 4 parts, so there is 64 subregions, one dirty mask bit per subregion.
+ * All chunk modification functions mark changed subregions and add changed voxel indices to the journal.
+ * Single voxel set functions skip tracking if the voxel value is the same.
+ *
+ * @note Changes made through the @ref getVoxels array or a base chunk reference are
+ *       not tracked, use @ref markDirty after them.
+ *
+ * @tparam C base chunk type (@ref Chunk3)
+ * @tparam J maximum change journal index count (0 disables journal)
+ */
+template<class C, size_t J = 0>
+struct TrackedChunk3 : public C
+{
+public:
+	/**
+	 * @brief Base chunk type.
+	 */
+	typedef C Chunk;
+	/**
+	 * @brief Chunk voxel ID type.
+	 */
+	typedef typename C::Voxel Voxel;
+	/**
+	 * @brief Chunk change journal type.
+	 */
+	typedef ChangeJournal<J> Journal;
+
+	/**
+	 * @brief Chunk subregion count along each axis.
+	 */
+	static constexpr uint8_t subregionCountAxis = 4;
+	/**
+	 * @brief Chunk subregion count. (dirty mask bit count)
+	 */
+	static constexpr uint8_t subregionCount = 64;
+protected:
+	uint64_t dirtyMask = 0;
+	Journal journal;
+
+	void track(size_t index, uint8_t x, uint8_t y, uint8_t z) noexcept
+	{
+		dirtyMask |= (uint64_t)1 << posToSubregion(x, y, z);
+		journal.add(index);
+	}
+	void track(uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX, uint8_t offsetY, uint8_t offsetZ) noexcept
+	{
+		dirtyMask |= calcSubregionMask(_sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ);
+		if constexpr (J > 0)
+		{
+			if (!journal.reserve((size_t)_sizeX * _sizeY * _sizeZ))
+				return;
+			C::forEachRow(_sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ, [&](size_t index, size_t count)
+			{
+				for (size_t i = 0; i < count; i++)
+					journal.add(index + i);
+			});
+		}
+	}
+	void trackAll() noexcept { track(C::sizeX, C::sizeY, C::sizeZ, 0, 0, 0); }
+public:
+	/**
+	 * @brief Creates a new uninitialized clean chunk.
+	 * @note Chunk may contain garbage voxels.
+	 */
+	TrackedChunk3() = default;
+	/**
+	 * @brief Creates a new initialized clean chunk.
+	 * @param voxel target voxel to fill chunk with
+	 */
+	TrackedChunk3(Voxel voxel) : C(voxel) { }
+
+	/**
+	 * @brief Returns chunk subregion index from the voxel position.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 */
+	static constexpr uint8_t posToSubregion(uint8_t x, uint8_t y, uint8_t z) noexcept
+	{
+		constexpr uint8_t s = subregionCountAxis;
+		return (uint8_t)(((z * s / C::sizeZ) * s + (y * s / C::sizeY)) * s + (x * s / C::sizeX));
+	}
+	/**
+	 * @brief Calculates chunk part subregion mask.
+	 *
+	 * @param _sizeX chunk part size along X-axis
+	 * @param _sizeY chunk part size along Y-axis
+	 * @param _sizeZ chunk part size along Z-axis
+	 * @param offsetX chunk part offset along X-axis
+	 * @param offsetY chunk part offset along Y-axis
+	 * @param offsetZ chunk part offset along Z-axis
+	 */
+	static constexpr uint64_t calcSubregionMask(uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX = 0, uint8_t offsetY = 0, uint8_t offsetZ = 0) noexcept
+	{
+		if (_sizeX == 0 || _sizeY == 0 || _sizeZ == 0)
+			return 0;
+
+		constexpr uint8_t s = subregionCountAxis;
+		auto begin = posToSubregion(offsetX, offsetY, offsetZ);
+		auto end = posToSubregion(offsetX + _sizeX - 1, offsetY + _sizeY - 1, offsetZ + _sizeZ - 1);
+		uint64_t rowMask = 0, mask = 0;
+		for (uint8_t x = begin % s; x <= end % s; x++)
+			rowMask |= (uint64_t)1 << x;
+		for (uint8_t z = begin / (s * s); z <= end / (s * s); z++)
+		{
+			for (uint8_t y = begin / s % s; y <= end / s % s; y++)
+				mask |= rowMask << (z * s + y) * s;
+		}
+		return mask;
+	}
+	/**
+	 * @brief Calculates chunk subregion bounds.
+	 * @note Subregion size can be zero if chunk is smaller than 4 voxels along axis.
+	 *
+	 * @param subregion target subregion index
+	 * @param[out] _sizeX chunk part size along X-axis
+	 * @param[out] _sizeY chunk part size along Y-axis
+	 * @param[out] _sizeZ chunk part size along Z-axis
+	 * @param[out] offsetX chunk part offset along X-axis
+	 * @param[out] offsetY chunk part offset along Y-axis
+	 * @param[out] offsetZ chunk part offset along Z-axis
+	 */
+	static constexpr void calcSubregionBounds(uint8_t subregion, uint8_t& _sizeX, uint8_t& _sizeY,
+		uint8_t& _sizeZ, uint8_t& offsetX, uint8_t& offsetY, uint8_t& offsetZ) noexcept
+	{
+		assert(subregion < subregionCount);
+		constexpr uint8_t s = subregionCountAxis;
+		auto x = subregion % s, y = subregion / s % s, z = subregion / (s * s);
+		offsetX = (uint8_t)((x * C::sizeX + s - 1) / s);
+		offsetY = (uint8_t)((y * C::sizeY + s - 1) / s);
+		offsetZ = (uint8_t)((z * C::sizeZ + s - 1) / s);
+		_sizeX = (uint8_t)(((x + 1) * C::sizeX + s - 1) / s - offsetX);
+		_sizeY = (uint8_t)(((y + 1) * C::sizeY + s - 1) / s - offsetY);
+		_sizeZ = (uint8_t)(((z + 1) * C::sizeZ + s - 1) / s - offsetZ);
+	}
+
+	/**
+	 * @brief Returns true if any chunk voxel was changed.
+	 */
+	bool isDirty() const noexcept { return dirtyMask != 0; }
+	/**
+	 * @brief Returns changed chunk subregion mask. (bit per subregion)
+	 */
+	uint64_t getDirtyMask() const noexcept { return dirtyMask; }
+	/**
+	 * @brief Returns chunk change journal.
+	 */
+	Journal& getJournal() noexcept { return journal; }
+	/**
+	 * @brief Returns constant chunk change journal.
+	 */
+	const Journal& getJournal() const noexcept { return journal; }
+
+	/**
+	 * @brief Marks whole chunk as changed.
+	 * @details Journal is marked as overflowed, because changed voxels are unknown.
+	 */
+	void markDirty() noexcept
+	{
+		dirtyMask = UINT64_MAX;
+		journal.overflow();
+	}
+	/**
+	 * @brief Marks chunk part as changed.
+	 *
+	 * @param _sizeX chunk part size along X-axis
+	 * @param _sizeY chunk part size along Y-axis
+	 * @param _sizeZ chunk part size along Z-axis
+	 * @param offsetX chunk part offset along X-axis
+	 * @param offsetY chunk part offset along Y-axis
+	 * @param offsetZ chunk part offset along Z-axis
+	 */
+	void markDirty(uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX = 0, uint8_t offsetY = 0, uint8_t offsetZ = 0) noexcept
+	{
+		track(_sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ);
+	}
+	/**
+	 * @brief Clears dirty mask and change journal. (after remesh or save)
+	 */
+	void clearDirty() noexcept
+	{
+		dirtyMask = 0;
+		journal.clear();
+	}
+
+	/**
+	 * @brief Sets chunk voxel at specified 3D position.
+	 * @note Use with care, it doesn't checks for out of chunk bounds!
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param voxel target voxel ID
+	 */
+	void set(uint8_t x, uint8_t y, uint8_t z, Voxel voxel) noexcept
+	{
+		assert(x < C::sizeX);
+		assert(y < C::sizeY);
+		assert(z < C::sizeZ);
+		auto index = C::posToIndex(x, y, z);
+		if (this->voxels[index] == voxel)
+			return;
+		this->voxels[index] = voxel;
+		track(index, x, y, z);
+	}
+	/**
+	 * @brief Sets chunk voxel at specified array index.
+	 * @note Use with care, it doesn't checks for out of array bounds!
+	 *
+	 * @param index target voxel index inside array
+	 * @param voxel target voxel ID
+	 */
+	void set(size_t index, Voxel voxel) noexcept
+	{
+		assert(index < C::size);
+		if (this->voxels[index] == voxel)
+			return;
+		this->voxels[index] = voxel;
+		uint8_t x, y, z;
+		C::indexToPos(index, x, y, z);
+		track(index, x, y, z);
+	}
+	/**
+	 * @brief Sets chunk voxel at specified 3D position if inside chunk bounds.
+	 * @return True if voxel position is inside chunk bounds, otherwise false.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param voxel target voxel ID
+	 */
+	bool trySet(uint8_t x, uint8_t y, uint8_t z, Voxel voxel) noexcept
+	{
+		if (x >= C::sizeX || y >= C::sizeY || z >= C::sizeZ)
+			return false;
+		set(x, y, z, voxel);
+		return true;
+	}
+	/**
+	 * @brief Sets chunk voxel at specified array index if inside array bounds.
+	 * @return True if voxel index is inside array bounds, otherwise false.
+	 *
+	 * @param index target voxel index inside array
+	 * @param voxel target voxel ID
+	 */
+	bool trySet(size_t index, Voxel voxel) noexcept
+	{
+		if (index >= C::size)
+			return false;
+		set(index, voxel);
+		return true;
+	}
+
+	/**
+	 * @brief Fills chunk with specified voxel ID.
+	 * @param voxel target voxel ID
+	 */
+	void fill(Voxel voxel) noexcept
+	{
+		C::fill(voxel);
+		trackAll();
+	}
+	/**
+	 * @brief Fills chunk part with specified voxel ID.
+	 *
+	 * @param voxel target voxel ID
+	 * @param _sizeX chunk part size along X-axis
+	 * @param _sizeY chunk part size along Y-axis
+	 * @param _sizeZ chunk part size along Z-axis
+	 * @param offsetX chunk part offset along X-axis
+	 * @param offsetY chunk part offset along Y-axis
+	 * @param offsetZ chunk part offset along Z-axis
+	 */
+	void fill(Voxel voxel, uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX = 0, uint8_t offsetY = 0, uint8_t offsetZ = 0) noexcept
+	{
+		C::fill(voxel, _sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ);
+		track(_sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ);
+	}
+
+	/**
+	 * @brief Replaces all chunk voxels with specified ID.
+	 * @details Whole chunk is marked as changed if any voxel was replaced.
+	 * @return Replaced voxel count.
+	 *
+	 * @param from voxel ID to replace
+	 * @param to new voxel ID
+	 */
+	size_t replace(Voxel from, Voxel to) noexcept
+	{
+		auto result = C::replace(from, to);
+		if (result > 0)
+			trackAll();
+		return result;
+	}
+	/**
+	 * @brief Replaces chunk part voxels with specified ID.
+	 * @details Whole chunk part is marked as changed if any voxel was replaced.
+	 * @return Replaced voxel count.
+	 *
+	 * @param from voxel ID to replace
+	 * @param to new voxel ID
+	 * @param _sizeX chunk part size along X-axis
+	 * @param _sizeY chunk part size along Y-axis
+	 * @param _sizeZ chunk part size along Z-axis
+	 * @param offsetX chunk part offset along X-axis
+	 * @param offsetY chunk part offset along Y-axis
+	 * @param offsetZ chunk part offset along Z-axis
+	 */
+	size_t replace(Voxel from, Voxel to, uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX = 0, uint8_t offsetY = 0, uint8_t offsetZ = 0) noexcept
+	{
+		auto result = C::replace(from, to, _sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ);
+		if (result > 0)
+			track(_sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ);
+		return result;
+	}
+
+	/**
+	 * @brief Copies voxels from specified array to this chunk.
+	 * @note Voxel array should have bigger or the same size as chunk, and the same layout!
+	 * @param[in] voxels target voxel array
+	 */
+	void copy(const Voxel* voxels) noexcept
+	{
+		C::copy(voxels);
+		trackAll();
+	}
+	/**
+	 * @brief Copies voxels from specified array part to this chunk.
+	 * @note Voxel array should have bigger or the same size as specified part, and linear layout!
+	 *
+	 * @param[in] target voxel array
+	 * @param _sizeX voxel array part size along X-axis
+	 * @param _sizeY voxel array part size along Y-axis
+	 * @param _sizeZ voxel array part size along Z-axis
+	 * @param offsetX voxel array part offset along X-axis
+	 * @param offsetY voxel array part offset along Y-axis
+	 * @param offsetZ voxel array part offset along Z-axis
+	 */
+	void copy(const Voxel* voxels, uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX = 0, uint8_t offsetY = 0, uint8_t offsetZ = 0) noexcept
+	{
+		C::copy(voxels, _sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ);
+		track(_sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ);
+	}
+	/**
+	 * @brief Copies voxels from specified chunk, converting the voxel array layout if it's different.
+	 * @param[in] chunk source chunk
+	 */
+	template<class SL>
+	void copy(const Chunk3<C::sizeX, C::sizeY, C::sizeZ, Voxel, SL>& chunk) noexcept
+	{
+		C::copy(chunk);
+		trackAll();
+	}
+};
+
+};
\ No newline at end of file
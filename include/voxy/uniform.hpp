@@ -0,0 +1,340 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Uniform (single value) voxel chunk functions.
+ *
+ * @details
+ * Uniform chunk stores only one voxel ID while the whole chunk has the same value, and allocates
+ * dense voxel storage lazily on the first write that breaks uniformity.
+ */
+
+#pragma once
+#include "voxy/chunk.hpp"
+#include <memory>
+
+namespace voxy
+{
+
+/**
+ * @brief Lazily allocated voxel 3D container.
+ * @details It has the same voxel access interface as the @ref Chunk3, so it can be used inside a cluster.
+ *
+ * @tparam SX chunk size in voxels along X-axis
+ * @tparam SY chunk size in voxels along Y-axis
+ * @tparam SZ chunk size in voxels along Z-axis
+ * @tparam V chunk voxel ID type
+ */
+template<uint8_t SX, uint8_t SY, uint8_t SZ, typename V>
+struct UniformChunk3
+{
+public:
+	/**
+	 * @brief Chunk size in voxels along X-axis.
+	 */
+	static constexpr uint8_t sizeX = SX;
+	/**
+	 * @brief Chunk size in voxels along Y-axis.
+	 */
+	static constexpr uint8_t sizeY = SY;
+	/**
+	 * @brief Chunk size in voxels along Z-axis.
+	 */
+	static constexpr uint8_t sizeZ = SZ;
+	/**
+	 * @brief Chunk layer size in voxels. (sizeX * sizeY)
+	 */
+	static constexpr uint16_t sizeXY = SX * SY;
+	/**
+	 * @brief Chunk array size in voxels, or chunk volume. (sizeX * sizeY * sizeZ)
+	 */
+	static constexpr size_t size = SX * SY * SZ;
+	/**
+	 * @brief Chunk voxel ID type.
+	 */
+	typedef V Voxel;
+	/**
+	 * @brief Dense chunk type with the same size and voxel type.
+	 */
+	typedef Chunk3<SX, SY, SZ, V> Dense;
+protected:
+	std::unique_ptr<Dense> dense;
+	Voxel value = voxel::null;
+public:
+	/**
+	 * @brief Creates a new uniform chunk.
+	 * @note It doesn't allocate dense voxel storage.
+	 * @param voxel target voxel to fill chunk with
+	 */
+	UniformChunk3(Voxel voxel = voxel::null) noexcept : value(voxel) { }
+	/**
+	 * @brief Creates a new copy of the uniform chunk.
+	 * @param[in] chunk target uniform chunk
+	 */
+	UniformChunk3(const UniformChunk3& chunk) : value(chunk.value)
+	{
+		if (chunk.dense)
+			dense = std::make_unique<Dense>(*chunk.dense);
+	}
+	UniformChunk3(UniformChunk3&& chunk) noexcept = default;
+
+	UniformChunk3& operator=(const UniformChunk3& chunk)
+	{
+		if (this == &chunk)
+			return *this;
+		value = chunk.value;
+		if (!chunk.dense)
+			dense.reset();
+		else if (dense)
+			*dense = *chunk.dense;
+		else
+			dense = std::make_unique<Dense>(*chunk.dense);
+		return *this;
+	}
+	UniformChunk3& operator=(UniformChunk3&& chunk) noexcept = default;
+
+	/**
+	 * @brief Returns true if all chunk voxels have the same value and dense storage is not allocated.
+	 */
+	bool isUniform() const noexcept { return !dense; }
+	/**
+	 * @brief Returns uniform chunk voxel ID.
+	 * @note Value is valid only if chunk is uniform.
+	 */
+	Voxel getValue() const noexcept { return value; }
+	/**
+	 * @brief Returns dense chunk storage, or null if chunk is uniform.
+	 */
+	Dense* getDense() noexcept { return dense.get(); }
+	/**
+	 * @brief Returns constant dense chunk storage, or null if chunk is uniform.
+	 */
+	const Dense* getDense() const noexcept { return dense.get(); }
+	/**
+	 * @brief Returns chunk memory usage in bytes. (including dense storage)
+	 */
+	size_t getMemoryUsage() const noexcept { return sizeof(UniformChunk3) + (dense ? sizeof(Dense) : 0); }
+
+	/**
+	 * @brief Allocates and returns dense chunk storage, filled with the uniform value.
+	 * @details Returns existing dense storage if it is already allocated.
+	 */
+	Dense& makeDense()
+	{
+		if (!dense)
+			dense = std::make_unique<Dense>(value);
+		return *dense;
+	}
+	/**
+	 * @brief Frees dense chunk storage if all its voxels have the same value.
+	 * @return True if chunk is uniform after the call, otherwise false.
+	 */
+	bool optimize() noexcept
+	{
+		if (!dense)
+			return true;
+
+		auto voxels = dense->getVoxels();
+		auto voxel = voxels[0];
+		for (size_t i = 1; i < size; i++)
+		{
+			if (voxels[i] != voxel)
+				return false;
+		}
+
+		value = voxel;
+		dense.reset();
+		return true;
+	}
+
+	/**
+	 * @brief Calculates chunk voxel index from the position.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 */
+	static constexpr size_t posToIndex(uint8_t x, uint8_t y, uint8_t z) noexcept
+	{
+		return Dense::posToIndex(x, y, z);
+	}
+
+	/**
+	 * @brief Returns chunk voxel at specified 3D position.
+	 * @details Uniform chunk returns its value without reading voxel memory.
+	 * @note Use with care, it doesn't checks for out of chunk bounds!
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 */
+	Voxel get(uint8_t x, uint8_t y, uint8_t z) const noexcept
+	{
+		assert(x < SX);
+		assert(y < SY);
+		assert(z < SZ);
+		return dense ? dense->get(x, y, z) : value;
+	}
+	/**
+	 * @brief Sets chunk voxel at specified 3D position.
+	 * @details Allocates dense storage if voxel breaks chunk uniformity.
+	 * @note Use with care, it doesn't checks for out of chunk bounds!
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param voxel target voxel ID
+	 */
+	void set(uint8_t x, uint8_t y, uint8_t z, Voxel voxel)
+	{
+		assert(x < SX);
+		assert(y < SY);
+		assert(z < SZ);
+		if (!dense && voxel == value)
+			return;
+		makeDense().set(x, y, z, voxel);
+	}
+
+	/**
+	 * @brief Returns chunk voxel at specified array index.
+	 * @note Use with care, it doesn't checks for out of array bounds!
+	 * @param index target voxel index inside array
+	 */
+	Voxel get(size_t index) const noexcept
+	{
+		assert(index < size);
+		return dense ? dense->get(index) : value;
+	}
+	/**
+	 * @brief Sets chunk voxel at specified array index.
+	 * @details Allocates dense storage if voxel breaks chunk uniformity.
+	 * @note Use with care, it doesn't checks for out of array bounds!
+	 *
+	 * @param index target voxel index inside array
+	 * @param voxel target voxel ID
+	 */
+	void set(size_t index, Voxel voxel)
+	{
+		assert(index < size);
+		if (!dense && voxel == value)
+			return;
+		makeDense().set(index, voxel);
+	}
+
+	/**
+	 * @brief Returns chunk voxel at specified 3D position if inside chunk bounds.
+	 * @return True if voxel position is inside chunk bounds, otherwise false.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param[out] voxel target voxel ID
+	 */
+	bool tryGet(uint8_t x, uint8_t y, uint8_t z, Voxel& voxel) const noexcept
+	{
+		if (x >= SX || y >= SY || z >= SZ)
+			return false;
+		voxel = dense ? dense->get(x, y, z) : value;
+		return true;
+	}
+	/**
+	 * @brief Sets chunk voxel at specified 3D position if inside chunk bounds.
+	 * @return True if voxel position is inside chunk bounds, otherwise false.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param voxel target voxel ID
+	 */
+	bool trySet(uint8_t x, uint8_t y, uint8_t z, Voxel voxel)
+	{
+		if (x >= SX || y >= SY || z >= SZ)
+			return false;
+		set(x, y, z, voxel);
+		return true;
+	}
+
+	/**
+	 * @brief Returns chunk voxel at specified array index if inside array bounds.
+	 * @return True if voxel index is inside array bounds, otherwise false.
+	 *
+	 * @param index target voxel index inside array
+	 * @param[out] voxel target voxel ID
+	 */
+	bool tryGet(size_t index, Voxel& voxel) const noexcept
+	{
+		if (index >= size)
+			return false;
+		voxel = dense ? dense->get(index) : value;
+		return true;
+	}
+	/**
+	 * @brief Sets chunk voxel at specified array index if inside array bounds.
+	 * @return True if voxel index is inside array bounds, otherwise false.
+	 *
+	 * @param index target voxel index inside array
+	 * @param voxel target voxel ID
+	 */
+	bool trySet(size_t index, Voxel voxel)
+	{
+		if (index >= size)
+			return false;
+		set(index, voxel);
+		return true;
+	}
+
+	/**
+	 * @brief Fills chunk with specified voxel ID.
+	 * @details Frees dense storage, so chunk becomes uniform.
+	 * @param voxel target voxel ID
+	 */
+	void fill(Voxel voxel) noexcept
+	{
+		dense.reset();
+		value = voxel;
+	}
+
+	/**
+	 * @brief Copies voxels from specified array to this chunk.
+	 * @note Voxel array should have bigger or the same size as chunk!
+	 * @param[in] voxels target voxel array
+	 */
+	void copy(const Voxel* voxels)
+	{
+		assert(voxels);
+		if (!dense)
+			dense = std::make_unique<Dense>();
+		dense->copy(voxels);
+	}
+	/**
+	 * @brief Copies voxels from specified array part to this chunk.
+	 * @note Voxel array should have bigger or the same size as specified part!
+	 *
+	 * @param[in] voxels target voxel array
+	 * @param _sizeX voxel array part size along X-axis
+	 * @param _sizeY voxel array part size along Y-axis
+	 * @param _sizeZ voxel array part size along Z-axis
+	 * @param offsetX voxel array part offset along X-axis
+	 * @param offsetY voxel array part offset along Y-axis
+	 * @param offsetZ voxel array part offset along Z-axis
+	 */
+	void copy(const Voxel* voxels, uint8_t _sizeX, uint8_t _sizeY, uint8_t _sizeZ,
+		uint8_t offsetX = 0, uint8_t offsetY = 0, uint8_t offsetZ = 0)
+	{
+		makeDense().copy(voxels, _sizeX, _sizeY, _sizeZ, offsetX, offsetY, offsetZ);
+	}
+};
+
+};
\ No newline at end of file
@@ -0,0 +1,498 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/***********************************************************************************************************************
+ * @file
+ * @brief Voxel world (chunk map) functions.
+ *
+ * @details
+ * World stores chunks in the open addressing hash table (linear probing) keyed by the integer chunk position.
+ * Chunk instances are allocated from the chunk pool slabs, so their pointers stay valid until the chunk is destroyed.
+ */
+
+#pragma once
+#include "voxy/cluster.hpp"
+#include "voxy/pool.hpp"
+
+#include <memory>
+#include <utility>
+
+namespace voxy
+{
+
+/**
+ * @brief Calculates chunk position hash.
+ *
+ * @param x chunk position along X-axis
+ * @param y chunk position along Y-axis
+ * @param z chunk position along Z-axis
+ */
+static constexpr uint64_t hashChunkPos(int32_t x, int32_t y, int32_t z) noexcept
+{
+	auto hash = (uint64_t)(uint32_t)x * 0x9E3779B185EBCA87ull;
+	hash ^= (uint64_t)(uint32_t)y * 0xC2B2AE3D27D4EB4Full;
+	hash ^= (uint64_t)(uint32_t)z * 0x165667B19E3779F9ull;
+	hash ^= hash >> 32;
+	hash *= 0xD6E8FEB86659FD93ull;
+	return hash ^ (hash >> 32);
+}
+
+/**
+ * @brief Converts world voxel position to the chunk position. (floor division)
+ *
+ * @tparam S chunk size in voxels along the axis
+ * @param position voxel position in the world
+ */
+template<uint8_t S>
+static constexpr int32_t worldToChunkPos(int32_t position) noexcept
+{
+	return (position >= 0 ? position : position - (S - 1)) / S;
+}
+
+/***********************************************************************************************************************
+ * @brief Sparse voxel chunk 3D container. (map)
+ *
+ * @details
+ * It uses linear probing with backward shift deletion, so the lookup is the hash
+ * calculation and a short scan over the continuous entry array, without tombstones.
+ *
+ * @tparam C world chunk type
+ */
+template<class C>
+class World3
+{
+public:
+	/**
+	 * @brief World chunk type.
+	 */
+	typedef C Chunk;
+	/**
+	 * @brief Chunk voxel ID type.
+	 */
+	typedef typename C::Voxel Voxel;
+	/**
+	 * @brief World chunk cluster type.
+	 */
+	typedef Cluster3<C, Voxel> Cluster;
+	/**
+	 * @brief World chunk pool type.
+	 */
+	typedef ChunkPool<C> Pool;
+protected:
+	struct Entry
+	{
+		int32_t x, y, z;
+		C* chunk;
+	};
+
+	std::unique_ptr<Pool> ownedPool;
+	std::unique_ptr<Entry[]> entries;
+	Pool* pool = nullptr;
+	size_t capacity = 0;
+	size_t chunkCount = 0;
+
+	size_t findEntry(int32_t x, int32_t y, int32_t z) const noexcept
+	{
+		if (capacity == 0)
+			return SIZE_MAX;
+
+		auto mask = capacity - 1;
+		auto index = hashChunkPos(x, y, z) & mask;
+		while (true)
+		{
+			const auto& entry = entries[index];
+			if (!entry.chunk)
+				return SIZE_MAX;
+			if (entry.x == x && entry.y == y && entry.z == z)
+				return index;
+			index = (index + 1) & mask;
+		}
+	}
+	void insertEntry(Entry* _entries, size_t _capacity, const Entry& entry) noexcept
+	{
+		auto mask = _capacity - 1;
+		auto index = hashChunkPos(entry.x, entry.y, entry.z) & mask;
+		while (_entries[index].chunk)
+			index = (index + 1) & mask;
+		_entries[index] = entry;
+	}
+	void rehash(size_t newCapacity)
+	{
+		auto newEntries = new Entry[newCapacity];
+		for (size_t i = 0; i < newCapacity; i++)
+			newEntries[i].chunk = nullptr;
+
+		for (size_t i = 0; i < capacity; i++)
+		{
+			if (entries[i].chunk)
+				insertEntry(newEntries, newCapacity, entries[i]);
+		}
+
+		entries.reset(newEntries);
+		capacity = newCapacity;
+	}
+public:
+	/**
+	 * @brief Creates a new empty world.
+	 * @param[in] pool chunk pool to allocate chunks from, or null to create own one
+	 */
+	World3(Pool* pool = nullptr) : pool(pool)
+	{
+		if (!pool)
+		{
+			ownedPool = std::make_unique<Pool>();
+			this->pool = ownedPool.get();
+		}
+	}
+	/**
+	 * @brief Destroys all world chunks.
+	 */
+	~World3() { clear(); }
+
+	/**
+	 * @brief Creates a new world copy.
+	 * @details Chunks are copy constructed, so @ref SharedChunk3 world copy (snapshot) costs a reference count
+	 *          increment per chunk, voxels are cloned later by the first modification.
+	 *
+	 * @param[in] world source world
+	 * @param[in] pool chunk pool to allocate chunks from, or null to create own one
+	 */
+	World3(const World3& world, Pool* pool = nullptr) : World3(pool) { *this = world; }
+	World3& operator=(const World3& world)
+	{
+		if (this == &world)
+			return *this;
+		assert(pool);
+		clear();
+		if (world.chunkCount > 0)
+			reserve(world.chunkCount);
+
+		for (size_t i = 0; i < world.capacity; i++)
+		{
+			const auto& entry = world.entries[i];
+			if (entry.chunk)
+				insertEntry(entries.get(), capacity, { entry.x, entry.y, entry.z, pool->allocate(*entry.chunk) });
+		}
+		chunkCount = world.chunkCount;
+		return *this;
+	}
+
+	World3(World3&& world) noexcept { *this = std::move(world); }
+	World3& operator=(World3&& world) noexcept
+	{
+		if (this == &world)
+			return *this;
+		if (pool)
+			clear();
+		ownedPool = std::move(world.ownedPool); entries = std::move(world.entries);
+		pool = world.pool; capacity = world.capacity; chunkCount = world.chunkCount;
+		world.pool = nullptr; world.capacity = world.chunkCount = 0;
+		return *this;
+	}
+
+	/**
+	 * @brief Returns world chunk pool.
+	 */
+	Pool& getPool() noexcept { return *pool; }
+
+	/**
+	 * @brief Returns world chunk count.
+	 */
+	size_t getChunkCount() const noexcept { return chunkCount; }
+	/**
+	 * @brief Returns world hash table capacity.
+	 */
+	size_t getCapacity() const noexcept { return capacity; }
+
+	/**
+	 * @brief Preallocates hash table memory for the specified chunk count.
+	 * @param chunkCount target chunk count
+	 */
+	void reserve(size_t chunkCount)
+	{
+		auto newCapacity = capacity > 0 ? capacity : 16;
+		while (newCapacity / 2 < chunkCount)
+			newCapacity *= 2;
+		if (newCapacity != capacity)
+			rehash(newCapacity);
+	}
+
+	/**
+	 * @brief Returns world chunk at specified position, or null if it is not created.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 */
+	C* getChunk(int32_t x, int32_t y, int32_t z) noexcept
+	{
+		auto index = findEntry(x, y, z);
+		return index == SIZE_MAX ? nullptr : entries[index].chunk;
+	}
+	/**
+	 * @brief Returns constant world chunk at specified position, or null if it is not created.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 */
+	const C* getChunk(int32_t x, int32_t y, int32_t z) const noexcept
+	{
+		auto index = findEntry(x, y, z);
+		return index == SIZE_MAX ? nullptr : entries[index].chunk;
+	}
+
+	/**
+	 * @brief Creates a new world chunk at specified position.
+	 * @details Returns existing chunk if it is already created.
+	 * @note New chunk is default constructed, so @ref Chunk3 may contain garbage voxels.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 */
+	C* createChunk(int32_t x, int32_t y, int32_t z)
+	{
+		auto index = findEntry(x, y, z);
+		if (index != SIZE_MAX)
+			return entries[index].chunk;
+
+		reserve(chunkCount + 1);
+		auto chunk = pool->allocate();
+		insertEntry(entries.get(), capacity, { x, y, z, chunk });
+		chunkCount++;
+		return chunk;
+	}
+	/**
+	 * @brief Inserts chunk allocated from the world pool at specified position.
+	 * @details Chunk can be allocated and filled on other thread, then adopted by the world owner thread.
+	 * @return True on success, otherwise false if chunk is already created. (chunk is not adopted)
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 * @param[in] chunk target chunk allocated from the world pool
+	 */
+	bool adoptChunk(int32_t x, int32_t y, int32_t z, C* chunk)
+	{
+		assert(chunk);
+		if (findEntry(x, y, z) != SIZE_MAX)
+			return false;
+
+		reserve(chunkCount + 1);
+		insertEntry(entries.get(), capacity, { x, y, z, chunk });
+		chunkCount++;
+		return true;
+	}
+	/**
+	 * @brief Destroys world chunk at specified position.
+	 * @return True if chunk was destroyed, otherwise false if it is not created.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 */
+	bool destroyChunk(int32_t x, int32_t y, int32_t z) noexcept
+	{
+		auto index = findEntry(x, y, z);
+		if (index == SIZE_MAX)
+			return false;
+
+		pool->deallocate(entries[index].chunk);
+		entries[index].chunk = nullptr;
+		chunkCount--;
+
+		auto mask = capacity - 1;
+		auto next = (index + 1) & mask;
+		while (entries[next].chunk)
+		{
+			const auto& entry = entries[next];
+			auto home = hashChunkPos(entry.x, entry.y, entry.z) & mask;
+			if (((next - home) & mask) >= ((next - index) & mask))
+			{
+				entries[index] = entry;
+				entries[next].chunk = nullptr;
+				index = next;
+			}
+			next = (next + 1) & mask;
+		}
+		return true;
+	}
+	/**
+	 * @brief Destroys all world chunks.
+	 * @note It keeps allocated hash table memory, chunks are returned to the pool.
+	 */
+	void clear() noexcept
+	{
+		for (size_t i = 0; i < capacity; i++)
+		{
+			auto& entry = entries[i];
+			if (!entry.chunk)
+				continue;
+			pool->deallocate(entry.chunk);
+			entry.chunk = nullptr;
+		}
+		chunkCount = 0;
+	}
+
+	/**
+	 * @brief Calls specified function for each world chunk.
+	 * @details Function signature: void(int32_t x, int32_t y, int32_t z, C& chunk)
+	 * @note Do not create or destroy chunks inside the function!
+	 * @param func target function
+	 */
+	template<typename F>
+	void forEach(F&& func)
+	{
+		for (size_t i = 0; i < capacity; i++)
+		{
+			const auto& entry = entries[i];
+			if (entry.chunk)
+				func(entry.x, entry.y, entry.z, *entry.chunk);
+		}
+	}
+	/**
+	 * @brief Calls specified function for each constant world chunk.
+	 * @details Function signature: void(int32_t x, int32_t y, int32_t z, const C& chunk)
+	 * @param func target function
+	 */
+	template<typename F>
+	void forEach(F&& func) const
+	{
+		for (size_t i = 0; i < capacity; i++)
+		{
+			const auto& entry = entries[i];
+			if (entry.chunk)
+				func(entry.x, entry.y, entry.z, (const C&)*entry.chunk);
+		}
+	}
+
+	/**
+	 * @brief Returns chunk cluster at specified chunk position.
+	 * @note Not created cluster chunks are set to null.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 */
+	Cluster getCluster(int32_t x, int32_t y, int32_t z) noexcept
+	{
+		return Cluster(getChunk(x, y, z), getChunk(x - 1, y, z), getChunk(x + 1, y, z),
+			getChunk(x, y - 1, z), getChunk(x, y + 1, z), getChunk(x, y, z - 1), getChunk(x, y, z + 1));
+	}
+	/**
+	 * @brief Returns full chunk cluster at specified chunk position. (including edge and corner chunks)
+	 * @note Not created cluster chunks are set to null.
+	 *
+	 * @param x chunk position along X-axis
+	 * @param y chunk position along Y-axis
+	 * @param z chunk position along Z-axis
+	 */
+	Cluster27<C, Voxel> getCluster27(int32_t x, int32_t y, int32_t z) noexcept
+	{
+		Cluster27<C, Voxel> cluster;
+		for (int8_t dz = -1; dz <= 1; dz++)
+		{
+			for (int8_t dy = -1; dy <= 1; dy++)
+			{
+				for (int8_t dx = -1; dx <= 1; dx++)
+					cluster.setChunk(dx, dy, dz, getChunk(x + dx, y + dy, z + dz));
+			}
+		}
+		return cluster;
+	}
+
+	/**
+	 * @brief Returns world voxel at specified 3D position.
+	 * @note Use with care, it doesn't checks if chunk is created!
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 */
+	Voxel get(int32_t x, int32_t y, int32_t z) const noexcept
+	{
+		auto chunkX = worldToChunkPos<C::sizeX>(x);
+		auto chunkY = worldToChunkPos<C::sizeY>(y);
+		auto chunkZ = worldToChunkPos<C::sizeZ>(z);
+		auto chunk = getChunk(chunkX, chunkY, chunkZ);
+		assert(chunk);
+		return chunk->get((uint8_t)(x - chunkX * C::sizeX),
+			(uint8_t)(y - chunkY * C::sizeY), (uint8_t)(z - chunkZ * C::sizeZ));
+	}
+	/**
+	 * @brief Sets world voxel at specified 3D position.
+	 * @note Use with care, it doesn't checks if chunk is created!
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param voxel target voxel ID
+	 */
+	void set(int32_t x, int32_t y, int32_t z, Voxel voxel)
+	{
+		auto chunkX = worldToChunkPos<C::sizeX>(x);
+		auto chunkY = worldToChunkPos<C::sizeY>(y);
+		auto chunkZ = worldToChunkPos<C::sizeZ>(z);
+		auto chunk = getChunk(chunkX, chunkY, chunkZ);
+		assert(chunk);
+		chunk->set((uint8_t)(x - chunkX * C::sizeX),
+			(uint8_t)(y - chunkY * C::sizeY), (uint8_t)(z - chunkZ * C::sizeZ), voxel);
+	}
+
+	/**
+	 * @brief Returns world voxel at specified 3D position if chunk is created.
+	 * @return True if voxel chunk is created, otherwise false.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param[out] voxel target voxel ID
+	 */
+	bool tryGet(int32_t x, int32_t y, int32_t z, Voxel& voxel) const noexcept
+	{
+		auto chunkX = worldToChunkPos<C::sizeX>(x);
+		auto chunkY = worldToChunkPos<C::sizeY>(y);
+		auto chunkZ = worldToChunkPos<C::sizeZ>(z);
+		auto chunk = getChunk(chunkX, chunkY, chunkZ);
+		if (!chunk)
+			return false;
+		voxel = chunk->get((uint8_t)(x - chunkX * C::sizeX),
+			(uint8_t)(y - chunkY * C::sizeY), (uint8_t)(z - chunkZ * C::sizeZ));
+		return true;
+	}
+	/**
+	 * @brief Sets world voxel at specified 3D position if chunk is created.
+	 * @return True if voxel chunk is created, otherwise false.
+	 *
+	 * @param x voxel position along X-axis
+	 * @param y voxel position along Y-axis
+	 * @param z voxel position along Z-axis
+	 * @param voxel target voxel ID
+	 */
+	bool trySet(int32_t x, int32_t y, int32_t z, Voxel voxel)
+	{
+		auto chunkX = worldToChunkPos<C::sizeX>(x);
+		auto chunkY = worldToChunkPos<C::sizeY>(y);
+		auto chunkZ = worldToChunkPos<C::sizeZ>(z);
+		auto chunk = getChunk(chunkX, chunkY, chunkZ);
+		if (!chunk)
+			return false;
+		chunk->set((uint8_t)(x - chunkX * C::sizeX),
+			(uint8_t)(y - chunkY * C::sizeY), (uint8_t)(z - chunkZ * C::sizeZ), voxel);
+		return true;
+	}
+};
+
+};
\ No newline at end of file
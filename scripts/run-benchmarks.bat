@@ -0,0 +1,42 @@
+@ECHO OFF
+CD /D "%~dp0"
+
+cmake --version > nul
+
+IF NOT %ERRORLEVEL% == 0 (
+    ECHO Failed to get CMake version, please check if it's installed.
+    EXIT /B %ERRORLEVEL%
+)
+
+ECHO Configuring project... 1>&2
+
+cmake -DCMAKE_BUILD_TYPE=Release -DVOXY_BUILD_TESTS=OFF -DVOXY_BUILD_BENCHMARKS=ON -S ../ -B ../build-benchmarks/ 1>&2
+
+IF NOT %ERRORLEVEL% == 0 (
+    ECHO Failed to configure CMake project. 1>&2
+    EXIT /B %ERRORLEVEL%
+)
+
+ECHO( 1>&2
+ECHO Building project... 1>&2
+
+cmake --build ../build-benchmarks/ --config Release --parallel 1>&2
+
+IF NOT %ERRORLEVEL% == 0 (
+    ECHO Failed to build CMake project. 1>&2
+    EXIT /B %ERRORLEVEL%
+)
+
+ECHO( 1>&2
+ECHO Running benchmarks... 1>&2
+
+FOR %%B IN (..\build-benchmarks\Release\BenchVoxy*.exe) DO (
+    "%%B" %*
+
+    IF ERRORLEVEL 1 (
+        ECHO Failed to run %%B benchmark. 1>&2
+        EXIT /B 1
+    )
+)
+
+EXIT /B 0
\ No newline at end of file
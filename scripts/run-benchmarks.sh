@@ -0,0 +1,47 @@
+#!/bin/bash
+cd "$(dirname "$BASH_SOURCE")"
+
+cmake --version > /dev/null
+status=$?
+
+if [ $status -ne 0 ]; then
+    echo "Failed to get CMake version, please check if it's installed."
+    exit $status
+fi
+
+echo "Configuring project..." >&2
+
+cmake -DCMAKE_BUILD_TYPE=Release -DVOXY_BUILD_TESTS=OFF -DVOXY_BUILD_BENCHMARKS=ON \
+    -S ../ -B ../build-benchmarks/ >&2
+status=$?
+
+if [ $status -ne 0 ]; then
+    echo "Failed to configure CMake project." >&2
+    exit $status
+fi
+
+echo "" >&2
+echo "Building project..." >&2
+
+cmake --build ../build-benchmarks/ --config Release --parallel >&2
+status=$?
+
+if [ $status -ne 0 ]; then
+    echo "Failed to build CMake project." >&2
+    exit $status
+fi
+
+echo "" >&2
+echo "Running benchmarks..." >&2
+
+for benchmark in ../build-benchmarks/BenchVoxy*; do
+    "$benchmark" "$@"
+    status=$?
+
+    if [ $status -ne 0 ]; then
+        echo "Failed to run $benchmark benchmark." >&2
+        exit $status
+    fi
+done
+
+exit 0
\ No newline at end of file
@@ -22,8 +22,151 @@ using namespace voxy;
 
 typedef Chunk3<16, 16, 16, uint8_t> Chunk;
 
+static void testParts()
+{
+	Chunk chunk(voxel::null);
+	chunk.fill(100, 16, 16, 2, 0, 0, 3);
+	chunk.fill(101, 16, 2, 3, 0, 4, 7);
+	chunk.fill(102, 2, 3, 4, 5, 6, 10);
+
+	for (uint8_t z = 0; z < 16; z++)
+	{
+		for (uint8_t y = 0; y < 16; y++)
+		{
+			for (uint8_t x = 0; x < 16; x++)
+			{
+				uint8_t voxel = voxel::null;
+				if (z >= 3 && z < 5)
+					voxel = 100;
+				else if (z >= 7 && z < 10 && y >= 4 && y < 6)
+					voxel = 101;
+				else if (z >= 10 && z < 14 && y >= 6 && y < 9 && x >= 5 && x < 7)
+					voxel = 102;
+
+				if (chunk.get(x, y, z) != voxel)
+					throw runtime_error("Bad chunk part fill.");
+			}
+		}
+	}
+
+	Chunk copy(voxel::null);
+	copy.copy(chunk.getVoxels() + Chunk::posToIndex(0, 0, 3), 16, 16, 2, 0, 0, 3);
+	copy.copy(chunk.getVoxels() + Chunk::posToIndex(0, 4, 7), 16, 2, 1, 0, 4, 7);
+	copy.copy(chunk.getVoxels() + Chunk::posToIndex(0, 4, 8), 16, 2, 1, 0, 4, 8);
+	copy.copy(chunk.getVoxels() + Chunk::posToIndex(0, 4, 9), 16, 2, 1, 0, 4, 9);
+
+	uint8_t part[2 * 3 * 4];
+	memset(part, 102, sizeof(part));
+	copy.copy(part, 2, 3, 4, 5, 6, 10);
+
+	if (copy != chunk || copy.findDifference(chunk) != Chunk::size)
+		throw runtime_error("Bad chunk part copy.");
+
+	copy.set(7, 8, 9, 1);
+	if (copy == chunk || copy.findDifference(chunk) != Chunk::posToIndex(7, 8, 9) ||
+		copy.findDifference(chunk, Chunk::posToIndex(7, 8, 9) + 1) != Chunk::size)
+	{
+		throw runtime_error("Bad chunk difference.");
+	}
+}
+
+template<class C>
+static void testBulk()
+{
+	C chunk(voxel::null);
+	chunk.fill(100, 4, 5, 6, 1, 2, 3);
+
+	if (chunk.count(100) != 4 * 5 * 6 || chunk.count(voxel::null, 4, 5, 6, 1, 2, 3) != 0 ||
+		chunk.count(100, 16, 16, 4, 0, 0, 0) != 4 * 5)
+	{
+		throw runtime_error("Bad chunk voxel count.");
+	}
+
+	if (chunk.replace(100, 101, 2, 5, 6, 1, 2, 3) != 2 * 5 * 6 || chunk.replace(voxel::null, voxel::unknown) !=
+		C::size - 4 * 5 * 6 || chunk.count(101) != 2 * 5 * 6 || chunk.get(0, 0, 0) != voxel::unknown)
+	{
+		throw runtime_error("Bad chunk voxel replace.");
+	}
+
+	uint32_t histogram[256] = {};
+	chunk.calcHistogram(histogram, 256);
+	if (histogram[100] != 2 * 5 * 6 || histogram[101] != 2 * 5 * 6 ||
+		histogram[voxel::unknown] != C::size - 4 * 5 * 6 || histogram[voxel::null] != 0)
+	{
+		throw runtime_error("Bad chunk voxel histogram.");
+	}
+
+	uint32_t smallHistogram[101] = {};
+	chunk.calcHistogram(smallHistogram, 101);
+	if (smallHistogram[100] != 2 * 5 * 6 || smallHistogram[voxel::unknown] != C::size - 4 * 5 * 6)
+		throw runtime_error("Bad chunk voxel small histogram.");
+}
+
+template<class C>
+static void testLayout()
+{
+	static_assert(C::posToIndex(0, 0, 0) == 0, "Bad chunk layout first index");
+	C chunk(voxel::null);
+	Chunk linear(voxel::null);
+	for (uint8_t z = 0; z < C::sizeZ; z++)
+	{
+		for (uint8_t y = 0; y < C::sizeY; y++)
+		{
+			for (uint8_t x = 0; x < C::sizeX; x++)
+			{
+				auto index = C::posToIndex(x, y, z);
+				if (index >= C::size || chunk.get(index) != voxel::null)
+					throw runtime_error("Bad chunk layout index.");
+				uint8_t ix, iy, iz;
+				C::indexToPos(index, ix, iy, iz);
+				if (ix != x || iy != y || iz != z)
+					throw runtime_error("Bad chunk layout index position.");
+				chunk.set(index, (uint8_t)(x + y + z + 2));
+			}
+		}
+	}
+
+	linear.copy(chunk);
+	chunk.fill(voxel::null);
+	chunk.copy(linear);
+	for (uint8_t z = 0; z < C::sizeZ; z++)
+	{
+		for (uint8_t y = 0; y < C::sizeY; y++)
+		{
+			for (uint8_t x = 0; x < C::sizeX; x++)
+			{
+				if (chunk.get(x, y, z) != x + y + z + 2 || linear.get(x, y, z) != x + y + z + 2)
+					throw runtime_error("Bad chunk layout conversion.");
+			}
+		}
+	}
+
+	uint8_t part[3 * 5 * 2];
+	for (uint8_t i = 0; i < sizeof(part); i++)
+		part[i] = i + 100;
+	chunk.copy(part, 3, 5, 2, 1, 2, 3);
+	chunk.fill(voxel::unknown, 2, 2, 2, 9, 9, 9);
+	if (chunk.get(1, 2, 3) != 100 || chunk.get(3, 6, 4) != 100 + 2 + 4 * 3 + 1 * 15 || chunk.get(4, 2, 3) != 4 + 2 + 3 + 2 ||
+		chunk.count(voxel::unknown, 4, 4, 4, 8, 8, 8) != 8 || chunk.get(10, 10, 10) != voxel::unknown)
+	{
+		throw runtime_error("Bad chunk layout part operation.");
+	}
+}
+
 int main()
 {
+	testParts();
+	testBulk<Chunk>();
+	testBulk<Chunk3<16, 16, 16, uint8_t, layout::Morton>>();
+	testBulk<Chunk3<16, 16, 16, uint8_t, layout::Brick>>();
+	testLayout<Chunk>();
+	testLayout<Chunk3<16, 16, 16, uint8_t, layout::Morton>>();
+	testLayout<Chunk3<16, 16, 16, uint8_t, layout::Brick>>();
+
+	static_assert(layout::Morton::posToIndex<16, 16, 16>(1, 1, 1) == 7, "Bad Morton chunk layout index");
+	static_assert(layout::Morton::posToIndex<16, 16, 16>(15, 15, 15) == 4095, "Bad Morton chunk layout index");
+	static_assert(layout::Brick::posToIndex<16, 16, 16>(4, 0, 0) == 64, "Bad brick chunk layout index");
+
 	Chunk chunk(voxel::null);
 	chunk.set(1, 2, 3, 100);
 
@@ -22,6 +22,125 @@ using namespace voxy;
 
 typedef Chunk3<16, 16, 16, uint8_t> Chunk;
 typedef Cluster3<Chunk, uint8_t> Cluster;
+typedef Cluster27<Chunk, uint8_t> FullCluster;
+
+static void testFullCluster()
+{
+	static Chunk chunks[FullCluster::chunkSize];
+	FullCluster cluster;
+	for (uint8_t i = 0; i < FullCluster::chunkSize; i++)
+	{
+		chunks[i].fill(i + 10);
+		cluster.chunks[i] = &chunks[i];
+	}
+
+	if (!cluster.isComplete() || cluster.getChunk(0, 0, 0) != &chunks[13] ||
+		cluster.getChunk(-1, -1, -1) != &chunks[0] || cluster.getChunk(1, 1, 1) != &chunks[26])
+	{
+		throw runtime_error("Bad full cluster chunk index.");
+	}
+
+	for (int16_t z = -16; z < 32; z += 5)
+	{
+		for (int16_t y = -16; y < 32; y += 3)
+		{
+			for (int16_t x = -16; x < 32; x++)
+			{
+				auto index = (z >= 0) + (z >= 16) + ((y >= 0) + (y >= 16)) * 3 + ((x >= 0) + (x >= 16)) * 9;
+				uint8_t voxel = 0;
+				if (cluster.get(x, y, z) != (index % 3) * 9 + (index / 3 % 3) * 3 + index / 9 + 10 ||
+					!cluster.tryGet(x, y, z, voxel) || voxel != cluster.get(x, y, z))
+				{
+					throw runtime_error("Bad full cluster voxel value.");
+				}
+			}
+		}
+	}
+
+	cluster.set(-1, 16, -16, 100);
+	if (chunks[FullCluster::getChunkIndex(-1, 1, -1)].get(15, 0, 0) != 100)
+		throw runtime_error("Bad full cluster set voxel.");
+
+	uint8_t voxel = 0;
+	if (cluster.tryGet(-17, 0, 0, voxel) || cluster.tryGet(0, 32, 0, voxel) || cluster.trySet(0, 0, -17, 1))
+		throw runtime_error("Bad full cluster out of bounds access.");
+
+	cluster.setChunk(1, 0, -1, nullptr);
+	if (cluster.isComplete() || cluster.tryGet(16, 0, -1, voxel) || !cluster.trySet(15, 0, -1, 101) ||
+		chunks[FullCluster::getChunkIndex(0, 0, -1)].get(15, 0, 15) != 101)
+	{
+		throw runtime_error("Bad incomplete full cluster access.");
+	}
+}
+
+static void testCluster()
+{
+	static Chunk chunks[Cluster::chunkSize];
+	for (uint8_t i = 0; i < Cluster::chunkSize; i++)
+		chunks[i].fill(i + 10);
+	Cluster cluster(&chunks[0], &chunks[1], &chunks[2], &chunks[3], &chunks[4], &chunks[5], &chunks[6]);
+
+	if (Cluster::getChunkIndex(0, 0, 0) != 0 || Cluster::getChunkIndex(-1, 0, 0) != 1 ||
+		Cluster::getChunkIndex(0, 1, 0) != 4 || Cluster::getChunkIndex(0, 0, 1) != 6 ||
+		Cluster::getChunkIndex(1, 1, 0) != -1 || Cluster::getChunkIndex(-1, -1, -1) != -1)
+	{
+		throw runtime_error("Bad cluster chunk index.");
+	}
+	for (int8_t i = 0; i < Cluster::chunkSize; i++)
+	{
+		if (cluster.getChunk(i) != &chunks[i])
+			throw runtime_error("Bad cluster chunk.");
+	}
+	if (cluster.getChunk(0, -1, 0) != cluster.ny || cluster.getChunk(1, 0, 0) != cluster.px ||
+		cluster.getChunk(0, 1, 1) != nullptr)
+	{
+		throw runtime_error("Bad cluster chunk offset.");
+	}
+
+	for (int16_t z = -16; z < 32; z++)
+	{
+		for (int16_t y = -16; y < 32; y++)
+		{
+			for (int16_t x = -16; x < 32; x += 3)
+			{
+				auto dx = (x >= 0) + (x >= 16) - 1, dy = (y >= 0) + (y >= 16) - 1, dz = (z >= 0) + (z >= 16) - 1;
+				uint8_t voxel = 0;
+				if (abs(dx) + abs(dy) + abs(dz) > 1)
+				{
+					if (cluster.tryGet(x, y, z, voxel) || cluster.trySet(x, y, z, 1))
+						throw runtime_error("Bad cluster edge chunk access.");
+					continue;
+				}
+
+				auto index = dx ? (dx < 0 ? 1 : 2) : dy ? (dy < 0 ? 3 : 4) : dz ? (dz < 0 ? 5 : 6) : 0;
+				if (cluster.get(x, y, z) != index + 10 || !cluster.tryGet(x, y, z, voxel) || voxel != index + 10)
+					throw runtime_error("Bad cluster voxel value.");
+			}
+		}
+	}
+
+	cluster.set(-1, 5, 6, 100);
+	cluster.set(3, -16, 6, 101);
+	cluster.set(3, 5, 31, 102);
+	if (chunks[1].get(15, 5, 6) != 100 || chunks[3].get(3, 0, 6) != 101 || chunks[6].get(3, 5, 15) != 102)
+		throw runtime_error("Bad cluster set voxel.");
+	if (!cluster.trySet(-16, 0, 0, 103) || chunks[1].get(0, 0, 0) != 103 ||
+		!cluster.trySet(0, 0, -1, 104) || chunks[5].get(0, 0, 15) != 104)
+	{
+		throw runtime_error("Bad cluster try set voxel.");
+	}
+
+	uint8_t voxel = 0;
+	if (cluster.tryGet(-17, 0, 0, voxel) || cluster.tryGet(0, 32, 0, voxel) || cluster.trySet(0, 0, 32, 1))
+		throw runtime_error("Bad cluster out of bounds access.");
+
+	cluster.nz = nullptr;
+	if (cluster.isComplete() || cluster.tryGet(0, 0, -1, voxel) || cluster.trySet(0, 0, -1, 1) ||
+		!cluster.tryGet(0, 0, 0, voxel) || voxel != 10)
+	{
+		throw runtime_error("Bad incomplete cluster access.");
+	}
+}
 
 int main()
 {
@@ -29,6 +148,16 @@ int main()
 
 	Cluster cluster(&chunks[0], &chunks[1], &chunks[2],
 		&chunks[3], &chunks[4], &chunks[5], &chunks[6]);
-	
+
+	FullCluster fullCluster(cluster);
+	if (fullCluster.getChunk(0, 0, 0) != cluster.c || fullCluster.getChunk(-1, 0, 0) != cluster.nx ||
+		fullCluster.getChunk(0, 1, 0) != cluster.py || fullCluster.getChunk(0, 0, 1) != cluster.pz ||
+		fullCluster.getChunk(1, 1, 0) || fullCluster.isComplete())
+	{
+		throw runtime_error("Bad full cluster from cluster.");
+	}
+
+	testCluster();
+	testFullCluster();
 	return EXIT_SUCCESS;
 }
\ No newline at end of file
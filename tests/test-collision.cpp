@@ -0,0 +1,286 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/collision.hpp"
+#include "voxy/occupancy.hpp"
+
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint8_t> Chunk;
+typedef OccupancyChunk3<Chunk3<16, 8, 16, uint8_t>> OccupancyChunk;
+
+static const bool solids[] = { false, true, true, false };
+
+template<class W, typename F>
+static bool overlapNaive(const W& world, const Aabb& box, const F& isSolid)
+{
+	int32_t minX, minY, minZ, maxX, maxY, maxZ;
+	calcVoxelRange(box.minX, box.maxX, minX, maxX);
+	calcVoxelRange(box.minY, box.maxY, minY, maxY);
+	calcVoxelRange(box.minZ, box.maxZ, minZ, maxZ);
+	for (auto z = minZ; z < maxZ; z++)
+	{
+		for (auto y = minY; y < maxY; y++)
+		{
+			for (auto x = minX; x < maxX; x++)
+			{
+				uint8_t voxel = voxel::null;
+				if (world.tryGet(x, y, z, voxel) && isSolid(voxel))
+					return true;
+			}
+		}
+	}
+	return false;
+}
+
+template<class W, typename F>
+static float sweepAxisNaive(const W& world, const Aabb& box, uint8_t axis, float move, const F& isSolid)
+{
+	const float boxMin[3] = { box.minX, box.minY, box.minZ };
+	const float boxMax[3] = { box.maxX, box.maxY, box.maxZ };
+	int32_t min[3], max[3];
+	for (uint8_t i = 0; i < 3; i++)
+		calcVoxelRange(boxMin[i], boxMax[i], min[i], max[i]);
+
+	auto isBlocked = [&](int32_t layer)
+	{
+		min[axis] = layer; max[axis] = layer + 1;
+		Aabb layerBox = { (float)min[0], (float)min[1], (float)min[2], (float)max[0], (float)max[1], (float)max[2] };
+		return overlapNaive(world, layerBox, isSolid);
+	};
+
+	if (move > 0.0f)
+	{
+		for (auto layer = ceilVoxel(boxMax[axis]); layer < ceilVoxel(boxMax[axis] + move); layer++)
+		{
+			if (isBlocked(layer))
+				return std::max((float)layer - boxMax[axis], 0.0f);
+		}
+	}
+	else if (move < 0.0f)
+	{
+		for (auto layer = floorVoxel(boxMin[axis]) - 1; layer >= floorVoxel(boxMin[axis] + move); layer--)
+		{
+			if (isBlocked(layer))
+				return std::min((float)(layer + 1) - boxMin[axis], 0.0f);
+		}
+	}
+	return move;
+}
+
+template<class C>
+static void fillWorld(World3<C>& world, mt19937& random)
+{
+	for (int32_t z = -2; z < 2; z++)
+	{
+		for (int32_t y = -2; y < 2; y++)
+		{
+			for (int32_t x = -2; x < 2; x++)
+			{
+				auto chunk = world.createChunk(x, y, z);
+				chunk->fill(voxel::null);
+				if ((x + y + z) & 1)
+					continue;
+				for (uint32_t i = 0; i < 64; i++)
+					chunk->set(random() % C::sizeX, random() % C::sizeY, random() % C::sizeZ, (uint8_t)(random() % 3 + 1));
+			}
+		}
+	}
+	world.destroyChunk(1, 1, 1);
+}
+
+static Aabb randomBox(mt19937& random, float sizeY)
+{
+	uniform_real_distribution<float> position(-30.0f, 30.0f), size(0.2f, 2.5f);
+	Aabb box;
+	box.minX = position(random); box.minY = position(random) * sizeY / 16.0f; box.minZ = position(random);
+	box.maxX = box.minX + size(random); box.maxY = box.minY + size(random); box.maxZ = box.minZ + size(random);
+	return box;
+}
+
+template<class C>
+static void testOverlap()
+{
+	mt19937 random(1);
+	World3<C> world;
+	fillWorld(world, random);
+	SolidTable table = { solids, 4 };
+
+	for (uint32_t i = 0; i < 2000; i++)
+	{
+		auto box = randomBox(random, C::sizeY);
+		if (overlapWorld(world, box) != overlapNaive(world, box, IsNotNullVoxel()))
+			throw runtime_error("Bad world box overlap.");
+		if (overlapWorld(world, box, table) != overlapNaive(world, box, table))
+			throw runtime_error("Bad world box overlap with solid table.");
+	}
+
+	auto cluster = world.getCluster(0, 0, 0);
+	auto chunk = world.getChunk(0, 0, 0);
+	uniform_real_distribution<float> outer(-10.0f, 10.0f), inner(1.0f, 6.0f);
+	for (uint32_t i = 0; i < 1000; i++)
+	{
+		float pos[3] = { inner(random), inner(random), inner(random) };
+		pos[i % 3] = outer(random) + (i % 3 == 1 ? C::sizeY : C::sizeX) * 0.5f;
+		Aabb box = { pos[0], pos[1], pos[2], pos[0] + inner(random), pos[1] + 1.0f, pos[2] + inner(random) };
+		if (overlapCluster(cluster, box) != overlapNaive(world, box, IsNotNullVoxel()))
+			throw runtime_error("Bad cluster box overlap.");
+
+		auto isInside = box.minX >= 0.0f && box.maxX <= C::sizeX &&
+			box.minY >= 0.0f && box.maxY <= C::sizeY && box.minZ >= 0.0f && box.maxZ <= C::sizeZ;
+		if (isInside && overlapChunk(*chunk, box) != overlapNaive(world, box, IsNotNullVoxel()))
+			throw runtime_error("Bad chunk box overlap.");
+	}
+}
+
+static void testSweep()
+{
+	World3<Chunk> world;
+	for (int32_t z = -2; z < 2; z++)
+	{
+		for (int32_t y = -1; y < 1; y++)
+		{
+			for (int32_t x = -2; x < 2; x++)
+				world.createChunk(x, y, z)->fill(voxel::null);
+		}
+	}
+	for (int32_t z = -32; z < 32; z++)
+	{
+		for (int32_t x = -32; x < 32; x++)
+		{
+			world.set(x, -1, z, 1);
+			world.set(x, 0, z, 3);
+		}
+	}
+	world.set(-3, 1, 0, 2);
+	world.set(-3, 2, 0, 2);
+
+	SolidTable table = { solids, 4 };
+	SweepQuery query;
+	query.box = { -0.7f, 5.0f, 0.2f, -0.1f, 6.8f, 0.8f };
+	query.moveY = -10.0f;
+	auto result = sweepWorld(world, query, table);
+	if (fabsf(result.moveY + 5.0f) > 1.0e-5f || result.normalY != 1 || result.box.minY != 0.0f)
+		throw runtime_error("Bad swept box floor collision.");
+	if (fabsf(sweepWorld(world, query).box.minY - 1.0f) > 1.0e-5f)
+		throw runtime_error("Bad swept box default predicate collision.");
+
+	query.box = result.box;
+	query.moveY = -1.0f;
+	query.moveX = -5.0f;
+	query.moveZ = 0.5f;
+	result = sweepWorld(world, query, table);
+	if (result.moveY != 0.0f || result.normalY != 1 || fabsf(result.box.minX + 2.0f) > 1.0e-5f ||
+		result.normalX != 1 || result.moveZ != 0.5f || result.normalZ != 0)
+	{
+		throw runtime_error("Bad swept box wall collision.");
+	}
+
+	query = SweepQuery();
+	query.box = { -3.5f, 1.2f, 0.2f, -2.9f, 2.8f, 0.8f };
+	query.moveX = 1.0f;
+	if (sweepWorld(world, query, table).moveX != 1.0f)
+		throw runtime_error("Bad swept box leaving solid voxel.");
+	query.moveX = -1.0f;
+	if (sweepWorld(world, query, table).moveX != -1.0f)
+		throw runtime_error("Bad swept box inside solid voxel.");
+
+	mt19937 random(2);
+	for (uint32_t i = 0; i < 2000; i++)
+		world.set((int32_t)(random() % 64) - 32, (int32_t)(random() % 32) - 16, (int32_t)(random() % 64) - 32, 2);
+
+	vector<SweepQuery> queries;
+	while (queries.size() < 1000)
+	{
+		SweepQuery randomQuery;
+		randomQuery.box = randomBox(random, 16.0f);
+		if (overlapWorld(world, randomQuery.box, table))
+			continue;
+		uniform_real_distribution<float> move(-6.0f, 6.0f);
+		randomQuery.moveX = move(random); randomQuery.moveY = move(random); randomQuery.moveZ = move(random);
+		queries.push_back(randomQuery);
+	}
+
+	vector<SweepResult> results(queries.size());
+	uint32_t blockedCount = 0;
+	sweepWorld(world, queries.data(), results.data(), queries.size(), table);
+	for (size_t i = 0; i < queries.size(); i++)
+	{
+		const auto& batchResult = results[i];
+		result = sweepWorld(world, queries[i], table);
+		if (memcmp(&result, &batchResult, sizeof(SweepResult)) != 0)
+			throw runtime_error("Bad batched swept box result.");
+		if (overlapWorld(world, result.box, table))
+			throw runtime_error("Bad swept box overlap.");
+
+		auto naiveBox = queries[i].box;
+		auto moveY = sweepAxisNaive(world, naiveBox, 1, queries[i].moveY, table);
+		naiveBox.minY += moveY; naiveBox.maxY += moveY;
+		auto moveX = sweepAxisNaive(world, naiveBox, 0, queries[i].moveX, table);
+		naiveBox.minX += moveX; naiveBox.maxX += moveX;
+		auto moveZ = sweepAxisNaive(world, naiveBox, 2, queries[i].moveZ, table);
+		if (result.moveX != moveX || result.moveY != moveY || result.moveZ != moveZ)
+			throw runtime_error("Bad swept box movement.");
+
+		blockedCount += result.normalX != 0;
+		blockedCount += result.normalY != 0;
+		blockedCount += result.normalZ != 0;
+
+		auto box = queries[i].box;
+		box.minY = result.box.minY - result.normalY * 0.01f; box.maxY = result.box.maxY - result.normalY * 0.01f;
+		if (result.normalY != 0 && !overlapWorld(world, box, table))
+			throw runtime_error("Bad swept box blocked axis.");
+
+		box = queries[i].box;
+		box.minY = result.box.minY; box.maxY = result.box.maxY;
+		box.minX = result.box.minX - result.normalX * 0.01f; box.maxX = result.box.maxX - result.normalX * 0.01f;
+		if (result.normalX != 0 && !overlapWorld(world, box, table))
+			throw runtime_error("Bad swept box blocked axis.");
+
+		box = result.box;
+		box.minZ -= result.normalZ * 0.01f; box.maxZ -= result.normalZ * 0.01f;
+		if (result.normalZ != 0 && !overlapWorld(world, box, table))
+			throw runtime_error("Bad swept box blocked axis.");
+	}
+
+	if (blockedCount < 100)
+		throw runtime_error("Bad swept box blocked count.");
+
+	OccupancyChunk chunk(voxel::null);
+	auto cluster = Cluster3<OccupancyChunk, uint8_t>(&chunk, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
+	chunk.set(4, 0, 4, 1);
+	query = SweepQuery();
+	query.box = { 4.1f, 6.0f, 4.1f, 4.9f, 7.0f, 4.9f };
+	query.moveY = -20.0f;
+	result = sweepCluster(cluster, query);
+	if (fabsf(result.box.minY - 1.0f) > 1.0e-5f || result.normalY != 1)
+		throw runtime_error("Bad swept box cluster collision.");
+	query.box = { 5.1f, 6.0f, 4.1f, 5.9f, 7.0f, 4.9f };
+	if (sweepCluster(cluster, query).moveY != -20.0f)
+		throw runtime_error("Bad swept box cluster miss.");
+}
+
+int main()
+{
+	testOverlap<Chunk>();
+	testOverlap<OccupancyChunk>();
+	testSweep();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,178 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/concurrent.hpp"
+
+#include <vector>
+#include <thread>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint16_t> Chunk;
+typedef ConcurrentWorld3<Chunk> World;
+
+static void testChunks()
+{
+	World world(16);
+	if (!world.createChunk(1, -2, 3, 7) || !world.createChunk(1, -2, 3, 8) || world.getChunkCount() != 1 ||
+		!world.createChunk(World::minPosition, World::maxPosition, 0) || world.getChunkCount() != 2)
+	{
+		throw runtime_error("Bad concurrent world chunk creation.");
+	}
+
+	Chunk chunk(voxel::null);
+	uint32_t version = UINT32_MAX;
+	if (!world.tryRead(1, -2, 3, chunk) || chunk.count(7) != Chunk::size || world.tryRead(0, 0, 0, chunk) ||
+		!world.tryGetVersion(1, -2, 3, version) || version != 0)
+	{
+		throw runtime_error("Bad concurrent world chunk read.");
+	}
+
+	{
+		auto lease = world.tryLease(1, -2, 3);
+		if (!lease || world.tryLease(1, -2, 3) || world.tryLease(0, 0, 0))
+			throw runtime_error("Bad concurrent world chunk lease.");
+		lease->set(1, 2, 3, 9);
+	}
+
+	uint16_t voxel = 0;
+	if (!world.tryGet(16 + 1, -32 + 2, 48 + 3, voxel) || voxel != 9 ||
+		!world.tryGetVersion(1, -2, 3, version) || version != 1)
+	{
+		throw runtime_error("Bad concurrent world chunk lease release.");
+	}
+	if (!world.trySet(16, -32, 48, 10) || world.trySet(0, 0, 0, 10) ||
+		!world.tryGet(16, -32, 48, voxel) || voxel != 10)
+	{
+		throw runtime_error("Bad concurrent world voxel set.");
+	}
+
+	World::ClusterSnapshot snapshot;
+	world.createChunk(1, -1, 3, 11);
+	if (!world.snapshotCluster(1, -2, 3, snapshot) || !snapshot.isCreated[4] || snapshot.isCreated[1] ||
+		snapshot.chunks[4].get(0, 0, 0) != 11 || snapshot.versions[0] != 2)
+	{
+		throw runtime_error("Bad concurrent world cluster snapshot.");
+	}
+	auto cluster = snapshot.getCluster();
+	if (cluster.c->get(1, 2, 3) != 9 || !cluster.py || cluster.px)
+		throw runtime_error("Bad concurrent world snapshot cluster.");
+
+	if (!world.destroyChunk(1, -2, 3) || world.destroyChunk(1, -2, 3) || world.hasChunk(1, -2, 3) ||
+		world.getChunkCount() != 2)
+	{
+		throw runtime_error("Bad concurrent world chunk destruction.");
+	}
+	world.collect();
+
+	size_t count = 0;
+	world.forEach([&](int32_t x, int32_t y, int32_t z, Chunk&)
+	{
+		if (!(x == 1 && y == -1 && z == 3) && !(x == World::minPosition && y == World::maxPosition && z == 0))
+			throw runtime_error("Bad concurrent world chunk position.");
+		count++;
+	});
+	if (count != 2 || !world.hasChunk(1, -1, 3))
+		throw runtime_error("Bad collected concurrent world.");
+
+	for (int32_t i = 0; i < 64; i++)
+	{
+		if (!world.createChunk(i, 0, 0))
+		{
+			world.collect();
+			if (!world.createChunk(i, 0, 0))
+				throw runtime_error("Bad concurrent world collect grow.");
+		}
+	}
+	if (world.getChunkCount() != 66)
+		throw runtime_error("Bad grown concurrent world chunk count.");
+}
+
+static void testThreads()
+{
+	constexpr int32_t chunkCount = 8;
+	constexpr uint32_t writeCount = 2000;
+	World world(64);
+	vector<thread> threads;
+
+	for (int t = 0; t < 4; t++)
+	{
+		threads.emplace_back([&]()
+		{
+			for (int32_t i = 0; i < chunkCount; i++)
+				world.createChunk(i, 0, 0);
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+	threads.clear();
+	if (world.getChunkCount() != chunkCount)
+		throw runtime_error("Bad concurrent world parallel creation.");
+
+	atomic<bool> isInconsistent = false;
+	for (int t = 0; t < 2; t++)
+	{
+		threads.emplace_back([&, t]()
+		{
+			for (uint32_t i = 1; i <= writeCount; i++)
+			{
+				auto lease = world.lease((int32_t)(i % chunkCount), 0, 0);
+				lease->fill((uint16_t)(i * 2 + t));
+			}
+		});
+	}
+	for (int t = 0; t < 2; t++)
+	{
+		threads.emplace_back([&]()
+		{
+			auto snapshot = make_unique<World::ClusterSnapshot>();
+			for (uint32_t i = 0; i < writeCount; i++)
+			{
+				world.snapshotCluster((int32_t)(i % chunkCount), 0, 0, *snapshot);
+				for (uint8_t j = 0; j < 7; j++)
+				{
+					const auto& chunk = snapshot->chunks[j];
+					if (snapshot->isCreated[j] && chunk.count(chunk.get(0)) != Chunk::size)
+						isInconsistent = true;
+				}
+			}
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	if (isInconsistent)
+		throw runtime_error("Bad concurrent world snapshot consistency.");
+
+	uint32_t totalVersion = 0;
+	for (int32_t i = 0; i < chunkCount; i++)
+	{
+		uint32_t version = 0;
+		if (!world.tryGetVersion(i, 0, 0, version))
+			throw runtime_error("Bad concurrent world chunk version lookup.");
+		totalVersion += version;
+	}
+	if (totalVersion != writeCount * 2)
+		throw runtime_error("Bad concurrent world chunk versions.");
+}
+
+int main()
+{
+	testChunks();
+	testThreads();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/delta.hpp"
+
+#include <vector>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+template<class C>
+static void testRoundTrip(const C& from, const C& to, size_t expectedSize)
+{
+	vector<uint8_t> buffer(delta::calcMaxSize<C>());
+	size_t size = 0;
+	if (!delta::encode(from, to, buffer.data(), buffer.size(), size))
+		throw runtime_error("Failed to encode chunk delta.");
+	if (size != expectedSize)
+		throw runtime_error("Bad chunk delta size.");
+
+	auto chunk = from;
+	if (!delta::apply(buffer.data(), size, chunk) || chunk != to)
+		throw runtime_error("Bad applied chunk delta.");
+
+	if (size > 0 && delta::encode(from, to, buffer.data(), size - 1, size))
+		throw runtime_error("Bad chunk delta buffer overflow check.");
+}
+
+template<class C>
+static void testDelta()
+{
+	C from(voxel::null);
+	for (size_t i = 0; i < C::size; i++)
+		from.set(i, (typename C::Voxel)(i % 100));
+	testRoundTrip(from, from, 0);
+
+	constexpr auto voxelSize = sizeof(typename C::Voxel);
+	auto to = from;
+	to.set(0, 200);
+	testRoundTrip(from, to, 2 + voxelSize);
+	to.set(C::size - 1, 200);
+	testRoundTrip(from, to, 3 + voxelSize * 2 + serial::calcVarintSize(C::size - 2));
+
+	to = from;
+	for (size_t i = 10; i < 14; i++)
+		to.set(i, 201);
+	to.set(15, 202); // One voxel gap between the spans.
+	size_t expectedSize = 2 + voxelSize * 5;
+	if (voxelSize > delta::maxGapSize)
+		expectedSize += 2;
+	else
+		expectedSize += voxelSize;
+	testRoundTrip(from, to, expectedSize);
+
+	to.fill(203);
+	testRoundTrip(from, to, delta::calcMaxSize<C>());
+}
+
+static void testIndices()
+{
+	Chunk3<16, 16, 16, uint16_t> chunk(voxel::null);
+	vector<size_t> indices = { 40, 2, 3, 4, 3, 100, 41 };
+	for (auto index : indices)
+		chunk.set(index, (uint16_t)(index + 1));
+
+	vector<uint8_t> buffer(delta::calcMaxSize<decltype(chunk)>());
+	size_t size = 0;
+	if (!delta::encode(chunk, indices.data(), indices.size(), buffer.data(), buffer.size(), size))
+		throw runtime_error("Failed to encode chunk delta from indices.");
+	if (size != (2 + 3 * 2) + (2 + 2 * 2) + (2 + 2))
+		throw runtime_error("Bad chunk delta size from indices.");
+
+	decltype(chunk) other(voxel::null);
+	if (!delta::apply(buffer.data(), size, other) || other != chunk)
+		throw runtime_error("Bad applied chunk delta from indices.");
+
+	size_t emptySize = 1;
+	if (!delta::encode(chunk, indices.data(), 0, buffer.data(), buffer.size(), emptySize) || emptySize != 0)
+		throw runtime_error("Bad empty chunk delta from indices.");
+}
+
+static void testInvalid()
+{
+	Chunk3<16, 16, 16, uint8_t> chunk(voxel::null);
+	const uint8_t zeroLength[] = { 0, 0 };
+	const uint8_t outOfBounds[] = { 0x80, 0x20, 1, 5 }; // skip = 4096
+	const uint8_t truncatedData[] = { 0, 3, 1, 2 };
+	const uint8_t truncatedVarint[] = { 0x80 };
+
+	if (delta::apply(zeroLength, sizeof(zeroLength), chunk) ||
+		delta::apply(outOfBounds, sizeof(outOfBounds), chunk) ||
+		delta::apply(truncatedData, sizeof(truncatedData), chunk) ||
+		delta::apply(truncatedVarint, sizeof(truncatedVarint), chunk))
+	{
+		throw runtime_error("Bad invalid chunk delta check.");
+	}
+	if (!delta::apply(nullptr, 0, chunk) || chunk.get(0) != voxel::null)
+		throw runtime_error("Bad empty chunk delta apply.");
+}
+
+int main()
+{
+	testDelta<Chunk3<16, 16, 16, uint8_t>>();
+	testDelta<Chunk3<16, 16, 16, uint16_t>>();
+	testDelta<Chunk3<32, 32, 32, uint32_t>>();
+	testDelta<Chunk3<16, 16, 16, uint16_t, layout::Morton>>();
+	testIndices();
+	testInvalid();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,160 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/generation.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint8_t> Chunk;
+
+static float calcDensity(int32_t x, int32_t y, int32_t z) noexcept
+{
+	return sinf(x * 0.3f) + cosf(z * 0.2f) - y * 0.1f;
+}
+static int32_t calcHeight(int32_t x, int32_t z) noexcept
+{
+	return (x * 7 + z * 3) % 24 - 4;
+}
+
+static void testDensity()
+{
+	GenerationPipeline3<Chunk> pipeline;
+	pipeline.addDensityStage([](int32_t x, int32_t y, int32_t z, uint8_t count, float* values)
+	{
+		for (uint8_t i = 0; i < count; i++)
+			values[i] = calcDensity(x + i, y, z);
+	}, 2, 0.5f);
+	if (pipeline.getStageCount() != 1)
+		throw runtime_error("Bad pipeline stage count.");
+
+	World3<Chunk> world;
+	world.createChunk(-1, 0, 2)->fill(voxel::unknown);
+	auto chunk = pipeline.generate(world, -1, 0, 2);
+	if (chunk != world.getChunk(-1, 0, 2) || !pipeline.generate(world, 3, -1, 0))
+		throw runtime_error("Bad generated chunk.");
+
+	const int32_t positions[] = { -1, 0, 2, 3, -1, 0 };
+	for (uint8_t i = 0; i < 6; i += 3)
+	{
+		for (int32_t z = 0; z < 16; z++)
+		{
+			for (int32_t y = 0; y < 16; y++)
+			{
+				for (int32_t x = 0; x < 16; x++)
+				{
+					auto worldX = positions[i] * 16 + x, worldY = positions[i + 1] * 16 + y;
+					auto worldZ = positions[i + 2] * 16 + z;
+					auto voxel = calcDensity(worldX, worldY, worldZ) > 0.5f ? 2 : voxel::null;
+					if (world.get(worldX, worldY, worldZ) != voxel)
+						throw runtime_error("Bad generated density voxel.");
+				}
+			}
+		}
+	}
+}
+
+static uint8_t calcTerrain(int32_t x, int32_t y, int32_t z) noexcept
+{
+	auto height = calcHeight(x, z);
+	if (y >= height)
+		return voxel::null;
+	if (y == height - 1)
+		return 3;
+	return y < 0 ? 4 : 1;
+}
+
+static void testTerrain()
+{
+	GenerationPipeline3<Chunk> pipeline;
+	pipeline.addHeightStage([](int32_t x, int32_t z, uint8_t count, int32_t* heights)
+	{
+		for (uint8_t i = 0; i < count; i++)
+			heights[i] = calcHeight(x + i, z);
+	}, 1);
+	pipeline.addColumnStage([](GenerationPipeline3<Chunk>::Column& column)
+	{
+		for (uint8_t y = 0; y < column.size && column.worldY + y < 0; y++)
+		{
+			if (column.get(y) == 1)
+				column.set(y, 4);
+		}
+	});
+	pipeline.addClusterStage([](World3<Chunk>::Cluster& cluster, int32_t, int32_t, int32_t)
+	{
+		for (int16_t vz = 0; vz < 16; vz++)
+		{
+			for (int16_t vy = 0; vy < 16; vy++)
+			{
+				for (int16_t vx = 0; vx < 16; vx++)
+				{
+					uint8_t above = voxel::null;
+					cluster.tryGet(vx, vy + 1, vz, above);
+					if (cluster.get(vx, vy, vz) != voxel::null && above == voxel::null)
+						cluster.set(vx, vy, vz, 3);
+				}
+			}
+		}
+	});
+
+	atomic<uint32_t> chunkCount(0);
+	pipeline.addChunkStage([&](Chunk&, int32_t, int32_t, int32_t) { chunkCount++; });
+
+	vector<BatchChunk> chunks;
+	for (int32_t z = -2; z < 2; z++)
+	{
+		for (int32_t y = -1; y < 2; y++)
+		{
+			for (int32_t x = -2; x < 2; x++)
+				chunks.push_back({ x, y, z, (float)(x * x + z * z) });
+		}
+	}
+
+	World3<Chunk> world;
+	ThreadPool pool(4);
+	BatchExecutor executor(pool);
+	if (!pipeline.generate(executor, world, chunks.data(), chunks.size()))
+		throw runtime_error("Bad pipeline generation result.");
+	if (world.getChunkCount() != chunks.size() || chunkCount != chunks.size())
+		throw runtime_error("Bad generated chunk count.");
+
+	for (int32_t z = -32; z < 32; z++)
+	{
+		for (int32_t y = -16; y < 32; y++)
+		{
+			for (int32_t x = -32; x < 32; x++)
+			{
+				if (world.get(x, y, z) != calcTerrain(x, y, z))
+					throw runtime_error("Bad generated terrain voxel.");
+			}
+		}
+	}
+
+	atomic<bool> isCancelled(true);
+	if (pipeline.generate(executor, world, chunks.data(), chunks.size(), &isCancelled))
+		throw runtime_error("Bad cancelled pipeline generation result.");
+	pipeline.clear();
+	if (pipeline.getStageCount() != 0 || !pipeline.generate(executor, world, chunks.data(), chunks.size()))
+		throw runtime_error("Bad empty pipeline.");
+}
+
+int main()
+{
+	testDensity();
+	testTerrain();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,248 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/light.hpp"
+
+#include <random>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint8_t> Chunk;
+typedef LightChunk3<16, 16, 16> LightChunk;
+typedef LightEngine3<Chunk> LightEngine;
+
+struct TestLightProperties
+{
+	uint8_t getOpacity(uint8_t voxel) const noexcept
+	{
+		return voxel == voxel::null ? 0 : voxel == 4 ? 2 : maxLightLevel;
+	}
+	uint8_t getEmission(uint8_t voxel) const noexcept { return voxel == 3 ? 12 : 0; }
+};
+
+struct TestCluster
+{
+	Chunk voxelChunks[7];
+	LightChunk lightChunks[7];
+	LightEngine::Cluster voxels;
+	LightEngine::LightCluster lights;
+
+	TestCluster()
+	{
+		for (uint8_t i = 0; i < 7; i++)
+		{
+			voxelChunks[i].fill(voxel::null);
+			lightChunks[i].fill(0);
+		}
+		voxels = LightEngine::Cluster(voxelChunks, voxelChunks + 1, voxelChunks + 2,
+			voxelChunks + 3, voxelChunks + 4, voxelChunks + 5, voxelChunks + 6);
+		lights = LightEngine::LightCluster(lightChunks, lightChunks + 1, lightChunks + 2,
+			lightChunks + 3, lightChunks + 4, lightChunks + 5, lightChunks + 6);
+	}
+
+	static LightChunk* getChunk(LightChunk* chunks, int16_t& x, int16_t& y, int16_t& z)
+	{
+		uint8_t index = 0;
+		if (x < 0) { x += 16; index = 1; }
+		else if (x >= 16) { x -= 16; index = 2; }
+		else if (y < 0) { y += 16; index = 3; }
+		else if (y >= 16) { y -= 16; index = 4; }
+		else if (z < 0) { z += 16; index = 5; }
+		else if (z >= 16) { z -= 16; index = 6; }
+		return chunks + index;
+	}
+	uint8_t getLight(int16_t x, int16_t y, int16_t z)
+	{
+		auto chunk = getChunk(lightChunks, x, y, z);
+		return chunk->get((uint8_t)x, (uint8_t)y, (uint8_t)z);
+	}
+	void setVoxel(int16_t x, int16_t y, int16_t z, uint8_t voxel)
+	{
+		auto index = getChunk(lightChunks, x, y, z) - lightChunks;
+		voxelChunks[index].set((uint8_t)x, (uint8_t)y, (uint8_t)z, voxel);
+	}
+};
+
+static void testLightChunk()
+{
+	LightChunk chunk(0);
+	chunk.set(1, 2, 3, 15);
+	chunk.set(2, 2, 3, 7);
+	chunk.set(0, 2, 3, 9);
+	if (chunk.get(1, 2, 3) != 15 || chunk.get(2, 2, 3) != 7 || chunk.get(0, 2, 3) != 9 || chunk.get(3, 2, 3) != 0)
+		throw runtime_error("Bad light chunk level.");
+	chunk.set(1, 2, 3, 0);
+	if (chunk.get(1, 2, 3) != 0 || chunk.get(0, 2, 3) != 9)
+		throw runtime_error("Bad light chunk nibble.");
+
+	chunk.fill(11);
+	for (size_t i = 0; i < LightChunk::size; i++)
+	{
+		if (chunk.get(i) != 11)
+			throw runtime_error("Bad light chunk fill.");
+	}
+	if (sizeof(LightChunk) != LightChunk::size / 2)
+		throw runtime_error("Bad light chunk size.");
+}
+
+template<typename F>
+static void forEachClusterPos(F&& func)
+{
+	for (int16_t z = -16; z < 32; z++)
+	{
+		for (int16_t y = -16; y < 32; y++)
+		{
+			for (int16_t x = -16; x < 32; x++)
+			{
+				auto outside = (x < 0 || x >= 16) + (y < 0 || y >= 16) + (z < 0 || z >= 16);
+				if (outside <= 1)
+					func(x, y, z);
+			}
+		}
+	}
+}
+
+static void testBlockLight()
+{
+	TestCluster cluster;
+	LightEngine engine;
+	engine.addLight(0, 8, 8, 15);
+	if (!engine.hasPending())
+		throw runtime_error("Bad light engine pending state.");
+	auto mask = engine.update(cluster.voxels, cluster.lights);
+	if (engine.hasPending() || mask != 0b1111011)
+		throw runtime_error("Bad light engine changed mask.");
+
+	forEachClusterPos([&](int16_t x, int16_t y, int16_t z)
+	{
+		auto distance = abs(x) + abs(y - 8) + abs(z - 8);
+		if (cluster.getLight(x, y, z) != (distance < 15 ? 15 - distance : 0))
+			throw runtime_error("Bad propagated block light level.");
+	});
+
+	engine.removeLight(0, 8, 8);
+	engine.update(cluster.voxels, cluster.lights);
+	forEachClusterPos([&](int16_t x, int16_t y, int16_t z)
+	{
+		if (cluster.getLight(x, y, z) != 0)
+			throw runtime_error("Bad removed block light level.");
+	});
+
+	engine.addLight(0, 8, 8, 15);
+	engine.update(cluster.voxels, cluster.lights);
+	for (int16_t z = 0; z < 16; z++)
+	{
+		for (int16_t y = 0; y < 16; y++)
+		{
+			cluster.setVoxel(3, y, z, 2);
+			engine.updateVoxel(3, y, z);
+		}
+	}
+	engine.update(cluster.voxels, cluster.lights);
+	if (cluster.getLight(2, 8, 8) != 13 || cluster.getLight(3, 8, 8) != 0 || cluster.getLight(4, 8, 8) != 0)
+		throw runtime_error("Bad blocked block light level.");
+
+	cluster.setVoxel(3, 8, 8, voxel::null);
+	engine.updateVoxel(3, 8, 8);
+	engine.update(cluster.voxels, cluster.lights);
+	if (cluster.getLight(3, 8, 8) != 12 || cluster.getLight(4, 8, 8) != 11 || cluster.getLight(5, 9, 8) != 9)
+		throw runtime_error("Bad opened block light level.");
+}
+
+static void testSunlight()
+{
+	TestCluster cluster;
+	LightEngine engine;
+	for (int16_t z = 0; z < 16; z++)
+	{
+		for (int16_t x = 0; x < 16; x++)
+			engine.addLight(x, 15, z, maxLightLevel);
+	}
+	engine.update(cluster.voxels, cluster.lights, LightChannel::sun);
+	if (cluster.getLight(5, 0, 5) != 15 || cluster.getLight(5, -16, 5) != 15 ||
+		cluster.getLight(-1, 3, 5) != 14 || cluster.getLight(5, 16, 5) != 14)
+	{
+		throw runtime_error("Bad propagated sunlight level.");
+	}
+
+	cluster.setVoxel(5, 10, 5, 2);
+	engine.updateVoxel(5, 10, 5);
+	engine.update(cluster.voxels, cluster.lights, LightChannel::sun);
+	if (cluster.getLight(5, 10, 5) != 0 || cluster.getLight(5, 9, 5) != 14 ||
+		cluster.getLight(5, 0, 5) != 14 || cluster.getLight(5, 11, 5) != 15)
+	{
+		throw runtime_error("Bad shadowed sunlight level.");
+	}
+
+	cluster.setVoxel(5, 10, 5, voxel::null);
+	engine.updateVoxel(5, 10, 5);
+	engine.update(cluster.voxels, cluster.lights, LightChannel::sun);
+	if (cluster.getLight(5, 10, 5) != 15 || cluster.getLight(5, 0, 5) != 15)
+		throw runtime_error("Bad restored sunlight level.");
+}
+
+static void testIncremental()
+{
+	mt19937 random(123);
+	TestCluster cluster;
+	LightEngine engine;
+	TestLightProperties properties;
+	engine.reserve(4096);
+
+	for (uint32_t i = 0; i < 400; i++)
+	{
+		auto x = (int16_t)(random() % 48) - 16;
+		auto y = (int16_t)(random() % 16);
+		auto z = (int16_t)(random() % 16);
+		uint8_t voxels[] = { voxel::null, 2, 3, 4 };
+		cluster.setVoxel(x, y, z, voxels[random() % 4]);
+		engine.updateVoxel(x, y, z);
+
+		if (i % 7 == 0 || i == 399)
+			engine.update(cluster.voxels, cluster.lights, LightChannel::block, properties);
+	}
+
+	TestCluster reference;
+	for (uint8_t i = 0; i < 7; i++)
+		reference.voxelChunks[i] = cluster.voxelChunks[i];
+	LightEngine referenceEngine;
+	forEachClusterPos([&](int16_t x, int16_t y, int16_t z)
+	{
+		auto chunkX = x, chunkY = y, chunkZ = z;
+		auto chunk = TestCluster::getChunk(reference.lightChunks, chunkX, chunkY, chunkZ);
+		auto emission = properties.getEmission(reference.voxelChunks[chunk -
+			reference.lightChunks].get((uint8_t)chunkX, (uint8_t)chunkY, (uint8_t)chunkZ));
+		if (emission > 0)
+			referenceEngine.addLight(x, y, z, emission);
+	});
+	referenceEngine.update(reference.voxels, reference.lights, LightChannel::block, properties);
+
+	forEachClusterPos([&](int16_t x, int16_t y, int16_t z)
+	{
+		if (cluster.getLight(x, y, z) != reference.getLight(x, y, z))
+			throw runtime_error("Bad incremental block light level.");
+	});
+}
+
+int main()
+{
+	testLightChunk();
+	testBlockLight();
+	testSunlight();
+	testIncremental();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/lod.hpp"
+
+#include <map>
+#include <random>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint8_t> Chunk;
+
+struct MaxReducer
+{
+	uint8_t operator()(const uint8_t* voxels, uint32_t count) const noexcept
+	{
+		return *max_element(voxels, voxels + count);
+	}
+};
+
+template<class C>
+static void fillChunk(C& chunk, mt19937& random)
+{
+	chunk.fill(voxel::null);
+	for (uint8_t z = 0; z < C::sizeZ; z++)
+	{
+		for (uint8_t x = 0; x < C::sizeX; x++)
+		{
+			auto height = (uint8_t)((x + z) / 3 + 2);
+			for (uint8_t y = 0; y < C::sizeY && y < height; y++)
+				chunk.set(x, y, z, (typename C::Voxel)(random() % 4 == 0 ? 3 : 2));
+		}
+	}
+}
+
+template<uint8_t F, class C>
+static uint8_t reduceNaive(const C& chunk, uint8_t x, uint8_t y, uint8_t z, uint8_t mode)
+{
+	map<uint8_t, uint32_t> counts;
+	uint8_t first = voxel::null, maximum = 0;
+	for (uint8_t bz = 0; bz < F; bz++)
+	{
+		for (uint8_t by = 0; by < F; by++)
+		{
+			for (uint8_t bx = 0; bx < F; bx++)
+			{
+				auto voxel = chunk.get(x * F + bx, y * F + by, z * F + bz);
+				counts[voxel]++;
+				if (first == voxel::null)
+					first = voxel;
+				maximum = max(maximum, voxel);
+			}
+		}
+	}
+
+	if (mode == 1)
+		return first;
+	if (mode == 2)
+		return maximum;
+
+	uint8_t result = 0; uint32_t best = 0;
+	for (const auto& pair : counts)
+	{
+		if (pair.second >= best)
+		{
+			result = pair.first;
+			best = pair.second;
+		}
+	}
+	return result;
+}
+
+template<uint8_t F, class C, class D>
+static void checkReduced(const C& chunk, const D& reduced, uint8_t mode,
+	uint8_t offsetX = 0, uint8_t offsetY = 0, uint8_t offsetZ = 0)
+{
+	for (uint8_t z = 0; z < C::sizeZ / F; z++)
+	{
+		for (uint8_t y = 0; y < C::sizeY / F; y++)
+		{
+			for (uint8_t x = 0; x < C::sizeX / F; x++)
+			{
+				if (reduced.get(offsetX + x, offsetY + y, offsetZ + z) != reduceNaive<F>(chunk, x, y, z, mode))
+					throw runtime_error("Bad downsampled voxel.");
+			}
+		}
+	}
+}
+
+template<uint8_t F, class C>
+static void testDownsample(mt19937& random)
+{
+	C chunk;
+	fillChunk(chunk, random);
+
+	lod::ReducedChunk3<C, F> reduced;
+	lod::downsample<F>(chunk, reduced);
+	checkReduced<F>(chunk, reduced, 0);
+	lod::downsample<F, lod::FirstNotNull>(chunk, reduced);
+	checkReduced<F>(chunk, reduced, 1);
+	lod::downsample<F>(chunk, reduced, 0, 0, 0, MaxReducer());
+	checkReduced<F>(chunk, reduced, 2);
+
+	C parent(voxel::unknown);
+	lod::downsampleToParent<F>(chunk, parent, F - 1, 0, 1);
+	checkReduced<F>(chunk, parent, 0, (F - 1) * C::sizeX / F, 0, C::sizeZ / F);
+	if (parent.get(0, 0, 0) != voxel::unknown || parent.count(voxel::unknown) != C::size - C::size / (F * F * F))
+		throw runtime_error("Bad downsampled parent chunk part.");
+}
+
+static void testReducers()
+{
+	const uint8_t tie[] = { 0, 0, 5, 5, 3, 0, 5, 7 };
+	if (lod::Majority()(tie, 8) != 5 || lod::Majority()(tie, 2) != 0 || lod::Majority()(tie + 4, 1) != 3)
+		throw runtime_error("Bad majority reducer.");
+	if (lod::FirstNotNull()(tie, 8) != 5 || lod::FirstNotNull()(tie, 2) != voxel::null)
+		throw runtime_error("Bad first not null reducer.");
+}
+
+static void testWorld()
+{
+	mt19937 random(5);
+	World3<Chunk> world, lodWorld;
+	for (int32_t z = -2; z < 2; z++)
+	{
+		for (int32_t x = -2; x < 2; x++)
+		{
+			if (x == 1 && z == 1)
+				continue;
+			fillChunk(*world.createChunk(x, 0, z), random);
+			world.createChunk(x, 1, z)->fill(voxel::null);
+		}
+	}
+
+	vector<BatchChunk> chunks;
+	for (int32_t z = -1; z < 1; z++)
+	{
+		for (int32_t x = -1; x < 1; x++)
+		{
+			lodWorld.createChunk(x, 0, z)->fill(voxel::unknown);
+			chunks.push_back({ x, 0, z });
+		}
+	}
+	chunks.push_back({ 5, 5, 5 });
+
+	ThreadPool pool(4);
+	BatchExecutor executor(pool);
+	if (lod::downsampleWorld<2>(executor, world, lodWorld, chunks.data(), chunks.size()) != chunks.size())
+		throw runtime_error("Bad downsampled world chunk count.");
+
+	for (int32_t z = -16; z < 16; z++)
+	{
+		for (int32_t y = 0; y < 16; y++)
+		{
+			for (int32_t x = -16; x < 16; x++)
+			{
+				uint8_t block[8];
+				for (uint8_t i = 0; i < 8; i++)
+				{
+					block[i] = voxel::null;
+					world.tryGet(x * 2 + (i & 1), y * 2 + (i >> 1 & 1), z * 2 + (i >> 2), block[i]);
+				}
+				if (lodWorld.get(x, y, z) != lod::Majority()((const uint8_t*)block, 8))
+					throw runtime_error("Bad downsampled world voxel.");
+			}
+		}
+	}
+}
+
+int main()
+{
+	mt19937 random(1);
+	testReducers();
+	testDownsample<2, Chunk>(random);
+	testDownsample<4, Chunk>(random);
+	testDownsample<8, Chunk>(random);
+	testDownsample<2, Chunk3<16, 16, 16, uint8_t, layout::Morton>>(random);
+	testDownsample<4, Chunk3<32, 16, 8, uint8_t>>(random);
+	testWorld();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/mesh.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint8_t> Chunk;
+typedef Cluster3<Chunk, uint8_t> Cluster;
+typedef mesh::Quad<uint8_t> Quad;
+
+static constexpr size_t quadCapacity = 16 * 16 * 16 * 6;
+static Quad quads[quadCapacity];
+
+static size_t buildMesh(const Cluster& cluster)
+{
+	size_t quadCount = 0;
+	if (!mesh::buildGreedy(cluster, quads, quadCapacity, quadCount))
+		throw runtime_error("Failed to build mesh.");
+	return quadCount;
+}
+
+static size_t calcArea(size_t quadCount, mesh::Face face)
+{
+	size_t area = 0;
+	for (size_t i = 0; i < quadCount; i++)
+	{
+		if (quads[i].face == face)
+			area += quads[i].width * quads[i].height;
+	}
+	return area;
+}
+
+int main()
+{
+	Chunk chunks[7];
+	for (auto& chunk : chunks)
+		chunk.fill(voxel::null);
+	Cluster cluster(&chunks[0]);
+
+	chunks[0].set(1, 2, 3, 100);
+	if (buildMesh(cluster) != 6 || quads[0].x != 1 || quads[0].y != 2 || quads[0].z != 3 || quads[0].voxel != 100)
+		throw runtime_error("Bad single voxel mesh.");
+
+	chunks[0].fill(100);
+	auto quadCount = buildMesh(cluster);
+	if (quadCount != 6 || quads[0].width != 16 || quads[0].height != 16)
+		throw runtime_error("Bad full chunk mesh.");
+
+	chunks[2].fill(voxel::unknown);
+	cluster.px = &chunks[2];
+	quadCount = buildMesh(cluster);
+	if (quadCount != 5 || calcArea(quadCount, mesh::Face::px) != 0)
+		throw runtime_error("Bad neighbour culled mesh.");
+
+	chunks[0].fill(100, 16, 16, 8, 0, 0, 8);
+	chunks[0].fill(101, 16, 16, 8, 0, 0, 0);
+	chunks[0].set(5, 5, 5, voxel::null);
+	quadCount = buildMesh(cluster);
+	if (calcArea(quadCount, mesh::Face::nx) != 16 * 16 + 1 || calcArea(quadCount, mesh::Face::pz) != 16 * 16 + 1 ||
+		calcArea(quadCount, mesh::Face::ny) != 16 * 16 + 1 || calcArea(quadCount, mesh::Face::px) != 1)
+	{
+		throw runtime_error("Bad split chunk mesh.");
+	}
+	for (size_t i = 0; i < quadCount; i++)
+	{
+		const auto& quad = quads[i];
+		if (quad.face == mesh::Face::ny && quad.y == 0 && quad.voxel != (quad.z < 8 ? 101 : 100))
+			throw runtime_error("Bad split chunk quad voxel.");
+	}
+
+	for (uint8_t z = 0; z < 16; z++)
+	{
+		for (uint8_t y = 0; y < 16; y++)
+		{
+			for (uint8_t x = 0; x < 16; x++)
+				chunks[0].set(x, y, z, (x + y + z) % 2 ? 100 : voxel::null);
+		}
+	}
+	chunks[2].fill(voxel::null);
+	size_t count = 0;
+	if (mesh::buildGreedy(cluster, quads, 100, count) || count != 100)
+		throw runtime_error("Bad small buffer mesh.");
+	if (buildMesh(cluster) != 16 * 16 * 16 / 2 * 6)
+		throw runtime_error("Bad checkerboard mesh.");
+
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
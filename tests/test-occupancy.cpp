@@ -0,0 +1,166 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/occupancy.hpp"
+#include "voxy/tracked.hpp"
+#include "voxy/raycast.hpp"
+#include "voxy/world.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint8_t> Chunk;
+
+template<class C>
+static void checkOccupancy(const C& chunk)
+{
+	size_t count = 0;
+	for (uint8_t z = 0; z < C::sizeZ; z++)
+	{
+		for (uint8_t y = 0; y < C::sizeY; y++)
+		{
+			for (uint8_t x = 0; x < C::sizeX; x++)
+			{
+				auto isOccupied = chunk.get(x, y, z) != voxel::null;
+				if (chunk.isOccupied(x, y, z) != isOccupied)
+					throw runtime_error("Bad occupancy chunk voxel mask.");
+				count += isOccupied;
+			}
+		}
+	}
+
+	if (chunk.countOccupied() != count || chunk.isEmpty() != (count == 0))
+		throw runtime_error("Bad occupancy chunk occupied count.");
+
+	size_t iterated = 0;
+	chunk.forEachOccupied([&](uint8_t x, uint8_t y, uint8_t z)
+	{
+		if (chunk.get(x, y, z) == voxel::null)
+			throw runtime_error("Bad occupancy chunk occupied voxel.");
+		iterated++;
+	});
+	if (iterated != count)
+		throw runtime_error("Bad occupancy chunk occupied iteration.");
+
+	for (size_t i = 0; i < C::brickCount; i++)
+	{
+		if ((chunk.getBrickMask(i / 64) >> (i % 64) & 1) != (uint64_t)(chunk.getVoxelMask(
+			i % C::bricksX, i / C::bricksX % C::bricksY, i / (C::bricksX * C::bricksY)) != 0))
+		{
+			throw runtime_error("Bad occupancy chunk brick mask.");
+		}
+	}
+}
+
+template<class C>
+static void testOccupancy()
+{
+	C chunk(voxel::null);
+	checkOccupancy(chunk);
+	if (!chunk.isEmpty(C::sizeX, C::sizeY, C::sizeZ))
+		throw runtime_error("Bad empty occupancy chunk.");
+
+	chunk.set(5, 6, 13, 1);
+	chunk.set(C::posToIndex(C::sizeX - 1, 0, 0), 2);
+	if (!chunk.trySet(0, 7, 0, 3) || chunk.trySet(C::sizeX, 0, 0, 3) || chunk.trySet(C::size, 3))
+		throw runtime_error("Bad occupancy chunk voxel try set.");
+	checkOccupancy(chunk);
+	if (chunk.isEmpty(1, 1, 1, 5, 6, 13) || !chunk.isEmpty(1, 1, 1, 4, 6, 13) ||
+		!chunk.isEmpty(2, 8, 16, 6, 0, 0) || chunk.isEmpty(3, 2, 3, 4, 5, 12))
+	{
+		throw runtime_error("Bad occupancy chunk region query.");
+	}
+
+	chunk.set(5, 6, 13, voxel::null);
+	checkOccupancy(chunk);
+
+	chunk.fill(4, 7, 3, 5, 2, 4, 1);
+	checkOccupancy(chunk);
+	if (chunk.isEmpty(1, 1, 1, 2, 4, 1) || !chunk.isEmpty(C::sizeX - 10, 8, 16, 9, 0, 0) ||
+		!chunk.isEmpty(C::sizeX, 8, C::sizeZ - 6, 0, 0, 6))
+		throw runtime_error("Bad occupancy chunk fill region query.");
+	chunk.fill(voxel::null, 3, 3, 3, 3, 5, 2);
+	checkOccupancy(chunk);
+
+	if (chunk.replace(4, voxel::null, 16, 5, 16) == 0)
+		throw runtime_error("Bad occupancy chunk part replace.");
+	checkOccupancy(chunk);
+	chunk.replace(voxel::null, 6);
+	checkOccupancy(chunk);
+	if (chunk.countOccupied() != C::size)
+		throw runtime_error("Bad occupancy chunk replace count.");
+
+	chunk.fill(voxel::null);
+	checkOccupancy(chunk);
+
+	Chunk3<C::sizeX, C::sizeY, C::sizeZ, typename C::Voxel> source(voxel::null);
+	source.set(1, 2, 3, 7);
+	source.set(C::sizeX - 2, 2, 9, 8);
+	chunk.copy(source);
+	checkOccupancy(chunk);
+	if (chunk.countOccupied() != 2)
+		throw runtime_error("Bad occupancy chunk copy.");
+	chunk.copy(source.getVoxels());
+	checkOccupancy(chunk);
+
+	typename C::Voxel part[4 * 4 * 4] = {};
+	part[5] = 9;
+	chunk.copy(part, 4, 4, 4, 8, 4, 8);
+	checkOccupancy(chunk);
+
+	chunk.getVoxels()[C::posToIndex(10, 6, 10)] = 1;
+	chunk.updateOccupancy(1, 1, 1, 10, 6, 10);
+	checkOccupancy(chunk);
+
+	C full(voxel::unknown);
+	checkOccupancy(full);
+	if (full.countOccupied() != C::size)
+		throw runtime_error("Bad full occupancy chunk count.");
+}
+
+static void testTracked()
+{
+	OccupancyChunk3<TrackedChunk3<Chunk>> chunk(voxel::null);
+	chunk.clearDirty();
+	chunk.set(3, 3, 3, 1);
+	if (!chunk.isDirty() || chunk.countOccupied() != 1)
+		throw runtime_error("Bad tracked occupancy chunk.");
+}
+
+static void testRaycast()
+{
+	typedef OccupancyChunk3<Chunk> OccupancyChunk;
+	World3<OccupancyChunk> world;
+	for (int32_t x = 0; x < 4; x++)
+		world.createChunk(x, 0, 0)->fill(voxel::null);
+	world.set(53, 5, 5, 1);
+
+	RayHit<uint8_t> hit;
+	if (!raycastWorld(world, { 0.5f, 5.5f, 5.5f, 1.0f, 0.0f, 0.0f, 100.0f }, hit) ||
+		hit.x != 53 || hit.voxel != 1 || !world.getChunk(0, 0, 0)->isEmpty())
+		throw runtime_error("Bad occupancy chunk raycast.");
+}
+
+int main()
+{
+	testOccupancy<OccupancyChunk3<Chunk>>();
+	testOccupancy<OccupancyChunk3<Chunk3<16, 16, 16, uint8_t, layout::Morton>>>();
+	testOccupancy<OccupancyChunk3<Chunk3<32, 8, 16, uint16_t, layout::Brick>>>();
+	testTracked();
+	testRaycast();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/padded.hpp"
+#include "voxy/uniform.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+template<class P>
+static void testGather(const typename P::Cluster& cluster)
+{
+	constexpr int16_t b = P::border;
+	constexpr int16_t sx = P::Chunk::sizeX, sy = P::Chunk::sizeY, sz = P::Chunk::sizeZ;
+	static P padded;
+	padded.gather(cluster, voxel::unknown);
+
+	for (int16_t z = -b; z < sz + b; z++)
+	{
+		for (int16_t y = -b; y < sy + b; y++)
+		{
+			for (int16_t x = -b; x < sx + b; x++)
+			{
+				auto outCount = (x < 0 || x >= sx) + (y < 0 || y >= sy) + (z < 0 || z >= sz);
+				auto voxel = padded.get(x, y, z);
+				typename P::Voxel clusterVoxel = voxel::unknown;
+				if (outCount < 2)
+				{
+					auto chunk = x < 0 ? cluster.nx : x >= sx ? cluster.px : y < 0 ? cluster.ny :
+						y >= sy ? cluster.py : z < 0 ? cluster.nz : z >= sz ? cluster.pz : cluster.c;
+					if (chunk)
+						clusterVoxel = chunk->get((x + sx) % sx, (y + sy) % sy, (z + sz) % sz);
+				}
+				if (voxel != clusterVoxel)
+					throw runtime_error("Bad padded chunk voxel.");
+			}
+		}
+	}
+}
+
+int main()
+{
+	typedef Chunk3<16, 8, 12, uint16_t> Chunk;
+	typedef Cluster3<Chunk, uint16_t> Cluster;
+	Chunk chunks[7];
+	for (uint8_t i = 0; i < 7; i++)
+	{
+		for (uint8_t z = 0; z < Chunk::sizeZ; z++)
+		{
+			for (uint8_t y = 0; y < Chunk::sizeY; y++)
+			{
+				for (uint8_t x = 0; x < Chunk::sizeX; x++)
+					chunks[i].set(x, y, z, (uint16_t)(i * 1000 + z * 100 + y * 10 + x));
+			}
+		}
+	}
+
+	Cluster cluster(&chunks[0], &chunks[1], &chunks[2], &chunks[3], &chunks[4], &chunks[5], &chunks[6]);
+	testGather<PaddedChunk3<Chunk>>(cluster);
+	testGather<PaddedChunk3<Chunk, 3>>(cluster);
+
+	PaddedChunk3<Chunk> padded(cluster);
+	constexpr auto strideY = (ptrdiff_t)PaddedChunk3<Chunk>::sizeX;
+	auto index = padded.posToIndex(0, 0, 0);
+	if (padded.getVoxels()[index - 1] != chunks[1].get(15, 0, 0) ||
+		padded.getVoxels()[index - strideY] != chunks[3].get(0, 7, 0) ||
+		padded.getVoxels()[padded.posToIndex(-1, -1, 0)] != voxel::null)
+	{
+		throw runtime_error("Bad padded chunk index offset.");
+	}
+
+	cluster.px = cluster.nz = nullptr;
+	testGather<PaddedChunk3<Chunk, 2>>(cluster);
+
+	typedef UniformChunk3<16, 16, 16, uint8_t> UniformChunk;
+	UniformChunk uniformChunks[7] = { UniformChunk(10), UniformChunk(11), UniformChunk(12),
+		UniformChunk(13), UniformChunk(14), UniformChunk(15), UniformChunk(16) };
+	uniformChunks[0].set(0, 5, 6, 100);
+	uniformChunks[2].set(0, 1, 2, 101);
+	Cluster3<UniformChunk, uint8_t> uniformCluster(&uniformChunks[0], &uniformChunks[1],
+		&uniformChunks[2], &uniformChunks[3], &uniformChunks[4], &uniformChunks[5], nullptr);
+	testGather<PaddedChunk3<UniformChunk>>(uniformCluster);
+
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/palette.hpp"
+#include "voxy/cluster.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef PaletteChunk3<16, 16, 16, uint16_t> Chunk;
+typedef Cluster3<Chunk, uint16_t> Cluster;
+
+static void testGrow()
+{
+	Chunk chunk(voxel::null);
+	if (chunk.getIndexBits() != 1 || chunk.get(5, 6, 7) != voxel::null)
+		throw runtime_error("Bad palette chunk initial state.");
+
+	chunk.set(1, 2, 3, 100);
+	if (chunk.get(1, 2, 3) != 100 || chunk.getIndexBits() != 1)
+		throw runtime_error("Bad palette chunk voxel value.");
+
+	for (uint16_t i = 0; i < 16; i++)
+		chunk.set(i, 0, 0, 200 + i);
+	if (chunk.getIndexBits() != 8)
+		throw runtime_error("Bad palette chunk index size.");
+
+	for (uint16_t i = 0; i < 16; i++)
+	{
+		if (chunk.get(i, 0, 0) != 200 + i)
+			throw runtime_error("Bad palette chunk grown voxel value.");
+	}
+	if (chunk.get(1, 2, 3) != 100 || chunk.get(15, 15, 15) != voxel::null)
+		throw runtime_error("Bad palette chunk repacked voxel value.");
+
+	for (size_t i = 0; i < Chunk::size; i++)
+		chunk.set(i, (uint16_t)(i % 1000));
+	if (chunk.getIndexBits() != Chunk::directBits || chunk.getPaletteSize() != 0)
+		throw runtime_error("Bad palette chunk direct mode.");
+	for (size_t i = 0; i < Chunk::size; i++)
+	{
+		if (chunk.get(i) != i % 1000)
+			throw runtime_error("Bad palette chunk direct voxel value.");
+	}
+
+	chunk.fill(voxel::unknown);
+	if (chunk.getIndexBits() != 1 || chunk.get(2, 2, 2) != voxel::unknown)
+		throw runtime_error("Bad palette chunk fill.");
+}
+
+static void testDense()
+{
+	Chunk::Dense dense(voxel::null);
+	for (uint8_t i = 0; i < 16; i++)
+		dense.set(i, i, i, i + 10);
+
+	Chunk chunk(dense);
+	if (chunk.getPaletteSize() != 17 || chunk.getIndexBits() != 8)
+		throw runtime_error("Bad palette chunk packed palette.");
+
+	Chunk::Dense result(voxel::unknown);
+	chunk.unpack(result);
+	if (memcmp(dense.getVoxels(), result.getVoxels(), Chunk::size * sizeof(uint16_t)) != 0)
+		throw runtime_error("Bad palette chunk unpacked voxels.");
+
+	for (uint8_t i = 1; i < 16; i++)
+		chunk.set(i, i, i, voxel::null);
+	chunk.compact();
+	if (chunk.getPaletteSize() != 2 || chunk.getIndexBits() != 1 || chunk.get(0, 0, 0) != 10)
+		throw runtime_error("Bad palette chunk compaction.");
+
+	uint16_t part[2 * 3 * 4];
+	for (uint16_t i = 0; i < 2 * 3 * 4; i++)
+		part[i] = 50 + i;
+	chunk.copy(part, 2, 3, 4, 5, 6, 7);
+	if (chunk.get(5, 6, 7) != 50 || chunk.get(6, 8, 10) != 50 + 2 * 3 * 4 - 1)
+		throw runtime_error("Bad palette chunk part copy.");
+
+	uint16_t voxel = 0;
+	if (chunk.tryGet(16, 0, 0, voxel) || chunk.trySet(0, 16, 0, 1) || !chunk.tryGet(5, 6, 7, voxel) || voxel != 50)
+		throw runtime_error("Bad palette chunk bounds check.");
+}
+
+int main()
+{
+	testGrow();
+	testDense();
+
+	Cluster::Chunk chunks[7] = {};
+	Cluster cluster(&chunks[0], &chunks[1], &chunks[2],
+		&chunks[3], &chunks[4], &chunks[5], &chunks[6]);
+	if (!cluster.isComplete())
+		throw runtime_error("Bad palette chunk cluster.");
+
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/pool.hpp"
+#include "voxy/cluster.hpp"
+
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint8_t> Chunk;
+typedef ChunkPool<Chunk> Pool;
+
+static void testPool(bool useHugePages)
+{
+	Pool pool(8, useHugePages);
+	Chunk* chunks[7];
+	for (auto& chunk : chunks)
+	{
+		chunk = pool.allocate();
+		chunk->fill(voxel::unknown);
+	}
+
+	Cluster3<Chunk, uint8_t> cluster(chunks[0], chunks[1], chunks[2], chunks[3], chunks[4], chunks[5], chunks[6]);
+	if (cluster.get(-1, 0, 0) != voxel::unknown)
+		throw runtime_error("Bad pool chunk voxel value.");
+
+	auto stats = pool.getStats();
+	if (stats.usedCount != 7 || stats.capacity != stats.slabCount * pool.getSlabSize() ||
+		stats.freeCount != stats.capacity - 7 || stats.memorySize < stats.capacity * sizeof(Chunk))
+	{
+		throw runtime_error("Bad pool stats.");
+	}
+
+	for (auto chunk : chunks)
+		pool.deallocate(chunk);
+	if (pool.getStats().usedCount != 0)
+		throw runtime_error("Bad pool deallocated stats.");
+}
+
+static void testLocalCache()
+{
+	Pool pool(32);
+	vector<thread> threads;
+	for (int i = 0; i < 4; i++)
+	{
+		threads.emplace_back([&pool, i]()
+		{
+			Pool::LocalCache cache(pool, 8);
+			vector<Chunk*> chunks;
+			for (int j = 0; j < 1000; j++)
+			{
+				auto chunk = cache.allocate();
+				chunk->fill((uint8_t)i);
+				chunks.push_back(chunk);
+				if (j % 3 == 0)
+				{
+					cache.deallocate(chunks.back());
+					chunks.pop_back();
+				}
+			}
+			for (auto chunk : chunks)
+			{
+				if (chunk->get(1, 2, 3) != (uint8_t)i)
+					throw runtime_error("Bad pool cache chunk voxel value.");
+				cache.deallocate(chunk);
+			}
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	auto stats = pool.getStats();
+	if (stats.usedCount != 0 || stats.cachedCount != 0 || stats.freeCount != stats.capacity)
+		throw runtime_error("Bad pool cache stats.");
+}
+
+int main()
+{
+	testPool(false);
+	testPool(true);
+	testLocalCache();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,188 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/raycast.hpp"
+#include "voxy/uniform.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint8_t> Chunk;
+
+static bool isNear(float a, float b) { return fabs(a - b) < 0.001f; }
+
+static void testChunk()
+{
+	Chunk chunk(voxel::null);
+	chunk.set(5, 5, 5, 2);
+
+	RayHit<uint8_t> hit;
+	if (!raycastChunk(chunk, { 0.5f, 5.5f, 5.5f, 1.0f, 0.0f, 0.0f }, hit) ||
+		hit.x != 5 || hit.y != 5 || hit.z != 5 || !isNear(hit.distance, 4.5f) ||
+		hit.normalX != -1 || hit.normalY != 0 || hit.normalZ != 0 || hit.voxel != 2)
+	{
+		throw runtime_error("Bad chunk raycast hit.");
+	}
+	if (raycastChunk(chunk, { 0.5f, 5.5f, 5.5f, 1.0f, 0.0f, 0.0f, 4.0f }, hit) || hit.distance != INFINITY)
+		throw runtime_error("Bad chunk raycast max distance.");
+	if (raycastChunk(chunk, { 0.5f, 6.5f, 5.5f, 1.0f, 0.0f, 0.0f }, hit))
+		throw runtime_error("Bad chunk raycast miss.");
+
+	// Ray starts outside of the chunk.
+	if (!raycastChunk(chunk, { 5.5f, 30.0f, 5.5f, 0.0f, -1.0f, 0.0f }, hit) ||
+		hit.y != 5 || !isNear(hit.distance, 24.0f) || hit.normalY != 1)
+	{
+		throw runtime_error("Bad outside chunk raycast hit.");
+	}
+	if (raycastChunk(chunk, { 5.5f, 30.0f, 5.5f, 0.0f, 1.0f, 0.0f }, hit) ||
+		raycastChunk(chunk, { -1.0f, 5.5f, 5.5f, 0.0f, 1.0f, 0.0f }, hit))
+	{
+		throw runtime_error("Bad outside chunk raycast miss.");
+	}
+
+	auto d = 1.0f / sqrt(3.0f);
+	if (!raycastChunk(chunk, { 0.5f, 0.5f, 0.5f, d, d, d }, hit) ||
+		hit.x != 5 || hit.y != 5 || hit.z != 5 || hit.voxel != 2)
+	{
+		throw runtime_error("Bad diagonal chunk raycast hit.");
+	}
+	if (!raycastChunk(chunk, { 5.5f, 5.5f, 5.5f, 1.0f, 0.0f, 0.0f }, hit) || hit.distance != 0.0f ||
+		hit.normalX != 0 || hit.normalY != 0 || hit.normalZ != 0)
+	{
+		throw runtime_error("Bad inside chunk raycast hit.");
+	}
+}
+
+static void testWorld()
+{
+	World3<Chunk> world;
+	world.createChunk(0, 0, 0)->fill(voxel::null);
+	world.createChunk(-1, 0, 0)->fill(voxel::null);
+	world.createChunk(-3, 0, 0)->fill(voxel::null);
+	world.set(-40, 3, 4, 7);
+
+	RayHit<uint8_t> hit;
+	if (!raycastWorld(world, { 10.5f, 3.5f, 4.5f, -1.0f, 0.0f, 0.0f, 100.0f }, hit) ||
+		hit.x != -40 || hit.y != 3 || hit.z != 4 || !isNear(hit.distance, 49.5f) || hit.normalX != 1 || hit.voxel != 7)
+	{
+		throw runtime_error("Bad world raycast hit.");
+	}
+	if (raycastWorld(world, { 10.5f, 3.5f, 4.5f, -1.0f, 0.0f, 0.0f, 40.0f }, hit) ||
+		raycastWorld(world, { -40.5f, 3.5f, 4.5f, 0.0f, 0.0f, 1.0f, 100.0f }, hit))
+	{
+		throw runtime_error("Bad world raycast miss.");
+	}
+
+	World3<UniformChunk3<16, 16, 16, uint8_t>> uniformWorld;
+	for (int32_t x = 0; x < 4; x++)
+		uniformWorld.createChunk(x, 0, 0)->fill(voxel::null);
+	uniformWorld.createChunk(4, 0, 0)->fill(3);
+	uniformWorld.set(40, 8, 8, 4);
+	if (!raycastWorld(uniformWorld, { 0.5f, 8.5f, 8.5f, 1.0f, 0.0f, 0.0f, 200.0f }, hit) ||
+		hit.x != 40 || hit.voxel != 4)
+	{
+		throw runtime_error("Bad uniform world raycast hit.");
+	}
+	if (!raycastWorld(uniformWorld, { 0.5f, 9.5f, 8.5f, 1.0f, 0.0f, 0.0f, 200.0f }, hit) ||
+		hit.x != 64 || hit.voxel != 3 || !isNear(hit.distance, 63.5f))
+	{
+		throw runtime_error("Bad uniform chunk raycast hit.");
+	}
+
+	mt19937 random(1);
+	uniform_real_distribution<float> position(-20.0f, 36.0f), direction(-1.0f, 1.0f);
+	for (int i = 0; i < 200; i++)
+		world.trySet((int32_t)position(random), (int32_t)position(random), (int32_t)position(random), 9);
+
+	vector<Ray> rays(256);
+	for (auto& ray : rays)
+	{
+		ray.originX = position(random); ray.originY = position(random); ray.originZ = position(random);
+		ray.directionX = direction(random); ray.directionY = direction(random); ray.directionZ = direction(random);
+		auto length = sqrt(ray.directionX * ray.directionX +
+			ray.directionY * ray.directionY + ray.directionZ * ray.directionZ);
+		ray.directionX /= length; ray.directionY /= length; ray.directionZ /= length;
+		ray.maxDistance = 64.0f;
+	}
+
+	vector<RayHit<uint8_t>> hits(rays.size());
+	auto hitCount = raycastWorld(world, rays.data(), rays.size(), hits.data());
+	size_t expectedHitCount = 0;
+	for (size_t i = 0; i < rays.size(); i++)
+	{
+		const auto& ray = rays[i];
+		auto isHit = raycastWorld(world, ray, hit);
+		expectedHitCount += isHit;
+		if (isHit != (hits[i].distance != INFINITY) || (isHit && (hit.x != hits[i].x ||
+			hit.y != hits[i].y || hit.z != hits[i].z || hit.distance != hits[i].distance)))
+		{
+			throw runtime_error("Bad batched world raycast hit.");
+		}
+		if (!isHit)
+			continue;
+
+		// Brute force check of the hit voxel and distance.
+		uint8_t voxel;
+		auto px = ray.originX + ray.directionX * (hit.distance + 0.001f);
+		auto py = ray.originY + ray.directionY * (hit.distance + 0.001f);
+		auto pz = ray.originZ + ray.directionZ * (hit.distance + 0.001f);
+		if (!world.tryGet(hit.x, hit.y, hit.z, voxel) || voxel == voxel::null || (int32_t)floor(px) != hit.x ||
+			(int32_t)floor(py) != hit.y || (int32_t)floor(pz) != hit.z)
+		{
+			throw runtime_error("Bad random world raycast hit.");
+		}
+		for (float t = 0.0f; t < hit.distance - 0.01f; t += 0.01f)
+		{
+			if (world.tryGet((int32_t)floor(ray.originX + ray.directionX * t), (int32_t)floor(ray.originY +
+				ray.directionY * t), (int32_t)floor(ray.originZ + ray.directionZ * t), voxel) && voxel != voxel::null)
+			{
+				throw runtime_error("Bad random world raycast skipped voxel.");
+			}
+		}
+	}
+	if (hitCount != expectedHitCount || hitCount == 0)
+		throw runtime_error("Bad batched world raycast hit count.");
+}
+
+static void testCluster()
+{
+	vector<Chunk> chunks(27, Chunk(voxel::null));
+	Cluster27<Chunk, uint8_t> cluster;
+	for (uint8_t i = 0; i < 27; i++)
+		cluster.chunks[i] = &chunks[i];
+	cluster.getChunk(1, 1, 0)->set(2, 3, 4, 5);
+
+	RayHit<uint8_t> hit;
+	if (!raycastCluster(cluster, { 8.5f, 19.5f, 4.5f, 1.0f, 0.0f, 0.0f }, hit) ||
+		hit.x != 18 || hit.y != 19 || hit.z != 4 || hit.voxel != 5)
+	{
+		throw runtime_error("Bad cluster raycast hit.");
+	}
+	if (raycastCluster(cluster, { 8.5f, 8.5f, 8.5f, 0.0f, 1.0f, 0.0f }, hit))
+		throw runtime_error("Bad cluster raycast miss.");
+}
+
+int main()
+{
+	testChunk();
+	testWorld();
+	testCluster();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/region.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint16_t> Chunk;
+typedef region::Writer<Chunk, 8> RegionWriter;
+typedef region::Reader<Chunk, 8> RegionReader;
+
+static constexpr const char* regionPath = "test-region.voxr";
+
+int main()
+{
+	Chunk rleChunk(voxel::null), rawChunk(voxel::null), chunk;
+	rleChunk.fill(100, 16, 16, 5);
+	for (size_t i = 0; i < Chunk::size; i++)
+		rawChunk.set(i, (uint16_t)(i * 31));
+
+	{
+		RegionWriter writer(regionPath);
+		if (!writer.isOpen() || !writer.write(1, 2, 3, rleChunk) || !writer.write(7, 7, 7, rawChunk) ||
+			!writer.write(0, 0, 0, Chunk(voxel::unknown)) || !writer.writeUniform(4, 0, 0, 1000) ||
+			!writer.write(5, 0, 0, rleChunk, serial::Encoding::raw) || !writer.close() || writer.write(6, 0, 0, rleChunk))
+		{
+			throw runtime_error("Failed to write region file.");
+		}
+	}
+
+	{
+		RegionReader reader(regionPath);
+		if (!reader.isOpen())
+			throw runtime_error("Failed to open region file.");
+
+		uint16_t voxel = 0;
+		if (!reader.hasChunk(1, 2, 3) || reader.hasChunk(3, 2, 1) || reader.read(3, 2, 1, chunk) ||
+			!reader.isUniform(0, 0, 0, voxel) || voxel != voxel::unknown ||
+			!reader.isUniform(4, 0, 0, voxel) || voxel != 1000 || reader.isUniform(1, 2, 3, voxel))
+		{
+			throw runtime_error("Bad region chunk entries.");
+		}
+
+		if (!reader.read(1, 2, 3, chunk) || chunk != rleChunk || !reader.read(7, 7, 7, chunk) || chunk != rawChunk ||
+			!reader.read(5, 0, 0, chunk) || chunk != rleChunk || !reader.read(4, 0, 0, chunk) || chunk.count(1000) != Chunk::size)
+		{
+			throw runtime_error("Bad region chunk data.");
+		}
+
+		auto rawVoxels = reader.getRawVoxels(7, 7, 7);
+		if (!rawVoxels || (uintptr_t)rawVoxels % region::dataAlignment != 0 ||
+			memcmp(rawVoxels, rawChunk.getVoxels(), Chunk::size * sizeof(uint16_t)) != 0 ||
+			reader.getRawVoxels(1, 2, 3) || !reader.getRawVoxels(5, 0, 0))
+		{
+			throw runtime_error("Bad region raw chunk voxels.");
+		}
+	}
+
+	if (region::Reader<Chunk, 4>(regionPath).isOpen() || region::Reader<Chunk3<16, 16, 16, uint8_t>, 8>(regionPath).isOpen())
+		throw runtime_error("Bad different region type open.");
+
+	auto file = fopen(regionPath, "r+b");
+	fseek(file, (long)(region::headerSize + region::posToIndex<8>(1, 2, 3) * sizeof(region::Entry)), SEEK_SET);
+	region::Entry entry;
+	entry.offset = UINT32_MAX; entry.size = 100; entry.type = region::EntryType::data;
+	fwrite(&entry, sizeof(entry), 1, file);
+	fclose(file);
+
+	if (RegionReader(regionPath).isOpen())
+		throw runtime_error("Bad corrupted region file open.");
+
+	remove(regionPath);
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
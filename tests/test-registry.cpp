@@ -0,0 +1,151 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "voxy/registry.hpp"
+#include "voxy/collision.hpp"
+#include "voxy/light.hpp"
+#include "voxy/mesh.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint8_t> Chunk;
+typedef Cluster3<Chunk, uint8_t> Cluster;
+
+constexpr uint8_t stoneVoxel = 2, glassVoxel = 3, lampVoxel = 4, grassVoxel = 5;
+
+constexpr VoxelProperties voxelTypes[] =
+{
+	emptyVoxelProperties,               // null
+	VoxelProperties(),                  // unknown
+	VoxelProperties(),                  // stone
+	{ true, false, true, 0, 0 },        // glass
+	{ true, true, false, 15, 12 },      // lamp
+	{ false, false, true, 1, 0 },       // grass
+};
+constexpr VoxelRegistry<> registry(voxelTypes, sizeof(voxelTypes) / sizeof(VoxelProperties));
+
+static_assert(!registry.isSolid(voxel::null) && registry.isSolid(voxel::unknown), "Bad predefined voxel");
+static_assert(registry.isSolid(glassVoxel) && !registry.isOpaque(glassVoxel), "Bad constexpr registry");
+static_assert(registry.getEmission(lampVoxel) == 12 && registry.getOpacity(grassVoxel) == 1, "Bad light table");
+static_assert(registry.isSolid((uint8_t)200) && !registry.isTransparent((uint8_t)200), "Bad default voxel");
+
+static void testProperties()
+{
+	VoxelRegistry<1024> bigRegistry;
+	VoxelProperties properties;
+	properties.isSolid = false; properties.isTransparent = true;
+	properties.opacity = 3; properties.emission = 7;
+	bigRegistry.set(1000, properties);
+
+	auto result = bigRegistry.get(1000);
+	if (result.isSolid || !result.isOpaque || !result.isTransparent || result.opacity != 3 || result.emission != 7)
+		throw runtime_error("Bad registry voxel properties.");
+	if (!bigRegistry.isSolid((uint16_t)999) || bigRegistry.isSolid((uint16_t)1000) ||
+		bigRegistry.isSolid(voxel::null) || !bigRegistry.isOpaque((uint16_t)1001))
+	{
+		throw runtime_error("Bad registry neighbour voxel properties.");
+	}
+	if ((bigRegistry.getTransparentBits()[1000 / 64] >> (1000 % 64) & 1) != 1 ||
+		bigRegistry.getEmissions()[1000] != 7 || bigRegistry.getOpacities()[2] != 15)
+	{
+		throw runtime_error("Bad registry property arrays.");
+	}
+
+	bigRegistry.set(1000, emptyVoxelProperties);
+	if (bigRegistry.isOpaque((uint16_t)1000) || bigRegistry.getEmission((uint16_t)1000) != 0)
+		throw runtime_error("Bad overwritten registry voxel properties.");
+	if (alignof(VoxelRegistry<>) != 64 || sizeof(VoxelRegistry<>) > 640)
+		throw runtime_error("Bad registry memory layout.");
+}
+
+static void testMesh()
+{
+	Chunk chunks[7];
+	for (auto& chunk : chunks)
+		chunk.fill(voxel::null);
+	Cluster cluster(&chunks[0]);
+	chunks[0].set(4, 4, 4, stoneVoxel);
+	chunks[0].set(5, 4, 4, glassVoxel);
+
+	mesh::Quad<uint8_t> quads[64];
+	size_t quadCount = 0;
+	if (!mesh::buildGreedy(cluster, quads, 64, quadCount) || quadCount != 10)
+		throw runtime_error("Bad default predicate mesh.");
+	if (!mesh::buildGreedy(cluster, quads, 64, quadCount, registry.getOpaquePredicate()) || quadCount != 6)
+		throw runtime_error("Bad registry opaque mesh.");
+	for (size_t i = 0; i < quadCount; i++)
+	{
+		if (quads[i].voxel != stoneVoxel)
+			throw runtime_error("Bad registry opaque mesh voxel.");
+	}
+}
+
+static void testCollision()
+{
+	Chunk chunk(voxel::null);
+	chunk.fill(grassVoxel, 16, 1, 16, 0, 1, 0);
+	chunk.fill(stoneVoxel, 16, 1, 16, 0, 0, 0);
+
+	Aabb box = { 2.2f, 1.1f, 2.2f, 2.8f, 2.9f, 2.8f };
+	if (!overlapChunk(chunk, box) || overlapChunk(chunk, box, registry.getSolidPredicate()))
+		throw runtime_error("Bad registry overlap.");
+
+	World3<Chunk> world;
+	*world.createChunk(0, 0, 0) = chunk;
+	SweepQuery query = { box, 0.0f, -5.0f, 0.0f };
+	auto result = sweepWorld(world, query, registry.getSolidPredicate());
+	if (result.normalY != 1 || result.box.minY < 1.0f - collisionEpsilon || result.box.minY > 1.0f + collisionEpsilon)
+		throw runtime_error("Bad registry sweep.");
+}
+
+static void testLight()
+{
+	Chunk voxelChunks[7];
+	LightChunk3<16, 16, 16> lightChunks[7];
+	for (uint8_t i = 0; i < 7; i++)
+	{
+		voxelChunks[i].fill(voxel::null);
+		lightChunks[i].fill(0);
+	}
+	LightEngine3<Chunk>::Cluster voxels(voxelChunks, voxelChunks + 1, voxelChunks + 2,
+		voxelChunks + 3, voxelChunks + 4, voxelChunks + 5, voxelChunks + 6);
+	LightEngine3<Chunk>::LightCluster lights(lightChunks, lightChunks + 1, lightChunks + 2,
+		lightChunks + 3, lightChunks + 4, lightChunks + 5, lightChunks + 6);
+
+	voxelChunks[0].set(8, 8, 8, lampVoxel);
+	voxelChunks[0].set(8, 8, 10, grassVoxel);
+	LightEngine3<Chunk> engine;
+	engine.updateVoxel(8, 8, 8);
+	engine.update(voxels, lights, LightChannel::block, registry);
+
+	if (lightChunks[0].get(8, 8, 8) != 12 || lightChunks[0].get(8, 8, 9) != 11 ||
+		lightChunks[0].get(8, 8, 10) != 9 || lightChunks[0].get(9, 8, 8) != 11)
+	{
+		throw runtime_error("Bad registry light propagation.");
+	}
+}
+
+int main()
+{
+	testProperties();
+	testMesh();
+	testCollision();
+	testLight();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
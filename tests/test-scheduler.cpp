@@ -0,0 +1,151 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/scheduler.hpp"
+
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+static void testPool()
+{
+	ThreadPool pool(4);
+	if (pool.getThreadCount() != 4)
+		throw runtime_error("Bad thread pool thread count.");
+
+	atomic<uint32_t> counter = 0;
+	for (uint32_t i = 0; i < 1000; i++)
+	{
+		pool.addTask([&]()
+		{
+			if (++counter % 100 == 0)
+				pool.addTask([&]() { counter += 1000; });
+		});
+	}
+	pool.wait();
+	if (counter != 1000 + 10 * 1000 || pool.getPendingCount() != 0)
+		throw runtime_error("Bad thread pool task count.");
+
+	pool.wait();
+}
+
+static void testNeighbours()
+{
+	constexpr int32_t size = 6;
+	ThreadPool pool(8);
+	BatchExecutor executor(pool);
+
+	vector<BatchChunk> chunks;
+	for (int32_t z = 0; z < size; z++)
+	{
+		for (int32_t y = 0; y < size; y++)
+		{
+			for (int32_t x = 0; x < size; x++)
+				chunks.push_back({ x, y, z, BatchExecutor::calcDistancePriority(x, y, z, 2, 2, 2) });
+		}
+	}
+	if (chunks.size() != size * size * size || chunks[0].priority != 12.0f)
+		throw runtime_error("Bad batch chunk distance priority.");
+
+	vector<atomic<uint32_t>> active(size * size * size);
+	vector<atomic<uint32_t>> processed(size * size * size);
+	atomic<bool> isConflict = false;
+
+	auto count = executor.run(chunks.data(), chunks.size(), [&](int32_t x, int32_t y, int32_t z)
+	{
+		active[(z * size + y) * size + x]++;
+		for (int32_t dz = max(z - 1, 0); dz <= min(z + 1, size - 1); dz++)
+		{
+			for (int32_t dy = max(y - 1, 0); dy <= min(y + 1, size - 1); dy++)
+			{
+				for (int32_t dx = max(x - 1, 0); dx <= min(x + 1, size - 1); dx++)
+				{
+					if ((dx != x || dy != y || dz != z) && active[(dz * size + dy) * size + dx] != 0)
+						isConflict = true;
+				}
+			}
+		}
+		this_thread::yield();
+		processed[(z * size + y) * size + x]++;
+		active[(z * size + y) * size + x]--;
+	});
+
+	if (count != chunks.size() || isConflict)
+		throw runtime_error("Bad batch executor neighbour dependency.");
+	for (const auto& value : processed)
+	{
+		if (value != 1)
+			throw runtime_error("Bad batch executor processed chunk.");
+	}
+	if (chunks[0].x != 2 || chunks[0].y != 2 || chunks[0].z != 2)
+		throw runtime_error("Bad batch executor priority order.");
+}
+
+static bool isSameOrder(const BatchChunk* chunks, const vector<int32_t>& order)
+{
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		if (chunks[i].x != order[i])
+			return false;
+	}
+	return true;
+}
+
+static void testOrder()
+{
+	// Waiting thread runs queued tasks too, so kernels of the same phase can run at once.
+	ThreadPool pool(1);
+	BatchExecutor executor(pool);
+	BatchChunk chunks[4] = { { 0, 0, 0, 3.0f }, { 1, 0, 0, 0.0f }, { 2, 0, 0, 1.0f }, { 3, 0, 0, 2.0f } };
+	vector<int32_t> order;
+	mutex orderMutex;
+	auto kernel = [&](int32_t x, int32_t, int32_t)
+	{
+		lock_guard lock(orderMutex);
+		order.push_back(x);
+	};
+
+	executor.run(chunks, 4, kernel, BatchDependency::none);
+	sort(order.begin(), order.end());
+	if (!isSameOrder(chunks, { 1, 2, 3, 0 }) || order != vector<int32_t>({ 0, 1, 2, 3 }))
+		throw runtime_error("Bad batch executor independent order.");
+
+	order.clear();
+	executor.run(chunks, 4, kernel);
+	if (!isSameOrder(chunks, { 1, 3, 2, 0 }) || order.size() != 4)
+		throw runtime_error("Bad batch executor phase order.");
+	sort(order.begin(), order.begin() + 2);
+	sort(order.begin() + 2, order.end());
+	if (order != vector<int32_t>({ 1, 3, 0, 2 }))
+		throw runtime_error("Bad batch executor phase kernel order.");
+
+	atomic<bool> isCancelled = false;
+	auto count = executor.run(chunks, 4, [&](int32_t, int32_t, int32_t) { isCancelled = true; },
+		BatchDependency::none, &isCancelled);
+	if (count < 1 || count > pool.getThreadCount() + 1)
+		throw runtime_error("Bad batch executor cancellation.");
+}
+
+int main()
+{
+	testPool();
+	testNeighbours();
+	testOrder();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
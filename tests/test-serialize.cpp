@@ -0,0 +1,109 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/serialize.hpp"
+
+#include <vector>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+template<class C>
+static void testEncoding(const C& chunk, serial::Encoding encoding, serial::Encoding expectedEncoding)
+{
+	vector<uint8_t> buffer(serial::calcMaxEncodedSize<C>());
+	size_t size = 0;
+	if (!serial::encode(chunk, buffer.data(), buffer.size(), size, encoding))
+		throw runtime_error("Failed to encode chunk.");
+
+	serial::Encoder<C> encoder(chunk, encoding);
+	if (encoder.getEncoding() != expectedEncoding || encoder.getEncodedSize() != size)
+		throw runtime_error("Bad chunk encoder encoding.");
+
+	for (size_t partSize : { (size_t)1, (size_t)7, size })
+	{
+		serial::Encoder<C> partEncoder(chunk, encoding);
+		vector<uint8_t> data;
+		uint8_t part[64];
+		while (!partEncoder.isDone())
+		{
+			auto count = partEncoder.write(part, partSize < sizeof(part) ? partSize : sizeof(part));
+			data.insert(data.end(), part, part + count);
+		}
+		if (data.size() != size || memcmp(data.data(), buffer.data(), size) != 0)
+			throw runtime_error("Bad chunk streaming encoder data.");
+
+		C decoded(voxel::unknown);
+		serial::Decoder<C> decoder(decoded);
+		for (size_t i = 0; i < size; i += partSize)
+		{
+			auto count = size - i < partSize ? size - i : partSize;
+			if (decoder.read(data.data() + i, count) != count)
+				throw runtime_error("Bad chunk streaming decoder consumed size.");
+		}
+		if (!decoder.isDone() || decoder.getEncoding() != expectedEncoding || decoded != chunk)
+			throw runtime_error("Bad chunk streaming decoder result.");
+	}
+
+	C decoded(voxel::unknown);
+	if (serial::decode(buffer.data(), size - 1, decoded))
+		throw runtime_error("Bad truncated chunk decode.");
+
+	buffer[0] ^= 0xFF;
+	if (serial::decode(buffer.data(), size, decoded))
+		throw runtime_error("Bad corrupted chunk decode.");
+}
+
+int main()
+{
+	typedef Chunk3<16, 16, 16, uint8_t> Chunk;
+	Chunk chunk(voxel::null);
+	chunk.fill(100, 16, 16, 4);
+	chunk.fill(101, 3, 4, 5, 6, 7, 8);
+
+	testEncoding(chunk, serial::Encoding::raw, serial::Encoding::raw);
+	testEncoding(chunk, serial::Encoding::rle, serial::Encoding::rle);
+	testEncoding(chunk, serial::Encoding::paletteRle, serial::Encoding::paletteRle);
+	testEncoding(chunk, serial::Encoding::smallest, serial::Encoding::rle);
+
+	size_t size = 0;
+	uint8_t buffer[serial::calcMaxEncodedSize<Chunk>()];
+	serial::encode(Chunk(voxel::unknown), buffer, sizeof(buffer), size);
+	if (size != serial::headerSize + 3 || serial::encode(chunk, buffer, 16, size))
+		throw runtime_error("Bad uniform chunk encoded size.");
+
+	for (size_t i = 0; i < Chunk::size; i++)
+		chunk.set(i, (uint8_t)(i * 7));
+	testEncoding(chunk, serial::Encoding::smallest, serial::Encoding::raw);
+
+	typedef Chunk3<16, 16, 16, uint16_t, layout::Morton> BigChunk;
+	BigChunk bigChunk(voxel::null);
+	for (size_t i = 0; i < BigChunk::size; i++)
+		bigChunk.set(i, (uint16_t)(i / 10 % 300));
+	testEncoding(bigChunk, serial::Encoding::paletteRle, serial::Encoding::rle);
+	for (size_t i = 0; i < BigChunk::size; i++)
+		bigChunk.set(i, (uint16_t)(i / 10 % 100));
+	bigChunk.fill(1000, 8, 8, 8);
+	testEncoding(bigChunk, serial::Encoding::smallest, serial::Encoding::paletteRle);
+
+	vector<uint8_t> data(serial::calcMaxEncodedSize<BigChunk>());
+	serial::encode(bigChunk, data.data(), data.size(), size);
+	Chunk3<16, 16, 16, uint16_t> linearChunk;
+	if (serial::decode(data.data(), size, linearChunk))
+		throw runtime_error("Bad different layout chunk decode.");
+
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/shared.hpp"
+#include "voxy/world.hpp"
+
+#include <thread>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint8_t> Chunk;
+typedef SharedChunk3<Chunk> SharedChunk;
+
+static void testSharedChunk()
+{
+	SharedChunk chunk(2);
+	chunk.set(1, 2, 3, 5);
+	auto copy = chunk;
+	if (!copy.isSharedWith(chunk) || chunk.getRefCount() != 2 || !copy.isShared() || copy != chunk)
+		throw runtime_error("Bad shared chunk copy.");
+	if (copy.getVoxels() == chunk.getChunk().getVoxels() || copy.isShared() || chunk.getRefCount() != 1)
+		throw runtime_error("Bad shared chunk mutable voxel access.");
+
+	copy = chunk;
+	copy.set(1, 2, 3, 7);
+	if (copy.isSharedWith(chunk) || chunk.get(1, 2, 3) != 5 || copy.get(1, 2, 3) != 7 || copy.count(2) != Chunk::size - 1)
+		throw runtime_error("Bad shared chunk copy on write.");
+	if (copy.detach() || copy == chunk)
+		throw runtime_error("Bad unique shared chunk.");
+
+	copy = chunk;
+	if (copy.replace(9, 3) != 0 || !copy.isSharedWith(chunk))
+		throw runtime_error("Bad shared chunk empty replace.");
+	if (copy.replace(5, 3) != 1 || copy.isSharedWith(chunk) || chunk.get(1, 2, 3) != 5)
+		throw runtime_error("Bad shared chunk replace.");
+
+	copy = chunk;
+	copy.fill(4);
+	if (copy.isSharedWith(chunk) || copy.count(4) != Chunk::size || chunk.count(2) != Chunk::size - 1)
+		throw runtime_error("Bad shared chunk fill.");
+
+	copy = chunk;
+	uint8_t voxel = 0;
+	if (copy.trySet(16, 0, 0, 1) || !copy.isSharedWith(chunk) || copy.tryGet(0, 16, 0, voxel))
+		throw runtime_error("Bad shared chunk out of bounds access.");
+	if (!copy.trySet(0, 0, 0, 1) || !copy.tryGet(0, 0, 0, voxel) || voxel != 1 || chunk.get((size_t)0) != 2)
+		throw runtime_error("Bad shared chunk try access.");
+
+	auto moved = std::move(copy);
+	if (moved.get(0, 0, 0) != 1 || moved.isShared())
+		throw runtime_error("Bad moved shared chunk.");
+}
+
+static void testSnapshot()
+{
+	World3<SharedChunk> world;
+	for (int32_t z = -2; z < 2; z++)
+	{
+		for (int32_t x = -2; x < 2; x++)
+			world.createChunk(x, 0, z)->fill((uint8_t)(x + z + 5));
+	}
+
+	World3<SharedChunk> snapshot(world);
+	if (snapshot.getChunkCount() != world.getChunkCount())
+		throw runtime_error("Bad world snapshot chunk count.");
+	world.forEach([&](int32_t x, int32_t y, int32_t z, SharedChunk& chunk)
+	{
+		auto snapshotChunk = snapshot.getChunk(x, y, z);
+		if (!snapshotChunk || !snapshotChunk->isSharedWith(chunk))
+			throw runtime_error("Bad world snapshot chunk.");
+	});
+
+	thread saver([snapshot = std::move(snapshot)]()
+	{
+		for (uint32_t i = 0; i < 64; i++)
+		{
+			snapshot.forEach([](int32_t x, int32_t, int32_t z, const SharedChunk& chunk)
+			{
+				if (chunk.count((uint8_t)(x + z + 5)) != Chunk::size)
+					throw runtime_error("Bad world snapshot voxel.");
+			});
+		}
+	});
+	for (int32_t i = 0; i < 64; i++)
+		world.set(i % 64 - 32, 1, i / 4 % 32 - 32, 1);
+	saver.join();
+
+	if (world.get(-32, 1, -32) != 1 || world.getChunk(-2, 0, -2)->isShared())
+		throw runtime_error("Bad modified world voxel.");
+
+	World3<Chunk> deepWorld;
+	deepWorld.createChunk(3, 4, 5)->fill(6);
+	World3<Chunk> deepCopy;
+	deepCopy = deepWorld;
+	deepWorld.set(48, 64, 80, 7);
+	if (deepCopy.getChunkCount() != 1 || deepCopy.get(48, 64, 80) != 6 || deepWorld.get(48, 64, 80) != 7)
+		throw runtime_error("Bad world copy.");
+}
+
+int main()
+{
+	testSharedChunk();
+	testSnapshot();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
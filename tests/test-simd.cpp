@@ -0,0 +1,105 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/simd.hpp"
+
+#include <vector>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+template<typename V>
+static void testKernels()
+{
+	constexpr size_t maxCount = 200;
+	vector<V> a(maxCount + 8), b(maxCount + 8);
+
+	for (size_t offset = 0; offset < 4; offset++)
+	{
+		for (size_t count = 0; count < maxCount; count += 7)
+		{
+			simd::fill(a.data(), (V)0, a.size());
+			simd::fill(a.data() + offset, (V)0x5A, count);
+
+			for (size_t i = 0; i < a.size(); i++)
+			{
+				auto value = i >= offset && i < offset + count ? (V)0x5A : (V)0;
+				if (a[i] != value)
+					throw runtime_error("Bad vectorized fill.");
+			}
+
+			if (simd::count(a.data(), (V)0x5A, a.size()) != count ||
+				simd::count(a.data() + offset, (V)0, count) != 0)
+			{
+				throw runtime_error("Bad vectorized count.");
+			}
+
+			b = a;
+			if (simd::replace(b.data(), (V)0, (V)7, b.size()) != b.size() - count ||
+				simd::count(b.data(), (V)7, b.size()) != b.size() - count ||
+				simd::replace(b.data(), (V)0x5A, (V)0, b.size()) != count ||
+				simd::replace(b.data(), (V)7, (V)0x5A, b.size()) != b.size() - count)
+			{
+				throw runtime_error("Bad vectorized replace.");
+			}
+			for (size_t i = 0; i < a.size(); i++)
+			{
+				if (b[i] != (a[i] == (V)0 ? (V)0x5A : (V)0))
+					throw runtime_error("Bad vectorized replaced value.");
+			}
+
+			b = a;
+			if (simd::findMismatch(a.data(), b.data(), a.size()) != a.size() || !simd::isEqual(a.data(), b.data(), a.size()))
+				throw runtime_error("Bad vectorized compare of equal arrays.");
+
+			for (size_t i = 0; i < count; i += 5)
+			{
+				b = a;
+				b[offset + i] = (V)1;
+				if (simd::findMismatch(a.data() + offset, b.data() + offset, count) != i ||
+					simd::isEqual(a.data() + offset, b.data() + offset, count))
+				{
+					throw runtime_error("Bad vectorized compare of different arrays.");
+				}
+			}
+
+			for (size_t i = 0; i < b.size(); i++)
+				b[i] = a[i] + (V)1;
+			if (simd::findMatch(a.data(), b.data(), a.size()) != a.size())
+				throw runtime_error("Bad vectorized match of different arrays.");
+			for (size_t i = 0; i < count; i += 5)
+			{
+				auto last = b[offset + i];
+				b[offset + i] = a[offset + i];
+				// Only one byte of the multibyte voxel is equal, it should not match.
+				b[offset + i + 1] = (V)(a[offset + i + 1] ^ (V)0x100);
+				if (simd::findMatch(a.data() + offset, b.data() + offset, count) != i)
+					throw runtime_error("Bad vectorized match of arrays.");
+				b[offset + i] = last;
+				b[offset + i + 1] = a[offset + i + 1] + (V)1;
+			}
+		}
+	}
+}
+
+int main()
+{
+	testKernels<uint8_t>();
+	testKernels<uint16_t>();
+	testKernels<uint32_t>();
+	testKernels<uint64_t>();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "voxy/mesh.hpp"
+#include "voxy/pool.hpp"
+#include "voxy/serialize.hpp"
+
+#include <thread>
+#include <vector>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint8_t> Chunk;
+typedef Cluster3<Chunk, uint8_t> Cluster;
+
+static_assert(stats::isEnabled, "Stats test should be built with VOXY_ENABLE_STATS");
+
+static void testCounters()
+{
+	stats::reset();
+	Chunk chunk(voxel::null);
+	chunk.fill(3, 4, 4, 4);
+	Chunk other;
+	other.copy(chunk.getVoxels());
+
+	Cluster cluster(&chunk);
+	uint8_t voxel;
+	cluster.set(1, 1, 1, 5);
+	if (cluster.get(1, 1, 1) != 5 || !cluster.tryGet(2, 2, 2, voxel) || cluster.tryGet(-1, 0, 0, voxel))
+		throw runtime_error("Bad stats cluster access.");
+
+	auto snapshot = stats::getSnapshot();
+	if (snapshot.getCounter(stats::Counter::chunkFill) != 2 || snapshot.getCounter(stats::Counter::chunkCopy) != 1 ||
+		snapshot.getCounter(stats::Counter::clusterAccess) != 4)
+	{
+		throw runtime_error("Bad stats chunk counters.");
+	}
+
+	vector<thread> threads;
+	for (int i = 0; i < 4; i++)
+	{
+		threads.emplace_back([]()
+		{
+			for (int j = 0; j < 10000; j++)
+				stats::count(stats::Counter::chunkFill);
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+	if (stats::getSnapshot().getCounter(stats::Counter::chunkFill) != 40002)
+		throw runtime_error("Bad stats concurrent counter.");
+
+	stats::reset();
+	if (stats::getSnapshot().getCounter(stats::Counter::chunkFill) != 0)
+		throw runtime_error("Bad stats reset.");
+}
+
+static void testMemory()
+{
+	auto memory = stats::getSnapshot().getMemory(stats::Memory::pool);
+	{
+		ChunkPool<Chunk> pool(16);
+		auto chunk = pool.allocate();
+		pool.deallocate(chunk);
+
+		auto snapshot = stats::getSnapshot();
+		if (snapshot.getMemory(stats::Memory::pool) < memory + 16 * (int64_t)sizeof(Chunk) ||
+			snapshot.getCounter(stats::Counter::poolAllocate) != 1 || snapshot.getCounter(stats::Counter::poolFree) != 1)
+		{
+			throw runtime_error("Bad stats pool memory.");
+		}
+	}
+	if (stats::getSnapshot().getMemory(stats::Memory::pool) != memory)
+		throw runtime_error("Bad stats freed pool memory.");
+
+	stats::setMemory(stats::Memory::dense, (int64_t)Chunk::getMemoryUsage() * 10);
+	stats::addMemory(stats::Memory::dense, -(int64_t)Chunk::getMemoryUsage());
+	if (stats::getSnapshot().getMemory(stats::Memory::dense) != 9 * 4096)
+		throw runtime_error("Bad stats reported memory.");
+}
+
+static void testTimers()
+{
+	stats::reset();
+	Chunk chunk(voxel::null);
+	chunk.set(1, 2, 3, 4);
+	Cluster cluster(&chunk);
+	mesh::Quad<uint8_t> quads[16];
+	size_t quadCount = 0;
+	for (int i = 0; i < 3; i++)
+		mesh::buildGreedy(cluster, quads, 16, quadCount);
+
+	uint8_t buffer[serial::calcMaxEncodedSize<Chunk>()];
+	size_t size = 0;
+	if (!serial::encode(chunk, buffer, sizeof(buffer), size) || !serial::decode(buffer, size, chunk))
+		throw runtime_error("Bad stats serialization.");
+
+	auto snapshot = stats::getSnapshot();
+	const auto& mesh = snapshot.getTimer(stats::Timer::mesh);
+	if (mesh.count != 3 || mesh.maxTime == 0 || mesh.totalTime < mesh.maxTime ||
+		mesh.getAverageTime() > mesh.maxTime || mesh.getPercentileTime(1.0f) < mesh.maxTime)
+	{
+		throw runtime_error("Bad stats mesh timer.");
+	}
+	if (snapshot.getTimer(stats::Timer::encode).count != 1 || snapshot.getTimer(stats::Timer::decode).count != 1 ||
+		snapshot.getTimer(stats::Timer::light).count != 0)
+	{
+		throw runtime_error("Bad stats serialization timers.");
+	}
+
+	stats::reset();
+	stats::addTime(stats::Timer::light, 0);
+	stats::addTime(stats::Timer::light, 100);
+	stats::addTime(stats::Timer::light, 1000);
+	stats::addTime(stats::Timer::light, (uint64_t)1 << 40);
+	snapshot = stats::getSnapshot();
+	const auto& light = snapshot.getTimer(stats::Timer::light);
+	if (light.buckets[0] != 1 || light.buckets[6] != 1 || light.buckets[9] != 1 ||
+		light.buckets[stats::histogramBucketCount - 1] != 1 || light.maxTime != (uint64_t)1 << 40)
+	{
+		throw runtime_error("Bad stats histogram buckets.");
+	}
+	if (light.getPercentileTime(0.5f) != 128 || light.getPercentileTime(0.0f) != 2)
+		throw runtime_error("Bad stats histogram percentile.");
+}
+
+int main()
+{
+	testCounters();
+	testMemory();
+	testTimers();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
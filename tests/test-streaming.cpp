@@ -0,0 +1,176 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/streaming.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint8_t> Chunk;
+
+static constexpr const char* regionPath = "test-streaming.voxr";
+
+static uint8_t calcVoxel(int32_t x, int32_t y, int32_t z) noexcept
+{
+	return (uint8_t)((x * 3 + y * 5 + z * 7) & 7) + 1;
+}
+static float calcDistance(int32_t x, int32_t y, int32_t z, float viewX, float viewY, float viewZ) noexcept
+{
+	auto dx = x + 0.5f - viewX / 16.0f, dy = y + 0.5f - viewY / 16.0f, dz = z + 0.5f - viewZ / 16.0f;
+	return sqrtf(dx * dx + dy * dy + dz * dz);
+}
+
+static void streamAll(ChunkStreamer3<Chunk>& streamer, const StreamViewpoint& viewpoint)
+{
+	for (uint32_t i = 0; i < 64; i++)
+	{
+		streamer.update(&viewpoint, 1);
+		if (streamer.getLoadingCount() == 0)
+			return;
+		streamer.wait();
+	}
+	throw runtime_error("Bad streaming convergence.");
+}
+
+static void testStreaming()
+{
+	World3<Chunk> world;
+	ThreadPool pool(2);
+	atomic<uint32_t> loadCount(0), generateCount(0);
+	uint32_t unloadCount = 0;
+
+	StreamSettings settings;
+	settings.loadRadius = 2.5f;
+	settings.unloadRadius = 3.5f;
+	settings.maxLoadCount = 8;
+
+	ChunkStreamer3<Chunk> streamer(world, pool, [&](int32_t x, int32_t y, int32_t z, Chunk& chunk)
+	{
+		if (x & 1)
+			return false;
+		chunk.fill(calcVoxel(x, y, z));
+		loadCount++;
+		return true;
+	}, [&](int32_t x, int32_t y, int32_t z, Chunk& chunk)
+	{
+		chunk.fill(calcVoxel(x, y, z));
+		generateCount++;
+	}, [&](int32_t x, int32_t y, int32_t z, const Chunk& chunk)
+	{
+		if (chunk.get(0, 0, 0) != calcVoxel(x, y, z))
+			throw runtime_error("Bad unloaded chunk.");
+		unloadCount++;
+	}, settings);
+
+	StreamViewpoint viewpoint;
+	viewpoint.x = 8.0f; viewpoint.y = 8.0f; viewpoint.z = 8.0f;
+	streamer.update(&viewpoint, 1);
+	if (streamer.getLoadingCount() != settings.maxLoadCount || world.getChunkCount() != 0)
+		throw runtime_error("Bad in flight chunk load count.");
+
+	streamAll(streamer, viewpoint);
+	if (loadCount == 0 || generateCount == 0 || world.getChunkCount() != loadCount + generateCount)
+		throw runtime_error("Bad streamed chunk count.");
+
+	for (int32_t z = -4; z <= 4; z++)
+	{
+		for (int32_t y = -4; y <= 4; y++)
+		{
+			for (int32_t x = -4; x <= 4; x++)
+			{
+				auto chunk = world.getChunk(x, y, z);
+				if ((calcDistance(x, y, z, 8.0f, 8.0f, 8.0f) <= settings.loadRadius) != (chunk != nullptr))
+					throw runtime_error("Bad streamed chunk.");
+				if (chunk && chunk->count(calcVoxel(x, y, z)) != Chunk::size)
+					throw runtime_error("Bad streamed chunk voxels.");
+			}
+		}
+	}
+
+	viewpoint.velocityX = 16.0f * 4.0f;
+	streamer.update(&viewpoint, 1);
+	streamer.wait();
+	streamer.update(&viewpoint, 1);
+	if (!world.getChunk(4, 0, 0) || world.getChunk(-3, 0, 0))
+		throw runtime_error("Bad prefetched chunk.");
+	streamAll(streamer, viewpoint);
+	if (!world.getChunk(6, 0, 0) || world.getChunk(7, 0, 0))
+		throw runtime_error("Bad prefetched chunks.");
+
+	viewpoint.x += 16.0f * 20.0f;
+	viewpoint.velocityX = 0.0f;
+	auto chunkCount = world.getChunkCount();
+	streamAll(streamer, viewpoint);
+	if (unloadCount != chunkCount || !world.getChunk(20, 0, 0) || world.getChunk(0, 0, 0))
+		throw runtime_error("Bad unloaded chunk count.");
+
+	settings.maxChunkCount = 10;
+	streamer.setSettings(settings);
+	streamAll(streamer, viewpoint);
+	if (world.getChunkCount() != 10 || !world.getChunk(20, 0, 0))
+		throw runtime_error("Bad streamed chunk budget.");
+
+	viewpoint.x += 16.0f * 20.0f;
+	streamer.update(&viewpoint, 1);
+}
+
+static void testRegionLoader()
+{
+	{
+		region::Writer<Chunk, 8> writer(regionPath);
+		if (!writer.write(1, 2, 3, Chunk(5)) || !writer.writeUniform(7, 7, 7, 6) || !writer.close())
+			throw runtime_error("Failed to write region file.");
+	}
+
+	RegionLoader<Chunk, 8> loader([](int32_t x, int32_t y, int32_t z)
+	{
+		return x == -1 && y == 0 && z == 0 ? string(regionPath) : string("missing.voxr");
+	});
+
+	Chunk chunk(voxel::null);
+	if (!loader.read(-7, 2, 3, chunk) || chunk.count(5) != Chunk::size)
+		throw runtime_error("Bad region loaded chunk.");
+	if (!loader.read(-1, 7, 7, chunk) || chunk.count(6) != Chunk::size)
+		throw runtime_error("Bad region loaded uniform chunk.");
+	if (loader.read(-8, 0, 0, chunk) || loader.read(1, 2, 3, chunk))
+		throw runtime_error("Bad region missing chunk.");
+
+	World3<Chunk> world;
+	ThreadPool pool(2);
+	{
+		ChunkStreamer3<Chunk> streamer(world, pool, [&](int32_t x, int32_t y, int32_t z, Chunk& chunk)
+		{
+			return loader.read(x, y, z, chunk);
+		});
+
+		StreamViewpoint viewpoint;
+		viewpoint.x = -7.0f * 16.0f; viewpoint.y = 2.0f * 16.0f; viewpoint.z = 3.0f * 16.0f;
+		streamAll(streamer, viewpoint);
+	}
+
+	loader.clear();
+	remove(regionPath);
+	if (world.get(-7 * 16, 2 * 16, 3 * 16) != 5 || world.get(-6 * 16, 2 * 16, 3 * 16) != voxel::null)
+		throw runtime_error("Bad region streamed chunk.");
+}
+
+int main()
+{
+	testStreaming();
+	testRegionLoader();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
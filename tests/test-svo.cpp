@@ -0,0 +1,206 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/svo.hpp"
+#include "voxy/uniform.hpp"
+
+#include <random>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint8_t> Chunk;
+typedef SparseOctree3<Chunk> Octree;
+
+static constexpr uint32_t regionSize = 4;
+
+static void fillWorld(World3<Chunk>& world, mt19937& random)
+{
+	for (int32_t z = 0; z < (int32_t)regionSize; z++)
+	{
+		for (int32_t y = 0; y < (int32_t)regionSize - 1; y++)
+		{
+			for (int32_t x = 0; x < (int32_t)regionSize; x++)
+				world.createChunk(x, y, z)->fill(voxel::null);
+		}
+	}
+
+	for (int32_t z = 0; z < (int32_t)regionSize * 16; z++)
+	{
+		for (int32_t x = 0; x < (int32_t)regionSize * 16; x++)
+		{
+			auto height = 12 + (x / 5 + z / 7) % 12;
+			for (int32_t y = 0; y < height; y++)
+				world.set(x, y, z, y < height - 3 ? 2 : 3);
+		}
+	}
+	for (uint32_t i = 0; i < 200; i++)
+	{
+		world.set((int32_t)(random() % (regionSize * 16)), (int32_t)(random() % 12),
+			(int32_t)(random() % (regionSize * 16)), 4);
+	}
+}
+
+template<class W>
+static void buildOctree(Octree& octree, const W& world)
+{
+	octree.build(regionSize, [&](uint32_t x, uint32_t y, uint32_t z)
+	{
+		return world.getChunk((int32_t)x, (int32_t)y, (int32_t)z);
+	});
+}
+
+static void checkVoxels(const Octree& octree, const World3<Chunk>& world)
+{
+	for (uint32_t z = 0; z < octree.getSize(); z++)
+	{
+		for (uint32_t y = 0; y < octree.getSize(); y++)
+		{
+			for (uint32_t x = 0; x < octree.getSize(); x++)
+			{
+				uint8_t voxel = voxel::null;
+				world.tryGet((int32_t)x, (int32_t)y, (int32_t)z, voxel);
+				if (octree.get(x, y, z) != voxel)
+					throw runtime_error("Bad octree voxel.");
+			}
+		}
+	}
+
+	uint8_t voxel;
+	if (octree.tryGet(octree.getSize(), 0, 0, voxel) || !octree.tryGet(0, 0, 0, voxel))
+		throw runtime_error("Bad octree voxel try get.");
+}
+
+static void testBuild()
+{
+	mt19937 random(7);
+	World3<Chunk> world;
+	fillWorld(world, random);
+
+	Octree octree(false), dag(true);
+	buildOctree(octree, world);
+	buildOctree(dag, world);
+	if (octree.getSize() != regionSize * 16 || octree.getDepth() != 6 || octree.isDeduplicated())
+		throw runtime_error("Bad octree size.");
+
+	checkVoxels(octree, world);
+	checkVoxels(dag, world);
+	if (dag.getNodeCount() >= octree.getNodeCount() ||
+		octree.getMemorySize() >= world.getChunkCount() * sizeof(Chunk))
+	{
+		throw runtime_error("Bad octree node count.");
+	}
+
+	Octree empty;
+	empty.build(regionSize, [](uint32_t, uint32_t, uint32_t) -> const Chunk* { return nullptr; });
+	if (empty.getNodeCount() != 0 || empty.get(5, 5, 5) != voxel::null)
+		throw runtime_error("Bad empty octree.");
+}
+
+static void testUpdate()
+{
+	mt19937 random(11);
+	World3<Chunk> world;
+	fillWorld(world, random);
+
+	for (auto isDag : { false, true })
+	{
+		Octree octree(isDag);
+		buildOctree(octree, world);
+
+		auto chunk = world.getChunk(1, 0, 2);
+		chunk->fill(5, 4, 4, 4, 8, 8, 8);
+		octree.update(1, 0, 2, chunk);
+		chunk = world.createChunk(2, 3, 1);
+		chunk->fill(voxel::null);
+		chunk->set(3, 3, 3, 6);
+		octree.update(2, 3, 1, chunk);
+		checkVoxels(octree, world);
+
+		Octree reference(isDag);
+		buildOctree(reference, world);
+		octree.compact();
+		checkVoxels(octree, world);
+		if (octree.getNodeCount() != reference.getNodeCount())
+			throw runtime_error("Bad compacted octree node count.");
+
+		octree.update(2, 3, 1, nullptr);
+		if (octree.get(2 * 16 + 3, 3 * 16 + 3, 16 + 3) != voxel::null)
+			throw runtime_error("Bad destroyed octree chunk.");
+		octree.update(2, 3, 1, chunk);
+	}
+	world.destroyChunk(2, 3, 1);
+
+	World3<UniformChunk3<16, 16, 16, uint8_t>> uniformWorld;
+	uniformWorld.createChunk(0, 0, 0)->fill(7);
+	SparseOctree3<UniformChunk3<16, 16, 16, uint8_t>> uniformOctree;
+	uniformOctree.build(2, [&](uint32_t x, uint32_t y, uint32_t z)
+	{
+		return uniformWorld.getChunk((int32_t)x, (int32_t)y, (int32_t)z);
+	});
+	if (uniformOctree.getNodeCount() != 1 || uniformOctree.get(15, 15, 15) != 7 || uniformOctree.get(16, 0, 0) != 0)
+		throw runtime_error("Bad uniform chunk octree.");
+}
+
+static void testRaycast()
+{
+	mt19937 random(3);
+	World3<Chunk> world;
+	fillWorld(world, random);
+	Octree octree;
+	buildOctree(octree, world);
+
+	uniform_real_distribution<float> position(-8.0f, regionSize * 16.0f + 8.0f);
+	uniform_real_distribution<float> direction(-1.0f, 1.0f);
+	for (uint32_t i = 0; i < 2000; i++)
+	{
+		Ray ray;
+		ray.originX = position(random); ray.originY = position(random); ray.originZ = position(random);
+		ray.directionX = direction(random); ray.directionY = direction(random); ray.directionZ = direction(random);
+		if (i % 10 == 0)
+			ray.directionX = ray.directionZ = 0.0f;
+		auto length = sqrt(ray.directionX * ray.directionX +
+			ray.directionY * ray.directionY + ray.directionZ * ray.directionZ);
+		if (length == 0.0f)
+			continue;
+		ray.directionX /= length; ray.directionY /= length; ray.directionZ /= length;
+		ray.maxDistance = 200.0f;
+
+		RayHit<uint8_t> worldHit, octreeHit;
+		auto isWorldHit = raycastWorld(world, ray, worldHit);
+		auto isOctreeHit = octree.raycast(ray, octreeHit);
+		if (isWorldHit != isOctreeHit)
+			throw runtime_error("Bad octree raycast result.");
+		if (!isWorldHit)
+			continue;
+
+		if (worldHit.x != octreeHit.x || worldHit.y != octreeHit.y || worldHit.z != octreeHit.z ||
+			worldHit.voxel != octreeHit.voxel || fabs(worldHit.distance - octreeHit.distance) > 0.001f ||
+			worldHit.normalX != octreeHit.normalX || worldHit.normalY != octreeHit.normalY ||
+			worldHit.normalZ != octreeHit.normalZ)
+		{
+			throw runtime_error("Bad octree raycast hit.");
+		}
+	}
+}
+
+int main()
+{
+	testBuild();
+	testUpdate();
+	testRaycast();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,178 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "voxy/tiered.hpp"
+
+#include <random>
+#include <unordered_map>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint8_t> Chunk;
+typedef TieredWorld3<Chunk> World;
+
+static void fillTerrain(Chunk& chunk, int32_t x, int32_t z)
+{
+	auto height = (uint8_t)(4 + ((x * 5 + z * 3) & 7));
+	chunk.fill(voxel::null);
+	chunk.fill(2, 16, height, 16);
+	chunk.fill(3, 16, 1, 16, 0, height, 0);
+	chunk.set((uint8_t)(x & 15), 15, (uint8_t)(z & 15), 4);
+}
+static bool isTerrain(const Chunk& chunk, int32_t x, int32_t z)
+{
+	Chunk expected;
+	fillTerrain(expected, x, z);
+	return memcmp(expected.getVoxels(), chunk.getVoxels(), sizeof(Chunk)) == 0;
+}
+
+static void testCompression()
+{
+	TierSettings settings;
+	settings.coldTickCount = 2;
+	World world(nullptr, settings);
+	for (int32_t z = 0; z < 8; z++)
+	{
+		for (int32_t x = 0; x < 8; x++)
+			fillTerrain(*world.createChunk(x, 0, z), x, z);
+	}
+
+	if (world.update() != 0 || world.getColdCount() != 0)
+		throw runtime_error("Bad tiered world early compression.");
+	world.getChunk(3, 0, 3);
+	if (world.update() != 63 || world.getColdCount() != 63 || world.isCompressed(3, 0, 3) || !world.isCompressed(0, 0, 0))
+		throw runtime_error("Bad tiered world cold compression.");
+	if (world.update() != 1 || world.getColdCount() != 64 || world.getChunkCount() != 64)
+		throw runtime_error("Bad tiered world accessed chunk compression.");
+	if (world.getMemoryUsage() * 3 > 64 * sizeof(Chunk) || world.getCompressedSize() != world.getMemoryUsage())
+		throw runtime_error("Bad tiered world compressed size.");
+
+	auto chunk = world.getChunk(5, 0, 6);
+	if (!chunk || !isTerrain(*chunk, 5, 6) || world.getColdCount() != 63 || world.isCompressed(5, 0, 6))
+		throw runtime_error("Bad tiered world decompression.");
+	chunk->set(1, 1, 1, 9);
+	world.update(); world.update();
+	if (!world.isCompressed(5, 0, 6) || world.getChunk(5, 0, 6)->get(1, 1, 1) != 9)
+		throw runtime_error("Bad tiered world modified chunk compression.");
+
+	auto cluster = world.getCluster(1, 0, 1);
+	if (!cluster.c || !cluster.nx || !cluster.pz || cluster.ny || cluster.py || !isTerrain(*cluster.px, 2, 1))
+		throw runtime_error("Bad tiered world cluster.");
+
+	if (!world.destroyChunk(0, 0, 0) || world.destroyChunk(0, 0, 0) || world.getChunk(0, 0, 0) ||
+		world.getChunkCount() != 63 || world.getColdCount() != 63 - 6)
+	{
+		throw runtime_error("Bad tiered world destroyed chunk.");
+	}
+	world.clear();
+	if (world.getChunkCount() != 0 || world.getColdCount() != 0 || world.getCompressedSize() != 0)
+		throw runtime_error("Bad tiered world clear.");
+}
+
+static void testThreadPool()
+{
+	ThreadPool threadPool(2);
+	TierSettings settings;
+	settings.coldTickCount = 1;
+	World world(&threadPool, settings);
+	for (int32_t i = 0; i < 32; i++)
+		fillTerrain(*world.createChunk(i, 0, 0), i, 0);
+
+	world.update();
+	if (world.getCompressingCount() != 32)
+		throw runtime_error("Bad tiered world compression count.");
+	world.getChunk(0, 0, 0)->set(0, 0, 0, 7);
+	world.destroyChunk(1, 0, 0);
+	world.wait();
+	if (world.update() != 30 || world.isCompressed(0, 0, 0) || world.getCompressingCount() != 1)
+		throw runtime_error("Bad tiered world touched chunk compression.");
+
+	settings.maxCompressCount = 4;
+	world.setSettings(settings);
+	for (int32_t i = 32; i < 48; i++)
+		fillTerrain(*world.createChunk(i, 0, 0), i, 0);
+	world.wait();
+	if (world.update() != 1 || world.getCompressingCount() != 4)
+		throw runtime_error("Bad tiered world compression limit.");
+
+	for (int i = 0; i < 8; i++)
+	{
+		world.wait();
+		world.update();
+	}
+	if (world.getColdCount() != 47 || world.getCompressingCount() != 0)
+		throw runtime_error("Bad tiered world background compression.");
+	if (world.getChunk(0, 0, 0)->get(0, 0, 0) != 7)
+		throw runtime_error("Bad tiered world modified chunk.");
+	for (int32_t i = 2; i < 48; i++)
+	{
+		if (!isTerrain(*world.getChunk(i, 0, 0), i, 0))
+			throw runtime_error("Bad tiered world background decompression.");
+	}
+
+	world.update();
+	world.destroyChunk(5, 0, 0);
+}
+
+static void testRandom()
+{
+	mt19937 random(123);
+	TierSettings settings;
+	settings.coldTickCount = 3;
+	settings.scanCount = 16;
+	World world(nullptr, settings);
+	unordered_map<int32_t, uint8_t> chunks;
+
+	for (int i = 0; i < 20000; i++)
+	{
+		auto x = (int32_t)(random() % 200) - 100;
+		auto voxel = (uint8_t)(random() % 250 + 1);
+		switch (random() % 4)
+		{
+		case 0:
+			world.createChunk(x, 1, -x)->fill(voxel);
+			chunks[x] = voxel;
+			break;
+		case 1:
+			if (world.destroyChunk(x, 1, -x) != (chunks.erase(x) > 0))
+				throw runtime_error("Bad random tiered world destroy.");
+			break;
+		case 2:
+		{
+			auto chunk = world.getChunk(x, 1, -x);
+			auto iterator = chunks.find(x);
+			if ((chunk != nullptr) != (iterator != chunks.end()) || (chunk && chunk->get(15, 15, 15) != iterator->second))
+				throw runtime_error("Bad random tiered world chunk.");
+			break;
+		}
+		default:
+			world.update();
+			break;
+		}
+	}
+	if (world.getChunkCount() != chunks.size() || world.getColdCount() == 0)
+		throw runtime_error("Bad random tiered world chunk count.");
+}
+
+int main()
+{
+	testCompression();
+	testThreadPool();
+	testRandom();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/tracked.hpp"
+#include "voxy/delta.hpp"
+
+#include <vector>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint8_t> Chunk;
+
+template<class C>
+static void testDirtyMask()
+{
+	static_assert(C::posToSubregion(0, 0, 0) == 0, "Bad first chunk subregion");
+	static_assert(C::posToSubregion(15, 15, 15) == 63, "Bad last chunk subregion");
+	static_assert(C::calcSubregionMask(16, 16, 16) == UINT64_MAX, "Bad chunk subregion mask");
+	static_assert(C::calcSubregionMask(8, 4, 4, 4, 4, 4) == ((uint64_t)0b0110 << 20), "Bad chunk subregion mask");
+	static_assert(C::calcSubregionMask(0, 4, 4) == 0, "Bad empty chunk subregion mask");
+
+	C chunk(voxel::null);
+	if (chunk.isDirty())
+		throw runtime_error("Bad new tracked chunk dirty state.");
+
+	chunk.set(0, 0, 0, voxel::null);
+	if (chunk.isDirty())
+		throw runtime_error("Bad unchanged tracked chunk voxel.");
+
+	chunk.set(5, 9, 13, 1);
+	if (chunk.getDirtyMask() != (uint64_t)1 << C::posToSubregion(5, 9, 13))
+		throw runtime_error("Bad tracked chunk voxel dirty mask.");
+	chunk.set(C::posToIndex(15, 0, 0), 2);
+	if (!chunk.trySet(0, 15, 0, 3) || chunk.trySet(16, 0, 0, 3) || chunk.trySet(C::size, 3))
+		throw runtime_error("Bad tracked chunk voxel try set.");
+	if (chunk.getDirtyMask() != ((uint64_t)1 << C::posToSubregion(5, 9, 13) | (uint64_t)1 << 3 | (uint64_t)1 << 12))
+		throw runtime_error("Bad tracked chunk index dirty mask.");
+
+	chunk.clearDirty();
+	chunk.fill(4, 8, 4, 4, 4, 4, 4);
+	if (chunk.getDirtyMask() != C::calcSubregionMask(8, 4, 4, 4, 4, 4) || chunk.count(4) != 8 * 4 * 4)
+		throw runtime_error("Bad tracked chunk part fill dirty mask.");
+
+	chunk.clearDirty();
+	if (chunk.replace(100, 5) != 0 || chunk.isDirty() || chunk.replace(4, 5, 4, 4, 4, 4, 4, 4) != 4 * 4 * 4 ||
+		chunk.getDirtyMask() != (uint64_t)1 << C::posToSubregion(4, 4, 4))
+	{
+		throw runtime_error("Bad tracked chunk replace dirty mask.");
+	}
+
+	chunk.clearDirty();
+	chunk.copy(Chunk(voxel::unknown));
+	if (chunk.getDirtyMask() != UINT64_MAX || chunk.get(7, 7, 7) != voxel::unknown)
+		throw runtime_error("Bad tracked chunk copy dirty mask.");
+
+	for (uint8_t i = 0; i < C::subregionCount; i++)
+	{
+		uint8_t sx, sy, sz, ox, oy, oz;
+		C::calcSubregionBounds(i, sx, sy, sz, ox, oy, oz);
+		if (sx != 4 || sy != 4 || sz != 4 || C::posToSubregion(ox, oy, oz) != i ||
+			C::calcSubregionMask(sx, sy, sz, ox, oy, oz) != (uint64_t)1 << i)
+		{
+			throw runtime_error("Bad tracked chunk subregion bounds.");
+		}
+	}
+}
+
+static void testJournal()
+{
+	TrackedChunk3<Chunk, 16> chunk(voxel::null);
+	auto& journal = chunk.getJournal();
+	auto baseline = (Chunk)chunk;
+
+	chunk.set(1, 2, 3, 10);
+	chunk.set(1, 2, 3, 10);
+	chunk.set(200, 11);
+	chunk.fill(12, 2, 2, 2, 8, 8, 8);
+	if (journal.getCount() != 2 + 8 || journal.isOverflowed() || journal.getIndices()[0] != Chunk::posToIndex(1, 2, 3))
+		throw runtime_error("Bad tracked chunk journal.");
+
+	vector<uint8_t> buffer(delta::calcMaxSize<Chunk>());
+	size_t size = 0;
+	if (!delta::encode(chunk, journal.getIndices(), journal.getCount(), buffer.data(), buffer.size(), size) ||
+		!delta::apply(buffer.data(), size, baseline) || baseline != chunk)
+	{
+		throw runtime_error("Bad tracked chunk journal delta.");
+	}
+
+	chunk.fill(13, 4, 4, 4);
+	if (!journal.isOverflowed() || journal.getCount() != 10)
+		throw runtime_error("Bad overflowed tracked chunk journal.");
+
+	chunk.clearDirty();
+	if (chunk.isDirty() || journal.isOverflowed() || journal.getCount() != 0)
+		throw runtime_error("Bad cleared tracked chunk journal.");
+
+	chunk.getVoxels()[0] = 14;
+	chunk.markDirty();
+	if (chunk.getDirtyMask() != UINT64_MAX || !journal.isOverflowed())
+		throw runtime_error("Bad marked tracked chunk journal.");
+
+	TrackedChunk3<Chunk> disabled(voxel::null);
+	disabled.set(0, 1);
+	if (!disabled.isDirty() || !disabled.getJournal().isOverflowed() || disabled.getJournal().getCount() != 0)
+		throw runtime_error("Bad disabled tracked chunk journal.");
+}
+
+int main()
+{
+	testDirtyMask<TrackedChunk3<Chunk>>();
+	testDirtyMask<TrackedChunk3<Chunk, 64>>();
+	testDirtyMask<TrackedChunk3<Chunk3<16, 16, 16, uint8_t, layout::Morton>>>();
+	testJournal();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
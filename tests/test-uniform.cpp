@@ -0,0 +1,70 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/uniform.hpp"
+#include "voxy/cluster.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef UniformChunk3<16, 16, 16, uint8_t> Chunk;
+typedef Cluster3<Chunk, uint8_t> Cluster;
+
+int main()
+{
+	Chunk chunk(voxel::null);
+	chunk.set(1, 2, 3, voxel::null);
+
+	if (!chunk.isUniform() || chunk.getDense())
+		throw runtime_error("Bad uniform chunk state.");
+
+	chunk.set(1, 2, 3, 100);
+
+	if (chunk.isUniform() || chunk.get(1, 2, 3) != 100 || chunk.get(3, 2, 1) != voxel::null)
+		throw runtime_error("Bad uniform chunk voxel value.");
+
+	auto copy = chunk;
+	if (copy.isUniform() || copy.get(1, 2, 3) != 100)
+		throw runtime_error("Bad uniform chunk copy.");
+
+	chunk.set(1, 2, 3, voxel::null);
+	if (!chunk.optimize() || !chunk.isUniform() || copy.optimize())
+		throw runtime_error("Bad uniform chunk optimization.");
+
+	chunk.fill(voxel::unknown);
+
+	if (!chunk.isUniform() || chunk.get(2, 2, 2) != voxel::unknown)
+		throw runtime_error("Bad uniform chunk fill.");
+
+	Cluster::Chunk chunks[7] = { Chunk(10), Chunk(11), Chunk(12), Chunk(13), Chunk(14), Chunk(15), Chunk(16) };
+	Cluster cluster(&chunks[0], &chunks[1], &chunks[2],
+		&chunks[3], &chunks[4], &chunks[5], &chunks[6]);
+
+	if (cluster.get(0, 0, 0) != 10 || cluster.get(-1, 0, 0) != 11 || cluster.get(16, 0, 0) != 12 ||
+		cluster.get(0, -1, 0) != 13 || cluster.get(0, 16, 0) != 14 ||
+		cluster.get(0, 0, -1) != 15 || cluster.get(0, 0, 16) != 16)
+	{
+		throw runtime_error("Bad uniform chunk cluster voxel value.");
+	}
+	for (const auto& clusterChunk : chunks)
+	{
+		if (!clusterChunk.isUniform())
+			throw runtime_error("Bad uniform chunk cluster state.");
+	}
+
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+// Copyright 2023-2023 Nikita Fediuchin. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "voxy/world.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace voxy;
+
+typedef Chunk3<16, 16, 16, uint8_t> Chunk;
+typedef World3<Chunk> World;
+
+static void testChunks()
+{
+	World world;
+	for (int32_t z = -8; z < 8; z++)
+	{
+		for (int32_t y = -8; y < 8; y++)
+		{
+			for (int32_t x = -8; x < 8; x++)
+				world.createChunk(x, y, z)->fill((uint8_t)(x + y * 16 + z * 256));
+		}
+	}
+
+	if (world.getChunkCount() != 16 * 16 * 16 || world.getChunk(8, 0, 0) || !world.getChunk(-8, -8, -8))
+		throw runtime_error("Bad world chunk count.");
+	if (world.getChunk(3, -4, 5)->get(0, 0, 0) != (uint8_t)(3 - 4 * 16 + 5 * 256))
+		throw runtime_error("Bad world chunk voxel value.");
+
+	for (int32_t z = -8; z < 8; z++)
+	{
+		for (int32_t y = -8; y < 8; y++)
+		{
+			for (int32_t x = -8; x < 8; x += 2)
+			{
+				if (!world.destroyChunk(x, y, z))
+					throw runtime_error("Failed to destroy world chunk.");
+			}
+		}
+	}
+
+	if (world.getChunkCount() != 16 * 16 * 8 || world.destroyChunk(0, 0, 0))
+		throw runtime_error("Bad world destroyed chunk count.");
+
+	size_t chunkCount = 0;
+	world.forEach([&](int32_t x, int32_t y, int32_t z, Chunk& chunk)
+	{
+		if ((x & 1) == 0 || chunk.get(1, 1, 1) != (uint8_t)(x + y * 16 + z * 256))
+			throw runtime_error("Bad world iterated chunk.");
+		chunkCount++;
+	});
+
+	if (chunkCount != world.getChunkCount())
+		throw runtime_error("Bad world iterated chunk count.");
+}
+
+static void testVoxels()
+{
+	World world;
+	world.createChunk(0, 0, 0)->fill(voxel::null);
+	world.createChunk(-1, 0, 0)->fill(voxel::null);
+
+	world.set(-1, 2, 3, 100);
+
+	uint8_t voxel = 0;
+	if (world.getChunk(-1, 0, 0)->get(15, 2, 3) != 100 || world.get(-1, 2, 3) != 100 ||
+		world.trySet(16, 0, 0, 100) || world.tryGet(-17, 0, 0, voxel) || !world.tryGet(15, 2, 3, voxel))
+	{
+		throw runtime_error("Bad world voxel value.");
+	}
+
+	auto cluster = world.getCluster(0, 0, 0);
+	if (!cluster.c || !cluster.nx || cluster.px || cluster.ny || cluster.py || cluster.nz || cluster.pz)
+		throw runtime_error("Bad world chunk cluster.");
+	if (cluster.nx->get(15, 2, 3) != 100)
+		throw runtime_error("Bad world chunk cluster voxel value.");
+
+	world.createChunk(1, -1, 0)->fill(voxel::unknown);
+	auto fullCluster = world.getCluster27(0, 0, 0);
+	if (fullCluster.getChunk(0, 0, 0) != cluster.c || fullCluster.getChunk(-1, 0, 0) != cluster.nx ||
+		fullCluster.get(16, -1, 0) != voxel::unknown || fullCluster.get(-1, 2, 3) != 100 || fullCluster.getChunk(1, 1, 0))
+	{
+		throw runtime_error("Bad world full chunk cluster.");
+	}
+}
+
+static void testPool()
+{
+	World::Pool pool;
+	{
+		World world1(&pool), world2(&pool);
+		world1.createChunk(0, 0, 0);
+		world2.createChunk(0, 0, 0);
+		world2.createChunk(1, 0, 0);
+
+		if (&world1.getPool() != &pool || pool.getStats().usedCount != 3)
+			throw runtime_error("Bad world shared pool stats.");
+
+		world2.destroyChunk(1, 0, 0);
+		World world3 = std::move(world2);
+		if (pool.getStats().usedCount != 2 || world3.getChunkCount() != 1)
+			throw runtime_error("Bad world moved pool stats.");
+	}
+	if (pool.getStats().usedCount != 0)
+		throw runtime_error("Bad world destroyed pool stats.");
+}
+
+int main()
+{
+	testChunks();
+	testVoxels();
+	testPool();
+	return EXIT_SUCCESS;
+}
\ No newline at end of file